@@ -1,6 +1,17 @@
 // FluidVisualizationShader.fx - Colores agradables y buena visibilidad de partculas
-Texture2D g_VelocityTexture;
-SamplerState g_LinearSampler;
+//
+// La visualizacin se dibuja en dos pases. FLUID_VISUALIZATION_COLORS calcula el color de
+// cada celda del campo en una textura temporal del tamao de la rejilla y
+// FLUID_VISUALIZATION_COMPOSITE la ampla a la pantalla con filtrado lineal y aade las
+// lneas de la rejilla: el color se calcula una vez por celda en lugar de por pxel.
+// La composicin pasa cada pxel al espacio de las partculas con la cmara del modo
+// mundo y de ah a la ventana del fluido, igual que particle.vsh y move_particles.csh.
+#define FLUID_VISUALIZATION_COLORS    0
+#define FLUID_VISUALIZATION_COMPOSITE 1
+
+#ifndef FLUID_VISUALIZATION_PASS
+#   define FLUID_VISUALIZATION_PASS FLUID_VISUALIZATION_COMPOSITE
+#endif
 
 cbuffer cbFluidConstants
 {
@@ -23,10 +34,15 @@ struct PSInput
     float2 TexCoord : TEXCOORD0;
 };
 
+#if FLUID_VISUALIZATION_PASS == FLUID_VISUALIZATION_COLORS
+
+Texture2D g_VelocityTexture;
+
+// Se dibuja con un viewport del tamao de la rejilla: cada pxel es una celda
 float4 main(PSInput PSIn) : SV_TARGET
 {
-    // Leer velocidad en este punto
-    float2 velocity = g_VelocityTexture.Sample(g_LinearSampler, PSIn.TexCoord).xy;
+    // Leer velocidad en esta celda
+    float2 velocity = g_VelocityTexture.Load(int3(PSIn.Position.xy, 0)).xy;
     
     // Calcular magnitud del flujo
     float speed = length(velocity) * 5.0; // Menor amplificacin para colores ms suaves
@@ -59,14 +75,47 @@ float4 main(PSInput PSIn) : SV_TARGET
     // Mezclar basado en velocidad
     float3 finalColor = lerp(zeroColor, baseColor, saturate(speed));
     
-    // Aadir rejilla sutil
-    float2 grid = frac(PSIn.TexCoord * 15.0);
-    float gridLine = (grid.x > 0.93 || grid.y > 0.93) ? 0.1 : 0.0;
-    finalColor += float3(gridLine, gridLine, gridLine);
-    
     // Transparencia moderada para que se vean las partculas
     // Ms transparente en general, pero ms opaco en zonas de alta velocidad
     float alpha = saturate(0.2 + speed * 0.2);
     
     return float4(finalColor, alpha);
-}
\ No newline at end of file
+}
+
+#else
+
+// Fuera del modo mundo la vista es la identidad y la ventana est en el origen
+cbuffer cbVisualizationConstants
+{
+    float2 f2ViewCenter;
+    float2 f2FluidWindowCenter;
+
+    float  fViewZoom;
+    float3 f3Padding0;
+}
+
+Texture2D    g_VisualizationColors;
+SamplerState g_LinearSampler;
+
+float4 main(PSInput PSIn) : SV_TARGET
+{
+    // De la pantalla al espacio de las partculas (inversa de particle.vsh)
+    float2 screenPos = float2(PSIn.TexCoord.x * 2.0 - 1.0, 1.0 - PSIn.TexCoord.y * 2.0);
+    float2 worldPos  = screenPos / fViewZoom + f2ViewCenter;
+    
+    // Misma conversin que move_particles.csh; fuera de la ventana no hay campo
+    float2 fluidUV = (worldPos - f2FluidWindowCenter + 1.0) * 0.5;
+    if (any(fluidUV < float2(0.0, 0.0)) || any(fluidUV > float2(1.0, 1.0)))
+        return float4(0.0, 0.0, 0.0, 0.0);
+    
+    float4 color = g_VisualizationColors.Sample(g_LinearSampler, fluidUV);
+    
+    // Aadir rejilla sutil, fija a las celdas del campo
+    float2 grid = frac(fluidUV * 15.0);
+    float gridLine = (grid.x > 0.93 || grid.y > 0.93) ? 0.1 : 0.0;
+    color.rgb += float3(gridLine, gridLine, gridLine);
+    
+    return color;
+}
+
+#endif
\ No newline at end of file
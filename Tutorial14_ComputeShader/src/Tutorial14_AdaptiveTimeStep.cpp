@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cmath>
+#include "Tutorial14_AdaptiveTimeStep.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de TimeStepConstants en timestep.fxh
+struct TimeStepConstants
+{
+    Uint32 uiNumParticles    = 0;
+    float  fCFLNumber        = 0;
+    float  fSubstepDeltaTime = 0;
+    float  fFluidTimeScale   = 0;
+
+    float2 f2Scale;
+    float2 f2ParticleCellSize;
+
+    uint2 u2FluidGridSize;
+    uint2 u2Padding0;
+};
+
+// Pases definidos en timestep.fxh
+enum TIMESTEP_PASS : int
+{
+    TIMESTEP_PASS_REDUCE_PARTICLES = 0,
+    TIMESTEP_PASS_REDUCE_FLUID     = 1,
+    TIMESTEP_PASS_SELECT           = 2
+};
+
+} // namespace
+
+Tutorial14_AdaptiveTimeStep::Tutorial14_AdaptiveTimeStep(IRenderDevice*             pDevice,
+                                                         IDeviceContext*            pContext,
+                                                         IEngineFactory*            pEngineFactory,
+                                                         Tutorial14_FrameAllocator* pFrameAllocator) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pEngineFactory(pEngineFactory),
+    m_pFrameAllocator(pFrameAllocator)
+{
+    const Uint32 MaxSpeeds[4] = {};
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Max speeds buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS | BIND_SHADER_RESOURCE;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = sizeof(MaxSpeeds);
+    BufferData MaxSpeedsData{MaxSpeeds, sizeof(MaxSpeeds)};
+    m_pDevice->CreateBuffer(BuffDesc, &MaxSpeedsData, &m_pMaxSpeedsBuffer);
+
+    // Hasta que se ejecute el primer subpaso se usa un intervalo de 1/60 s
+    TimeStepData InitialTimeStep;
+    InitialTimeStep.fDeltaTime       = 1.f / 60.f;
+    InitialTimeStep.fStableDeltaTime = 1.f / 60.f;
+
+    BuffDesc.Name              = "Time step buffer";
+    BuffDesc.ElementByteStride = sizeof(TimeStepData);
+    BuffDesc.Size              = sizeof(TimeStepData);
+    BufferData TimeStepInitData{&InitialTimeStep, sizeof(InitialTimeStep)};
+    m_pDevice->CreateBuffer(BuffDesc, &TimeStepInitData, &m_pTimeStepBuffer);
+
+    m_pReadback = std::make_unique<Tutorial14_AsyncReadback>(m_pDevice, m_pContext, sizeof(TimeStepData), 4, "Time step readback");
+
+    CreatePipelines();
+}
+
+void Tutorial14_AdaptiveTimeStep::CreatePipelines()
+{
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.EntryPoint                      = "main";
+    ShaderCI.FilePath                        = "timestep.csh";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+    // Las constantes son una ventana del asignador de frame
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_COMPUTE, "g_MaxSpeeds",            SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_COMPUTE, "g_TimeStep",             SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        // La textura de velocidad alterna entre dos texturas cada paso
+        {SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    auto CreatePSO = [&](TIMESTEP_PASS Pass, const char* Name, RefCntAutoPtr<IPipelineState>& pPSO, RefCntAutoPtr<IShaderResourceBinding>& pSRB) {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("TIMESTEP_GROUP_SIZE", static_cast<int>(TIMESTEP_GROUP_SIZE));
+        Macros.AddShaderMacro("TIMESTEP_PASS", static_cast<int>(Pass));
+        ShaderCI.Macros    = Macros;
+        ShaderCI.Desc.Name = Name;
+
+        RefCntAutoPtr<IShader> pCS;
+        m_pDevice->CreateShader(ShaderCI, &pCS);
+        if (!pCS)
+        {
+            LOG_ERROR_MESSAGE("Failed to create shader ", Name);
+            return;
+        }
+
+        PSODesc.Name      = Name;
+        PSOCreateInfo.pCS = pCS;
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+        if (!pPSO)
+        {
+            LOG_ERROR_MESSAGE("Failed to create PSO ", Name);
+            return;
+        }
+
+        pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "g_MaxSpeeds")->Set(m_pMaxSpeedsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+        if (auto* pTimeStepVar = pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "g_TimeStep"))
+            pTimeStepVar->Set(m_pTimeStepBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+        pPSO->CreateShaderResourceBinding(&pSRB, true);
+        m_pFrameAllocator->BindConstants(pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "TimeStepConstantsBuffer"), sizeof(TimeStepConstants));
+    };
+
+    CreatePSO(TIMESTEP_PASS_REDUCE_PARTICLES, "Reduce particle speed CS", m_pReduceParticlesPSO, m_pReduceParticlesSRB);
+    CreatePSO(TIMESTEP_PASS_REDUCE_FLUID, "Reduce fluid speed CS", m_pReduceFluidPSO, m_pReduceFluidSRB);
+    CreatePSO(TIMESTEP_PASS_SELECT, "Select time step CS", m_pSelectPSO, m_pSelectSRB);
+}
+
+void Tutorial14_AdaptiveTimeStep::SetParticleBuffer(IBuffer* pParticleAttribs)
+{
+    if (!m_pReduceParticlesPSO)
+        return;
+
+    m_pReduceParticlesSRB.Release();
+    m_pReduceParticlesPSO->CreateShaderResourceBinding(&m_pReduceParticlesSRB, true);
+    m_pReduceParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pParticleAttribs->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pFrameAllocator->BindConstants(m_pReduceParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "TimeStepConstantsBuffer"), sizeof(TimeStepConstants));
+}
+
+Uint32 Tutorial14_AdaptiveTimeStep::GetNumSubsteps(float FrameTime)
+{
+    TimeStepData Data;
+    if (m_pReadback->Poll(Data))
+    {
+        m_LastReadback = Data;
+        m_bHasReadback = true;
+    }
+
+    if (!m_bHasReadback || m_LastReadback.fStableDeltaTime <= 0)
+        return 1;
+
+    // El intervalo estable es de hace unos frames; los subpasos lo vuelven a
+    // acotar en la GPU, as que un valor algo desfasado solo ralentiza la simulacin
+    const float NumSubsteps = std::ceil(std::min(FrameTime, m_Settings.MaxFrameTime) / m_LastReadback.fStableDeltaTime);
+    return static_cast<Uint32>(clamp(NumSubsteps, 1.f, static_cast<float>(m_Settings.MaxSubsteps)));
+}
+
+void Tutorial14_AdaptiveTimeStep::ComputeTimeStep(Uint32        NumParticles,
+                                                  float         SubstepTime,
+                                                  const float2& f2Scale,
+                                                  const int2&   i2ParticleGridSize,
+                                                  ITextureView* pFluidVelocitySRV,
+                                                  Uint32        FluidGridSize,
+                                                  float         FluidTimeScale)
+{
+    if (!m_pReduceParticlesSRB || !m_pReduceFluidSRB || !m_pSelectSRB)
+        return;
+
+    // Una asignacin por subpaso para los tres pases, en lugar de un DISCARD por subpaso
+    {
+        TimeStepConstants Constants;
+        Constants.uiNumParticles     = NumParticles;
+        Constants.fCFLNumber         = m_Settings.CFLNumber;
+        Constants.fSubstepDeltaTime  = SubstepTime;
+        Constants.fFluidTimeScale    = FluidTimeScale;
+        Constants.f2Scale            = f2Scale;
+        Constants.f2ParticleCellSize = float2{2.f / static_cast<float>(std::max(i2ParticleGridSize.x, 1)),
+                                              2.f / static_cast<float>(std::max(i2ParticleGridSize.y, 1))};
+        Constants.u2FluidGridSize    = uint2{FluidGridSize, FluidGridSize};
+        Constants.u2Padding0         = uint2{0, 0};
+
+        const Uint32 Offset = m_pFrameAllocator->Allocate(Constants);
+        for (IShaderResourceBinding* pSRB : {m_pReduceParticlesSRB.RawPtr(), m_pReduceFluidSRB.RawPtr(), m_pSelectSRB.RawPtr()})
+        {
+            if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "TimeStepConstantsBuffer"))
+                pVar->SetBufferOffset(Offset);
+        }
+    }
+
+    m_pContext->SetPipelineState(m_pReduceParticlesPSO);
+    m_pContext->CommitShaderResources(m_pReduceParticlesSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{(NumParticles + TIMESTEP_GROUP_SIZE - 1) / TIMESTEP_GROUP_SIZE});
+
+    if (pFluidVelocitySRV != nullptr)
+    {
+        m_pReduceFluidSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture")->Set(pFluidVelocitySRV);
+        m_pContext->SetPipelineState(m_pReduceFluidPSO);
+        m_pContext->CommitShaderResources(m_pReduceFluidSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pContext->DispatchCompute(DispatchComputeAttribs{(FluidGridSize + 15) / 16, (FluidGridSize + 15) / 16});
+    }
+
+    m_pContext->SetPipelineState(m_pSelectPSO);
+    m_pContext->CommitShaderResources(m_pSelectSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{1});
+}
+
+void Tutorial14_AdaptiveTimeStep::EnqueueReadback()
+{
+    m_pReadback->Enqueue(m_pTimeStepBuffer);
+}
+
+} // namespace Diligent
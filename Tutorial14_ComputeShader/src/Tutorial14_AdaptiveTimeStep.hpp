@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Tutorial14_AsyncReadback.hpp"
+
+namespace Diligent
+{
+
+class Tutorial14_FrameAllocator;
+
+// Intervalo de tiempo adaptativo segn la condicin CFL. Antes de cada subpaso se
+// reducen en la GPU la velocidad mxima de las partculas y del fluido, y un pase
+// de un solo hilo escribe el intervalo estable en un bfer que leen directamente
+// move_particles.csh y los shaders del fluido, sin esperar a la CPU.
+// El nmero de subpasos por frame se decide en la CPU con el intervalo estable
+// ledo de forma asncrona unos frames antes.
+class Tutorial14_AdaptiveTimeStep
+{
+public:
+    static constexpr Uint32 TIMESTEP_GROUP_SIZE = 256;
+
+    // Espejo de TimeStepData en timestep.fxh
+    struct TimeStepData
+    {
+        float fDeltaTime        = 0;
+        float fStableDeltaTime  = 0;
+        float fMaxParticleSpeed = 0;
+        float fMaxFluidSpeed    = 0;
+    };
+
+    struct Settings
+    {
+        float  CFLNumber    = 0.5f;
+        Uint32 MaxSubsteps  = 8;
+        float  MaxFrameTime = 0.1f; // Tiempo mximo simulado por frame, en segundos
+    };
+
+    Tutorial14_AdaptiveTimeStep(IRenderDevice*             pDevice,
+                                IDeviceContext*            pContext,
+                                IEngineFactory*            pEngineFactory,
+                                Tutorial14_FrameAllocator* pFrameAllocator);
+
+    // Debe llamarse cada vez que se recrea el bfer de partculas
+    void SetParticleBuffer(IBuffer* pParticleAttribs);
+
+    // Bfer con el TimeStepData del subpaso en curso
+    IBuffer* GetTimeStepBuffer() const { return m_pTimeStepBuffer; }
+
+    // Nmero de subpasos para simular FrameTime segundos, segn el ltimo intervalo estable conocido
+    Uint32 GetNumSubsteps(float FrameTime);
+
+    // Graba las reducciones y la seleccin del intervalo de un subpaso
+    void ComputeTimeStep(Uint32        NumParticles,
+                         float         SubstepTime,
+                         const float2& f2Scale,
+                         const int2&   i2ParticleGridSize,
+                         ITextureView* pFluidVelocitySRV,
+                         Uint32        FluidGridSize,
+                         float         FluidTimeScale);
+
+    // Copia asncrona del ltimo TimeStepData; llamar una vez por frame tras los subpasos
+    void EnqueueReadback();
+
+    const TimeStepData& GetLastReadback() const { return m_LastReadback; }
+
+    Settings& GetSettings() { return m_Settings; }
+
+private:
+    void CreatePipelines();
+
+    IRenderDevice*             m_pDevice         = nullptr;
+    IDeviceContext*            m_pContext        = nullptr;
+    IEngineFactory*            m_pEngineFactory  = nullptr;
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
+
+    RefCntAutoPtr<IBuffer> m_pMaxSpeedsBuffer;
+    RefCntAutoPtr<IBuffer> m_pTimeStepBuffer;
+
+    RefCntAutoPtr<IPipelineState>         m_pReduceParticlesPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pReduceParticlesSRB;
+    RefCntAutoPtr<IPipelineState>         m_pReduceFluidPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pReduceFluidSRB;
+    RefCntAutoPtr<IPipelineState>         m_pSelectPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pSelectSRB;
+
+    std::unique_ptr<Tutorial14_AsyncReadback> m_pReadback;
+
+    Settings     m_Settings;
+    TimeStepData m_LastReadback;
+    bool         m_bHasReadback = false;
+};
+
+} // namespace Diligent
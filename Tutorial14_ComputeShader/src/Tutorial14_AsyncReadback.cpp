@@ -0,0 +1,135 @@
+#include <cstring>
+#include "Tutorial14_AsyncReadback.hpp"
+
+namespace Diligent
+{
+
+Tutorial14_AsyncReadback::Tutorial14_AsyncReadback(IRenderDevice*  pDevice,
+                                                   IDeviceContext* pContext,
+                                                   Uint64          Size,
+                                                   Uint32          NumSlots,
+                                                   const char*     Name) :
+    m_pContext(pContext),
+    m_Size(Size)
+{
+    FenceDesc FDesc;
+    FDesc.Name = Name;
+    pDevice->CreateFence(FDesc, &m_pFence);
+    if (!m_pFence)
+    {
+        LOG_ERROR_MESSAGE("Failed to create readback fence for ", Name);
+        return;
+    }
+
+    m_Slots.resize(NumSlots);
+    for (auto& Slot : m_Slots)
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name           = Name;
+        BuffDesc.Usage          = USAGE_STAGING;
+        BuffDesc.CPUAccessFlags = CPU_ACCESS_READ;
+        BuffDesc.Size           = Size;
+        pDevice->CreateBuffer(BuffDesc, nullptr, &Slot.pStagingBuffer);
+        if (!Slot.pStagingBuffer)
+        {
+            LOG_ERROR_MESSAGE("Failed to create readback staging buffer for ", Name);
+            m_Slots.clear();
+            return;
+        }
+    }
+}
+
+bool Tutorial14_AsyncReadback::Enqueue(IBuffer* pSrcBuffer, Uint64 SrcOffset)
+{
+    if (!IsValid() || pSrcBuffer == nullptr)
+        return false;
+
+    auto& Slot = m_Slots[m_NextSlot];
+    if (Slot.Pending)
+        return false;
+
+    m_pContext->CopyBuffer(pSrcBuffer, SrcOffset, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                           Slot.pStagingBuffer, 0, m_Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    Slot.FenceValue = m_NextFenceValue++;
+    Slot.FrameId    = m_FrameId;
+    Slot.Pending    = true;
+    m_pContext->EnqueueSignal(m_pFence, Slot.FenceValue);
+
+    m_NextSlot = (m_NextSlot + 1) % static_cast<Uint32>(m_Slots.size());
+    return true;
+}
+
+bool Tutorial14_AsyncReadback::Poll(void* pData, Uint64* pFrameId)
+{
+    if (!IsValid())
+        return false;
+
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+
+    Slot* pNewest = nullptr;
+    for (auto& Slot : m_Slots)
+    {
+        if (Slot.Pending && Slot.FenceValue <= CompletedValue)
+        {
+            if (pNewest == nullptr || Slot.FenceValue > pNewest->FenceValue)
+                pNewest = &Slot;
+            Slot.Pending = false;
+        }
+    }
+    if (pNewest == nullptr)
+        return false;
+
+    return ReadSlot(*pNewest, pData, pFrameId);
+}
+
+bool Tutorial14_AsyncReadback::PollOldest(void* pData, Uint64* pFrameId)
+{
+    if (!IsValid())
+        return false;
+
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+
+    Slot* pOldest = nullptr;
+    for (auto& Slot : m_Slots)
+    {
+        if (Slot.Pending && Slot.FenceValue <= CompletedValue)
+        {
+            if (pOldest == nullptr || Slot.FenceValue < pOldest->FenceValue)
+                pOldest = &Slot;
+        }
+    }
+    if (pOldest == nullptr)
+        return false;
+
+    pOldest->Pending = false;
+    return ReadSlot(*pOldest, pData, pFrameId);
+}
+
+bool Tutorial14_AsyncReadback::HasPendingCopies() const
+{
+    for (const auto& Slot : m_Slots)
+    {
+        if (Slot.Pending)
+            return true;
+    }
+    return false;
+}
+
+bool Tutorial14_AsyncReadback::ReadSlot(const Slot& ReadbackSlot, void* pData, Uint64* pFrameId)
+{
+    // La fence garantiza que la copia ha terminado, as que el mapeo no espera
+    void* pMappedData = nullptr;
+    m_pContext->MapBuffer(ReadbackSlot.pStagingBuffer, MAP_READ, MAP_FLAG_DO_NOT_WAIT, pMappedData);
+    if (pMappedData == nullptr)
+        return false;
+
+    memcpy(pData, pMappedData, static_cast<size_t>(m_Size));
+    m_pContext->UnmapBuffer(ReadbackSlot.pStagingBuffer, MAP_READ);
+
+    if (pFrameId != nullptr)
+        *pFrameId = ReadbackSlot.FrameId;
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+// Anillo de bfers de lectura (staging) para copiar datos de la GPU a la CPU sin
+// bloquear. Enqueue() copia el bfer origen a la siguiente ranura libre y marca
+// la copia con una seal de fence; Poll() devuelve los datos de la copia
+// completada ms reciente. Si todas las ranuras estn ocupadas la copia se omite.
+class Tutorial14_AsyncReadback
+{
+public:
+    Tutorial14_AsyncReadback(IRenderDevice*  pDevice,
+                             IDeviceContext* pContext,
+                             Uint64          Size,
+                             Uint32          NumSlots,
+                             const char*     Name);
+
+    bool IsValid() const { return m_pFence != nullptr && !m_Slots.empty(); }
+
+    // Copia Size bytes de pSrcBuffer a partir de SrcOffset. Devuelve false si no hay ranura libre.
+    bool Enqueue(IBuffer* pSrcBuffer, Uint64 SrcOffset = 0);
+
+    // Copia en pData los datos de la copia completada ms reciente y libera todas
+    // las completadas. Devuelve false si ninguna copia ha terminado todava.
+    bool Poll(void* pData, Uint64* pFrameId = nullptr);
+
+    template <typename DataType>
+    bool Poll(DataType& Data, Uint64* pFrameId = nullptr)
+    {
+        VERIFY_EXPR(sizeof(DataType) <= m_Size);
+        return Poll(&Data, pFrameId);
+    }
+
+    // Como Poll(), pero devuelve la copia completada ms antigua y libera solo esa,
+    // para consumidores que necesitan todas las copias en orden
+    bool PollOldest(void* pData, Uint64* pFrameId = nullptr);
+
+    bool HasPendingCopies() const;
+
+    // Nmero de frame que se asocia a la prxima copia
+    void SetFrameId(Uint64 FrameId) { m_FrameId = FrameId; }
+
+    Uint64 GetSize() const { return m_Size; }
+
+private:
+    struct Slot
+    {
+        RefCntAutoPtr<IBuffer> pStagingBuffer;
+        Uint64                 FenceValue = 0;
+        Uint64                 FrameId    = 0;
+        bool                   Pending    = false;
+    };
+
+    bool ReadSlot(const Slot& ReadbackSlot, void* pData, Uint64* pFrameId);
+
+    IDeviceContext*       m_pContext = nullptr;
+    RefCntAutoPtr<IFence> m_pFence;
+    std::vector<Slot>     m_Slots;
+
+    Uint64 m_Size           = 0;
+    Uint64 m_NextFenceValue = 1;
+    Uint32 m_NextSlot       = 0;
+    Uint64 m_FrameId        = 0;
+};
+
+} // namespace Diligent
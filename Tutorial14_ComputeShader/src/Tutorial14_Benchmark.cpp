@@ -0,0 +1,322 @@
+#include "Tutorial14_Benchmark.hpp"
+#include "Tutorial14_ComputeShader.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Pases del perfilador que miden el trabajo de partculas y de fluido. Se usan para
+// calcular partculas por segundo y celdas por segundo.
+const char* const ParticlePasses[] = {"Reset particle lists", "Move particles", "Collide particles", "Update particle speed"};
+const char* const FluidPasses[]    = {"Fluid force", "Fluid advection"};
+
+// Modos de visualizacin que recorre el barrido
+struct BenchmarkMode
+{
+    VisualizationMode Mode;
+    bool              ShowFluidVisualization;
+    PaintMethod       Paint;
+};
+const BenchmarkMode BenchmarkModes[] = {
+    {VisualizationMode::FLUID_VISUALIZATION, true, PaintMethod::RASTER},
+    {VisualizationMode::FLUID_VISUALIZATION, false, PaintMethod::RASTER},
+    {VisualizationMode::PAINT_CANVAS, false, PaintMethod::RASTER},
+    {VisualizationMode::PAINT_CANVAS, false, PaintMethod::TILED_COMPUTE},
+};
+
+const char* GetModeName(VisualizationMode Mode)
+{
+    switch (Mode)
+    {
+        case VisualizationMode::FLUID_VISUALIZATION: return "fluid";
+        case VisualizationMode::PAINT_CANVAS: return "paint";
+        case VisualizationMode::SCENE_BATCH: return "scene_batch";
+        default: return "unknown";
+    }
+}
+
+const char* GetPaintMethodName(PaintMethod Method)
+{
+    switch (Method)
+    {
+        case PaintMethod::RASTER: return "raster";
+        case PaintMethod::TILED_COMPUTE: return "tiled_compute";
+        default: return "unknown";
+    }
+}
+
+bool IsInList(const std::string& Name, const char* const* List, size_t Count)
+{
+    for (size_t i = 0; i < Count; ++i)
+    {
+        if (Name == List[i])
+            return true;
+    }
+    return false;
+}
+
+std::string EscapeJSON(const std::string& Str)
+{
+    std::string Escaped;
+    Escaped.reserve(Str.size());
+    for (char c : Str)
+    {
+        if (c == '"' || c == '\\')
+        {
+            Escaped += '\\';
+            Escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) >= 0x20)
+        {
+            Escaped += c;
+        }
+    }
+    return Escaped;
+}
+
+} // namespace
+
+void Tutorial14_Benchmark::Accumulator::Add(double Value)
+{
+    Min = Count > 0 ? std::min(Min, Value) : Value;
+    Max = Count > 0 ? std::max(Max, Value) : Value;
+    Sum += Value;
+    ++Count;
+}
+
+Tutorial14_Benchmark::Tutorial14_Benchmark(const Settings& BenchSettings, std::string DeviceName, std::string AdapterName) :
+    m_Settings(BenchSettings),
+    m_DeviceName(std::move(DeviceName)),
+    m_AdapterName(std::move(AdapterName))
+{
+    for (int NumParticles : m_Settings.ParticleCounts)
+    {
+        for (int ThreadGroupSize : m_Settings.ThreadGroupSizes)
+        {
+            for (Uint32 GridSize : m_Settings.FluidGridSizes)
+            {
+                for (const auto& Mode : BenchmarkModes)
+                {
+                    if (Mode.Paint == PaintMethod::TILED_COMPUTE && !m_Settings.TiledPaint)
+                        continue;
+
+                    BenchmarkCase Case;
+                    Case.NumParticles           = NumParticles;
+                    Case.ThreadGroupSize        = ThreadGroupSize;
+                    Case.FluidGridSize          = GridSize;
+                    Case.Mode                   = Mode.Mode;
+                    Case.ShowFluidVisualization = Mode.ShowFluidVisualization;
+                    Case.Paint                  = Mode.Paint;
+                    Case.ParticleCoupling       = m_Settings.ParticleCoupling;
+                    m_Cases.push_back(Case);
+                }
+            }
+        }
+    }
+    m_Results.resize(m_Cases.size());
+    m_Settings.MeasureFrames = std::max(m_Settings.MeasureFrames, 1u);
+
+    if (m_Cases.empty())
+    {
+        LOG_ERROR_MESSAGE("Benchmark has no cases to run");
+        m_State = State::Finished;
+    }
+    else
+    {
+        LOG_INFO_MESSAGE("Benchmark started: ", m_Cases.size(), " cases, ", m_Settings.WarmUpFrames, " warm-up and ",
+                         m_Settings.MeasureFrames, " measured frames per case");
+    }
+}
+
+const BenchmarkCase* Tutorial14_Benchmark::BeginFrame(Uint64 FrameId)
+{
+    m_FrameId = FrameId;
+    if (m_State != State::Running)
+        return nullptr;
+
+    if (m_CaseFrame == 0)
+    {
+        auto& Result              = m_Results[m_CaseIdx];
+        Result.FirstMeasuredFrame = FrameId + m_Settings.WarmUpFrames;
+        Result.LastMeasuredFrame  = Result.FirstMeasuredFrame + m_Settings.MeasureFrames - 1;
+        return &m_Cases[m_CaseIdx];
+    }
+    return nullptr;
+}
+
+void Tutorial14_Benchmark::EndFrame(double CPUSubmitMs, double FrameMs)
+{
+    if (m_State == State::Draining)
+    {
+        // Esperar a que lleguen los tiempos de GPU de los ltimos frames medidos
+        if (++m_DrainFrames > Tutorial14_GPUProfiler::NUM_FRAMES_IN_FLIGHT + 2)
+        {
+            WriteResults();
+            m_State = State::Finished;
+        }
+        return;
+    }
+    if (m_State != State::Running)
+        return;
+
+    auto& Result = m_Results[m_CaseIdx];
+    if (m_CaseFrame >= m_Settings.WarmUpFrames)
+    {
+        Result.CPUSubmitMs.Add(CPUSubmitMs);
+        Result.FrameMs.Add(FrameMs);
+    }
+
+    if (++m_CaseFrame == m_Settings.WarmUpFrames + m_Settings.MeasureFrames)
+    {
+        Result.Measured = true;
+        m_CaseFrame     = 0;
+        if (++m_CaseIdx == m_Cases.size())
+            m_State = State::Draining;
+    }
+}
+
+void Tutorial14_Benchmark::AddGPUTimings(const Tutorial14_GPUProfiler::FrameTimings& Timings)
+{
+    if (m_State == State::Finished)
+        return;
+
+    for (auto& Result : m_Results)
+    {
+        if (Timings.FrameId < Result.FirstMeasuredFrame || Timings.FrameId > Result.LastMeasuredFrame || Result.FirstMeasuredFrame == 0)
+            continue;
+
+        for (const auto& Pass : Timings.Passes)
+        {
+            auto it = std::find_if(Result.GPUPasses.begin(), Result.GPUPasses.end(),
+                                   [&](const PassAccumulator& Acc) { return Acc.Name == Pass.Name; });
+            if (it == Result.GPUPasses.end())
+            {
+                Result.GPUPasses.push_back({Pass.Name, {}});
+                it = Result.GPUPasses.end() - 1;
+            }
+            it->Time.Add(Pass.Milliseconds);
+        }
+        ++Result.NumGPUFrames;
+        break;
+    }
+}
+
+float Tutorial14_Benchmark::GetProgress() const
+{
+    if (m_Cases.empty() || m_State == State::Finished)
+        return 1.f;
+
+    const double FramesPerCase = static_cast<double>(m_Settings.WarmUpFrames + m_Settings.MeasureFrames);
+    const double Done          = static_cast<double>(m_CaseIdx) * FramesPerCase + static_cast<double>(m_CaseFrame);
+    return static_cast<float>(std::min(Done / (FramesPerCase * static_cast<double>(m_Cases.size())), 1.0));
+}
+
+bool Tutorial14_Benchmark::ParseList(const char* Str, std::vector<int>& Values)
+{
+    std::vector<int> Parsed;
+    while (Str != nullptr && *Str != '\0')
+    {
+        char* pEnd  = nullptr;
+        long  Value = std::strtol(Str, &pEnd, 10);
+        if (pEnd == Str || Value <= 0)
+            return false;
+        Parsed.push_back(static_cast<int>(Value));
+        Str = (*pEnd == ',') ? pEnd + 1 : pEnd;
+        if (*pEnd != ',' && *pEnd != '\0')
+            return false;
+    }
+    if (Parsed.empty())
+        return false;
+
+    Values = std::move(Parsed);
+    return true;
+}
+
+void Tutorial14_Benchmark::WriteResults()
+{
+    std::ofstream Out{m_Settings.OutputPath};
+    if (!Out)
+    {
+        LOG_ERROR_MESSAGE("Failed to open benchmark output file '", m_Settings.OutputPath, "'");
+        return;
+    }
+
+    Out << "{\n";
+    Out << "  \"sample\": \"Tutorial14_ComputeShader\",\n";
+    Out << "  \"device\": \"" << EscapeJSON(m_DeviceName) << "\",\n";
+    Out << "  \"adapter\": \"" << EscapeJSON(m_AdapterName) << "\",\n";
+    Out << "  \"warmup_frames\": " << m_Settings.WarmUpFrames << ",\n";
+    Out << "  \"measured_frames\": " << m_Settings.MeasureFrames << ",\n";
+    Out << "  \"results\": [";
+    for (size_t i = 0; i < m_Cases.size(); ++i)
+    {
+        const auto& Case   = m_Cases[i];
+        const auto& Result = m_Results[i];
+
+        double ParticleGPUMs = 0;
+        double FluidGPUMs    = 0;
+        double TotalGPUMs    = 0;
+        for (const auto& Pass : Result.GPUPasses)
+        {
+            TotalGPUMs += Pass.Time.Mean();
+            if (IsInList(Pass.Name, ParticlePasses, _countof(ParticlePasses)))
+                ParticleGPUMs += Pass.Time.Mean();
+            if (IsInList(Pass.Name, FluidPasses, _countof(FluidPasses)))
+                FluidGPUMs += Pass.Time.Mean();
+        }
+        // Sin consultas de tiempo en GPU se usa el tiempo de frame como cota superior
+        if (Result.NumGPUFrames == 0)
+            ParticleGPUMs = FluidGPUMs = Result.FrameMs.Mean();
+
+        const double NumCells = static_cast<double>(Case.FluidGridSize) * static_cast<double>(Case.FluidGridSize);
+
+        Out << (i > 0 ? ",\n" : "\n");
+        Out << "    {\n";
+        Out << "      \"num_particles\": " << Case.NumParticles << ",\n";
+        Out << "      \"thread_group_size\": " << Case.ThreadGroupSize << ",\n";
+        Out << "      \"fluid_grid_size\": " << Case.FluidGridSize << ",\n";
+        Out << "      \"visualization_mode\": \"" << GetModeName(Case.Mode) << "\",\n";
+        Out << "      \"fluid_overlay\": " << (Case.ShowFluidVisualization ? "true" : "false") << ",\n";
+        if (Case.Mode == VisualizationMode::PAINT_CANVAS)
+            Out << "      \"paint_method\": \"" << GetPaintMethodName(Case.Paint) << "\",\n";
+        Out << "      \"particle_sleep\": " << (Case.ParticleSleep ? "true" : "false") << ",\n";
+        Out << "      \"neighbor_lists\": " << (Case.NeighborLists ? "true" : "false") << ",\n";
+        Out << "      \"sph_fluid\": " << (Case.SPHFluid ? "true" : "false") << ",\n";
+        Out << "      \"particle_coupling\": " << Case.ParticleCoupling << ",\n";
+        Out << "      \"async_compute\": " << (Case.AsyncCompute ? "true" : "false") << ",\n";
+        Out << "      \"pipelined_particles\": " << (Case.PipelinedParticles ? "true" : "false") << ",\n";
+        Out << "      \"measured\": " << (Result.Measured ? "true" : "false") << ",\n";
+        Out << "      \"frame_ms\": " << Result.FrameMs.Mean() << ",\n";
+        Out << "      \"cpu_submit_ms\": {\"mean\": " << Result.CPUSubmitMs.Mean() << ", \"min\": " << Result.CPUSubmitMs.Min
+            << ", \"max\": " << Result.CPUSubmitMs.Max << "},\n";
+        Out << "      \"gpu_frames\": " << Result.NumGPUFrames << ",\n";
+        Out << "      \"gpu_total_ms\": " << TotalGPUMs << ",\n";
+        Out << "      \"gpu_passes_ms\": {";
+        for (size_t p = 0; p < Result.GPUPasses.size(); ++p)
+        {
+            const auto& Pass = Result.GPUPasses[p];
+            Out << (p > 0 ? ",\n" : "\n");
+            Out << "        \"" << EscapeJSON(Pass.Name) << "\": {\"mean\": " << Pass.Time.Mean() << ", \"min\": " << Pass.Time.Min
+                << ", \"max\": " << Pass.Time.Max << "}";
+        }
+        Out << (Result.GPUPasses.empty() ? "},\n" : "\n      },\n");
+        Out << "      \"particles_per_second\": " << (ParticleGPUMs > 0 ? Case.NumParticles * 1000.0 / ParticleGPUMs : 0.0) << ",\n";
+        Out << "      \"cells_per_second\": " << (FluidGPUMs > 0 ? NumCells * 1000.0 / FluidGPUMs : 0.0) << "\n";
+        Out << "    }";
+    }
+    Out << "\n  ]\n}\n";
+
+    m_bWriteSucceeded = static_cast<bool>(Out);
+    if (m_bWriteSucceeded)
+        LOG_INFO_MESSAGE("Benchmark results written to '", m_Settings.OutputPath, "'");
+    else
+        LOG_ERROR_MESSAGE("Failed to write benchmark results to '", m_Settings.OutputPath, "'");
+}
+
+} // namespace Diligent
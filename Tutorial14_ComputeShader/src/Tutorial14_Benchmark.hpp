@@ -0,0 +1,139 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "BasicMath.hpp"
+#include "Tutorial14_GPUProfiler.hpp"
+
+namespace Diligent
+{
+
+enum class VisualizationMode;
+enum class PaintMethod;
+
+// Una combinacin concreta de parmetros del barrido
+struct BenchmarkCase
+{
+    int               NumParticles    = 0;
+    int               ThreadGroupSize = 0;
+    Uint32            FluidGridSize   = 0;
+    VisualizationMode Mode{};
+    bool              ShowFluidVisualization = false;
+    PaintMethod       Paint{};
+
+    // Opciones de la simulacin, iguales en todos los casos para que el resultado no dependa
+    // de la interfaz. El perfilador solo mide la cola grfica, as que el fluido y las
+    // partculas no usan la cola de cmputo asncrona.
+    bool  ParticleSleep      = false;
+    bool  NeighborLists      = false;
+    bool  SPHFluid           = false;
+    float ParticleCoupling   = 0;
+    bool  AsyncCompute       = false;
+    bool  PipelinedParticles = false;
+};
+
+// Barrido de rendimiento reproducible. Recorre el producto cartesiano de los
+// parmetros configurados; cada caso se calienta durante WarmUpFrames frames y se
+// mide durante MeasureFrames frames. Los resultados se escriben en JSON.
+class Tutorial14_Benchmark
+{
+public:
+    struct Settings
+    {
+        std::vector<int>    ParticleCounts   = {1000, 10000, 50000, 100000};
+        std::vector<int>    ThreadGroupSizes = {64, 256};
+        std::vector<Uint32> FluidGridSizes   = {128, 256, 512};
+
+        // Incluir los casos con pintura por tiles (solo si el dispositivo la admite)
+        bool TiledPaint = true;
+
+        // Acoplamiento de las partculas con el fluido en todos los casos (el valor por
+        // defecto de Tutorial14_FluidSimulation)
+        float ParticleCoupling = 2.0f;
+
+        Uint32      WarmUpFrames  = 60;
+        Uint32      MeasureFrames = 240;
+        std::string OutputPath    = "Tutorial14_Benchmark.json";
+    };
+
+    // Intervalo de tiempo fijo que se usa durante el barrido para que la simulacin
+    // sea la misma en todas las ejecuciones
+    static constexpr float FIXED_TIME_STEP = 1.f / 60.f;
+
+    Tutorial14_Benchmark(const Settings& BenchSettings, std::string DeviceName, std::string AdapterName);
+
+    // Devuelve el caso que hay que aplicar antes de renderizar este frame, o nullptr
+    const BenchmarkCase* BeginFrame(Uint64 FrameId);
+    void                 EndFrame(double CPUSubmitMs, double FrameMs);
+
+    // Asigna los tiempos de GPU resueltos (con retraso) al caso al que pertenecen
+    void AddGPUTimings(const Tutorial14_GPUProfiler::FrameTimings& Timings);
+
+    bool IsFinished() const { return m_State == State::Finished; }
+    bool WriteSucceeded() const { return m_bWriteSucceeded; }
+
+    size_t GetNumCases() const { return m_Cases.size(); }
+    size_t GetCurrentCase() const { return m_CaseIdx; }
+    float  GetProgress() const;
+
+    const std::string& GetOutputPath() const { return m_Settings.OutputPath; }
+
+    // Parsea una lista separada por comas, p. ej. "1000,10000"
+    static bool ParseList(const char* Str, std::vector<int>& Values);
+
+private:
+    struct Accumulator
+    {
+        double Sum   = 0;
+        double Min   = 0;
+        double Max   = 0;
+        Uint32 Count = 0;
+
+        void   Add(double Value);
+        double Mean() const { return Count > 0 ? Sum / Count : 0; }
+    };
+
+    struct PassAccumulator
+    {
+        std::string Name;
+        Accumulator Time;
+    };
+
+    struct CaseResult
+    {
+        Uint64 FirstMeasuredFrame = 0;
+        Uint64 LastMeasuredFrame  = 0;
+        bool   Measured           = false;
+
+        Accumulator                  CPUSubmitMs;
+        Accumulator                  FrameMs;
+        std::vector<PassAccumulator> GPUPasses;
+        Uint32                       NumGPUFrames = 0;
+    };
+
+    enum class State
+    {
+        Running,
+        Draining,
+        Finished
+    };
+
+    void WriteResults();
+
+    Settings    m_Settings;
+    std::string m_DeviceName;
+    std::string m_AdapterName;
+
+    std::vector<BenchmarkCase> m_Cases;
+    std::vector<CaseResult>    m_Results;
+
+    State  m_State       = State::Running;
+    size_t m_CaseIdx     = 0;
+    Uint32 m_CaseFrame   = 0;
+    Uint32 m_DrainFrames = 0;
+    Uint64 m_FrameId     = 0;
+
+    bool m_bWriteSucceeded = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Tutorial14_CPUTrace.hpp"
+#include "Errors.hpp"
+
+namespace Diligent
+{
+
+std::atomic<bool> Tutorial14_CPUTrace::s_bEnabled{true};
+
+namespace
+{
+
+// Entrada del bfer circular protegida con un seqlock: Seq es impar mientras el hilo
+// propietario la escribe y vale 2 * (ndice de la zona + 1) cuando est completa. El
+// volcado descarta las entradas cuyo Seq cambia durante la copia.
+struct ZoneSlot
+{
+    std::atomic<Uint64>      Seq{0};
+    std::atomic<const char*> Name{nullptr};
+    std::atomic<Uint64>      BeginNs{0};
+    std::atomic<Uint64>      EndNs{0};
+};
+
+// Bfer circular de un hilo. Solo lo escribe su hilo; el ndice se publica con
+// release para que el volcado sepa qu entradas existen.
+struct ThreadRing
+{
+    std::unique_ptr<ZoneSlot[]> Slots{new ZoneSlot[Tutorial14_CPUTrace::RING_SIZE]};
+    std::atomic<Uint64>         NumWritten{0};
+
+    Uint32      ThreadId = 0;
+    std::string ThreadName;
+};
+
+// Registro global de bfers. El mutex solo se toma al registrar un hilo nuevo y al
+// volcar; los bfers nunca se liberan para que las zonas de hilos ya terminados
+// sigan disponibles.
+struct ThreadRegistry
+{
+    std::mutex                               Mtx;
+    std::vector<std::unique_ptr<ThreadRing>> Rings;
+};
+
+ThreadRegistry& GetRegistry()
+{
+    static ThreadRegistry Registry;
+    return Registry;
+}
+
+ThreadRing& GetThreadRing()
+{
+    thread_local ThreadRing* pRing = nullptr;
+    if (pRing == nullptr)
+    {
+        auto& Registry = GetRegistry();
+
+        std::lock_guard<std::mutex> Lock{Registry.Mtx};
+        Registry.Rings.emplace_back(new ThreadRing);
+        pRing           = Registry.Rings.back().get();
+        pRing->ThreadId = static_cast<Uint32>(Registry.Rings.size());
+    }
+    return *pRing;
+}
+
+void WriteEscaped(std::ostream& Out, const char* Str)
+{
+    for (; *Str != '\0'; ++Str)
+    {
+        if (*Str == '"' || *Str == '\\')
+            Out << '\\';
+        Out << *Str;
+    }
+}
+
+} // namespace
+
+void Tutorial14_CPUTrace::Record(const char* Name, Uint64 BeginNs, Uint64 EndNs)
+{
+    auto&        Ring = GetThreadRing();
+    const Uint64 Idx  = Ring.NumWritten.load(std::memory_order_relaxed);
+
+    auto& Slot = Ring.Slots[Idx % RING_SIZE];
+    Slot.Seq.store(2 * Idx + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    Slot.Name.store(Name, std::memory_order_relaxed);
+    Slot.BeginNs.store(BeginNs, std::memory_order_relaxed);
+    Slot.EndNs.store(EndNs, std::memory_order_relaxed);
+    Slot.Seq.store(2 * Idx + 2, std::memory_order_release);
+    Ring.NumWritten.store(Idx + 1, std::memory_order_release);
+}
+
+void Tutorial14_CPUTrace::SetThreadName(const char* Name)
+{
+    auto&                       Ring = GetThreadRing();
+    std::lock_guard<std::mutex> Lock{GetRegistry().Mtx};
+    Ring.ThreadName = Name;
+}
+
+bool Tutorial14_CPUTrace::WriteChromeTrace(const std::string& Path)
+{
+    struct ThreadZones
+    {
+        Uint32            ThreadId = 0;
+        std::string       ThreadName;
+        std::vector<Zone> Zones;
+    };
+    std::vector<ThreadZones> Threads;
+
+    Uint64 BaseNs = ~Uint64{0};
+    {
+        auto&                       Registry = GetRegistry();
+        std::lock_guard<std::mutex> Lock{Registry.Mtx};
+        for (const auto& pRing : Registry.Rings)
+        {
+            const Uint64 NumWritten = pRing->NumWritten.load(std::memory_order_acquire);
+            const Uint64 First      = NumWritten > RING_SIZE ? NumWritten - RING_SIZE : 0;
+
+            ThreadZones Thread;
+            Thread.ThreadId   = pRing->ThreadId;
+            Thread.ThreadName = pRing->ThreadName;
+            Thread.Zones.reserve(static_cast<size_t>(NumWritten - First));
+            for (Uint64 i = First; i < NumWritten; ++i)
+            {
+                const auto&  Slot = pRing->Slots[i % RING_SIZE];
+                const Uint64 Seq  = Slot.Seq.load(std::memory_order_acquire);
+                // La entrada ya pertenece a una zona posterior o se est escribiendo
+                if (Seq != 2 * i + 2)
+                    continue;
+
+                Zone Copy;
+                Copy.Name    = Slot.Name.load(std::memory_order_relaxed);
+                Copy.BeginNs = Slot.BeginNs.load(std::memory_order_relaxed);
+                Copy.EndNs   = Slot.EndNs.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                // Sobrescrita durante la copia
+                if (Slot.Seq.load(std::memory_order_relaxed) != Seq)
+                    continue;
+
+                Thread.Zones.push_back(Copy);
+                BaseNs = std::min(BaseNs, Copy.BeginNs);
+            }
+            Threads.emplace_back(std::move(Thread));
+        }
+    }
+
+    std::ofstream Out{Path};
+    if (!Out)
+    {
+        LOG_ERROR_MESSAGE("Failed to open CPU trace output file '", Path, "'");
+        return false;
+    }
+
+    // Chrome trace usa microsegundos; se conservan tres decimales para no perder
+    // la resolucin de nanosegundos
+    Out.setf(std::ios::fixed);
+    Out.precision(3);
+
+    Out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool bFirst = true;
+    for (const auto& Thread : Threads)
+    {
+        if (!Thread.ThreadName.empty())
+        {
+            Out << (bFirst ? "\n" : ",\n");
+            Out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << Thread.ThreadId << ",\"args\":{\"name\":\"";
+            WriteEscaped(Out, Thread.ThreadName.c_str());
+            Out << "\"}}";
+            bFirst = false;
+        }
+
+        for (const auto& Zone : Thread.Zones)
+        {
+            Out << (bFirst ? "\n" : ",\n");
+            Out << "{\"name\":\"";
+            WriteEscaped(Out, Zone.Name);
+            Out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << Thread.ThreadId
+                << ",\"ts\":" << static_cast<double>(Zone.BeginNs - BaseNs) / 1000.0
+                << ",\"dur\":" << static_cast<double>(Zone.EndNs - Zone.BeginNs) / 1000.0 << "}";
+            bFirst = false;
+        }
+    }
+    Out << "\n]}\n";
+
+    if (!Out)
+    {
+        LOG_ERROR_MESSAGE("Failed to write CPU trace to '", Path, "'");
+        return false;
+    }
+    LOG_INFO_MESSAGE("CPU trace written to ", Path);
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// Trazas de CPU con marcas de tiempo en nanosegundos. Cada hilo escribe en su
+// propio bfer circular sin bloqueos; el volcado genera JSON en formato Chrome
+// trace, que se puede abrir en chrome://tracing o en Perfetto.
+class Tutorial14_CPUTrace
+{
+public:
+    // Nmero de zonas que guarda cada hilo antes de sobrescribir las ms antiguas
+    static constexpr Uint32 RING_SIZE = 1 << 16;
+
+    struct Zone
+    {
+        const char* Name    = nullptr; // Debe apuntar a una cadena esttica
+        Uint64      BeginNs = 0;
+        Uint64      EndNs   = 0;
+    };
+
+    static Uint64 Now()
+    {
+        return static_cast<Uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now().time_since_epoch())
+                                       .count());
+    }
+
+    static void SetEnabled(bool bEnabled) { s_bEnabled.store(bEnabled, std::memory_order_relaxed); }
+    static bool IsEnabled() { return s_bEnabled.load(std::memory_order_relaxed); }
+
+    // Registra una zona terminada en el bfer del hilo actual
+    static void Record(const char* Name, Uint64 BeginNs, Uint64 EndNs);
+
+    // Nombre que aparece en la traza para el hilo actual
+    static void SetThreadName(const char* Name);
+
+    // Escribe las zonas registradas por todos los hilos. Puede llamarse mientras
+    // otros hilos siguen grabando; las zonas que se sobrescriban durante el volcado
+    // se descartan enteras.
+    static bool WriteChromeTrace(const std::string& Path);
+
+    // Mide el mbito actual
+    class Scope
+    {
+    public:
+        explicit Scope(const char* Name) :
+            m_Name(IsEnabled() ? Name : nullptr),
+            m_BeginNs(m_Name != nullptr ? Now() : 0)
+        {}
+        ~Scope()
+        {
+            if (m_Name != nullptr)
+                Record(m_Name, m_BeginNs, Now());
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* const m_Name;
+        const Uint64      m_BeginNs;
+    };
+
+private:
+    static std::atomic<bool> s_bEnabled;
+};
+
+} // namespace Diligent
+
+#define T14_TRACE_CONCAT_IMPL(a, b) a##b
+#define T14_TRACE_CONCAT(a, b)      T14_TRACE_CONCAT_IMPL(a, b)
+
+// Uso: T14_TRACE_SCOPE("Nombre de la zona");
+#define T14_TRACE_SCOPE(Name) Diligent::Tutorial14_CPUTrace::Scope T14_TRACE_CONCAT(_T14TraceScope, __LINE__){Name}
@@ -0,0 +1,878 @@
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+#include "Tutorial14_CanvasAutosave.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de CanvasDirtyConstants en canvas_dirty.csh
+struct CanvasDirtyConstants
+{
+    Uint32 uiNumParticles = 0;
+    Uint32 uiTileSize     = 0;
+    uint2  u2NumTiles     = uint2{0, 0};
+
+    float2 f2CanvasSize = float2{0, 0};
+    float2 f2Padding0   = float2{0, 0};
+};
+
+// Tiles por fila en los atlas de lectura
+constexpr Uint32 ATLAS_TILES_X = 16;
+
+Uint32 GetLowestBit(Uint32 Bits)
+{
+    Uint32 Bit = 0;
+    while ((Bits & (1u << Bit)) == 0)
+        ++Bit;
+    return Bit;
+}
+
+// Remuestreo bilineal con centros de texel, el mismo filtrado con el que la
+// aplicacin remuestrea el canvas al cambiar su resolucin
+void ResampleTexels(const std::vector<Uint8>& Src, uint2 SrcSize, std::vector<Uint8>& Dst, uint2 DstSize)
+{
+    Dst.assign(size_t{DstSize.x} * DstSize.y * 4, 0);
+
+    const float ScaleX = static_cast<float>(SrcSize.x) / static_cast<float>(DstSize.x);
+    const float ScaleY = static_cast<float>(SrcSize.y) / static_cast<float>(DstSize.y);
+    for (Uint32 y = 0; y < DstSize.y; ++y)
+    {
+        const float  v  = std::max((static_cast<float>(y) + 0.5f) * ScaleY - 0.5f, 0.f);
+        const Uint32 y0 = std::min(static_cast<Uint32>(v), SrcSize.y - 1);
+        const Uint32 y1 = std::min(y0 + 1, SrcSize.y - 1);
+        const float  fy = std::min(v - static_cast<float>(y0), 1.f);
+        for (Uint32 x = 0; x < DstSize.x; ++x)
+        {
+            const float  u  = std::max((static_cast<float>(x) + 0.5f) * ScaleX - 0.5f, 0.f);
+            const Uint32 x0 = std::min(static_cast<Uint32>(u), SrcSize.x - 1);
+            const Uint32 x1 = std::min(x0 + 1, SrcSize.x - 1);
+            const float  fx = std::min(u - static_cast<float>(x0), 1.f);
+
+            const Uint8* p00 = &Src[(size_t{y0} * SrcSize.x + x0) * 4];
+            const Uint8* p10 = &Src[(size_t{y0} * SrcSize.x + x1) * 4];
+            const Uint8* p01 = &Src[(size_t{y1} * SrcSize.x + x0) * 4];
+            const Uint8* p11 = &Src[(size_t{y1} * SrcSize.x + x1) * 4];
+            Uint8*       pDst = &Dst[(size_t{y} * DstSize.x + x) * 4];
+            for (Uint32 c = 0; c < 4; ++c)
+            {
+                const float Top    = p00[c] + (p10[c] - p00[c]) * fx;
+                const float Bottom = p01[c] + (p11[c] - p01[c]) * fx;
+                pDst[c]            = static_cast<Uint8>(Top + (Bottom - Top) * fy + 0.5f);
+            }
+        }
+    }
+}
+
+// Reconstruye el canvas a partir de un diario. Texels y CanvasSize quedan con la
+// resolucin del ltimo cambio de resolucin del fichero.
+bool ReadJournal(const std::string& Path, std::vector<Uint8>& Texels, uint2& CanvasSize, Uint64& NumRecords)
+{
+    using Autosave = Tutorial14_CanvasAutosave;
+
+    std::ifstream        File{Path, std::ios::binary};
+    Autosave::FileHeader Header;
+    if (!File.read(reinterpret_cast<char*>(&Header), sizeof(Header)) || Header.Magic != Autosave::FILE_MAGIC ||
+        Header.Version == 0 || Header.Version > Autosave::FILE_VERSION ||
+        Header.Width == 0 || Header.Height == 0 || Header.TileSize == 0)
+    {
+        LOG_ERROR_MESSAGE(Path, " is not a canvas autosave file");
+        return false;
+    }
+
+    // Los registros se aplican en orden: el ltimo de cada tile sobrescribe a los anteriores
+    CanvasSize = uint2{Header.Width, Header.Height};
+    Texels.assign(size_t{CanvasSize.x} * CanvasSize.y * 4, 0);
+    NumRecords = 0;
+
+    std::vector<Uint8>   Resampled;
+    Autosave::TileHeader Tile;
+    while (File.read(reinterpret_cast<char*>(&Tile), sizeof(Tile)))
+    {
+        if (Tile.TileX == Autosave::RESIZE_RECORD)
+        {
+            Autosave::ResizeRecord Resize;
+            if (!File.read(reinterpret_cast<char*>(&Resize), sizeof(Resize)))
+            {
+                LOG_WARNING_MESSAGE("Canvas autosave file ", Path, " ends with a truncated record");
+                break;
+            }
+            if (Resize.Width == 0 || Resize.Height == 0)
+            {
+                LOG_ERROR_MESSAGE("Canvas autosave file ", Path, " is corrupted after ", NumRecords, " tiles");
+                break;
+            }
+
+            const uint2 NewSize{Resize.Width, Resize.Height};
+            ResampleTexels(Texels, CanvasSize, Resampled, NewSize);
+            std::swap(Texels, Resampled);
+            CanvasSize = NewSize;
+            continue;
+        }
+
+        const Uint32 NumTilesX = (CanvasSize.x + Header.TileSize - 1) / Header.TileSize;
+        const Uint32 NumTilesY = (CanvasSize.y + Header.TileSize - 1) / Header.TileSize;
+        if (Tile.TileX >= NumTilesX || Tile.TileY >= NumTilesY)
+        {
+            LOG_ERROR_MESSAGE("Canvas autosave file ", Path, " is corrupted after ", NumRecords, " tiles");
+            break;
+        }
+
+        const Uint32 X      = Tile.TileX * Header.TileSize;
+        const Uint32 Y      = Tile.TileY * Header.TileSize;
+        const Uint32 Width  = std::min(Header.TileSize, CanvasSize.x - X);
+        const Uint32 Height = std::min(Header.TileSize, CanvasSize.y - Y);
+        for (Uint32 y = 0; y < Height && File; ++y)
+            File.read(reinterpret_cast<char*>(&Texels[(size_t{Y + y} * CanvasSize.x + X) * 4]), static_cast<std::streamsize>(Width) * 4);
+
+        // El ltimo registro puede estar incompleto si la aplicacin se cerr mientras se escriba
+        if (!File)
+        {
+            LOG_WARNING_MESSAGE("Canvas autosave file ", Path, " ends with a truncated tile");
+            break;
+        }
+        ++NumRecords;
+    }
+    return true;
+}
+
+} // namespace
+
+Tutorial14_CanvasAutosave::Tutorial14_CanvasAutosave(IRenderDevice*             pDevice,
+                                                     IDeviceContext*            pContext,
+                                                     IEngineFactory*            pEngineFactory,
+                                                     Tutorial14_FrameAllocator* pFrameAllocator) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pFrameAllocator(pFrameAllocator)
+{
+    FenceDesc FDesc;
+    FDesc.Name = "Canvas autosave fence";
+    m_pDevice->CreateFence(FDesc, &m_pFence);
+
+    CreatePipeline(pEngineFactory);
+}
+
+Tutorial14_CanvasAutosave::~Tutorial14_CanvasAutosave()
+{
+    Stop();
+}
+
+void Tutorial14_CanvasAutosave::CreatePipeline(IEngineFactory* pEngineFactory)
+{
+    if (!m_pDevice->GetDeviceInfo().Features.ComputeShaders)
+        return;
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("DIRTY_GROUP_SIZE", static_cast<int>(DIRTY_GROUP_SIZE));
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.Desc.Name                       = "Mark dirty canvas tiles CS";
+    ShaderCI.EntryPoint                      = "main";
+    ShaderCI.FilePath                        = "canvas_dirty.csh";
+    ShaderCI.Macros                          = Macros;
+    ShaderCI.pShaderSourceStreamFactory      = pShaderSourceFactory;
+
+    RefCntAutoPtr<IShader> pCS;
+    m_pDevice->CreateShader(ShaderCI, &pCS);
+    if (!pCS)
+    {
+        LOG_ERROR_MESSAGE("Failed to create canvas dirty tiles shader");
+        return;
+    }
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name         = "Mark dirty canvas tiles PSO";
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+    // Las constantes son una ventana del asignador de frame
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    PSOCreateInfo.pCS = pCS;
+    m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pDirtyPSO);
+    if (!m_pDirtyPSO)
+    {
+        LOG_ERROR_MESSAGE("Failed to create canvas dirty tiles PSO");
+        return;
+    }
+}
+
+bool Tutorial14_CanvasAutosave::Start(const Settings& AutosaveSettings, ITexture* pCanvas)
+{
+    Stop();
+
+    if (!m_pDirtyPSO || !m_pFence)
+    {
+        LOG_ERROR_MESSAGE("Canvas autosave is not available");
+        return false;
+    }
+    if (pCanvas == nullptr || pCanvas->GetDesc().Format != TEX_FORMAT_RGBA8_UNORM)
+    {
+        LOG_ERROR_MESSAGE("Canvas autosave requires an RGBA8 canvas");
+        return false;
+    }
+
+    m_Settings                 = AutosaveSettings;
+    m_Settings.IntervalFrames  = std::max(m_Settings.IntervalFrames, 1u);
+    m_Settings.TileSize        = std::min(std::max(m_Settings.TileSize, 16u), 1024u);
+    m_Settings.MaxTilesPerCopy = std::max(m_Settings.MaxTilesPerCopy, 1u);
+    m_Settings.CompactionRatio = std::max(m_Settings.CompactionRatio, 1.5f);
+
+    m_pCanvas = pCanvas;
+    m_pWriter = std::make_unique<Tutorial14_ThreadPool>(1, "Canvas autosave writer");
+    if (!OpenJournal())
+    {
+        m_pWriter.reset();
+        return false;
+    }
+
+    m_SavedTiles     = 0;
+    m_NumCompactions = 0;
+    m_NextMaskFrame  = m_FrameId + m_Settings.IntervalFrames;
+    m_bSaving        = true;
+
+    LOG_INFO_MESSAGE("Autosaving canvas to ", m_Settings.OutputPath);
+    return true;
+}
+
+bool Tutorial14_CanvasAutosave::CreateDirtyMask()
+{
+    const auto& CanvasDesc = m_pCanvas->GetDesc();
+
+    m_CanvasWidth         = CanvasDesc.Width;
+    m_CanvasHeight        = CanvasDesc.Height;
+    m_NumTiles            = GetNumTiles(uint2{m_CanvasWidth, m_CanvasHeight});
+    const Uint32 NumTiles = m_NumTiles.x * m_NumTiles.y;
+    const Uint32 NumWords = (NumTiles + 31) / 32;
+
+    // Mscara de la GPU y su lectura
+    const std::vector<Uint32> Zeros(NumWords, 0u);
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Canvas dirty mask buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = Uint64{sizeof(Uint32)} * NumWords;
+    BufferData MaskData{Zeros.data(), BuffDesc.Size};
+    m_pDirtyMask.Release();
+    m_pDirtySRB.Release();
+    m_pDevice->CreateBuffer(BuffDesc, &MaskData, &m_pDirtyMask);
+
+    m_pMaskReadback = std::make_unique<Tutorial14_AsyncReadback>(m_pDevice, m_pContext, BuffDesc.Size, 4, "Canvas dirty mask readback");
+    if (!m_pDirtyMask || !m_pMaskReadback->IsValid())
+    {
+        LOG_ERROR_MESSAGE("Failed to create canvas dirty mask");
+        return false;
+    }
+
+    m_PendingMask.assign(NumWords, 0u);
+    m_ReadbackMask.assign(NumWords, 0u);
+    m_NumPendingTiles = 0;
+    return true;
+}
+
+bool Tutorial14_CanvasAutosave::OpenJournal()
+{
+    if (!CreateDirtyMask())
+        return false;
+
+    const auto&  CanvasDesc = m_pCanvas->GetDesc();
+    const Uint32 TileSize   = m_Settings.TileSize;
+
+    // Atlas de lectura con el mismo formato que el canvas
+    m_AtlasTilesX            = std::min(ATLAS_TILES_X, m_Settings.MaxTilesPerCopy);
+    const Uint32 AtlasWidth  = m_AtlasTilesX * TileSize;
+    const Uint32 AtlasHeight = (m_Settings.MaxTilesPerCopy + m_AtlasTilesX - 1) / m_AtlasTilesX * TileSize;
+    for (auto& Slot : m_Slots)
+    {
+        if (Slot.pStagingTexture)
+        {
+            const auto& StagingDesc = Slot.pStagingTexture->GetDesc();
+            if (StagingDesc.Width == AtlasWidth && StagingDesc.Height == AtlasHeight && StagingDesc.Format == CanvasDesc.Format)
+                continue;
+            Slot.pStagingTexture.Release();
+        }
+
+        TextureDesc StagingDesc;
+        StagingDesc.Name           = "Canvas autosave staging atlas";
+        StagingDesc.Type           = RESOURCE_DIM_TEX_2D;
+        StagingDesc.Width          = AtlasWidth;
+        StagingDesc.Height         = AtlasHeight;
+        StagingDesc.Format         = CanvasDesc.Format;
+        StagingDesc.Usage          = USAGE_STAGING;
+        StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+        m_pDevice->CreateTexture(StagingDesc, nullptr, &Slot.pStagingTexture);
+        if (!Slot.pStagingTexture)
+        {
+            LOG_ERROR_MESSAGE("Failed to create canvas autosave staging atlas");
+            return false;
+        }
+        Slot.Tiles.reserve(m_Settings.MaxTilesPerCopy);
+    }
+
+    // El hilo de escritura est parado: el fichero y los desplazamientos se pueden tocar aqu
+    m_File.close();
+    m_File.open(m_Settings.OutputPath, std::ios::binary | std::ios::trunc);
+    if (!m_File)
+    {
+        LOG_ERROR_MESSAGE("Failed to open canvas autosave file ", m_Settings.OutputPath);
+        return false;
+    }
+
+    FileHeader Header;
+    Header.Width    = m_CanvasWidth;
+    Header.Height   = m_CanvasHeight;
+    Header.TileSize = TileSize;
+    m_File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+    m_FileSize          = sizeof(Header);
+    m_JournalCanvasSize = uint2{m_CanvasWidth, m_CanvasHeight};
+    m_TileOffsets.assign(size_t{m_NumTiles.x} * m_NumTiles.y, 0);
+
+    // El diario empieza con una copia completa del canvas
+    SetAllTilesPending();
+    return true;
+}
+
+void Tutorial14_CanvasAutosave::SetCanvas(ITexture* pCanvas)
+{
+    if (!m_bSaving)
+    {
+        m_pCanvas = pCanvas;
+        return;
+    }
+
+    if (pCanvas == nullptr || pCanvas->GetDesc().Format != TEX_FORMAT_RGBA8_UNORM)
+    {
+        LOG_ERROR_MESSAGE("Canvas autosave stopped: the new canvas cannot be saved");
+        // Lo pendiente se guarda todava desde el canvas anterior
+        Stop();
+        m_pCanvas = pCanvas;
+        return;
+    }
+
+    const uint2 OldCanvasSize{m_CanvasWidth, m_CanvasHeight};
+    m_pCanvas = pCanvas;
+    if (pCanvas->GetDesc().Width == OldCanvasSize.x && pCanvas->GetDesc().Height == OldCanvasSize.y)
+        return;
+
+    T14_TRACE_SCOPE("CanvasAutosave::SetCanvas");
+
+    // Las copias de tiles en vuelo llevan la resolucin del canvas anterior y el hilo de
+    // escritura aade el cambio de resolucin al diario antes del primer tile del nuevo.
+    // Lo marcado en el canvas anterior que an no se ha copiado se guarda desde el nuevo,
+    // que tiene el mismo contenido remuestreado: los tiles pendientes se trasladan ahora
+    // y la mscara de la GPU se lee de forma asncrona como cualquier otra.
+    auto                      pOldReadback     = std::move(m_pMaskReadback);
+    const bool                bOldMaskEnqueued = pOldReadback->Enqueue(m_pDirtyMask);
+    const std::vector<Uint32> OldPendingMask   = std::move(m_PendingMask);
+
+    if (!CreateDirtyMask())
+    {
+        LOG_ERROR_MESSAGE("Canvas autosave stopped: the new canvas cannot be saved");
+        m_pWriter.reset();
+        m_File.close();
+        m_bSaving = false;
+        return;
+    }
+
+    SetResampledTilesPending(OldPendingMask.data(), OldPendingMask.size(), OldCanvasSize);
+    if (pOldReadback->HasPendingCopies())
+        m_RetiredMasks.push_back(RetiredMask{std::move(pOldReadback), OldCanvasSize});
+    // Sin ranura de lectura libre no se sabe qu se pint: se guarda todo el canvas
+    if (!bOldMaskEnqueued)
+        SetAllTilesPending();
+}
+
+void Tutorial14_CanvasAutosave::MarkAllDirty()
+{
+    if (m_bSaving)
+        SetAllTilesPending();
+}
+
+void Tutorial14_CanvasAutosave::SetAllTilesPending()
+{
+    const Uint32 NumTiles = m_NumTiles.x * m_NumTiles.y;
+    for (Uint32 Word = 0; Word < m_PendingMask.size(); ++Word)
+    {
+        const Uint32 NumBits = std::min(NumTiles - Word * 32, 32u);
+        m_PendingMask[Word]  = NumBits == 32 ? ~0u : (1u << NumBits) - 1u;
+    }
+    m_NumPendingTiles = NumTiles;
+}
+
+void Tutorial14_CanvasAutosave::SetTilePending(Uint32 TileIdx)
+{
+    if ((m_PendingMask[TileIdx / 32] & (1u << (TileIdx % 32))) == 0)
+    {
+        m_PendingMask[TileIdx / 32] |= 1u << (TileIdx % 32);
+        ++m_NumPendingTiles;
+    }
+}
+
+void Tutorial14_CanvasAutosave::SetResampledTilePending(uint2 SrcTile, uint2 SrcCanvasSize)
+{
+    const Uint32 TileSize = m_Settings.TileSize;
+    const float  ScaleX   = static_cast<float>(m_CanvasWidth) / static_cast<float>(SrcCanvasSize.x);
+    const float  ScaleY   = static_cast<float>(m_CanvasHeight) / static_cast<float>(SrcCanvasSize.y);
+
+    // Rectngulo del tile en el canvas actual, ampliado un texel por el filtrado bilineal
+    const float MinX = static_cast<float>(SrcTile.x * TileSize) * ScaleX - 1.f;
+    const float MinY = static_cast<float>(SrcTile.y * TileSize) * ScaleY - 1.f;
+    const float MaxX = static_cast<float>((SrcTile.x + 1) * TileSize) * ScaleX + 1.f;
+    const float MaxY = static_cast<float>((SrcTile.y + 1) * TileSize) * ScaleY + 1.f;
+
+    const Uint32 FirstX = static_cast<Uint32>(std::max(MinX, 0.f)) / TileSize;
+    const Uint32 FirstY = static_cast<Uint32>(std::max(MinY, 0.f)) / TileSize;
+    const Uint32 LastX  = std::min(static_cast<Uint32>(MaxX) / TileSize, m_NumTiles.x - 1);
+    const Uint32 LastY  = std::min(static_cast<Uint32>(MaxY) / TileSize, m_NumTiles.y - 1);
+    for (Uint32 y = FirstY; y <= LastY; ++y)
+    {
+        for (Uint32 x = FirstX; x <= LastX; ++x)
+            SetTilePending(y * m_NumTiles.x + x);
+    }
+}
+
+void Tutorial14_CanvasAutosave::SetResampledTilesPending(const Uint32* pMask, size_t NumWords, uint2 SrcCanvasSize)
+{
+    const uint2  SrcNumTiles = GetNumTiles(SrcCanvasSize);
+    const Uint32 NumSrcTiles = SrcNumTiles.x * SrcNumTiles.y;
+    for (size_t Word = 0; Word < NumWords; ++Word)
+    {
+        for (Uint32 Bits = pMask[Word]; Bits != 0; Bits &= Bits - 1u)
+        {
+            const Uint32 SrcTileIdx = static_cast<Uint32>(Word) * 32 + GetLowestBit(Bits);
+            if (SrcTileIdx >= NumSrcTiles)
+                break;
+            SetResampledTilePending(uint2{SrcTileIdx % SrcNumTiles.x, SrcTileIdx / SrcNumTiles.x}, SrcCanvasSize);
+        }
+    }
+}
+
+void Tutorial14_CanvasAutosave::MarkDirty(IBuffer* pParticleAttribs, Uint32 NumParticles)
+{
+    if (!m_bSaving || pParticleAttribs == nullptr || NumParticles == 0)
+        return;
+
+    T14_TRACE_SCOPE("CanvasAutosave::MarkDirty");
+
+    if (m_pParticleAttribs != pParticleAttribs || !m_pDirtySRB)
+    {
+        m_pParticleAttribs = pParticleAttribs;
+        m_pDirtySRB.Release();
+        m_pDirtyPSO->CreateShaderResourceBinding(&m_pDirtySRB, true);
+        m_pDirtySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pParticleAttribs->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+        m_pDirtySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_DirtyMask")->Set(m_pDirtyMask->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+        m_pFrameAllocator->BindConstants(m_pDirtySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "CanvasDirtyConstantsBuffer"), sizeof(CanvasDirtyConstants));
+    }
+
+    {
+        CanvasDirtyConstants Constants;
+        Constants.uiNumParticles = NumParticles;
+        Constants.uiTileSize     = m_Settings.TileSize;
+        Constants.u2NumTiles     = m_NumTiles;
+        Constants.f2CanvasSize   = float2{static_cast<float>(m_CanvasWidth), static_cast<float>(m_CanvasHeight)};
+        if (auto* pVar = m_pDirtySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "CanvasDirtyConstantsBuffer"))
+            pVar->SetBufferOffset(m_pFrameAllocator->Allocate(Constants));
+    }
+
+    m_pContext->SetPipelineState(m_pDirtyPSO);
+    m_pContext->CommitShaderResources(m_pDirtySRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{(NumParticles + DIRTY_GROUP_SIZE - 1) / DIRTY_GROUP_SIZE});
+}
+
+void Tutorial14_CanvasAutosave::Update(Uint64 FrameId)
+{
+    m_FrameId = FrameId;
+    if (!m_bSaving)
+        return;
+
+    T14_TRACE_SCOPE("CanvasAutosave::Update");
+
+    // La mscara se pone a cero detrs de la copia; si no hay ranura de lectura
+    // libre se sigue acumulando y se lee en otro frame
+    if (FrameId >= m_NextMaskFrame && m_pMaskReadback->Enqueue(m_pDirtyMask))
+    {
+        const std::vector<Uint32> Zeros(m_PendingMask.size(), 0u);
+        m_pContext->UpdateBuffer(m_pDirtyMask, 0, m_pMaskReadback->GetSize(), Zeros.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_NextMaskFrame = FrameId + m_Settings.IntervalFrames;
+    }
+
+    ReadDirtyMasks();
+    ProcessSlots();
+    CopyPendingTiles();
+}
+
+void Tutorial14_CanvasAutosave::ReadDirtyMasks()
+{
+    // Mscaras de canvas anteriores: sus tiles se trasladan al canvas actual
+    for (auto It = m_RetiredMasks.begin(); It != m_RetiredMasks.end();)
+    {
+        std::vector<Uint32> Mask(static_cast<size_t>(It->pReadback->GetSize() / sizeof(Uint32)));
+        while (It->pReadback->PollOldest(Mask.data()))
+            SetResampledTilesPending(Mask.data(), Mask.size(), It->CanvasSize);
+        It = It->pReadback->HasPendingCopies() ? std::next(It) : m_RetiredMasks.erase(It);
+    }
+
+    while (m_pMaskReadback->PollOldest(m_ReadbackMask.data()))
+    {
+        for (size_t Word = 0; Word < m_PendingMask.size(); ++Word)
+        {
+            const Uint32 NewBits = m_ReadbackMask[Word] & ~m_PendingMask[Word];
+            m_PendingMask[Word] |= NewBits;
+            m_NumPendingTiles += static_cast<Uint32>(std::bitset<32>{NewBits}.count());
+        }
+    }
+}
+
+uint2 Tutorial14_CanvasAutosave::GetTileSize(uint2 Tile, uint2 CanvasSize) const
+{
+    return uint2{std::min(m_Settings.TileSize, CanvasSize.x - Tile.x * m_Settings.TileSize),
+                 std::min(m_Settings.TileSize, CanvasSize.y - Tile.y * m_Settings.TileSize)};
+}
+
+uint2 Tutorial14_CanvasAutosave::GetNumTiles(uint2 CanvasSize) const
+{
+    const Uint32 TileSize = m_Settings.TileSize;
+    return uint2{(CanvasSize.x + TileSize - 1) / TileSize, (CanvasSize.y + TileSize - 1) / TileSize};
+}
+
+void Tutorial14_CanvasAutosave::CopyPendingTiles()
+{
+    const Uint32 TileSize = m_Settings.TileSize;
+    for (auto& Slot : m_Slots)
+    {
+        if (m_NumPendingTiles == 0)
+            break;
+        if (Slot.State.load() != SLOT_STATE_FREE)
+            continue;
+
+        T14_TRACE_SCOPE("Copy dirty canvas tiles");
+
+        Slot.CanvasSize = uint2{m_CanvasWidth, m_CanvasHeight};
+        Slot.Tiles.clear();
+        for (size_t Word = 0; Word < m_PendingMask.size() && Slot.Tiles.size() < m_Settings.MaxTilesPerCopy; ++Word)
+        {
+            while (m_PendingMask[Word] != 0 && Slot.Tiles.size() < m_Settings.MaxTilesPerCopy)
+            {
+                const Uint32 TileIdx = static_cast<Uint32>(Word) * 32 + GetLowestBit(m_PendingMask[Word]);
+                m_PendingMask[Word] &= m_PendingMask[Word] - 1u;
+                --m_NumPendingTiles;
+
+                const uint2  Tile      = {TileIdx % m_NumTiles.x, TileIdx / m_NumTiles.x};
+                const uint2  Size      = GetTileSize(Tile, Slot.CanvasSize);
+                const Uint32 AtlasIdx  = static_cast<Uint32>(Slot.Tiles.size());
+                Slot.Tiles.push_back(Tile);
+
+                Box SrcBox{Tile.x * TileSize, Tile.x * TileSize + Size.x, Tile.y * TileSize, Tile.y * TileSize + Size.y};
+
+                CopyTextureAttribs CopyAttribs{m_pCanvas, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                               Slot.pStagingTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+                CopyAttribs.pSrcBox = &SrcBox;
+                CopyAttribs.DstX    = (AtlasIdx % m_AtlasTilesX) * TileSize;
+                CopyAttribs.DstY    = (AtlasIdx / m_AtlasTilesX) * TileSize;
+                m_pContext->CopyTexture(CopyAttribs);
+            }
+        }
+
+        Slot.FenceValue = m_NextFenceValue++;
+        Slot.FrameId    = m_FrameId;
+        Slot.State.store(SLOT_STATE_COPYING);
+        m_pContext->EnqueueSignal(m_pFence, Slot.FenceValue);
+    }
+}
+
+void Tutorial14_CanvasAutosave::ProcessSlots()
+{
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+
+    for (auto& Slot : m_Slots)
+    {
+        if (Slot.State.load() == SLOT_STATE_WRITTEN)
+        {
+            m_pContext->UnmapTextureSubresource(Slot.pStagingTexture, 0, 0);
+            Slot.State.store(SLOT_STATE_FREE);
+        }
+    }
+
+    // Los atlas se escriben en el orden en que se copiaron para que el ltimo
+    // registro de cada tile en el diario sea tambin el ms reciente
+    for (;;)
+    {
+        AtlasSlot* pOldest = nullptr;
+        for (auto& Slot : m_Slots)
+        {
+            if (Slot.State.load() == SLOT_STATE_COPYING && Slot.FenceValue <= CompletedValue)
+            {
+                if (pOldest == nullptr || Slot.FenceValue < pOldest->FenceValue)
+                    pOldest = &Slot;
+            }
+        }
+        if (pOldest == nullptr)
+            break;
+
+        MappedTextureSubresource MappedData;
+        m_pContext->MapTextureSubresource(pOldest->pStagingTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+        if (MappedData.pData == nullptr)
+        {
+            // Los tiles vuelven a la lista de pendientes y se copian de nuevo, desde el
+            // canvas actual si se copiaron de uno con otra resolucin
+            const bool bSameCanvas = pOldest->CanvasSize == uint2{m_CanvasWidth, m_CanvasHeight};
+            for (const auto& Tile : pOldest->Tiles)
+            {
+                if (bSameCanvas)
+                    SetTilePending(Tile.y * m_NumTiles.x + Tile.x);
+                else
+                    SetResampledTilePending(Tile, pOldest->CanvasSize);
+            }
+            pOldest->State.store(SLOT_STATE_FREE);
+            continue;
+        }
+
+        pOldest->State.store(SLOT_STATE_WRITING);
+        m_pWriter->Enqueue([this, pOldest, MappedData]() {
+            WriteAtlas(*pOldest, MappedData.pData, MappedData.Stride);
+            pOldest->State.store(SLOT_STATE_WRITTEN);
+        });
+    }
+}
+
+void Tutorial14_CanvasAutosave::WriteAtlas(const AtlasSlot& Slot, const void* pData, Uint64 Stride)
+{
+    T14_TRACE_SCOPE("Write canvas tiles");
+
+    const Uint32 TileSize = m_Settings.TileSize;
+    Uint64       FileSize = m_FileSize.load();
+
+    // Los atlas llegan en el orden en que se copiaron: el primero de un canvas con
+    // otra resolucin va precedido del registro de cambio de resolucin
+    if (Slot.CanvasSize != m_JournalCanvasSize)
+    {
+        TileHeader Header;
+        Header.TileX   = RESIZE_RECORD;
+        Header.FrameId = Slot.FrameId;
+        ResizeRecord Resize;
+        Resize.Width  = Slot.CanvasSize.x;
+        Resize.Height = Slot.CanvasSize.y;
+        m_File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+        m_File.write(reinterpret_cast<const char*>(&Resize), sizeof(Resize));
+        FileSize += sizeof(Header) + sizeof(Resize);
+
+        const uint2 NumTiles = GetNumTiles(Slot.CanvasSize);
+        m_JournalCanvasSize  = Slot.CanvasSize;
+        m_TileOffsets.assign(size_t{NumTiles.x} * NumTiles.y, 0);
+    }
+
+    const Uint32 NumTilesX = GetNumTiles(Slot.CanvasSize).x;
+    for (Uint32 i = 0; i < Slot.Tiles.size(); ++i)
+    {
+        const uint2  Tile   = Slot.Tiles[i];
+        const uint2  Size   = GetTileSize(Tile, Slot.CanvasSize);
+        const Uint32 AtlasX = (i % m_AtlasTilesX) * TileSize;
+        const Uint32 AtlasY = (i / m_AtlasTilesX) * TileSize;
+
+        TileHeader Header;
+        Header.TileX   = Tile.x;
+        Header.TileY   = Tile.y;
+        Header.FrameId = Slot.FrameId;
+        m_File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+        for (Uint32 y = 0; y < Size.y; ++y)
+        {
+            const Uint8* pRow = static_cast<const Uint8*>(pData) + Stride * (AtlasY + y) + AtlasX * 4;
+            m_File.write(reinterpret_cast<const char*>(pRow), static_cast<std::streamsize>(Size.x) * 4);
+        }
+
+        m_TileOffsets[Tile.y * NumTilesX + Tile.x] = FileSize;
+        FileSize += sizeof(Header) + Uint64{Size.x} * Size.y * 4;
+    }
+    // Cada lote se vuelca para que un cierre inesperado pierda como mucho el lote en curso
+    m_File.flush();
+    m_FileSize = FileSize;
+    m_SavedTiles += Slot.Tiles.size();
+
+    if (!m_File)
+    {
+        LOG_ERROR_MESSAGE("Failed to write canvas autosave file ", m_Settings.OutputPath);
+        return;
+    }
+
+    const Uint64 CanvasSize = Uint64{m_JournalCanvasSize.x} * m_JournalCanvasSize.y * 4;
+    if (static_cast<double>(FileSize) > static_cast<double>(CanvasSize) * m_Settings.CompactionRatio)
+        CompactJournal(Slot.FrameId);
+}
+
+void Tutorial14_CanvasAutosave::CompactJournal(Uint64 FrameId)
+{
+    T14_TRACE_SCOPE("Compact canvas autosave");
+
+    const std::string& Path     = m_Settings.OutputPath;
+    const std::string  TempPath = Path + ".tmp";
+
+    m_File.close();
+
+    // El diario puede mezclar varias resoluciones: se reconstruye el canvas actual y se
+    // reescribe completo, con un registro por tile marcado con el frame de la compactacin
+    uint2  CanvasSize;
+    Uint64 NumRecords = 0;
+    bool   bSuccess   = ReadJournal(Path, m_CompactBuffer, CanvasSize, NumRecords) && CanvasSize == m_JournalCanvasSize;
+
+    const uint2         NumTiles = GetNumTiles(m_JournalCanvasSize);
+    std::vector<Uint64> NewOffsets(size_t{NumTiles.x} * NumTiles.y, 0);
+    Uint64              FileSize = sizeof(FileHeader);
+    if (bSuccess)
+    {
+        std::ofstream Dst{TempPath, std::ios::binary | std::ios::trunc};
+
+        FileHeader Header;
+        Header.Width    = CanvasSize.x;
+        Header.Height   = CanvasSize.y;
+        Header.TileSize = m_Settings.TileSize;
+        Dst.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+
+        for (Uint32 TileIdx = 0; TileIdx < NewOffsets.size() && Dst; ++TileIdx)
+        {
+            const uint2 Tile = {TileIdx % NumTiles.x, TileIdx / NumTiles.x};
+            const uint2 Size = GetTileSize(Tile, CanvasSize);
+
+            TileHeader TileRecord;
+            TileRecord.TileX   = Tile.x;
+            TileRecord.TileY   = Tile.y;
+            TileRecord.FrameId = FrameId;
+            Dst.write(reinterpret_cast<const char*>(&TileRecord), sizeof(TileRecord));
+            for (Uint32 y = 0; y < Size.y; ++y)
+            {
+                const size_t Offset = (size_t{Tile.y * m_Settings.TileSize + y} * CanvasSize.x + Tile.x * m_Settings.TileSize) * 4;
+                Dst.write(reinterpret_cast<const char*>(&m_CompactBuffer[Offset]), static_cast<std::streamsize>(Size.x) * 4);
+            }
+
+            NewOffsets[TileIdx] = FileSize;
+            FileSize += sizeof(TileRecord) + Uint64{Size.x} * Size.y * 4;
+        }
+        bSuccess = static_cast<bool>(Dst);
+    }
+
+    // rename() reemplaza el destino de forma atmica en POSIX; en Windows falla si existe
+    if (bSuccess && std::rename(TempPath.c_str(), Path.c_str()) != 0)
+    {
+        std::remove(Path.c_str());
+        bSuccess = std::rename(TempPath.c_str(), Path.c_str()) == 0;
+    }
+
+    if (bSuccess)
+    {
+        m_TileOffsets = std::move(NewOffsets);
+        m_FileSize    = FileSize;
+        ++m_NumCompactions;
+    }
+    else
+    {
+        LOG_ERROR_MESSAGE("Failed to compact canvas autosave file ", Path);
+        std::remove(TempPath.c_str());
+    }
+
+    m_File.open(Path, std::ios::binary | std::ios::app);
+}
+
+void Tutorial14_CanvasAutosave::WaitForWrites()
+{
+    m_pContext->WaitForIdle();
+    ProcessSlots();
+    m_pWriter->WaitIdle();
+    ProcessSlots();
+}
+
+void Tutorial14_CanvasAutosave::Flush()
+{
+    T14_TRACE_SCOPE("CanvasAutosave::Flush");
+
+    // Leer tambin los tiles que la GPU ha marcado desde la ltima lectura
+    m_pContext->WaitForIdle();
+    ReadDirtyMasks();
+    if (m_pMaskReadback->Enqueue(m_pDirtyMask))
+    {
+        m_pContext->WaitForIdle();
+        ReadDirtyMasks();
+    }
+
+    while (m_NumPendingTiles > 0)
+    {
+        WaitForWrites();
+        CopyPendingTiles();
+    }
+    WaitForWrites();
+}
+
+void Tutorial14_CanvasAutosave::Stop()
+{
+    if (!m_bSaving)
+        return;
+
+    Flush();
+    m_pWriter.reset();
+    m_File.close();
+    m_RetiredMasks.clear();
+    m_bSaving = false;
+
+    const auto Stats = GetStatistics();
+    LOG_INFO_MESSAGE("Canvas autosave finished: ", Stats.SavedTiles, " tiles saved, ", Stats.FileSize / 1024, " KB");
+}
+
+Tutorial14_CanvasAutosave::Statistics Tutorial14_CanvasAutosave::GetStatistics() const
+{
+    Statistics Stats;
+    Stats.SavedTiles     = m_SavedTiles.load();
+    Stats.FileSize       = m_FileSize.load();
+    Stats.PendingTiles   = m_NumPendingTiles;
+    Stats.NumCompactions = m_NumCompactions.load();
+    return Stats;
+}
+
+RefCntAutoPtr<ITexture> Tutorial14_CanvasAutosave::Load(const std::string& Path, IRenderDevice* pDevice)
+{
+    T14_TRACE_SCOPE("CanvasAutosave::Load");
+
+    std::vector<Uint8> Texels;
+    uint2              CanvasSize;
+    Uint64             NumRecords = 0;
+    if (!ReadJournal(Path, Texels, CanvasSize, NumRecords))
+        return {};
+
+    TextureDesc TexDesc;
+    TexDesc.Name      = "Loaded canvas";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D;
+    TexDesc.Width     = CanvasSize.x;
+    TexDesc.Height    = CanvasSize.y;
+    TexDesc.Format    = TEX_FORMAT_RGBA8_UNORM;
+    TexDesc.Usage     = USAGE_IMMUTABLE;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+    TextureSubResData Level0{Texels.data(), Uint64{CanvasSize.x} * 4};
+    TextureData       InitData{&Level0, 1};
+
+    RefCntAutoPtr<ITexture> pTexture;
+    pDevice->CreateTexture(TexDesc, &InitData, &pTexture);
+    if (!pTexture)
+    {
+        LOG_ERROR_MESSAGE("Failed to create texture for ", Path);
+        return {};
+    }
+
+    LOG_INFO_MESSAGE("Loaded canvas ", Path, " (", CanvasSize.x, "x", CanvasSize.y, ", ", NumRecords, " tile records)");
+    return pTexture;
+}
+
+} // namespace Diligent
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+#include "Tutorial14_AsyncReadback.hpp"
+#include "Tutorial14_ThreadPool.hpp"
+
+namespace Diligent
+{
+
+class Tutorial14_FrameAllocator;
+
+// Guardado continuo e incremental del canvas de pintura. Despus de pintar, un compute
+// shader (canvas_dirty.csh) marca en una mscara de bits los tiles que tocan los trazos.
+// Cada IntervalFrames la mscara se lee de forma asncrona y se pone a cero; cuando
+// llega, solo los tiles marcados se copian del canvas a un atlas de lectura y un hilo
+// de escritura los aade al final del fichero. El coste depende de la superficie
+// pintada, no del tamao del canvas.
+//
+// Formato del fichero .t14c (little-endian):
+//   FileHeader
+//   TileHeader + Width * Height texels RGBA8 del tile, por cada tile guardado
+//   TileHeader con TileX == RESIZE_RECORD + ResizeRecord, cuando cambia la resolucin
+// Es un diario: al cargarlo, el ltimo registro de cada tile es el que vale. Un cambio
+// de resolucin (escala dinmica del canvas) no reinicia el diario: al cargarlo, lo
+// reconstruido hasta ese punto se remuestrea a la nueva resolucin, igual que hace la
+// aplicacin con el canvas, y solo los tiles pintados despus se vuelven a guardar.
+// Cuando crece por encima de CompactionRatio veces el canvas, el hilo de escritura lo
+// reescribe con un nico registro por tile a la resolucin actual.
+class Tutorial14_CanvasAutosave
+{
+public:
+    static constexpr Uint32 FILE_MAGIC       = 0x43343154; // "T14C"
+    static constexpr Uint32 FILE_VERSION     = 2;
+    static constexpr Uint32 RESIZE_RECORD    = ~0u;
+    static constexpr Uint32 DIRTY_GROUP_SIZE = 256;
+    static constexpr Uint32 NUM_ATLAS_SLOTS  = 2;
+
+    struct FileHeader
+    {
+        Uint32 Magic    = FILE_MAGIC;
+        Uint32 Version  = FILE_VERSION;
+        Uint32 Width    = 0; // Resolucin inicial del canvas
+        Uint32 Height   = 0;
+        Uint32 TileSize = 0;
+        Uint32 Reserved = 0;
+    };
+
+    struct TileHeader
+    {
+        Uint32 TileX   = 0;
+        Uint32 TileY   = 0;
+        Uint64 FrameId = 0;
+    };
+
+    struct ResizeRecord
+    {
+        Uint32 Width  = 0;
+        Uint32 Height = 0;
+    };
+
+    struct Settings
+    {
+        std::string OutputPath      = "Tutorial14_Canvas.t14c";
+        Uint32      IntervalFrames  = 30; // Frecuencia con que se lee la mscara de tiles
+        Uint32      TileSize        = 64;
+        Uint32      MaxTilesPerCopy = 256; // Capacidad de cada atlas de lectura
+        float       CompactionRatio = 4;
+    };
+
+    struct Statistics
+    {
+        Uint64 SavedTiles     = 0;
+        Uint64 FileSize       = 0;
+        Uint32 PendingTiles   = 0;
+        Uint32 NumCompactions = 0;
+    };
+
+    Tutorial14_CanvasAutosave(IRenderDevice*             pDevice,
+                              IDeviceContext*            pContext,
+                              IEngineFactory*            pEngineFactory,
+                              Tutorial14_FrameAllocator* pFrameAllocator);
+    ~Tutorial14_CanvasAutosave();
+
+    bool Start(const Settings& AutosaveSettings, ITexture* pCanvas);
+    // Guarda todo lo pendiente (incluidos los tiles marcados en la GPU) y cierra el fichero
+    void Stop();
+
+    bool IsSaving() const { return m_bSaving; }
+
+    // El canvas se ha vuelto a crear, posiblemente con otra resolucin y con el
+    // contenido del anterior remuestreado. El diario contina sin esperar a la GPU.
+    void SetCanvas(ITexture* pCanvas);
+    // Todo el canvas ha cambiado, por ejemplo al limpiarlo o cargarlo
+    void MarkAllDirty();
+
+    // Despus de pintar: marca los tiles que tocan los trazos de las partculas
+    void MarkDirty(IBuffer* pParticleAttribs, Uint32 NumParticles);
+
+    // Una vez por frame: lee la mscara, copia los tiles pendientes y entrega a
+    // disco los atlas ya copiados
+    void Update(Uint64 FrameId);
+
+    Statistics GetStatistics() const;
+
+    const Settings& GetSettings() const { return m_Settings; }
+
+    // Reconstruye la ltima versin del canvas guardada en un fichero .t14c en una
+    // textura nueva con la resolucin original
+    static RefCntAutoPtr<ITexture> Load(const std::string& Path, IRenderDevice* pDevice);
+
+private:
+    enum SLOT_STATE : Uint32
+    {
+        SLOT_STATE_FREE = 0,
+        SLOT_STATE_COPYING, // Esperando a la fence
+        SLOT_STATE_WRITING, // Mapeado; lo usa el hilo de escritura
+        SLOT_STATE_WRITTEN  // Los tiles estn en el fichero; falta desmapear
+    };
+
+    struct AtlasSlot
+    {
+        RefCntAutoPtr<ITexture> pStagingTexture;
+        std::atomic<Uint32>     State{SLOT_STATE_FREE};
+        Uint64                  FenceValue = 0;
+        Uint64                  FrameId    = 0;
+        uint2                   CanvasSize = {0, 0}; // Resolucin del canvas del que se copiaron
+        std::vector<uint2>      Tiles;               // Tiles en el orden en que ocupan el atlas
+    };
+
+    // Lecturas de la mscara de un canvas anterior que an no han llegado
+    struct RetiredMask
+    {
+        std::unique_ptr<Tutorial14_AsyncReadback> pReadback;
+        uint2                                     CanvasSize = {0, 0};
+    };
+
+    void CreatePipeline(IEngineFactory* pEngineFactory);
+    bool CreateDirtyMask();
+    bool OpenJournal();
+    void SetAllTilesPending();
+    void SetTilePending(Uint32 TileIdx);
+    // Marca los tiles del canvas actual que cubren un tile de un canvas con otra resolucin
+    void SetResampledTilePending(uint2 SrcTile, uint2 SrcCanvasSize);
+    void SetResampledTilesPending(const Uint32* pMask, size_t NumWords, uint2 SrcCanvasSize);
+    void ReadDirtyMasks();
+    void ProcessSlots();
+    void CopyPendingTiles();
+    void WaitForWrites();
+    void Flush();
+    void WriteAtlas(const AtlasSlot& Slot, const void* pData, Uint64 Stride);
+    void CompactJournal(Uint64 FrameId);
+
+    uint2 GetTileSize(uint2 Tile, uint2 CanvasSize) const;
+    uint2 GetNumTiles(uint2 CanvasSize) const;
+
+    IRenderDevice*             m_pDevice         = nullptr;
+    IDeviceContext*            m_pContext        = nullptr;
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
+
+    RefCntAutoPtr<IPipelineState>         m_pDirtyPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pDirtySRB;
+    RefCntAutoPtr<IBuffer>                m_pDirtyMask;
+    RefCntAutoPtr<IBuffer>                m_pParticleAttribs;
+    RefCntAutoPtr<IFence>                 m_pFence;
+    RefCntAutoPtr<ITexture>               m_pCanvas;
+
+    std::unique_ptr<Tutorial14_AsyncReadback> m_pMaskReadback;
+    std::vector<RetiredMask>                  m_RetiredMasks;
+
+    Settings m_Settings;
+    bool     m_bSaving        = false;
+    Uint32   m_CanvasWidth    = 0;
+    Uint32   m_CanvasHeight   = 0;
+    uint2    m_NumTiles       = {0, 0};
+    Uint32   m_AtlasTilesX    = 0;
+    Uint64   m_FrameId        = 0;
+    Uint64   m_NextMaskFrame  = 0;
+    Uint64   m_NextFenceValue = 1;
+
+    // Tiles marcados que an no se han copiado (un bit por tile)
+    std::vector<Uint32> m_PendingMask;
+    std::vector<Uint32> m_ReadbackMask;
+    Uint32              m_NumPendingTiles = 0;
+
+    std::array<AtlasSlot, NUM_ATLAS_SLOTS> m_Slots;
+
+    // Solo los usa el hilo de escritura
+    std::ofstream       m_File;
+    uint2               m_JournalCanvasSize = {0, 0}; // Resolucin del ltimo registro del fichero
+    std::vector<Uint64> m_TileOffsets;                // ltimo registro de cada tile; 0 si no hay ninguno
+    std::vector<Uint8>  m_CompactBuffer;
+
+    std::unique_ptr<Tutorial14_ThreadPool> m_pWriter;
+    std::atomic<Uint64>                    m_SavedTiles{0};
+    std::atomic<Uint64>                    m_FileSize{0};
+    std::atomic<Uint32>                    m_NumCompactions{0};
+};
+
+} // namespace Diligent
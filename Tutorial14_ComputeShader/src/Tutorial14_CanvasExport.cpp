@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <vector>
+#include "Tutorial14_CanvasExport.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "MapHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de ExportTileConstants en ExportCanvas.psh
+struct ExportTileConstants
+{
+    float4 f4TileRect;
+    float4 f4CanvasSize;
+};
+
+constexpr Uint32 MIN_TILE_SIZE = 256;
+
+} // namespace
+
+Tutorial14_CanvasExport::Tutorial14_CanvasExport(IRenderDevice*  pDevice,
+                                                 IDeviceContext* pContext,
+                                                 IEngineFactory* pEngineFactory,
+                                                 TEXTURE_FORMAT  TileFormat) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_TileFormat(TileFormat)
+{
+    VERIFY(TileFormat == TEX_FORMAT_RGBA8_UNORM || TileFormat == TEX_FORMAT_RGBA8_UNORM_SRGB, "Canvas export tiles must be RGBA8");
+
+    FenceDesc FDesc;
+    FDesc.Name = "Canvas export fence";
+    m_pDevice->CreateFence(FDesc, &m_pFence);
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name           = "Canvas export constants buffer";
+    BuffDesc.Usage          = USAGE_DYNAMIC;
+    BuffDesc.BindFlags      = BIND_UNIFORM_BUFFER;
+    BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    BuffDesc.Size           = sizeof(ExportTileConstants);
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pConstants);
+
+    CreatePipeline(pEngineFactory);
+}
+
+Tutorial14_CanvasExport::~Tutorial14_CanvasExport()
+{
+    Cancel();
+}
+
+void Tutorial14_CanvasExport::CreatePipeline(IEngineFactory* pEngineFactory)
+{
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.pShaderSourceStreamFactory      = pShaderSourceFactory;
+    ShaderCI.EntryPoint                      = "main";
+
+    RefCntAutoPtr<IShader> pVS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.Desc.Name       = "Canvas Export VS";
+        ShaderCI.FilePath        = "FluidVertexShader.fx";
+        m_pDevice->CreateShader(ShaderCI, &pVS);
+    }
+
+    RefCntAutoPtr<IShader> pPS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.Desc.Name       = "Canvas Export PS";
+        ShaderCI.FilePath        = "ExportCanvas.psh";
+        m_pDevice->CreateShader(ShaderCI, &pPS);
+    }
+
+    if (!pVS || !pPS)
+    {
+        LOG_ERROR_MESSAGE("Failed to create canvas export shaders");
+        return;
+    }
+
+    GraphicsPipelineStateCreateInfo PSOCreateInfo;
+    PSOCreateInfo.PSODesc.Name         = "Canvas Export PSO";
+    PSOCreateInfo.PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
+    PSOCreateInfo.pVS                  = pVS;
+    PSOCreateInfo.pPS                  = pPS;
+
+    auto& GraphicsPipeline                        = PSOCreateInfo.GraphicsPipeline;
+    GraphicsPipeline.NumRenderTargets             = 1;
+    GraphicsPipeline.RTVFormats[0]                = m_TileFormat;
+    GraphicsPipeline.DSVFormat                    = TEX_FORMAT_UNKNOWN;
+    GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    GraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_NONE;
+    GraphicsPipeline.DepthStencilDesc.DepthEnable = False;
+
+    GraphicsPipeline.BlendDesc.RenderTargets[0].BlendEnable = False;
+
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_PIXEL, "ExportTileConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+    PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    PSOCreateInfo.PSODesc.ResourceLayout.Variables           = Vars;
+    PSOCreateInfo.PSODesc.ResourceLayout.NumVariables        = _countof(Vars);
+
+    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pExportPSO);
+    if (!m_pExportPSO)
+    {
+        LOG_ERROR_MESSAGE("Failed to create canvas export PSO");
+        return;
+    }
+    m_pExportPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "ExportTileConstants")->Set(m_pConstants);
+}
+
+bool Tutorial14_CanvasExport::CreateSlots()
+{
+    for (auto& TileSlot : m_Slots)
+    {
+        if (TileSlot.pTileTexture && TileSlot.pTileTexture->GetDesc().Width == m_Settings.TileSize)
+            continue;
+
+        TileSlot.pTileTexture.Release();
+        TileSlot.pStagingTexture.Release();
+
+        TextureDesc TileDesc;
+        TileDesc.Name      = "Canvas export tile";
+        TileDesc.Type      = RESOURCE_DIM_TEX_2D;
+        TileDesc.Width     = m_Settings.TileSize;
+        TileDesc.Height    = m_Settings.TileSize;
+        TileDesc.Format    = m_TileFormat;
+        TileDesc.Usage     = USAGE_DEFAULT;
+        TileDesc.BindFlags = BIND_RENDER_TARGET;
+        m_pDevice->CreateTexture(TileDesc, nullptr, &TileSlot.pTileTexture);
+
+        TextureDesc StagingDesc;
+        StagingDesc.Name           = "Canvas export staging tile";
+        StagingDesc.Type           = RESOURCE_DIM_TEX_2D;
+        StagingDesc.Width          = m_Settings.TileSize;
+        StagingDesc.Height         = m_Settings.TileSize;
+        StagingDesc.Format         = m_TileFormat;
+        StagingDesc.Usage          = USAGE_STAGING;
+        StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+        m_pDevice->CreateTexture(StagingDesc, nullptr, &TileSlot.pStagingTexture);
+
+        if (!TileSlot.pTileTexture || !TileSlot.pStagingTexture)
+        {
+            LOG_ERROR_MESSAGE("Failed to create canvas export tile textures");
+            TileSlot.pTileTexture.Release();
+            TileSlot.pStagingTexture.Release();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Tutorial14_CanvasExport::Start(const Settings& ExportSettings, ITexture* pCanvas)
+{
+    Cancel();
+
+    if (!m_pExportPSO || !m_pFence || pCanvas == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Canvas export is not available");
+        return false;
+    }
+    if (ExportSettings.Width == 0 || ExportSettings.Height == 0)
+    {
+        LOG_ERROR_MESSAGE("Invalid canvas export size ", ExportSettings.Width, "x", ExportSettings.Height);
+        return false;
+    }
+
+    m_Settings               = ExportSettings;
+    m_Settings.TileSize      = std::min(std::max(m_Settings.TileSize, MIN_TILE_SIZE), m_pDevice->GetAdapterInfo().Texture.MaxTexture2DDimension);
+    m_Settings.TilesPerFrame = std::max(m_Settings.TilesPerFrame, 1u);
+    if (!CreateSlots())
+        return false;
+
+    // Copia del canvas: la exportacin dura varios frames y se sigue pintando mientras tanto
+    const auto& CanvasDesc = pCanvas->GetDesc();
+    if (!m_pSourceCanvas || m_pSourceCanvas->GetDesc().Width != CanvasDesc.Width || m_pSourceCanvas->GetDesc().Height != CanvasDesc.Height ||
+        m_pSourceCanvas->GetDesc().Format != CanvasDesc.Format)
+    {
+        m_pSourceCanvas.Release();
+        m_pExportSRB.Release();
+
+        TextureDesc SourceDesc;
+        SourceDesc.Name      = "Canvas export source";
+        SourceDesc.Type      = RESOURCE_DIM_TEX_2D;
+        SourceDesc.Width     = CanvasDesc.Width;
+        SourceDesc.Height    = CanvasDesc.Height;
+        SourceDesc.Format    = CanvasDesc.Format;
+        SourceDesc.Usage     = USAGE_DEFAULT;
+        SourceDesc.BindFlags = BIND_SHADER_RESOURCE;
+        m_pDevice->CreateTexture(SourceDesc, nullptr, &m_pSourceCanvas);
+        if (!m_pSourceCanvas)
+        {
+            LOG_ERROR_MESSAGE("Failed to create canvas export source texture");
+            return false;
+        }
+
+        m_pExportPSO->CreateShaderResourceBinding(&m_pExportSRB, true);
+        m_pExportSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_CanvasTexture")->Set(m_pSourceCanvas->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+    }
+    m_pContext->CopyTexture(CopyTextureAttribs{pCanvas, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                               m_pSourceCanvas, RESOURCE_STATE_TRANSITION_MODE_TRANSITION});
+
+    m_File.open(m_Settings.OutputPath, std::ios::binary | std::ios::trunc);
+    if (!m_File)
+    {
+        LOG_ERROR_MESSAGE("Failed to open canvas export file ", m_Settings.OutputPath);
+        return false;
+    }
+
+    // PPM binario: cabecera de texto seguida de las filas RGB sin compresin, as que
+    // cada fila de un tile se puede escribir directamente en su posicin final.
+    // Se reserva el tamao completo para que los tiles puedan llegar en cualquier orden.
+    m_File << "P6\n"
+           << m_Settings.Width << " " << m_Settings.Height << "\n255\n";
+    m_HeaderSize = static_cast<Uint64>(m_File.tellp());
+    m_File.seekp(static_cast<std::streamoff>(m_HeaderSize + Uint64{m_Settings.Width} * m_Settings.Height * 3 - 1));
+    m_File.put(0);
+    if (!m_File)
+    {
+        LOG_ERROR_MESSAGE("Failed to reserve ", Uint64{m_Settings.Width} * m_Settings.Height * 3, " bytes for ", m_Settings.OutputPath);
+        m_File.close();
+        return false;
+    }
+
+    m_NumTilesX    = (m_Settings.Width + m_Settings.TileSize - 1) / m_Settings.TileSize;
+    m_NumTiles     = m_NumTilesX * ((m_Settings.Height + m_Settings.TileSize - 1) / m_Settings.TileSize);
+    m_NextTile     = 0;
+    m_WrittenTiles = 0;
+    m_bWriteFailed = false;
+    m_pWriter      = std::make_unique<Tutorial14_ThreadPool>(1, "Canvas export writer");
+    m_bExporting   = true;
+
+    LOG_INFO_MESSAGE("Exporting canvas to ", m_Settings.OutputPath, " at ", m_Settings.Width, "x", m_Settings.Height, " in ", m_NumTiles, " tiles");
+    return true;
+}
+
+void Tutorial14_CanvasExport::Update()
+{
+    if (!m_bExporting)
+        return;
+
+    T14_TRACE_SCOPE("CanvasExport::Update");
+
+    ProcessSlots();
+
+    if (m_bWriteFailed)
+    {
+        LOG_ERROR_MESSAGE("Failed to write canvas export file ", m_Settings.OutputPath);
+        Cancel();
+        return;
+    }
+    if (m_WrittenTiles.load() == m_NumTiles)
+    {
+        Finish();
+        LOG_INFO_MESSAGE("Canvas export finished: ", m_Settings.OutputPath);
+        return;
+    }
+
+    for (Uint32 i = 0; i < m_Settings.TilesPerFrame && m_NextTile < m_NumTiles; ++i)
+    {
+        auto FreeSlot = std::find_if(m_Slots.begin(), m_Slots.end(), [](const Slot& TileSlot) { return TileSlot.State.load() == SLOT_STATE_FREE; });
+        // Todas las ranuras esperan a la GPU o al disco: el tile se compone en otro frame
+        if (FreeSlot == m_Slots.end())
+            break;
+        RenderTile(*FreeSlot, m_NextTile++);
+    }
+}
+
+void Tutorial14_CanvasExport::RenderTile(Slot& TileSlot, Uint32 TileIndex)
+{
+    TileSlot.X      = (TileIndex % m_NumTilesX) * m_Settings.TileSize;
+    TileSlot.Y      = (TileIndex / m_NumTilesX) * m_Settings.TileSize;
+    TileSlot.Width  = std::min(m_Settings.TileSize, m_Settings.Width - TileSlot.X);
+    TileSlot.Height = std::min(m_Settings.TileSize, m_Settings.Height - TileSlot.Y);
+
+    {
+        const auto& SourceDesc = m_pSourceCanvas->GetDesc();
+        const float InvWidth   = 1.f / static_cast<float>(m_Settings.Width);
+        const float InvHeight  = 1.f / static_cast<float>(m_Settings.Height);
+
+        MapHelper<ExportTileConstants> Constants(m_pContext, m_pConstants, MAP_WRITE, MAP_FLAG_DISCARD);
+        Constants->f4TileRect   = float4{static_cast<float>(TileSlot.X) * InvWidth, static_cast<float>(TileSlot.Y) * InvHeight,
+                                       static_cast<float>(TileSlot.Width) * InvWidth, static_cast<float>(TileSlot.Height) * InvHeight};
+        Constants->f4CanvasSize = float4{static_cast<float>(SourceDesc.Width), static_cast<float>(SourceDesc.Height), 0, 0};
+    }
+
+    ITextureView* pTileRTV = TileSlot.pTileTexture->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+    m_pContext->SetRenderTargets(1, &pTileRTV, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    // Los tiles del borde derecho e inferior solo usan parte de la textura
+    Viewport VP;
+    VP.Width    = static_cast<float>(TileSlot.Width);
+    VP.Height   = static_cast<float>(TileSlot.Height);
+    VP.MinDepth = 0.0f;
+    VP.MaxDepth = 1.0f;
+    m_pContext->SetViewports(1, &VP, 0, 0);
+
+    m_pContext->SetPipelineState(m_pExportPSO);
+    m_pContext->CommitShaderResources(m_pExportSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    DrawAttribs drawAttrs;
+    drawAttrs.NumVertices = 4;
+    m_pContext->Draw(drawAttrs);
+
+    m_pContext->CopyTexture(CopyTextureAttribs{TileSlot.pTileTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                               TileSlot.pStagingTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION});
+
+    TileSlot.FenceValue = m_NextFenceValue++;
+    TileSlot.State.store(SLOT_STATE_COPYING);
+    m_pContext->EnqueueSignal(m_pFence, TileSlot.FenceValue);
+}
+
+void Tutorial14_CanvasExport::ProcessSlots()
+{
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+
+    for (auto& TileSlot : m_Slots)
+    {
+        if (TileSlot.State.load() == SLOT_STATE_WRITTEN)
+        {
+            m_pContext->UnmapTextureSubresource(TileSlot.pStagingTexture, 0, 0);
+            TileSlot.State.store(SLOT_STATE_FREE);
+        }
+        else if (TileSlot.State.load() == SLOT_STATE_COPYING && TileSlot.FenceValue <= CompletedValue)
+        {
+            // Cada tile va a su propia regin del fichero, as que el orden no importa.
+            // Si el mapeo falla se reintenta en el siguiente frame: un tile no se puede descartar.
+            MappedTextureSubresource MappedData;
+            m_pContext->MapTextureSubresource(TileSlot.pStagingTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+            if (MappedData.pData == nullptr)
+                continue;
+
+            TileSlot.State.store(SLOT_STATE_WRITING);
+
+            Slot* pSlot = &TileSlot;
+            m_pWriter->Enqueue([this, pSlot, MappedData]() {
+                WriteTile(*pSlot, MappedData.pData, MappedData.Stride);
+                ++m_WrittenTiles;
+                pSlot->State.store(SLOT_STATE_WRITTEN);
+            });
+        }
+    }
+}
+
+void Tutorial14_CanvasExport::WriteTile(const Slot& TileSlot, const void* pData, Uint64 Stride)
+{
+    T14_TRACE_SCOPE("Write canvas tile");
+
+    // Se descarta el canal alfa fila a fila: la memoria auxiliar es una fila del tile
+    std::vector<char> Row(size_t{TileSlot.Width} * 3);
+    for (Uint32 y = 0; y < TileSlot.Height; ++y)
+    {
+        const Uint8* pSrc = static_cast<const Uint8*>(pData) + Stride * y;
+        for (Uint32 x = 0; x < TileSlot.Width; ++x)
+        {
+            Row[x * 3 + 0] = static_cast<char>(pSrc[x * 4 + 0]);
+            Row[x * 3 + 1] = static_cast<char>(pSrc[x * 4 + 1]);
+            Row[x * 3 + 2] = static_cast<char>(pSrc[x * 4 + 2]);
+        }
+
+        const Uint64 Offset = m_HeaderSize + (Uint64{TileSlot.Y + y} * m_Settings.Width + TileSlot.X) * 3;
+        m_File.seekp(static_cast<std::streamoff>(Offset));
+        m_File.write(Row.data(), static_cast<std::streamsize>(Row.size()));
+    }
+
+    if (!m_File)
+        m_bWriteFailed = true;
+}
+
+void Tutorial14_CanvasExport::Cancel()
+{
+    if (!m_bExporting)
+        return;
+
+    // Las copias en vuelo se escriben igualmente para poder desmapear sus texturas
+    m_pContext->WaitForIdle();
+    Finish();
+    LOG_WARNING_MESSAGE("Canvas export to ", m_Settings.OutputPath, " was cancelled; the file is incomplete");
+}
+
+void Tutorial14_CanvasExport::Finish()
+{
+    T14_TRACE_SCOPE("CanvasExport::Finish");
+
+    ProcessSlots();
+    m_pWriter->WaitIdle();
+    ProcessSlots();
+    m_pWriter.reset();
+    m_File.close();
+    m_bExporting = false;
+}
+
+Tutorial14_CanvasExport::Progress Tutorial14_CanvasExport::GetProgress() const
+{
+    Progress ExportProgress;
+    ExportProgress.NumTiles     = m_NumTiles;
+    ExportProgress.WrittenTiles = m_WrittenTiles.load();
+    return ExportProgress;
+}
+
+} // namespace Diligent
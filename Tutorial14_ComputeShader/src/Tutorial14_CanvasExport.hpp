@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+#include "Tutorial14_ThreadPool.hpp"
+
+namespace Diligent
+{
+
+// Exportacin del canvas a resoluciones de impresin (16K x 16K o ms), por encima del
+// tamao mximo de textura. Al empezar se copia el canvas para que la imagen no cambie
+// mientras se pinta; despus, en cada frame, se componen unos pocos tiles ampliados con
+// ExportCanvas.psh en un anillo fijo de render targets. Cada tile se copia a su textura
+// de lectura y, cuando la fence indica que ha terminado, un hilo de escritura lo vuelca
+// directamente desde la memoria mapeada a su posicin en un fichero PPM binario.
+// La memoria de GPU y de CPU depende del tamao del tile, no del de la imagen.
+class Tutorial14_CanvasExport
+{
+public:
+    static constexpr Uint32 NUM_TILE_SLOTS = 3;
+
+    struct Settings
+    {
+        std::string OutputPath    = "Tutorial14_Canvas.ppm";
+        Uint32      Width         = 16384;
+        Uint32      Height        = 16384;
+        Uint32      TileSize      = 2048;
+        Uint32      TilesPerFrame = 1; // Tiles que se componen en cada frame
+    };
+
+    struct Progress
+    {
+        Uint32 NumTiles     = 0;
+        Uint32 WrittenTiles = 0;
+    };
+
+    // TileFormat: TEX_FORMAT_RGBA8_UNORM o TEX_FORMAT_RGBA8_UNORM_SRGB, segn el back buffer,
+    // para que el fichero tenga los mismos valores que se ven en pantalla
+    Tutorial14_CanvasExport(IRenderDevice*  pDevice,
+                            IDeviceContext* pContext,
+                            IEngineFactory* pEngineFactory,
+                            TEXTURE_FORMAT  TileFormat);
+    ~Tutorial14_CanvasExport();
+
+    // Copia el canvas y abre el fichero; los tiles se generan en Update()
+    bool Start(const Settings& ExportSettings, ITexture* pCanvas);
+    // Descarta los tiles pendientes y cierra el fichero incompleto
+    void Cancel();
+
+    // Una vez por frame: escribe los tiles ya copiados y compone los siguientes.
+    // Deja enlazado el render target de los tiles.
+    void Update();
+
+    bool     IsExporting() const { return m_bExporting; }
+    Progress GetProgress() const;
+
+    const Settings& GetSettings() const { return m_Settings; }
+
+private:
+    enum SLOT_STATE : Uint32
+    {
+        SLOT_STATE_FREE = 0,
+        SLOT_STATE_COPYING, // Esperando a la fence
+        SLOT_STATE_WRITING, // Mapeada; la usa el hilo de escritura
+        SLOT_STATE_WRITTEN  // El tile est en el fichero; falta desmapear
+    };
+
+    struct Slot
+    {
+        RefCntAutoPtr<ITexture> pTileTexture;
+        RefCntAutoPtr<ITexture> pStagingTexture;
+        std::atomic<Uint32>     State{SLOT_STATE_FREE};
+        Uint64                  FenceValue = 0;
+        Uint32                  X          = 0; // Origen y tamao del tile en la imagen
+        Uint32                  Y          = 0;
+        Uint32                  Width      = 0;
+        Uint32                  Height     = 0;
+    };
+
+    void CreatePipeline(IEngineFactory* pEngineFactory);
+    bool CreateSlots();
+    void ProcessSlots();
+    void RenderTile(Slot& TileSlot, Uint32 TileIndex);
+    void WriteTile(const Slot& TileSlot, const void* pData, Uint64 Stride);
+    void Finish();
+
+    IRenderDevice*  m_pDevice  = nullptr;
+    IDeviceContext* m_pContext = nullptr;
+    TEXTURE_FORMAT  m_TileFormat;
+
+    RefCntAutoPtr<IPipelineState>         m_pExportPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pExportSRB;
+    RefCntAutoPtr<IBuffer>                m_pConstants;
+    RefCntAutoPtr<IFence>                 m_pFence;
+    RefCntAutoPtr<ITexture>               m_pSourceCanvas;
+
+    Settings m_Settings;
+    bool     m_bExporting     = false;
+    Uint32   m_NumTilesX      = 0;
+    Uint32   m_NumTiles       = 0;
+    Uint32   m_NextTile       = 0;
+    Uint64   m_NextFenceValue = 1;
+    Uint64   m_HeaderSize     = 0;
+
+    std::array<Slot, NUM_TILE_SLOTS> m_Slots;
+
+    // Un nico hilo de escritura: todos los tiles van al mismo fichero
+    std::ofstream                          m_File;
+    std::unique_ptr<Tutorial14_ThreadPool> m_pWriter;
+    std::atomic<Uint32>                    m_WrittenTiles{0};
+    std::atomic<bool>                      m_bWriteFailed{false};
+};
+
+} // namespace Diligent
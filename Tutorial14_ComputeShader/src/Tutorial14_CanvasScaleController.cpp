@@ -0,0 +1,57 @@
+#include <algorithm>
+#include <cmath>
+#include "Tutorial14_CanvasScaleController.hpp"
+
+namespace Diligent
+{
+
+void Tutorial14_CanvasScaleController::Reset(float Scale, Uint64 FirstFrameId)
+{
+    m_Scale        = QuantizeScale(Scale);
+    m_FirstFrameId = FirstFrameId;
+    m_SumMs        = 0;
+    m_NumSamples   = 0;
+}
+
+float Tutorial14_CanvasScaleController::QuantizeScale(float Scale) const
+{
+    const float Step = std::max(m_Settings.Step, 0.01f);
+    Scale            = std::floor(Scale / Step + 0.5f) * Step;
+    return clamp(Scale, m_Settings.MinScale, m_Settings.MaxScale);
+}
+
+bool Tutorial14_CanvasScaleController::AddSample(Uint64 FrameId, double PaintMs)
+{
+    // Medidas de frames renderizados con la escala anterior
+    if (FrameId < m_FirstFrameId)
+        return false;
+
+    m_SumMs += PaintMs;
+    if (++m_NumSamples < std::max(m_Settings.NumSamples, 1u))
+        return false;
+
+    m_AverageMs  = m_SumMs / m_NumSamples;
+    m_SumMs      = 0;
+    m_NumSamples = 0;
+
+    float NewScale = m_Scale;
+    if (m_AverageMs > m_Settings.BudgetMs)
+    {
+        // El coste de la pintura es proporcional al nmero de pxeles, es decir, a la escala al cuadrado
+        const float Target = m_Scale * static_cast<float>(std::sqrt(m_Settings.BudgetMs / m_AverageMs));
+        NewScale           = std::min(QuantizeScale(Target), m_Scale - m_Settings.Step);
+    }
+    else if (m_AverageMs < m_Settings.BudgetMs * m_Settings.Headroom)
+    {
+        NewScale = m_Scale + m_Settings.Step;
+    }
+
+    NewScale = clamp(NewScale, m_Settings.MinScale, m_Settings.MaxScale);
+    if (NewScale == m_Scale)
+        return false;
+
+    m_Scale = NewScale;
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// Ajusta la escala de resolucin del canvas para que los pases de pintura no
+// superen un presupuesto de tiempo de GPU. Las medidas llegan del perfilador
+// varios frames tarde; tras cada cambio se ignoran las de frames anteriores.
+// La escala se mueve en pasos fijos para que el canvas no se remuestree (y se
+// emborrone) con cada pequea variacin del tiempo medido.
+class Tutorial14_CanvasScaleController
+{
+public:
+    struct Settings
+    {
+        double BudgetMs   = 2.0;
+        float  MinScale   = 0.25f;
+        float  MaxScale   = 1.0f;
+        float  Step       = 0.125f;
+        Uint32 NumSamples = 30;  // Frames que se promedian antes de decidir
+        double Headroom   = 0.6; // Se sube de escala si el tiempo es menor que BudgetMs * Headroom
+    };
+
+    // Reinicia el controlador con la escala aplicada a partir del frame FirstFrameId
+    void Reset(float Scale, Uint64 FirstFrameId);
+
+    // Aade el tiempo de los pases de pintura de un frame. Devuelve true si la escala ha cambiado.
+    bool AddSample(Uint64 FrameId, double PaintMs);
+
+    float GetScale() const { return m_Scale; }
+
+    // Media de la ltima ventana de medidas
+    double GetAverageMs() const { return m_AverageMs; }
+
+    Settings& GetSettings() { return m_Settings; }
+
+private:
+    float QuantizeScale(float Scale) const;
+
+    Settings m_Settings;
+
+    float  m_Scale        = 1.0f;
+    Uint64 m_FirstFrameId = 0;
+    double m_SumMs        = 0;
+    Uint32 m_NumSamples   = 0;
+    double m_AverageMs    = 0;
+};
+
+} // namespace Diligent
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "Tutorial14_CommandRecorder.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr Uint32 MAX_DEFAULT_CONTEXTS = 8;
+
+double MillisecondsSince(std::chrono::high_resolution_clock::time_point Start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - Start).count();
+}
+
+} // namespace
+
+Uint32 Tutorial14_CommandRecorder::GetDefaultNumContexts()
+{
+    return std::min(std::max(std::thread::hardware_concurrency(), 1u), MAX_DEFAULT_CONTEXTS);
+}
+
+Tutorial14_CommandRecorder::Tutorial14_CommandRecorder(IDeviceContext*                                   pImmediateContext,
+                                                       const std::vector<RefCntAutoPtr<IDeviceContext>>& DeferredContexts) :
+    m_pImmediateContext(pImmediateContext)
+{
+    for (const auto& pContext : DeferredContexts)
+    {
+        if (pContext)
+            m_DeferredContexts.push_back(pContext);
+    }
+
+    if (m_DeferredContexts.size() > 1)
+    {
+        m_pWorkers = std::make_unique<Tutorial14_ThreadPool>(static_cast<Uint32>(m_DeferredContexts.size() - 1), "Command recording");
+    }
+}
+
+Tutorial14_CommandRecorder::~Tutorial14_CommandRecorder()
+{
+    // Los trabajos en curso hacen referencia a los segmentos
+    if (m_pWorkers)
+        m_pWorkers->WaitIdle();
+}
+
+void Tutorial14_CommandRecorder::AddSegment(const char* Name, RecordFunc Func)
+{
+    Segment NewSegment;
+    NewSegment.Name = Name;
+    NewSegment.Func = std::move(Func);
+    m_Segments.emplace_back(std::move(NewSegment));
+}
+
+void Tutorial14_CommandRecorder::RecordSegments(IDeviceContext* pContext)
+{
+    for (size_t i = m_NextSegment.fetch_add(1); i < m_Segments.size(); i = m_NextSegment.fetch_add(1))
+    {
+        Segment&                   Seg = m_Segments[i];
+        Tutorial14_CPUTrace::Scope Trace{Seg.Name};
+
+        const auto StartTime = std::chrono::high_resolution_clock::now();
+        pContext->Begin(0);
+        Seg.Func(pContext);
+        pContext->FinishCommandList(&Seg.pCommandList);
+        Seg.RecordMs = MillisecondsSince(StartTime);
+    }
+}
+
+void Tutorial14_CommandRecorder::Submit(Tutorial14_GPUProfiler* pProfiler)
+{
+    T14_TRACE_SCOPE("CommandRecorder::Submit");
+
+    m_LastStats             = {};
+    m_LastStats.NumSegments = static_cast<Uint32>(m_Segments.size());
+    if (m_Segments.empty())
+        return;
+
+    const auto StartTime = std::chrono::high_resolution_clock::now();
+    if (!IsParallel())
+    {
+        for (Segment& Seg : m_Segments)
+        {
+            Tutorial14_GPUProfiler::ScopedPass Pass{pProfiler, Seg.Name};
+            Tutorial14_CPUTrace::Scope         Trace{Seg.Name};
+            Seg.Func(m_pImmediateContext);
+        }
+        m_LastStats.RecordMs   = MillisecondsSince(StartTime);
+        m_LastStats.SegmentsMs = m_LastStats.RecordMs;
+        m_Segments.clear();
+        return;
+    }
+
+    // Solo se despiertan los hilos que pueden encontrar un segmento libre
+    m_NextSegment.store(0);
+    const size_t NumHelpers = std::min(m_DeferredContexts.size(), m_Segments.size()) - 1;
+    for (size_t w = 1; w <= NumHelpers; ++w)
+    {
+        IDeviceContext* pContext = m_DeferredContexts[w];
+        m_pWorkers->Enqueue([this, pContext]() { RecordSegments(pContext); });
+    }
+    RecordSegments(m_DeferredContexts[0]);
+    if (NumHelpers > 0)
+        m_pWorkers->WaitIdle();
+
+    m_LastStats.RecordMs = MillisecondsSince(StartTime);
+
+    // Las listas se ejecutan en el orden de los segmentos, no en el de grabacin
+    for (Segment& Seg : m_Segments)
+    {
+        Tutorial14_GPUProfiler::ScopedPass Pass{pProfiler, Seg.Name};
+        ICommandList*                      pCommandList = Seg.pCommandList;
+        m_pImmediateContext->ExecuteCommandLists(1, &pCommandList);
+        m_LastStats.SegmentsMs += Seg.RecordMs;
+    }
+
+    for (auto& pContext : m_DeferredContexts)
+        pContext->FinishFrame();
+
+    m_Segments.clear();
+}
+
+} // namespace Diligent
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "BasicMath.hpp"
+#include "DeviceContext.h"
+#include "Tutorial14_ThreadPool.hpp"
+#include "Tutorial14_GPUProfiler.hpp"
+
+namespace Diligent
+{
+
+// Planificador de la grabacin de comandos en varios hilos. El frame se divide en
+// segmentos; cada segmento se graba en su propia lista de comandos en un contexto
+// diferido y las listas se ejecutan en el contexto inmediato en el orden en que se
+// aadieron los segmentos. Cada hilo (el principal y los del grupo) tiene un
+// contexto diferido y toma el siguiente segmento libre hasta que no quedan.
+//
+// Los contextos diferidos no pueden hacer transiciones de estado implcitas: los
+// segmentos usan RESOURCE_STATE_TRANSITION_MODE_NONE con barreras explcitas, y
+// quien los aade deja los recursos en sus estados de entrada antes de Submit() y
+// actualiza los estados registrados despus. Los bferes dinmicos deben mapearse
+// dentro del segmento que los usa, ya que sus datos son propios de cada contexto.
+class Tutorial14_CommandRecorder
+{
+public:
+    using RecordFunc = std::function<void(IDeviceContext* pContext)>;
+
+    // Nmero de contextos diferidos por defecto: uno por ncleo, hasta 8
+    static Uint32 GetDefaultNumContexts();
+
+    Tutorial14_CommandRecorder(IDeviceContext*                                   pImmediateContext,
+                               const std::vector<RefCntAutoPtr<IDeviceContext>>& DeferredContexts);
+    ~Tutorial14_CommandRecorder();
+
+    // Sin contextos diferidos los segmentos se graban en orden en el contexto inmediato
+    bool IsParallel() const { return !m_DeferredContexts.empty(); }
+
+    // Segmentos que pueden grabarse a la vez
+    Uint32 GetNumWorkers() const { return std::max(static_cast<Uint32>(m_DeferredContexts.size()), 1u); }
+
+    // Name debe apuntar a una cadena esttica; se usa en las trazas de CPU y GPU
+    void AddSegment(const char* Name, RecordFunc Func);
+
+    // Graba los segmentos aadidos y los ejecuta en orden. Despus, el estado del
+    // contexto inmediato (PSO, render targets, viewports) queda sin definir.
+    void Submit(Tutorial14_GPUProfiler* pProfiler);
+
+    struct Statistics
+    {
+        Uint32 NumSegments = 0;
+        double RecordMs    = 0; // Tiempo real de la grabacin de todos los segmentos
+        double SegmentsMs  = 0; // Suma de los tiempos de grabacin de cada segmento
+    };
+    const Statistics& GetLastStatistics() const { return m_LastStats; }
+
+private:
+    void RecordSegments(IDeviceContext* pContext);
+
+    struct Segment
+    {
+        const char*                 Name = nullptr;
+        RecordFunc                  Func;
+        RefCntAutoPtr<ICommandList> pCommandList;
+        double                      RecordMs = 0;
+    };
+
+    IDeviceContext* m_pImmediateContext = nullptr;
+
+    std::vector<RefCntAutoPtr<IDeviceContext>> m_DeferredContexts;
+    // Hilos de los contextos diferidos 1..N-1; el hilo principal graba con el contexto 0
+    std::unique_ptr<Tutorial14_ThreadPool> m_pWorkers;
+
+    std::vector<Segment> m_Segments;
+    std::atomic<size_t>  m_NextSegment{0};
+
+    Statistics m_LastStats;
+};
+
+} // namespace Diligent
@@ -26,13 +26,20 @@
  */
 
 #include <random>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
 #include "Tutorial14_FluidSimulation.hpp"
+#include "Tutorial14_ParticleStructures.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "Tutorial14_Snapshot.hpp"
 #include "Tutorial14_ComputeShader.hpp"
 #include "BasicMath.hpp"
-#include "MapHelper.hpp"
 #include "imgui.h"
 #include "ShaderMacroHelper.hpp"
 #include "ColorConversion.h"
+#include "GraphicsAccessories.hpp"
 
 namespace Diligent
 {
@@ -45,18 +52,11 @@ SampleBase* CreateSample()
 namespace
 {
 
-struct ParticleAttribs
+struct PaintConstants
 {
-    float2 f2Pos;
-    float2 f2NewPos;
-
-    float2 f2Speed;
-    float2 f2NewSpeed;
-
-    float fSize          = 0;
-    float fTemperature   = 0;
-    int   iNumCollisions = 0;
-    float fPadding0      = 0;
+    float  Time;
+    float  Chaos;
+    float2 ScreenSize;
 };
 
 } // namespace
@@ -108,7 +108,8 @@ void Tutorial14_ComputeShader::CreateRenderParticlePSO()
     // converted from linear to gamma space by the GPU. However, some platforms (e.g. Android in GLES mode,
     // or Emscripten in WebGL mode) do not support gamma-correction. In this case the application
     // has to do the conversion manually.
-    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}};
+    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"},
+                            {"WORLD_GRID", m_bWorldMode ? "1" : "0"}};
     ShaderCI.Macros      = {Macros, _countof(Macros)};
 
     // Create a shader source stream factory to load shaders from files.
@@ -146,14 +147,15 @@ void Tutorial14_ComputeShader::CreateRenderParticlePSO()
     // to change on a per-instance basis
     ShaderResourceVariableDesc Vars[] = 
     {
-        {SHADER_TYPE_VERTEX, "g_Particles", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
+        {SHADER_TYPE_VERTEX, "g_Particles", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        // Ventana del asignador de frame; el desplazamiento cambia cada frame
+        {SHADER_TYPE_VERTEX, "Constants",   SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
     };
     // clang-format on
     PSOCreateInfo.PSODesc.ResourceLayout.Variables    = Vars;
     PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
 
     m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pRenderParticlePSO);
-    m_pRenderParticlePSO->GetStaticVariableByName(SHADER_TYPE_VERTEX, "Constants")->Set(m_Constants);
 }
 
 void Tutorial14_ComputeShader::CreateUpdateParticlePSO()
@@ -173,6 +175,8 @@ void Tutorial14_ComputeShader::CreateUpdateParticlePSO()
 
     ShaderMacroHelper Macros;
     Macros.AddShaderMacro("THREAD_GROUP_SIZE", m_ThreadGroupSize);
+    Macros.AddShaderMacro("WORLD_GRID", m_bWorldMode ? 1 : 0);
+    Macros.AddShaderMacro("WORLD_HALF_SIZE", WORLD_HALF_SIZE);
 
     RefCntAutoPtr<IShader> pResetParticleListsCS;
     {
@@ -184,6 +188,10 @@ void Tutorial14_ComputeShader::CreateUpdateParticlePSO()
         m_pDevice->CreateShader(ShaderCI, &pResetParticleListsCS);
     }
 
+    // Con partculas dormidas los pases se lanzan sobre la lista de activas
+    m_pParticleSleep->SetThreadGroupSize(m_ThreadGroupSize);
+    Macros.AddShaderMacro("PARTICLE_SLEEP", IsParticleSleepEnabled() ? 1 : 0);
+
     RefCntAutoPtr<IShader> pMoveParticlesCS;
     {
         ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
@@ -194,6 +202,12 @@ void Tutorial14_ComputeShader::CreateUpdateParticlePSO()
         m_pDevice->CreateShader(ShaderCI, &pMoveParticlesCS);
     }
 
+    m_pSPHFluid->SetThreadGroupSize(m_ThreadGroupSize);
+
+    // Con listas de vecinas los pases de colisin no recorren la rejilla
+    m_pNeighborList->SetThreadGroupSize(m_ThreadGroupSize);
+    Macros.AddShaderMacro("NEIGHBOR_LIST", IsNeighborListEnabled() ? 1 : 0);
+
     RefCntAutoPtr<IShader> pCollideParticlesCS;
     {
         ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
@@ -221,44 +235,57 @@ void Tutorial14_ComputeShader::CreateUpdateParticlePSO()
     // This is a compute pipeline
     PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
 
+    // Todas las variables son mutables: Constants es una ventana del asignador de frame
+    // cuyo desplazamiento se fija en cada SRB
     PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
 
-    // clang-format off
-    ShaderResourceVariableDesc Vars[] = 
-    {
-        {SHADER_TYPE_COMPUTE, "Constants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
-    };
-    // clang-format on
-    PSODesc.ResourceLayout.Variables    = Vars;
-    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
-
     PSODesc.Name      = "Reset particle lists PSO";
     PSOCreateInfo.pCS = pResetParticleListsCS;
     m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pResetParticleListsPSO);
-    m_pResetParticleListsPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "Constants")->Set(m_Constants);
 
     PSODesc.Name      = "Move particles PSO";
     PSOCreateInfo.pCS = pMoveParticlesCS;
     m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pMoveParticlesPSO);
-    m_pMoveParticlesPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "Constants")->Set(m_Constants);
 
     PSODesc.Name      = "Collidse particles PSO";
     PSOCreateInfo.pCS = pCollideParticlesCS;
     m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pCollideParticlesPSO);
-    m_pCollideParticlesPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "Constants")->Set(m_Constants);
 
     PSODesc.Name      = "Update particle speed PSO";
     PSOCreateInfo.pCS = pUpdatedSpeedCS;
     m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pUpdateParticleSpeedPSO);
-    m_pUpdateParticleSpeedPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "Constants")->Set(m_Constants);
+
+    // El hilo de simulacin puede estar grabando un paso con los pipelines de la canalizacin
+    if (m_pParticlePipeline)
+    {
+        m_pFluidSim->WaitForAsyncStep();
+        m_pParticlePipeline->SetThreadGroupSize(m_ThreadGroupSize);
+    }
 }
 
-void Tutorial14_ComputeShader::CreateParticleBuffers()
+void Tutorial14_ComputeShader::CreateParticleBuffers(const void* pParticleData, const void* pListHeadsData, const void* pListsData)
 {
+    T14_TRACE_SCOPE("CreateParticleBuffers");
+
+    // La grabacin en curso depende del tamao del bfer de partculas
+    if (m_pTrajectoryRecorder && m_pTrajectoryRecorder->IsRecording())
+    {
+        m_pTrajectoryRecorder->Stop();
+    }
+
     m_pParticleAttribsBuffer.Release();
+    m_pMovedParticleAttribsBuffer.Release();
     m_pParticleListHeadsBuffer.Release();
     m_pParticleListsBuffer.Release();
 
+    // Las partculas canalizadas vuelven a empezar desde los bferes nuevos
+    if (m_pParticlePipeline)
+    {
+        m_pFluidSim->WaitForAsyncStep();
+        m_pParticlePipeline->SetNumParticles(static_cast<Uint32>(m_NumParticles));
+        m_bParticlesPipelined = false;
+    }
+
     BufferDesc BuffDesc;
     BuffDesc.Name              = "Particle attribs buffer";
     BuffDesc.Usage             = USAGE_DEFAULT;
@@ -267,80 +294,182 @@ void Tutorial14_ComputeShader::CreateParticleBuffers()
     BuffDesc.ElementByteStride = sizeof(ParticleAttribs);
     BuffDesc.Size              = sizeof(ParticleAttribs) * m_NumParticles;
 
-    std::vector<ParticleAttribs> ParticleData(m_NumParticles);
+    // Los datos de una instantnea se suben directamente desde el fichero proyectado
+    std::vector<ParticleAttribs> ParticleData;
+    if (pParticleData == nullptr)
+    {
+        ParticleData.resize(m_NumParticles);
 
-    std::mt19937 gen; // Standard mersenne_twister_engine. Use default seed
-                      // to generate consistent distribution.
+        std::mt19937 gen; // Standard mersenne_twister_engine. Use default seed
+                          // to generate consistent distribution.
 
-    std::uniform_real_distribution<float> pos_distr(-1.f, +1.f);
-    std::uniform_real_distribution<float> size_distr(0.5f, 1.f);
+        std::uniform_real_distribution<float> pos_distr(-1.f, +1.f);
+        std::uniform_real_distribution<float> size_distr(0.5f, 1.f);
 
-    constexpr float fMaxParticleSize = 0.05f;
-    float           fSize            = 0.7f / std::sqrt(static_cast<float>(m_NumParticles));
-    fSize                            = std::min(fMaxParticleSize, fSize);
-    for (auto& particle : ParticleData)
-    {
-        particle.f2NewPos.x   = pos_distr(gen);
-        particle.f2NewPos.y   = pos_distr(gen);
-        particle.f2NewSpeed.x = pos_distr(gen) * fSize * 5.f;
-        particle.f2NewSpeed.y = pos_distr(gen) * fSize * 5.f;
-        particle.fSize        = fSize * size_distr(gen);
+        constexpr float fMaxParticleSize = 0.05f;
+        float           fSize            = 0.7f / std::sqrt(static_cast<float>(m_NumParticles));
+        fSize                            = std::min(fMaxParticleSize, fSize);
+        for (auto& particle : ParticleData)
+        {
+            particle.f2Pos.x   = pos_distr(gen);
+            particle.f2Pos.y   = pos_distr(gen);
+            particle.f2Speed.x = pos_distr(gen) * fSize * 5.f;
+            particle.f2Speed.y = pos_distr(gen) * fSize * 5.f;
+            particle.fSize     = fSize * size_distr(gen);
+        }
+        pParticleData = ParticleData.data();
     }
 
     BufferData VBData;
-    VBData.pData    = ParticleData.data();
-    VBData.DataSize = sizeof(ParticleAttribs) * static_cast<Uint32>(ParticleData.size());
+    VBData.pData    = pParticleData;
+    VBData.DataSize = BuffDesc.Size;
     m_pDevice->CreateBuffer(BuffDesc, &VBData, &m_pParticleAttribsBuffer);
-    IBufferView* pParticleAttribsBufferSRV = m_pParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
-    IBufferView* pParticleAttribsBufferUAV = m_pParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+
+    // Segundo bfer del ping-pong: solo lo usan los pases de simulacin y se sobrescribe
+    // entero en cada paso, as que no necesita datos iniciales
+    BuffDesc.Name = "Moved particle attribs buffer";
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pMovedParticleAttribsBuffer);
 
     BuffDesc.ElementByteStride = sizeof(int);
     BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
     BuffDesc.Size              = Uint64{BuffDesc.ElementByteStride} * static_cast<Uint64>(m_NumParticles);
     BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS | BIND_SHADER_RESOURCE;
-    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pParticleListHeadsBuffer);
-    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pParticleListsBuffer);
-    IBufferView* pParticleListHeadsBufferUAV = m_pParticleListHeadsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
-    IBufferView* pParticleListsBufferUAV     = m_pParticleListsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
-    IBufferView* pParticleListHeadsBufferSRV = m_pParticleListHeadsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
-    IBufferView* pParticleListsBufferSRV     = m_pParticleListsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    BufferData ListHeadsData{pListHeadsData, BuffDesc.Size};
+    BufferData ListsData{pListsData, BuffDesc.Size};
+    m_pDevice->CreateBuffer(BuffDesc, pListHeadsData != nullptr ? &ListHeadsData : nullptr, &m_pParticleListHeadsBuffer);
+    m_pDevice->CreateBuffer(BuffDesc, pListsData != nullptr ? &ListsData : nullptr, &m_pParticleListsBuffer);
+
+    m_pParticleSleep->SetParticleBuffers(m_pParticleAttribsBuffer, m_pMovedParticleAttribsBuffer, m_pParticleListHeadsBuffer, m_pParticleListsBuffer,
+                                         m_pAdaptiveTimeStep->GetTimeStepBuffer(), static_cast<Uint32>(m_NumParticles));
+    m_pNeighborList->SetParticleBuffers(m_pMovedParticleAttribsBuffer, m_pParticleListHeadsBuffer, m_pParticleListsBuffer, static_cast<Uint32>(m_NumParticles));
+    m_pSPHFluid->SetParticleBuffers(m_pParticleAttribsBuffer, m_pMovedParticleAttribsBuffer, m_pParticleListHeadsBuffer, m_pParticleListsBuffer,
+                                    m_pAdaptiveTimeStep->GetTimeStepBuffer(), static_cast<Uint32>(m_NumParticles));
+    CreateParticleSRBs();
+
+    if (m_pSimStats)
+    {
+        m_pSimStats->SetParticleBuffers(m_pParticleAttribsBuffer, m_pParticleListHeadsBuffer, m_pParticleListsBuffer, static_cast<Uint32>(m_NumParticles));
+    }
+    m_pAdaptiveTimeStep->SetParticleBuffer(m_pParticleAttribsBuffer);
+    if (m_pFluidSim)
+    {
+        m_pFluidSim->SetParticleBuffers(m_pParticleAttribsBuffer, m_pParticleListHeadsBuffer, m_pParticleListsBuffer, static_cast<Uint32>(m_NumParticles));
+    }
+    if (m_pTiledPaint)
+    {
+        m_pTiledPaint->SetParticleBuffer(m_pParticleAttribsBuffer, static_cast<Uint32>(m_NumParticles));
+    }
+
+    RecreatePaintSRB();
+}
+
+
+void Tutorial14_ComputeShader::CreateParticleSRBs()
+{
+    if (!m_pParticleAttribsBuffer || !m_pResetParticleListsPSO)
+        return;
+
+    IBufferView* pParticleAttribsBufferSRV      = m_pParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pParticleAttribsBufferUAV      = m_pParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pMovedParticleAttribsBufferSRV = m_pMovedParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pMovedParticleAttribsBufferUAV = m_pMovedParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pParticleListHeadsBufferUAV    = m_pParticleListHeadsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pParticleListsBufferUAV        = m_pParticleListsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pParticleListHeadsBufferSRV    = m_pParticleListHeadsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pParticleListsBufferSRV        = m_pParticleListsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
 
     m_pResetParticleListsSRB.Release();
     m_pResetParticleListsPSO->CreateShaderResourceBinding(&m_pResetParticleListsSRB, true);
     m_pResetParticleListsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeadsBufferUAV);
+    m_pFrameAllocator->BindConstants(m_pResetParticleListsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "Constants"), sizeof(GlobalConstants));
 
     m_pRenderParticleSRB.Release();
     m_pRenderParticlePSO->CreateShaderResourceBinding(&m_pRenderParticleSRB, true);
     m_pRenderParticleSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_Particles")->Set(pParticleAttribsBufferSRV);
+    m_pFrameAllocator->BindConstants(m_pRenderParticleSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants"), sizeof(GlobalConstants));
+
+    // Un SRB de dibujo por bfer publicado de la canalizacin
+    for (Uint32 i = 0; i < Tutorial14_ParticlePipeline::NUM_PUBLISHED_BUFFERS; ++i)
+    {
+        m_pPipelinedRenderSRB[i].Release();
+        if (!m_pParticlePipeline || !m_pParticlePipeline->GetPublishedBuffer(i))
+            continue;
+        m_pRenderParticlePSO->CreateShaderResourceBinding(&m_pPipelinedRenderSRB[i], true);
+        m_pPipelinedRenderSRB[i]->GetVariableByName(SHADER_TYPE_VERTEX, "g_Particles")->Set(m_pParticlePipeline->GetPublishedBuffer(i)->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+        m_pFrameAllocator->BindConstants(m_pPipelinedRenderSRB[i]->GetVariableByName(SHADER_TYPE_VERTEX, "Constants"), sizeof(GlobalConstants));
+    }
 
     m_pMoveParticlesSRB.Release();
     m_pMoveParticlesPSO->CreateShaderResourceBinding(&m_pMoveParticlesSRB, true);
-    m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pParticleAttribsBufferUAV);
+    m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pParticleAttribsBufferSRV);
+    m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutParticles")->Set(pMovedParticleAttribsBufferUAV);
     m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeadsBufferUAV);
     m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pParticleListsBufferUAV);
+    m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TimeStep")->Set(m_pAdaptiveTimeStep->GetTimeStepBuffer()->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pFrameAllocator->BindConstants(m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "Constants"), sizeof(GlobalConstants));
 
     m_pCollideParticlesSRB.Release();
     m_pCollideParticlesPSO->CreateShaderResourceBinding(&m_pCollideParticlesSRB, true);
-    m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pParticleAttribsBufferUAV);
-    m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeadsBufferSRV);
-    m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pParticleListsBufferSRV);
+    m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pMovedParticleAttribsBufferSRV);
+    m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutParticles")->Set(pParticleAttribsBufferUAV);
+    m_pFrameAllocator->BindConstants(m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "Constants"), sizeof(GlobalConstants));
+
+    // El pase de actualizacin de velocidad usa el mismo shader de colisiones, pero con
+    // partculas dormidas su layout implcito no incluye g_WakeFlags, as que no comparte SRB
+    m_pUpdateParticleSpeedSRB.Release();
+    m_pUpdateParticleSpeedPSO->CreateShaderResourceBinding(&m_pUpdateParticleSpeedSRB, true);
+    m_pUpdateParticleSpeedSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pMovedParticleAttribsBufferSRV);
+    m_pUpdateParticleSpeedSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutParticles")->Set(pParticleAttribsBufferUAV);
+    m_pFrameAllocator->BindConstants(m_pUpdateParticleSpeedSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "Constants"), sizeof(GlobalConstants));
+
+    if (IsNeighborListEnabled())
+    {
+        m_pNeighborList->BindNeighborLists(m_pCollideParticlesSRB);
+        m_pNeighborList->BindNeighborLists(m_pUpdateParticleSpeedSRB);
+    }
+    else
+    {
+        m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeadsBufferSRV);
+        m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pParticleListsBufferSRV);
+        m_pUpdateParticleSpeedSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeadsBufferSRV);
+        m_pUpdateParticleSpeedSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pParticleListsBufferSRV);
+    }
 
-    RecreatePaintSRB();
+    if (IsParticleSleepEnabled())
+    {
+        m_pParticleSleep->BindActiveList(m_pMoveParticlesSRB);
+        m_pParticleSleep->BindActiveList(m_pCollideParticlesSRB);
+        m_pParticleSleep->BindActiveList(m_pUpdateParticleSpeedSRB);
+        m_pParticleSleep->BindWakeFlags(m_pCollideParticlesSRB);
+    }
 }
 
-void Tutorial14_ComputeShader::CreateConsantBuffer()
+
+bool Tutorial14_ComputeShader::IsParticlePipelineEnabled() const
 {
-    BufferDesc BuffDesc;
-    BuffDesc.Name           = "Constants buffer";
-    BuffDesc.Usage          = USAGE_DYNAMIC;
-    BuffDesc.BindFlags      = BIND_UNIFORM_BUFFER;
-    BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-    BuffDesc.Size           = sizeof(float4) * 2;
-    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_Constants);
+    if (!m_bPipelinedParticles || !m_pParticlePipeline || !m_pFluidSim || !m_pFluidSim->IsAsyncCompute())
+        return false;
+
+    // Estos modos tienen pases propios o leen el bfer de partculas en la cola grfica
+    const bool bRecording = m_pTrajectoryRecorder && m_pTrajectoryRecorder->IsRecording();
+    return !IsParticleSleepEnabled() && !IsNeighborListEnabled() && !m_bSPHFluid && !m_bAdaptiveTimeStep && !m_bComputeStats &&
+        !bRecording && !m_bWorldMode && m_VisualizationMode != VisualizationMode::PAINT_CANVAS;
+}
+
+void Tutorial14_ComputeShader::StopParticlePipeline()
+{
+    if (!m_bParticlesPipelined)
+        return;
+
+    m_pParticlePipeline->End(m_pParticleAttribsBuffer);
+    m_bParticlesPipelined = false;
 }
 
+
 void Tutorial14_ComputeShader::UpdateUI()
 {
+    T14_TRACE_SCOPE("UpdateUI");
+
     ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
     if (ImGui::Begin("Settings", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
     {
@@ -351,6 +480,27 @@ void Tutorial14_ComputeShader::UpdateUI()
         }
         ImGui::SliderFloat("Simulation Speed", &m_fSimulationSpeed, 0.1f, 5.f);
         ImGui::SliderFloat("Fluid Viscosity", &m_fViscosity, 0.0f, 1.0f);
+        if (m_pFluidSim)
+        {
+            // Con el fluido en la cola de cmputo las partculas no lo empujan
+            float ParticleCoupling = m_pFluidSim->GetParticleCoupling();
+            if (ImGui::SliderFloat("Particle Coupling", &ParticleCoupling, 0.0f, 10.0f))
+                m_pFluidSim->SetParticleCoupling(ParticleCoupling);
+        }
+        if (m_pFluidSim && m_pFluidSim->IsAsyncComputeSupported())
+        {
+            // Las partculas leen el campo del frame anterior
+            if (ImGui::Checkbox("Async Compute Fluid", &m_bAsyncCompute))
+                m_pFluidSim->SetAsyncCompute(m_bAsyncCompute);
+        }
+        if (m_pParticlePipeline && m_bAsyncCompute)
+        {
+            // Las partculas se simulan con el fluido en el hilo de simulacin y se dibujan
+            // un frame despus
+            ImGui::Checkbox("Pipelined Particles", &m_bPipelinedParticles);
+            if (m_bPipelinedParticles && !IsParticlePipelineEnabled())
+                ImGui::TextDisabled("(off: sleep, neighbor lists, SPH, adaptive step, stats, recording, paint or world mode)");
+        }
 
         ImGui::Separator();
         ImGui::Text("Visualization Mode:");
@@ -361,11 +511,21 @@ void Tutorial14_ComputeShader::UpdateUI()
             m_VisualizationMode = VisualizationMode::FLUID_VISUALIZATION;
         }
 
-        if (ImGui::RadioButton("Paint Canvas", m_VisualizationMode == VisualizationMode::PAINT_CANVAS))
+        // El canvas est fijo a la pantalla, as que no se pinta con la cmara del modo mundo
+        if (m_bWorldMode)
+        {
+            ImGui::TextDisabled("Paint Canvas (off in world mode)");
+        }
+        else if (ImGui::RadioButton("Paint Canvas", m_VisualizationMode == VisualizationMode::PAINT_CANVAS))
         {
             m_VisualizationMode = VisualizationMode::PAINT_CANVAS;
         }
 
+        if (ImGui::RadioButton("Scene Batch", m_VisualizationMode == VisualizationMode::SCENE_BATCH))
+        {
+            m_VisualizationMode = VisualizationMode::SCENE_BATCH;
+        }
+
         // Solo mostrar la opcin de fluido si estamos en modo fluido
         if (m_VisualizationMode == VisualizationMode::FLUID_VISUALIZATION)
         {
@@ -381,65 +541,1380 @@ void Tutorial14_ComputeShader::UpdateUI()
 
             ImGui::SameLine();
             ImGui::Text("| Tip: Try different particle counts!");
+
+            if (ImGui::RadioButton("Raster Splats", m_PaintMethod == PaintMethod::RASTER))
+            {
+                m_PaintMethod = PaintMethod::RASTER;
+            }
+            if (m_pTiledPaint)
+            {
+                ImGui::SameLine();
+                if (ImGui::RadioButton("Compute Tiles", m_PaintMethod == PaintMethod::TILED_COMPUTE))
+                {
+                    m_PaintMethod = PaintMethod::TILED_COMPUTE;
+                }
+                if (m_PaintMethod == PaintMethod::TILED_COMPUTE)
+                {
+                    ImGui::Text("Tile entries: %u / %u", m_pTiledPaint->GetLastNumEntries(), m_pTiledPaint->GetMaxEntries());
+                }
+            }
+            else
+            {
+                ImGui::SameLine();
+                ImGui::TextDisabled("(compute tiles not supported)");
+            }
+
+            UpdateCanvasScaleUI();
+        }
+        else if (m_VisualizationMode == VisualizationMode::SCENE_BATCH)
+        {
+            UpdateSceneBatchUI();
+        }
+
+        UpdateTimeStepUI();
+        UpdateParticleSleepUI();
+        UpdateNeighborListUI();
+        UpdateSPHFluidUI();
+        UpdateWorldUI();
+        UpdateVelocityQueryUI();
+        UpdateStatsUI();
+        UpdateRecorderUI();
+        UpdateCaptureUI();
+        UpdateCanvasExportUI();
+        UpdateCanvasAutosaveUI();
+
+        ImGui::Separator();
+        ImGui::Checkbox("Show GPU Profiler", &m_bShowGPUProfiler);
+        if (ImGui::Button("Dump CPU Trace (F9)"))
+        {
+            Tutorial14_CPUTrace::WriteChromeTrace(m_TraceOutputPath);
+        }
+        if (ImGui::Button("Save Snapshot"))
+        {
+            SaveSnapshot(m_SnapshotPath);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Load Snapshot"))
+        {
+            LoadSnapshot(m_SnapshotPath);
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", m_SnapshotPath.c_str());
+
+        if (m_pBenchmark && !m_pBenchmark->IsFinished())
+        {
+            ImGui::Text("Benchmark: case %d of %d", static_cast<int>(m_pBenchmark->GetCurrentCase() + 1), static_cast<int>(m_pBenchmark->GetNumCases()));
+            ImGui::ProgressBar(m_pBenchmark->GetProgress());
+            if (ImGui::Button("Abort Benchmark"))
+            {
+                RestoreBenchmarkSettings();
+                m_pBenchmark.reset();
+            }
+        }
+        else
+        {
+            if (ImGui::Button("Run Benchmark"))
+            {
+                StartBenchmark();
+            }
+            if (m_pBenchmark)
+            {
+                ImGui::SameLine();
+                ImGui::Text(m_pBenchmark->WriteSucceeded() ? "Results: %s" : "Failed to write %s", m_pBenchmark->GetOutputPath().c_str());
+            }
         }
     }
     ImGui::End();
+
+    if (m_bShowGPUProfiler)
+    {
+        UpdateProfilerUI();
+    }
 }
 
-void Tutorial14_ComputeShader::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs)
+void Tutorial14_ComputeShader::UpdateTimeStepUI()
 {
-    SampleBase::ModifyEngineInitInfo(Attribs);
+    if (!ImGui::CollapsingHeader("Adaptive Time Step"))
+        return;
+
+    if (ImGui::Checkbox("Enable (CFL)", &m_bAdaptiveTimeStep) && m_pFluidSim)
+    {
+        m_pFluidSim->SetAdaptiveTimeStep(m_bAdaptiveTimeStep);
+    }
+
+    auto& Settings = m_pAdaptiveTimeStep->GetSettings();
+    ImGui::SliderFloat("CFL Number", &Settings.CFLNumber, 0.05f, 1.f);
+
+    int MaxSubsteps = static_cast<int>(Settings.MaxSubsteps);
+    if (ImGui::SliderInt("Max Substeps", &MaxSubsteps, 1, 32))
+    {
+        Settings.MaxSubsteps = static_cast<Uint32>(MaxSubsteps);
+    }
 
-    Attribs.EngineCI.Features.ComputeShaders = DEVICE_FEATURE_STATE_ENABLED;
+    if (!m_bAdaptiveTimeStep)
+        return;
+
+    const auto& TimeStep = m_pAdaptiveTimeStep->GetLastReadback();
+    ImGui::Text("Substeps:           %u", m_NumSubsteps);
+    ImGui::Text("Substep dt:         %.5f s", TimeStep.fDeltaTime);
+    ImGui::Text("Stable dt:          %.5f s", TimeStep.fStableDeltaTime);
+    ImGui::Text("Max particle speed: %.4f", TimeStep.fMaxParticleSpeed);
+    ImGui::Text("Max fluid speed:    %.4f", TimeStep.fMaxFluidSpeed);
 }
 
-void Tutorial14_ComputeShader::CreatePaintSystem()
+void Tutorial14_ComputeShader::UpdateParticleSleepUI()
 {
-    try
+    // La clasificacin necesita el campo de velocidad del fluido para despertar partculas
+    if (!m_pParticleSleep->IsValid() || !m_pFluidSim || !ImGui::CollapsingHeader("Particle Sleep"))
+        return;
+
+    if (ImGui::Checkbox("Enable Sleep", &m_bParticleSleep))
     {
-        CreateCanvasTexture();
-        CreateColorPalette();
-        CreatePaintPipelines();
-        LOG_INFO_MESSAGE("Paint system created successfully");
+        // Los pases de movimiento y colisin se compilan con o sin la lista de activas
+        CreateUpdateParticlePSO();
+        CreateParticleSRBs();
     }
-    catch (const std::exception& e)
+
+    auto& Settings = m_pParticleSleep->GetSettings();
+    ImGui::SliderFloat("Sleep Speed", &Settings.SleepSpeed, 0.f, 0.1f, "%.4f");
+    ImGui::SliderFloat("Wake Fluid Speed", &Settings.WakeFluidSpeed, 0.f, 0.5f, "%.3f");
+    ImGui::SliderFloat("Sleep Delay", &Settings.SleepDelay, 0.f, 5.f, "%.2f s");
+
+    if (!m_bParticleSleep)
+        return;
+
+    ImGui::Text("Active particles:   %u / %d", m_pParticleSleep->GetNumActiveParticles(), m_NumParticles);
+}
+
+void Tutorial14_ComputeShader::UpdateNeighborListUI()
+{
+    if (!m_pNeighborList->IsValid() || !ImGui::CollapsingHeader("Neighbor Lists"))
+        return;
+
+    if (ImGui::Checkbox("Enable Verlet Lists", &m_bNeighborList))
     {
-        LOG_ERROR_MESSAGE("Failed to create paint system: %s", e.what());
+        // Los pases de colisin se compilan con o sin las listas; las que hubiera de una
+        // activacin anterior ya no son vlidas
+        m_pNeighborList->Invalidate();
+        CreateUpdateParticlePSO();
+        CreateParticleSRBs();
+    }
+
+    auto& Settings = m_pNeighborList->GetSettings();
+    if (ImGui::SliderFloat("Skin", &Settings.Skin, 0.f, 0.6f, "%.2f"))
+    {
+        m_pNeighborList->Invalidate();
+    }
+
+    if (!m_bNeighborList)
+        return;
+
+    const auto& Stats = m_pNeighborList->GetStatistics();
+    ImGui::Text("Rebuilds:           %u / %u substeps", Stats.NumRebuilds, Stats.NumChecks);
+    ImGui::Text("Max neighbors:      %u / %u", Stats.MaxNeighborsFound, Tutorial14_NeighborList::MaxNeighbors);
+    if (Stats.MaxNeighborsFound > Tutorial14_NeighborList::MaxNeighbors)
+    {
+        ImGui::TextDisabled("(lists truncated: reduce the skin)");
     }
 }
 
-void Tutorial14_ComputeShader::CreateCanvasTexture()
+void Tutorial14_ComputeShader::UpdateSPHFluidUI()
 {
-    // Crear textura persistente para el canvas
-    TextureDesc CanvasTexDesc;
-    CanvasTexDesc.Name              = "Paint Canvas";
-    CanvasTexDesc.Type              = RESOURCE_DIM_TEX_2D;
-    CanvasTexDesc.Width             = m_pSwapChain->GetDesc().Width;
-    CanvasTexDesc.Height            = m_pSwapChain->GetDesc().Height;
-    CanvasTexDesc.Format            = TEX_FORMAT_RGBA8_UNORM;
-    CanvasTexDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_RENDER_TARGET;
-    CanvasTexDesc.ClearValue.Format = TEX_FORMAT_RGBA8_UNORM;
-    // Canvas inicialmente transparente
-    CanvasTexDesc.ClearValue.Color[0] = 0.0f;
-    CanvasTexDesc.ClearValue.Color[1] = 0.0f;
-    CanvasTexDesc.ClearValue.Color[2] = 0.0f;
-    CanvasTexDesc.ClearValue.Color[3] = 0.0f;
+    if (!m_pSPHFluid->IsValid() || !ImGui::CollapsingHeader("SPH Fluid"))
+        return;
 
-    m_pDevice->CreateTexture(CanvasTexDesc, nullptr, &m_pCanvasTexture);
+    // Los pases SPH tienen sus propios pipelines: activar el modo no recompila nada. Las
+    // listas de vecinas no se actualizan mientras est activo.
+    if (ImGui::Checkbox("Enable SPH", &m_bSPHFluid))
+    {
+        m_pNeighborList->Invalidate();
+    }
+
+    auto& Settings = m_pSPHFluid->GetSettings();
+    ImGui::SliderFloat("Rest Density", &Settings.RestDensity, 1.f, 8.f, "%.2f");
+    ImGui::SliderFloat("Stiffness", &Settings.Stiffness, 1.f, 200.f, "%.1f");
+    ImGui::SliderFloat("Viscosity", &Settings.Viscosity, 0.f, 5.f, "%.2f");
+    ImGui::SliderFloat("Gravity", &Settings.Gravity, 0.f, 2.f, "%.2f");
+}
+
+void Tutorial14_ComputeShader::UpdateWorldUI()
+{
+    if (!ImGui::CollapsingHeader("Unbounded World"))
+        return;
+
+    bool bWorldMode = m_bWorldMode;
+    if (ImGui::Checkbox("Enable World Mode", &bWorldMode))
+    {
+        SetWorldMode(bWorldMode);
+    }
+
+    if (!m_bWorldMode)
+        return;
+
+    ImGui::DragFloat2("View Center", &m_f2ViewCenter.x, 0.01f / m_fViewZoom, -WORLD_HALF_SIZE, WORLD_HALF_SIZE, "%.2f");
+    ImGui::SliderFloat("View Zoom", &m_fViewZoom, 1.f / WORLD_HALF_SIZE, 4.f, "%.3f");
+    if (ImGui::Button("Reset View"))
+    {
+        m_f2ViewCenter = float2(0, 0);
+        m_fViewZoom    = 1.f;
+    }
+    ImGui::Text("Fluid window:       (%.2f, %.2f)", m_f2FluidWindowCenter.x, m_f2FluidWindowCenter.y);
+    ImGui::TextDisabled("(sleep, Verlet lists, SPH, fluid coupling and paint canvas are off)");
+}
+
+void Tutorial14_ComputeShader::SetWorldMode(bool bWorldMode)
+{
+    if (bWorldMode == m_bWorldMode)
+        return;
+
+    m_bWorldMode   = bWorldMode;
+    m_f2ViewCenter = float2(0, 0);
+    m_fViewZoom    = 1.f;
+    UpdateFluidWindow();
+
+    // El canvas est fijo a la pantalla; el fluido s sigue a la cmara
+    if (m_bWorldMode && m_VisualizationMode == VisualizationMode::PAINT_CANVAS)
+    {
+        m_VisualizationMode = VisualizationMode::FLUID_VISUALIZATION;
+    }
+
+    // Las listas de vecinas que hubiera se construyeron antes del cambio
+    m_pNeighborList->Invalidate();
+    CreateRenderParticlePSO();
+    CreateUpdateParticlePSO();
+    if (m_bWorldMode)
+    {
+        CreateParticleSRBs();
+    }
+    else
+    {
+        // Las partculas que estn fuera de la pantalla se quedaran pegadas a los bordes
+        CreateParticleBuffers();
+    }
+}
+
+void Tutorial14_ComputeShader::UpdateFluidWindow()
+{
+    if (!m_pFluidSim)
+        return;
+
+    // Fuera del modo mundo la ventana vuelve al origen
+    const float2 Target = m_bWorldMode ? m_f2ViewCenter : float2(0, 0);
+
+    // La ventana sigue a la cmara a saltos de texels enteros para no remuestrear el campo
+    const float  TexelSize = 2.f / static_cast<float>(m_pFluidSim->GetGridSize());
+    const float2 Delta     = Target - m_f2FluidWindowCenter;
+    const int2   Offset{static_cast<int>(std::round(Delta.x / TexelSize)), static_cast<int>(std::round(Delta.y / TexelSize))};
+    m_pFluidSim->ShiftWindow(Offset);
+    m_f2FluidWindowCenter.x += static_cast<float>(Offset.x) * TexelSize;
+    m_f2FluidWindowCenter.y += static_cast<float>(Offset.y) * TexelSize;
+    if (!m_bWorldMode)
+    {
+        m_f2FluidWindowCenter = float2(0, 0);
+    }
+}
+
+void Tutorial14_ComputeShader::UpdateVelocityQueryUI()
+{
+    if (!m_pVelocityQuery || !ImGui::CollapsingHeader("Velocity Queries"))
+        return;
+
+    ImGui::Checkbox("Probe Grid", &m_bProbeFluidVelocity);
+
+    const auto Stats = m_pVelocityQuery->GetStatistics();
+    ImGui::Text("Pending queries:    %u", Stats.NumPendingQueries);
+    ImGui::Text("Batches in flight:  %u", Stats.NumInFlightBatches);
+    ImGui::Text("Last batch:         %u positions", Stats.LastBatchPositions);
+    ImGui::Text("Resolved queries:   %llu", static_cast<unsigned long long>(Stats.TotalResolvedQueries));
+
+    if (!m_bProbeFluidVelocity)
+        return;
+
+    ImGui::Text("Probe mean speed:   %.4f", m_ProbeMeanSpeed);
+    ImGui::Text("Probe max speed:    %.4f", m_ProbeMaxSpeed);
+    ImGui::Text("Probe latency:      %llu frames", static_cast<unsigned long long>(m_ProbeLatencyFrames));
+}
+
+void Tutorial14_ComputeShader::UpdateRecorderUI()
+{
+    if (!ImGui::CollapsingHeader("Trajectory Recorder"))
+        return;
+
+    if (!m_pTrajectoryRecorder->IsRecording())
+    {
+        int FrameInterval = static_cast<int>(m_TrajectorySettings.FrameInterval);
+        if (ImGui::SliderInt("Record Every N Frames", &FrameInterval, 1, 60))
+        {
+            m_TrajectorySettings.FrameInterval = static_cast<Uint32>(FrameInterval);
+        }
+        if (ImGui::Button("Start Recording"))
+        {
+            m_pTrajectoryRecorder->Start(m_TrajectorySettings, static_cast<Uint32>(m_NumParticles));
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s", m_TrajectorySettings.OutputPath.c_str());
+    }
+    else if (ImGui::Button("Stop Recording"))
+    {
+        m_pTrajectoryRecorder->Stop();
+    }
+
+    const auto Stats = m_pTrajectoryRecorder->GetStatistics();
+    if (Stats.RecordedFrames == 0)
+        return;
+
+    ImGui::Text("Frames:      %llu recorded, %llu dropped", static_cast<unsigned long long>(Stats.RecordedFrames),
+                static_cast<unsigned long long>(Stats.DroppedFrames));
+    ImGui::Text("Written:     %.1f MB", static_cast<double>(Stats.WrittenBytes) / (1024.0 * 1024.0));
+    ImGui::Text("Compression: %.1fx", static_cast<double>(Stats.RawBytes) / static_cast<double>(std::max(Stats.WrittenBytes, Uint64{1})));
+}
+
+void Tutorial14_ComputeShader::UpdateCanvasScaleUI()
+{
+    auto& ScaleSettings = m_CanvasScaleController.GetSettings();
+
+    // El canvas se remuestrea al soltar el control, no en cada paso del arrastre
+    ImGui::SliderFloat(m_bDynamicCanvasScale ? "Max Canvas Scale" : "Canvas Scale", &m_CanvasScale, 0.25f, 1.0f, "%.2f");
+    if (ImGui::IsItemDeactivatedAfterEdit())
+    {
+        ScaleSettings.MaxScale = m_CanvasScale;
+        if (m_bDynamicCanvasScale)
+        {
+            m_CanvasScaleController.Reset(std::min(m_CanvasScaleController.GetScale(), m_CanvasScale), m_FrameId + 1);
+        }
+        CreateCanvasTexture();
+    }
+
+    if (m_pGPUProfiler->IsSupported())
+    {
+        if (ImGui::Checkbox("Dynamic Canvas Scale", &m_bDynamicCanvasScale))
+        {
+            m_CanvasScaleController.Reset(m_CanvasScale, m_FrameId + 1);
+            CreateCanvasTexture();
+        }
+        if (m_bDynamicCanvasScale)
+        {
+            float BudgetMs = static_cast<float>(ScaleSettings.BudgetMs);
+            if (ImGui::SliderFloat("Paint Budget (ms)", &BudgetMs, 0.25f, 10.0f, "%.2f"))
+            {
+                ScaleSettings.BudgetMs = BudgetMs;
+            }
+        }
+    }
 
     if (m_pCanvasTexture)
     {
-        m_pCanvasRTV = m_pCanvasTexture->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
-        m_pCanvasSRV = m_pCanvasTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+        const auto& CanvasDesc = m_pCanvasTexture->GetDesc();
+        ImGui::Text("Canvas: %ux%u (%.0f%%)", CanvasDesc.Width, CanvasDesc.Height, GetCanvasScale() * 100.f);
+        if (m_bDynamicCanvasScale)
+        {
+            ImGui::SameLine();
+            ImGui::Text("| paint %.2f ms", m_CanvasScaleController.GetAverageMs());
+        }
+    }
+}
 
-        // Limpiar el canvas inicialmente
-        float4 ClearColor = {0.0f, 0.0f, 0.0f, 0.0f};
-        m_pImmediateContext->ClearRenderTarget(m_pCanvasRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+void Tutorial14_ComputeShader::UpdateDynamicCanvasScale(const Tutorial14_GPUProfiler::FrameTimings& Timings)
+{
+    // La resolucin del canvas solo afecta de forma apreciable al pase de pintura;
+    // la composicin escribe siempre a la resolucin de la ventana
+    double PaintMs   = 0;
+    bool   bHasPaint = false;
+    for (const auto& Pass : Timings.Passes)
+    {
+        if (strcmp(Pass.Name, "Paint splat") == 0)
+        {
+            PaintMs += Pass.Milliseconds;
+            bHasPaint = true;
+        }
+    }
+
+    if (bHasPaint && m_CanvasScaleController.AddSample(Timings.FrameId, PaintMs))
+    {
+        CreateCanvasTexture();
+    }
+}
+
+void Tutorial14_ComputeShader::UpdateCaptureUI()
+{
+    if (!ImGui::CollapsingHeader("Frame Capture"))
+        return;
+
+    if (!m_pFrameCapture->IsCapturing())
+    {
+        ImGui::Checkbox("Back Buffer", &m_CaptureSettings.Sources[Tutorial14_FrameCapture::SOURCE_BACK_BUFFER]);
+        ImGui::SameLine();
+        ImGui::Checkbox("Canvas", &m_CaptureSettings.Sources[Tutorial14_FrameCapture::SOURCE_CANVAS]);
+
+        const char* const Formats[] = {"PNG sequence", "Y4M video"};
+
+        int Format = m_CaptureSettings.Format == Tutorial14_FrameCapture::FORMAT::PNG ? 0 : 1;
+        if (ImGui::Combo("Format", &Format, Formats, _countof(Formats)))
+        {
+            m_CaptureSettings.Format = Format == 0 ? Tutorial14_FrameCapture::FORMAT::PNG : Tutorial14_FrameCapture::FORMAT::Y4M;
+        }
+
+        int FrameInterval = static_cast<int>(m_CaptureSettings.FrameInterval);
+        if (ImGui::SliderInt("Capture Every N Frames", &FrameInterval, 1, 60))
+        {
+            m_CaptureSettings.FrameInterval = static_cast<Uint32>(FrameInterval);
+        }
+        if (ImGui::Button("Start Capture"))
+        {
+            m_pFrameCapture->Start(m_CaptureSettings);
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("%s_*", m_CaptureSettings.OutputPrefix.c_str());
+    }
+    else if (ImGui::Button("Stop Capture"))
+    {
+        m_pFrameCapture->Stop();
+    }
+
+    const auto Stats = m_pFrameCapture->GetStatistics();
+    if (Stats.CapturedFrames == 0 && Stats.DroppedFrames == 0)
+        return;
+
+    ImGui::Text("Frames: %llu captured, %llu encoded, %llu dropped", static_cast<unsigned long long>(Stats.CapturedFrames),
+                static_cast<unsigned long long>(Stats.EncodedFrames), static_cast<unsigned long long>(Stats.DroppedFrames));
+}
+
+void Tutorial14_ComputeShader::UpdateCanvasExportUI()
+{
+    if (!ImGui::CollapsingHeader("Canvas Export"))
+        return;
+
+    if (m_pCanvasExport->IsExporting())
+    {
+        const auto Progress = m_pCanvasExport->GetProgress();
+        char       Overlay[32];
+        snprintf(Overlay, sizeof(Overlay), "%u / %u tiles", Progress.WrittenTiles, Progress.NumTiles);
+        ImGui::ProgressBar(Progress.NumTiles != 0 ? static_cast<float>(Progress.WrittenTiles) / static_cast<float>(Progress.NumTiles) : 0.f,
+                           ImVec2(-1, 0), Overlay);
+        if (ImGui::Button("Cancel Export"))
+        {
+            m_pCanvasExport->Cancel();
+        }
+        return;
+    }
+
+    int Size[] = {static_cast<int>(m_ExportSettings.Width), static_cast<int>(m_ExportSettings.Height)};
+    if (ImGui::InputInt("Width", &Size[0], 1024, 4096) && Size[0] > 0)
+    {
+        m_ExportSettings.Width = static_cast<Uint32>(Size[0]);
+    }
+    if (ImGui::InputInt("Height", &Size[1], 1024, 4096) && Size[1] > 0)
+    {
+        m_ExportSettings.Height = static_cast<Uint32>(Size[1]);
+    }
+
+    int TilesPerFrame = static_cast<int>(m_ExportSettings.TilesPerFrame);
+    if (ImGui::SliderInt("Tiles Per Frame", &TilesPerFrame, 1, 4))
+    {
+        m_ExportSettings.TilesPerFrame = static_cast<Uint32>(TilesPerFrame);
+    }
+
+    if (ImGui::Button("Export Canvas") && m_pCanvasTexture)
+    {
+        m_pCanvasExport->Start(m_ExportSettings, m_pCanvasTexture);
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("%s (%.0f MB)", m_ExportSettings.OutputPath.c_str(),
+                        static_cast<double>(m_ExportSettings.Width) * m_ExportSettings.Height * 3 / (1024.0 * 1024.0));
+}
+
+void Tutorial14_ComputeShader::UpdateCanvasAutosaveUI()
+{
+    if (!ImGui::CollapsingHeader("Canvas Autosave"))
+        return;
+
+    if (m_pCanvasAutosave->IsSaving())
+    {
+        const auto Stats = m_pCanvasAutosave->GetStatistics();
+        ImGui::Text("Tiles: %llu saved, %u pending", static_cast<unsigned long long>(Stats.SavedTiles), Stats.PendingTiles);
+        ImGui::Text("File: %.1f MB, %u compactions", static_cast<double>(Stats.FileSize) / (1024.0 * 1024.0), Stats.NumCompactions);
+        if (ImGui::Button("Stop Autosave"))
+        {
+            m_pCanvasAutosave->Stop();
+        }
+        return;
+    }
+
+    int IntervalFrames = static_cast<int>(m_AutosaveSettings.IntervalFrames);
+    if (ImGui::SliderInt("Save Every N Frames", &IntervalFrames, 1, 300))
+    {
+        m_AutosaveSettings.IntervalFrames = static_cast<Uint32>(IntervalFrames);
+    }
+    if (ImGui::Button("Start Autosave") && m_pCanvasTexture)
+    {
+        m_pCanvasAutosave->Start(m_AutosaveSettings, m_pCanvasTexture);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load Canvas"))
+    {
+        LoadCanvas(m_AutosaveSettings.OutputPath);
+    }
+    ImGui::SameLine();
+    ImGui::TextDisabled("%s", m_AutosaveSettings.OutputPath.c_str());
+}
+
+void Tutorial14_ComputeShader::UpdateSceneBatchUI()
+{
+    if (!m_pSceneBatch)
+        return;
+
+    bool bRecreate = false;
+
+    int NumScenes = static_cast<int>(m_SceneBatchSettings.NumScenes);
+    if (ImGui::InputInt("Num Scenes", &NumScenes, 1, 16, ImGuiInputTextFlags_EnterReturnsTrue))
+    {
+        m_SceneBatchSettings.NumScenes = static_cast<Uint32>(std::min(std::max(NumScenes, 1), 4096));
+        bRecreate                      = true;
+    }
+    int ParticlesPerScene = static_cast<int>(m_SceneBatchSettings.ParticlesPerScene);
+    if (ImGui::InputInt("Particles / Scene", &ParticlesPerScene, 16, 256, ImGuiInputTextFlags_EnterReturnsTrue))
+    {
+        m_SceneBatchSettings.ParticlesPerScene = static_cast<Uint32>(std::min(std::max(ParticlesPerScene, 2), 16384));
+        bRecreate                              = true;
+    }
+    if (ImGui::SliderFloat("Fluid Influence", &m_SceneBatchSettings.FluidInfluence, 0.f, 1.f))
+    {
+        bRecreate = true;
+    }
+    if (ImGui::Checkbox("Dispatch Per Scene", &m_SceneBatchSettings.DispatchPerScene))
+    {
+        bRecreate = true;
+    }
+    if (bRecreate)
+    {
+        m_pSceneBatch->SetSettings(m_SceneBatchSettings, GetAspectRatio());
+    }
+
+    ImGui::Text("%u particles, %u cells, %u dispatches/frame", m_pSceneBatch->GetNumParticles(), m_pSceneBatch->GetNumCells(),
+                m_pSceneBatch->GetNumDispatches());
+
+    const auto& RecordStats = m_pCommandRecorder->GetLastStatistics();
+    if (m_pCommandRecorder->IsParallel())
+    {
+        ImGui::Text("Recording: %u segments on %u contexts, %.3f ms (%.3f ms total)", RecordStats.NumSegments,
+                    m_pCommandRecorder->GetNumWorkers(), RecordStats.RecordMs, RecordStats.SegmentsMs);
+    }
+    else
+    {
+        ImGui::Text("Recording: %u segments on the immediate context, %.3f ms", RecordStats.NumSegments, RecordStats.RecordMs);
+    }
+}
+
+void Tutorial14_ComputeShader::UpdateStatsUI()
+{
+    if (!ImGui::CollapsingHeader("Simulation Statistics"))
+        return;
+
+    ImGui::Checkbox("Compute on GPU", &m_bComputeStats);
+    if (!m_pSimStats || !m_pSimStats->HasResults())
+    {
+        ImGui::TextDisabled("No results yet");
+        return;
+    }
+
+    const auto& Stats = m_pSimStats->GetResults();
+    ImGui::Text("Frame:              %llu (%llu frames behind)", static_cast<unsigned long long>(Stats.FrameId),
+                static_cast<unsigned long long>(m_FrameId - Stats.FrameId));
+    ImGui::Text("Kinetic energy:     %.5f", Stats.KineticEnergy);
+    ImGui::Text("Max particle speed: %.4f", Stats.MaxParticleSpeed);
+    ImGui::Text("Mean temperature:   %.4f", Stats.MeanTemperature);
+    ImGui::Text("Max fluid speed:    %.4f", Stats.MaxFluidSpeed);
+    ImGui::Text("Cell occupancy:     max %u, mean %.2f over %u cells", Stats.MaxCellOccupancy, Stats.MeanCellOccupancy, Stats.NumOccupiedCells);
+
+    float Histogram[Tutorial14_SimulationStats::COLLISION_HISTOGRAM_BINS];
+    for (Uint32 i = 0; i < Tutorial14_SimulationStats::COLLISION_HISTOGRAM_BINS; ++i)
+        Histogram[i] = static_cast<float>(Stats.CollisionHistogram[i]);
+    ImGui::PlotHistogram("Collisions", Histogram, static_cast<int>(Tutorial14_SimulationStats::COLLISION_HISTOGRAM_BINS), 0,
+                         "0, 1, 2 ... 7+ collisions", 0.f, static_cast<float>(std::max(Stats.NumParticles, 1u)), ImVec2(0, 60));
+}
+
+void Tutorial14_ComputeShader::UpdateProfilerUI()
+{
+    ImGui::SetNextWindowPos(ImVec2(10, 300), ImGuiCond_FirstUseEver);
+    if (ImGui::Begin("GPU Profiler", &m_bShowGPUProfiler, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        if (!m_pGPUProfiler->IsSupported())
+        {
+            ImGui::TextDisabled("Timestamp queries are not supported on this device");
+        }
+        else
+        {
+            const auto& FrameStats = m_pGPUProfiler->GetFrameStatistics();
+            ImGui::Text("Last %d frames, GPU total avg %.3f ms, p99 %.3f ms",
+                        static_cast<int>(FrameStats.NumSamples), FrameStats.AverageMs, FrameStats.P99Ms);
+
+            if (ImGui::BeginTable("PassTimings", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+            {
+                ImGui::TableSetupColumn("Pass");
+                ImGui::TableSetupColumn("Last, ms");
+                ImGui::TableSetupColumn("Avg, ms");
+                ImGui::TableSetupColumn("p99, ms");
+                ImGui::TableSetupColumn("Max, ms");
+                ImGui::TableHeadersRow();
+
+                auto AddRow = [](const Tutorial14_GPUProfiler::PassStatistics& Stats) {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%s", Stats.Name);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", Stats.LastMs);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", Stats.AverageMs);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", Stats.P99Ms);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", Stats.MaxMs);
+                };
+                for (const auto& Stats : m_pGPUProfiler->GetStatistics())
+                    AddRow(Stats);
+                AddRow(FrameStats);
+
+                ImGui::EndTable();
+            }
+
+            if (ImGui::Button("Reset"))
+            {
+                m_pGPUProfiler->ResetStatistics();
+            }
+        }
+
+        ImGui::Separator();
+        const auto& AllocStats = m_pFrameAllocator->GetStatistics();
+        ImGui::Text("Frame constants: %u allocations, %u of %u bytes (peak %u)%s",
+                    AllocStats.NumAllocations, AllocStats.UsedBytes, AllocStats.FrameSize, AllocStats.PeakUsedBytes,
+                    m_pFrameAllocator->IsPersistent() ? ", persistent" : "");
+        ImGui::Text("Frame constants fence stalls: %llu", static_cast<unsigned long long>(AllocStats.NumFenceStalls));
+
+        const auto& GraphStats = m_pFrameGraph->GetStatistics();
+        ImGui::Text("Frame graph: %u passes, %u barriers (%u UAV) in %u batches",
+                    GraphStats.NumPasses, GraphStats.NumBarriers, GraphStats.NumUAVBarriers, GraphStats.NumBarrierBatches);
+        ImGui::Text("Transient textures: %u on %u physical", GraphStats.NumTransientTextures, GraphStats.NumPhysicalTextures);
+        ImGui::Text("Deferred passes: %u in %u segments", GraphStats.NumDeferredPasses, GraphStats.NumDeferredSegments);
+    }
+    ImGui::End();
+}
+
+Tutorial14_ComputeShader::CommandLineStatus Tutorial14_ComputeShader::ProcessCommandLine(int argc, const char* const* argv)
+{
+    // Opciones del benchmark:
+    //   --benchmark                     Ejecuta el barrido al arrancar
+    //   --bench_output <file.json>      Fichero de resultados
+    //   --bench_particles 1000,10000    Nmero de partculas
+    //   --bench_group_sizes 64,256      Tamao del grupo de hilos de los compute shaders
+    //   --bench_grid_sizes 128,256      Resolucin de la rejilla del fluido
+    //   --bench_warmup <frames>         Frames de calentamiento por caso
+    //   --bench_frames <frames>         Frames medidos por caso
+    // Opciones de la traza de CPU:
+    //   --trace_output <file.json>      Fichero de la traza (F9 la vuelca en cualquier momento)
+    //   --trace_on_exit                 Vuelca la traza al cerrar la aplicacin
+    // Opciones de las instantneas:
+    //   --snapshot <file.t14s>          Fichero que usan los botones Save/Load Snapshot
+    //   --load_snapshot <file.t14s>     Arranca desde la instantnea indicada
+    // Opciones de la grabacin de trayectorias:
+    //   --record <file.t14r>            Graba las trayectorias desde el primer frame
+    //   --record_interval <frames>      Graba uno de cada N frames
+    // Opciones de la captura de frames:
+    //   --capture <prefix>              Captura el back buffer desde el primer frame
+    //   --capture_format png|y4m        Secuencia de PNG o vdeo Y4M
+    //   --capture_interval <frames>     Captura uno de cada N frames
+    //   --capture_canvas                Captura tambin el canvas de pintura
+    // Opciones del canvas de pintura:
+    //   --canvas_scale <0.25-1>         Resolucin del canvas respecto a la ventana
+    //   --canvas_budget_ms <ms>         Ajusta la resolucin para no superar este tiempo de GPU
+    // Opciones de la exportacin del canvas:
+    //   --export_canvas <file.ppm>      Fichero de la exportacin
+    //   --export_size <W>x<H>           Resolucin de la imagen exportada
+    //   --export_at_frame <frame>       Exporta automticamente al llegar a este frame
+    // Opciones del guardado incremental del canvas:
+    //   --autosave <file.t14c>          Guarda el canvas de forma continua desde el primer frame
+    //   --autosave_interval <frames>    Lee los tiles modificados cada N frames
+    //   --load_canvas <file.t14c>       Carga un canvas guardado al arrancar
+    // Opciones del lote de escenas:
+    //   --scene_batch <num_scenes>      Arranca en el modo de lote con N escenas
+    //   --scene_particles <n>           Partculas mximas por escena
+    //   --scene_dispatch_per_scene      Un dispatch por escena y pase (para comparar)
+    // Opciones de la grabacin de comandos:
+    //   --deferred_contexts <n>         Contextos diferidos; 0 graba en el contexto inmediato
+    // Opciones de la cola de cmputo asncrona:
+    //   --async_compute                 Resuelve el fluido en una cola de cmputo (D3D12 y Vulkan)
+    //   --compute_queue <n>             Cola del adaptador para el contexto de cmputo (por defecto 1)
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* Arg   = argv[i];
+        const char* Value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (strcmp(Arg, "--benchmark") == 0)
+        {
+            m_bRunBenchmarkOnStart = true;
+            continue;
+        }
+
+        if (strcmp(Arg, "--scene_dispatch_per_scene") == 0)
+        {
+            m_SceneBatchSettings.DispatchPerScene = true;
+            continue;
+        }
+
+        if (strcmp(Arg, "--async_compute") == 0)
+        {
+            m_bAsyncCompute = true;
+            continue;
+        }
+
+        if (strcmp(Arg, "--trace_on_exit") == 0)
+        {
+            m_bDumpTraceOnExit = true;
+            continue;
+        }
+
+        if (strcmp(Arg, "--capture_canvas") == 0)
+        {
+            m_CaptureSettings.Sources[Tutorial14_FrameCapture::SOURCE_CANVAS] = true;
+            continue;
+        }
+
+        if (strncmp(Arg, "--bench_", 8) != 0 && strcmp(Arg, "--trace_output") != 0 &&
+            strcmp(Arg, "--snapshot") != 0 && strcmp(Arg, "--load_snapshot") != 0 &&
+            strncmp(Arg, "--record", 8) != 0 && strncmp(Arg, "--capture", 9) != 0 && strncmp(Arg, "--canvas_", 9) != 0 &&
+            strncmp(Arg, "--export_", 9) != 0 && strncmp(Arg, "--autosave", 10) != 0 && strcmp(Arg, "--load_canvas") != 0 &&
+            strncmp(Arg, "--scene_", 8) != 0 && strcmp(Arg, "--deferred_contexts") != 0 && strcmp(Arg, "--compute_queue") != 0)
+            continue;
+
+        if (Value == nullptr)
+        {
+            LOG_ERROR_MESSAGE("Missing value for command line option ", Arg);
+            return CommandLineStatus::Error;
+        }
+        ++i;
+
+        bool             bValid = true;
+        std::vector<int> Values;
+        if (strcmp(Arg, "--trace_output") == 0)
+        {
+            m_TraceOutputPath = Value;
+        }
+        else if (strcmp(Arg, "--snapshot") == 0)
+        {
+            m_SnapshotPath = Value;
+        }
+        else if (strcmp(Arg, "--load_snapshot") == 0)
+        {
+            m_SnapshotPath         = Value;
+            m_bLoadSnapshotOnStart = true;
+        }
+        else if (strcmp(Arg, "--record") == 0)
+        {
+            m_TrajectorySettings.OutputPath = Value;
+            m_bRecordOnStart                = true;
+        }
+        else if (strcmp(Arg, "--record_interval") == 0)
+        {
+            const int Frames = atoi(Value);
+            bValid           = Frames > 0;
+            if (bValid)
+                m_TrajectorySettings.FrameInterval = static_cast<Uint32>(Frames);
+        }
+        else if (strcmp(Arg, "--capture") == 0)
+        {
+            m_CaptureSettings.OutputPrefix = Value;
+            m_bCaptureOnStart              = true;
+        }
+        else if (strcmp(Arg, "--capture_format") == 0)
+        {
+            if (strcmp(Value, "png") == 0)
+                m_CaptureSettings.Format = Tutorial14_FrameCapture::FORMAT::PNG;
+            else if (strcmp(Value, "y4m") == 0)
+                m_CaptureSettings.Format = Tutorial14_FrameCapture::FORMAT::Y4M;
+            else
+                bValid = false;
+        }
+        else if (strcmp(Arg, "--capture_interval") == 0)
+        {
+            const int Frames = atoi(Value);
+            bValid           = Frames > 0;
+            if (bValid)
+                m_CaptureSettings.FrameInterval = static_cast<Uint32>(Frames);
+        }
+        else if (strcmp(Arg, "--canvas_scale") == 0)
+        {
+            const float Scale = static_cast<float>(atof(Value));
+            bValid            = Scale >= 0.25f && Scale <= 1.0f;
+            if (bValid)
+                m_CanvasScale = Scale;
+        }
+        else if (strcmp(Arg, "--canvas_budget_ms") == 0)
+        {
+            const double BudgetMs = atof(Value);
+            bValid                = BudgetMs > 0;
+            if (bValid)
+            {
+                m_CanvasScaleController.GetSettings().BudgetMs = BudgetMs;
+                m_bDynamicCanvasScale                          = true;
+            }
+        }
+        else if (strcmp(Arg, "--export_canvas") == 0)
+        {
+            m_ExportSettings.OutputPath = Value;
+        }
+        else if (strcmp(Arg, "--export_size") == 0)
+        {
+            unsigned int Width = 0, Height = 0;
+            bValid             = sscanf(Value, "%ux%u", &Width, &Height) == 2 && Width > 0 && Height > 0;
+            if (bValid)
+            {
+                m_ExportSettings.Width  = Width;
+                m_ExportSettings.Height = Height;
+            }
+        }
+        else if (strcmp(Arg, "--export_at_frame") == 0)
+        {
+            const long long Frame = atoll(Value);
+            bValid                = Frame > 0;
+            if (bValid)
+                m_ExportAtFrame = static_cast<Uint64>(Frame);
+        }
+        else if (strcmp(Arg, "--autosave") == 0)
+        {
+            m_AutosaveSettings.OutputPath = Value;
+            m_bAutosaveOnStart            = true;
+        }
+        else if (strcmp(Arg, "--autosave_interval") == 0)
+        {
+            const int Frames = atoi(Value);
+            bValid           = Frames > 0;
+            if (bValid)
+                m_AutosaveSettings.IntervalFrames = static_cast<Uint32>(Frames);
+        }
+        else if (strcmp(Arg, "--load_canvas") == 0)
+        {
+            m_LoadCanvasPath = Value;
+        }
+        else if (strcmp(Arg, "--scene_batch") == 0)
+        {
+            const int NumScenes = atoi(Value);
+            bValid              = NumScenes > 0;
+            if (bValid)
+            {
+                m_SceneBatchSettings.NumScenes = static_cast<Uint32>(NumScenes);
+                m_VisualizationMode            = VisualizationMode::SCENE_BATCH;
+            }
+        }
+        else if (strcmp(Arg, "--deferred_contexts") == 0)
+        {
+            m_NumDeferredContexts = atoi(Value);
+            bValid                = m_NumDeferredContexts >= 0;
+        }
+        else if (strcmp(Arg, "--compute_queue") == 0)
+        {
+            m_ComputeQueueId = atoi(Value);
+            bValid           = m_ComputeQueueId > 0 && m_ComputeQueueId < 256;
+        }
+        else if (strcmp(Arg, "--scene_particles") == 0)
+        {
+            const int NumParticles = atoi(Value);
+            bValid                 = NumParticles > 1;
+            if (bValid)
+                m_SceneBatchSettings.ParticlesPerScene = static_cast<Uint32>(NumParticles);
+        }
+        else if (strcmp(Arg, "--bench_output") == 0)
+        {
+            m_BenchmarkSettings.OutputPath = Value;
+        }
+        else if (strcmp(Arg, "--bench_particles") == 0)
+        {
+            bValid = Tutorial14_Benchmark::ParseList(Value, m_BenchmarkSettings.ParticleCounts);
+        }
+        else if (strcmp(Arg, "--bench_group_sizes") == 0)
+        {
+            bValid = Tutorial14_Benchmark::ParseList(Value, m_BenchmarkSettings.ThreadGroupSizes);
+            for (int Size : m_BenchmarkSettings.ThreadGroupSizes)
+                bValid = bValid && Size <= 1024;
+        }
+        else if (strcmp(Arg, "--bench_grid_sizes") == 0)
+        {
+            bValid = Tutorial14_Benchmark::ParseList(Value, Values);
+            if (bValid)
+                m_BenchmarkSettings.FluidGridSizes.assign(Values.begin(), Values.end());
+        }
+        else if (strcmp(Arg, "--bench_warmup") == 0)
+        {
+            const int Frames = atoi(Value);
+            bValid           = Frames >= 0;
+            if (bValid)
+                m_BenchmarkSettings.WarmUpFrames = static_cast<Uint32>(Frames);
+        }
+        else if (strcmp(Arg, "--bench_frames") == 0)
+        {
+            const int Frames = atoi(Value);
+            bValid           = Frames > 0;
+            if (bValid)
+                m_BenchmarkSettings.MeasureFrames = static_cast<Uint32>(Frames);
+        }
+        else
+        {
+            LOG_ERROR_MESSAGE("Unknown command line option ", Arg);
+            return CommandLineStatus::Error;
+        }
+
+        if (!bValid)
+        {
+            LOG_ERROR_MESSAGE("Invalid value '", Value, "' for command line option ", Arg);
+            return CommandLineStatus::Error;
+        }
+    }
+    return CommandLineStatus::OK;
+}
+
+void Tutorial14_ComputeShader::StartBenchmark()
+{
+    m_BenchmarkSettings.TiledPaint = m_pTiledPaint != nullptr;
+
+    auto& Saved                  = m_BenchmarkRestoreState;
+    Saved.NumParticles           = m_NumParticles;
+    Saved.ThreadGroupSize        = m_ThreadGroupSize;
+    Saved.FluidGridSize          = m_pFluidSim ? m_pFluidSim->GetGridSize() : 0;
+    Saved.AdaptiveTimeStep       = m_bAdaptiveTimeStep;
+    Saved.ComputeStats           = m_bComputeStats;
+    Saved.DynamicCanvasScale     = m_bDynamicCanvasScale;
+    Saved.Mode                   = m_VisualizationMode;
+    Saved.ShowFluidVisualization = m_bShowFluidVisualization;
+    Saved.Paint                  = m_PaintMethod;
+    Saved.ParticleSleep          = m_bParticleSleep;
+    Saved.NeighborList           = m_bNeighborList;
+    Saved.SPHFluid               = m_bSPHFluid;
+    Saved.ParticleCoupling       = m_pFluidSim ? m_pFluidSim->GetParticleCoupling() : 0;
+    Saved.AsyncCompute           = m_bAsyncCompute;
+    Saved.PipelinedParticles     = m_bPipelinedParticles;
+    Saved.WorldMode              = m_bWorldMode;
+    Saved.ViewCenter             = m_f2ViewCenter;
+    Saved.ViewZoom               = m_fViewZoom;
+    m_bBenchmarkSettingsSaved    = true;
+
+    // Los casos de pintura necesitan el canvas, que no se dibuja en el modo mundo
+    SetWorldMode(false);
+
+    const auto& DeviceInfo = m_pDevice->GetDeviceInfo();
+    m_pBenchmark           = std::make_unique<Tutorial14_Benchmark>(m_BenchmarkSettings,
+                                                                    GetRenderDeviceTypeString(DeviceInfo.Type),
+                                                                    m_pDevice->GetAdapterInfo().Description);
+}
+
+void Tutorial14_ComputeShader::ApplyBenchmarkCase(const BenchmarkCase& Case)
+{
+    // Las opciones de la simulacin son las del caso, no las de la interfaz
+    ApplySimulationOptions(Case.ParticleSleep, Case.NeighborLists, Case.SPHFluid, Case.ParticleCoupling,
+                           Case.AsyncCompute, Case.PipelinedParticles, Case.ThreadGroupSize);
+
+    m_NumParticles = Case.NumParticles;
+    // Los buffers y el fluido se recrean siempre para que cada caso parta del mismo estado
+    CreateParticleBuffers();
+    // Un solo paso por frame para que los tiempos de los pases sean comparables, y sin
+    // las reducciones de las estadsticas
+    m_bAdaptiveTimeStep = false;
+    m_bComputeStats     = false;
+    if (m_pFluidSim)
+    {
+        m_pFluidSim->SetGridSize(Case.FluidGridSize);
+        m_pFluidSim->SetAdaptiveTimeStep(false);
+    }
+
+    m_VisualizationMode       = Case.Mode;
+    m_bShowFluidVisualization = Case.ShowFluidVisualization;
+    m_PaintMethod             = Case.Paint;
+    // El canvas conserva la escala fija actual durante todo el barrido
+    m_bDynamicCanvasScale = false;
+    CreateCanvasTexture();
+    m_fAccumulatedTime        = 0;
+    ClearCanvas();
+}
+
+void Tutorial14_ComputeShader::RestoreBenchmarkSettings()
+{
+    if (!m_bBenchmarkSettingsSaved)
+        return;
+    m_bBenchmarkSettingsSaved = false;
+
+    const auto& Saved = m_BenchmarkRestoreState;
+
+    ApplySimulationOptions(Saved.ParticleSleep, Saved.NeighborList, Saved.SPHFluid, Saved.ParticleCoupling,
+                           Saved.AsyncCompute, Saved.PipelinedParticles, Saved.ThreadGroupSize);
+
+    m_NumParticles = Saved.NumParticles;
+    CreateParticleBuffers();
+
+    m_bAdaptiveTimeStep = Saved.AdaptiveTimeStep;
+    m_bComputeStats     = Saved.ComputeStats;
+    if (m_pFluidSim)
+    {
+        if (m_pFluidSim->GetGridSize() != Saved.FluidGridSize)
+            m_pFluidSim->SetGridSize(Saved.FluidGridSize);
+        m_pFluidSim->SetAdaptiveTimeStep(m_bAdaptiveTimeStep);
+    }
+
+    m_VisualizationMode       = Saved.Mode;
+    m_bShowFluidVisualization = Saved.ShowFluidVisualization;
+    m_PaintMethod             = Saved.Paint;
+
+    // El escalado dinmico vuelve a partir de la escala mxima, como al activarlo en la UI
+    if (Saved.DynamicCanvasScale)
+    {
+        m_bDynamicCanvasScale = true;
+        m_CanvasScaleController.Reset(m_CanvasScale, m_FrameId + 1);
+        CreateCanvasTexture();
+    }
+
+    // SetWorldMode() centra la cmara; se devuelve a donde estaba
+    SetWorldMode(Saved.WorldMode);
+    if (m_bWorldMode)
+    {
+        m_f2ViewCenter = Saved.ViewCenter;
+        m_fViewZoom    = Saved.ViewZoom;
+        UpdateFluidWindow();
+    }
+}
+
+void Tutorial14_ComputeShader::ApplySimulationOptions(bool  bParticleSleep,
+                                                      bool  bNeighborList,
+                                                      bool  bSPHFluid,
+                                                      float ParticleCoupling,
+                                                      bool  bAsyncCompute,
+                                                      bool  bPipelinedParticles,
+                                                      int   ThreadGroupSize)
+{
+    // El fluido vuelve a la cola grfica antes de que las partculas dejen la de cmputo
+    m_bAsyncCompute       = bAsyncCompute;
+    m_bPipelinedParticles = bPipelinedParticles;
+    if (m_pFluidSim)
+    {
+        m_pFluidSim->SetAsyncCompute(m_bAsyncCompute);
+        m_pFluidSim->SetParticleCoupling(ParticleCoupling);
+    }
+    if (!IsParticlePipelineEnabled())
+    {
+        StopParticlePipeline();
+    }
+
+    // Los pases de movimiento y colisin se compilan con o sin la lista de activas y las
+    // listas de vecinas
+    const bool bRecompile = bParticleSleep != m_bParticleSleep || bNeighborList != m_bNeighborList || ThreadGroupSize != m_ThreadGroupSize;
+    if (bNeighborList != m_bNeighborList || bSPHFluid != m_bSPHFluid)
+    {
+        m_pNeighborList->Invalidate();
+    }
+    m_bParticleSleep  = bParticleSleep;
+    m_bNeighborList   = bNeighborList;
+    m_bSPHFluid       = bSPHFluid;
+    m_ThreadGroupSize = ThreadGroupSize;
+    if (bRecompile)
+    {
+        CreateUpdateParticlePSO();
+    }
+}
+
+bool Tutorial14_ComputeShader::SaveSnapshot(const std::string& Path)
+{
+    T14_TRACE_SCOPE("SaveSnapshot");
+
+    Tutorial14_Snapshot::SimulationState State;
+    State.NumParticles    = static_cast<Uint32>(m_NumParticles);
+    State.ParticleStride  = sizeof(ParticleAttribs);
+    State.AccumulatedTime = m_fAccumulatedTime;
+    if (m_pFluidSim)
+    {
+        // Las texturas del solver no deben cambiar en la cola de cmputo mientras se copian
+        m_pFluidSim->SetAsyncCompute(false);
+        StopParticlePipeline();
+
+        const auto FluidState   = m_pFluidSim->GetState();
+        State.FluidGridSize     = FluidState.GridSize;
+        State.FluidTextureIndex = FluidState.CurrentTextureIndex;
+        State.FluidTimer        = FluidState.Timer;
+        State.FluidLastForcePos = FluidState.LastForcePos;
+    }
+
+    Tutorial14_Snapshot::Writer Writer{m_pDevice, m_pImmediateContext};
+    if (!Writer.Open(Path))
+        return false;
+
+    Writer.AddChunk(Tutorial14_Snapshot::CHUNK_SIMULATION_STATE, &State, sizeof(State));
+    bool bSucceeded = Writer.AddBufferChunk(Tutorial14_Snapshot::CHUNK_PARTICLES, m_pParticleAttribsBuffer) &&
+        Writer.AddBufferChunk(Tutorial14_Snapshot::CHUNK_PARTICLE_HEADS, m_pParticleListHeadsBuffer) &&
+        Writer.AddBufferChunk(Tutorial14_Snapshot::CHUNK_PARTICLE_LISTS, m_pParticleListsBuffer);
+    if (m_pFluidSim)
+    {
+        bSucceeded = bSucceeded &&
+            Writer.AddTextureChunk(Tutorial14_Snapshot::CHUNK_FLUID_VELOCITY1, m_pFluidSim->GetVelocityTexture(0)) &&
+            Writer.AddTextureChunk(Tutorial14_Snapshot::CHUNK_FLUID_VELOCITY2, m_pFluidSim->GetVelocityTexture(1));
+        m_pFluidSim->SetAsyncCompute(m_bAsyncCompute);
+    }
+    bSucceeded = Writer.Close() && bSucceeded;
+
+    if (bSucceeded)
+        LOG_INFO_MESSAGE("Simulation snapshot saved to ", Path);
+    else
+        LOG_ERROR_MESSAGE("Failed to write simulation snapshot ", Path);
+    return bSucceeded;
+}
+
+bool Tutorial14_ComputeShader::LoadSnapshot(const std::string& Path)
+{
+    T14_TRACE_SCOPE("LoadSnapshot");
+
+    Tutorial14_Snapshot::Reader Reader;
+    if (!Reader.Open(Path))
+        return false;
+
+    const auto* pState = Reader.FindChunk<Tutorial14_Snapshot::SimulationState>(Tutorial14_Snapshot::CHUNK_SIMULATION_STATE);
+    if (pState == nullptr || pState->NumParticles == 0 || pState->ParticleStride != sizeof(ParticleAttribs))
+    {
+        LOG_ERROR_MESSAGE("Snapshot ", Path, " has no compatible simulation state");
+        return false;
+    }
+
+    Uint64       ParticlesSize = 0, ListHeadsSize = 0, ListsSize = 0;
+    const void*  pParticles    = Reader.FindChunk(Tutorial14_Snapshot::CHUNK_PARTICLES, ParticlesSize);
+    const void*  pListHeads    = Reader.FindChunk(Tutorial14_Snapshot::CHUNK_PARTICLE_HEADS, ListHeadsSize);
+    const void*  pLists        = Reader.FindChunk(Tutorial14_Snapshot::CHUNK_PARTICLE_LISTS, ListsSize);
+    const Uint64 NumParticles  = pState->NumParticles;
+    if (pParticles == nullptr || ParticlesSize != NumParticles * sizeof(ParticleAttribs) ||
+        pListHeads == nullptr || ListHeadsSize != NumParticles * sizeof(int) ||
+        pLists == nullptr || ListsSize != NumParticles * sizeof(int))
+    {
+        LOG_ERROR_MESSAGE("Snapshot ", Path, " has missing or truncated particle buffers");
+        return false;
+    }
+
+    Uint64       Velocity1Size = 0, Velocity2Size = 0;
+    const void*  pVelocity1     = Reader.FindChunk(Tutorial14_Snapshot::CHUNK_FLUID_VELOCITY1, Velocity1Size);
+    const void*  pVelocity2     = Reader.FindChunk(Tutorial14_Snapshot::CHUNK_FLUID_VELOCITY2, Velocity2Size);
+    const Uint64 FluidGridSize  = pState->FluidGridSize;
+    const bool   bHasFluidState = FluidGridSize > 0;
+    if (bHasFluidState &&
+        (pVelocity1 == nullptr || Velocity1Size != FluidGridSize * FluidGridSize * sizeof(float2) ||
+         pVelocity2 == nullptr || Velocity2Size != FluidGridSize * FluidGridSize * sizeof(float2)))
+    {
+        LOG_ERROR_MESSAGE("Snapshot ", Path, " has missing or truncated fluid velocity fields");
+        return false;
+    }
+
+    m_NumParticles = static_cast<int>(pState->NumParticles);
+    CreateParticleBuffers(pParticles, pListHeads, pLists);
+
+    if (m_pFluidSim && bHasFluidState)
+    {
+        Tutorial14_FluidSimulation::State FluidState;
+        FluidState.GridSize            = pState->FluidGridSize;
+        FluidState.CurrentTextureIndex = pState->FluidTextureIndex;
+        FluidState.Timer               = pState->FluidTimer;
+        FluidState.LastForcePos        = pState->FluidLastForcePos;
+        m_pFluidSim->RestoreState(FluidState, pVelocity1, pVelocity2);
+    }
+    m_fAccumulatedTime = pState->AccumulatedTime;
+
+    LOG_INFO_MESSAGE("Simulation snapshot loaded from ", Path, " (", m_NumParticles, " particles)");
+    return true;
+}
+
+void Tutorial14_ComputeShader::WindowResize(Uint32 Width, Uint32 Height)
+{
+    SampleBase::WindowResize(Width, Height);
+
+    // El canvas sigue el tamao de la ventana y conserva lo pintado
+    if (m_pCanvasTexture)
+    {
+        CreateCanvasTexture();
+    }
+
+    // La cuadrcula de escenas depende de la relacin de aspecto
+    if (m_pSceneBatch)
+    {
+        m_pSceneBatch->SetSettings(m_SceneBatchSettings, GetAspectRatio());
+    }
+}
+
+float Tutorial14_ComputeShader::GetAspectRatio() const
+{
+    const auto& SCDesc = m_pSwapChain->GetDesc();
+    return static_cast<float>(SCDesc.Width) / static_cast<float>(std::max(SCDesc.Height, 1u));
+}
+
+void Tutorial14_ComputeShader::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs)
+{
+    SampleBase::ModifyEngineInitInfo(Attribs);
+
+    Attribs.EngineCI.Features.ComputeShaders   = DEVICE_FEATURE_STATE_ENABLED;
+    Attribs.EngineCI.Features.TimestampQueries = DEVICE_FEATURE_STATE_OPTIONAL;
+
+    // Lectura del canvas RGBA8 como UAV en la pintura por tiles
+    Attribs.EngineCI.Features.TextureUAVExtendedFormats = DEVICE_FEATURE_STATE_OPTIONAL;
+
+    // Contextos diferidos para grabar comandos en paralelo (no disponibles en OpenGL). El
+    // lote de escenas reparte sus rangos entre todos; el frame normal graba como mucho
+    // MAX_DEFERRED_SEGMENTS segmentos a la vez, as que sin --scene_batch no se crean ms
+    if (Attribs.DeviceType != RENDER_DEVICE_TYPE_GL && Attribs.DeviceType != RENDER_DEVICE_TYPE_GLES)
+    {
+        Uint32 NumContexts = Tutorial14_CommandRecorder::GetDefaultNumContexts();
+        if (m_VisualizationMode != VisualizationMode::SCENE_BATCH)
+            NumContexts = std::min(NumContexts, Tutorial14_FrameGraph::MAX_DEFERRED_SEGMENTS);
+        Attribs.EngineCI.NumDeferredContexts = m_NumDeferredContexts >= 0 ? static_cast<Uint32>(m_NumDeferredContexts) : NumContexts;
+    }
+
+    // Segundo contexto inmediato en una cola de cmputo para el fluido. Diligent expone
+    // varias colas por adaptador solo en D3D12 y Vulkan.
+    if (m_bAsyncCompute && (Attribs.DeviceType == RENDER_DEVICE_TYPE_D3D12 || Attribs.DeviceType == RENDER_DEVICE_TYPE_VULKAN))
+    {
+        m_ImmediateContextCI[0].Name     = "Graphics";
+        m_ImmediateContextCI[0].QueueId  = 0;
+        m_ImmediateContextCI[0].Priority = QUEUE_PRIORITY_MEDIUM;
+        m_ImmediateContextCI[1].Name     = "Async compute";
+        m_ImmediateContextCI[1].QueueId  = static_cast<Uint8>(m_ComputeQueueId);
+        m_ImmediateContextCI[1].Priority = QUEUE_PRIORITY_MEDIUM;
+
+        Attribs.EngineCI.NumImmediateContexts  = _countof(m_ImmediateContextCI);
+        Attribs.EngineCI.pImmediateContextInfo = m_ImmediateContextCI;
+    }
+}
+
+void Tutorial14_ComputeShader::CreatePaintSystem()
+{
+    try
+    {
+        CreateCanvasTexture();
+        CreateColorPalette();
+        CreatePaintPipelines();
+
+        if (Tutorial14_TiledPaint::IsSupported(m_pDevice) && m_pCanvasTexture)
+        {
+            m_pTiledPaint = std::make_unique<Tutorial14_TiledPaint>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pFrameAllocator.get(), m_pColorPaletteSRV);
+            m_pTiledPaint->SetCanvas(m_pCanvasTexture);
+            m_pTiledPaint->SetParticleBuffer(m_pParticleAttribsBuffer, static_cast<Uint32>(m_NumParticles));
+            if (!m_pTiledPaint->IsReady())
+            {
+                m_pTiledPaint.reset();
+            }
+        }
+        LOG_INFO_MESSAGE("Paint system created successfully");
+    }
+    catch (const std::exception& e)
+    {
+        LOG_ERROR_MESSAGE("Failed to create paint system: %s", e.what());
+    }
+}
+
+float Tutorial14_ComputeShader::GetCanvasScale() const
+{
+    return m_bDynamicCanvasScale ? m_CanvasScaleController.GetScale() : m_CanvasScale;
+}
+
+void Tutorial14_ComputeShader::CreateCanvasTexture()
+{
+    // La resolucin del canvas es la de la ventana multiplicada por la escala; el
+    // canvas se muestrea con filtrado lineal al componerlo, as que puede ser menor
+    const auto&  SCDesc = m_pSwapChain->GetDesc();
+    const float  Scale  = GetCanvasScale();
+    const Uint32 Width  = std::max(static_cast<Uint32>(static_cast<float>(SCDesc.Width) * Scale + 0.5f), 1u);
+    const Uint32 Height = std::max(static_cast<Uint32>(static_cast<float>(SCDesc.Height) * Scale + 0.5f), 1u);
+
+    if (m_pCanvasTexture && m_pCanvasTexture->GetDesc().Width == Width && m_pCanvasTexture->GetDesc().Height == Height)
+        return;
+
+    T14_TRACE_SCOPE("CreateCanvasTexture");
+
+    // El canvas anterior se conserva hasta remuestrear su contenido en el nuevo
+    RefCntAutoPtr<ITextureView> pOldCanvasSRV = m_pCanvasSRV;
+    m_pCanvasTexture.Release();
+    m_pCanvasRTV.Release();
+    m_pCanvasSRV.Release();
+
+    // Crear textura persistente para el canvas
+    TextureDesc CanvasTexDesc;
+    CanvasTexDesc.Name              = "Paint Canvas";
+    CanvasTexDesc.Type              = RESOURCE_DIM_TEX_2D;
+    CanvasTexDesc.Width             = Width;
+    CanvasTexDesc.Height            = Height;
+    CanvasTexDesc.Format            = TEX_FORMAT_RGBA8_UNORM;
+    CanvasTexDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_RENDER_TARGET;
+    // La pintura por tiles lee y escribe el canvas desde compute shaders
+    if (Tutorial14_TiledPaint::IsSupported(m_pDevice))
+        CanvasTexDesc.BindFlags |= BIND_UNORDERED_ACCESS;
+    CanvasTexDesc.ClearValue.Format = TEX_FORMAT_RGBA8_UNORM;
+    // Canvas inicialmente transparente
+    CanvasTexDesc.ClearValue.Color[0] = 0.0f;
+    CanvasTexDesc.ClearValue.Color[1] = 0.0f;
+    CanvasTexDesc.ClearValue.Color[2] = 0.0f;
+    CanvasTexDesc.ClearValue.Color[3] = 0.0f;
+
+    m_pDevice->CreateTexture(CanvasTexDesc, nullptr, &m_pCanvasTexture);
+
+    if (m_pCanvasTexture)
+    {
+        m_pCanvasRTV = m_pCanvasTexture->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+        m_pCanvasSRV = m_pCanvasTexture->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+
+        // Limpiar el canvas inicialmente
+        float4 ClearColor = {0.0f, 0.0f, 0.0f, 0.0f};
+        m_pImmediateContext->ClearRenderTarget(m_pCanvasRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        if (pOldCanvasSRV)
+        {
+            ResampleCanvas(pOldCanvasSRV);
+        }
     }
     else
     {
         LOG_ERROR_MESSAGE("Failed to create canvas texture");
     }
+
+    RecreateRenderCanvasSRB();
+    if (m_pTiledPaint)
+    {
+        m_pTiledPaint->SetCanvas(m_pCanvasTexture);
+    }
+    if (m_pCanvasAutosave)
+    {
+        m_pCanvasAutosave->SetCanvas(m_pCanvasTexture);
+    }
+    m_CanvasScaleController.Reset(Scale, m_FrameId + 1);
+}
+
+void Tutorial14_ComputeShader::ResampleCanvas(ITextureView* pSrcCanvasSRV)
+{
+    if (!m_pResampleCanvasPSO || !m_pCanvasRTV)
+        return;
+
+    RefCntAutoPtr<IShaderResourceBinding> pResampleSRB;
+    m_pResampleCanvasPSO->CreateShaderResourceBinding(&pResampleSRB, true);
+    pResampleSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_SourceCanvas")->Set(pSrcCanvasSRV);
+
+    ITextureView* pCanvasRTVs[] = {m_pCanvasRTV};
+    m_pImmediateContext->SetRenderTargets(1, pCanvasRTVs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    const auto& CanvasDesc = m_pCanvasTexture->GetDesc();
+
+    Viewport VP;
+    VP.Width    = static_cast<float>(CanvasDesc.Width);
+    VP.Height   = static_cast<float>(CanvasDesc.Height);
+    VP.MinDepth = 0.0f;
+    VP.MaxDepth = 1.0f;
+    m_pImmediateContext->SetViewports(1, &VP, 0, 0);
+
+    m_pImmediateContext->SetPipelineState(m_pResampleCanvasPSO);
+    m_pImmediateContext->CommitShaderResources(pResampleSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    DrawAttribs drawAttrs;
+    drawAttrs.NumVertices = 4;
+    m_pImmediateContext->Draw(drawAttrs);
+
+    // Se puede llamar en mitad del frame (escala dinmica): restaurar el back buffer
+    // para lo que se dibuje despus, como la interfaz
+    ITextureView* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
+    m_pImmediateContext->SetRenderTargets(1, &pRTV, m_pSwapChain->GetDepthBufferDSV(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->SetViewports(1, nullptr, 0, 0);
 }
 
 void Tutorial14_ComputeShader::CreateColorPalette()
@@ -625,15 +2100,6 @@ void Tutorial14_ComputeShader::CreatePaintPipelines()
 
     m_pDevice->CreateGraphicsPipelineState(CanvasPSOCreateInfo, &m_pRenderCanvasPSO);
 
-    // === Crear buffer de constantes para paint ===
-    BufferDesc PaintBuffDesc;
-    PaintBuffDesc.Name           = "Paint constants buffer";
-    PaintBuffDesc.Usage          = USAGE_DYNAMIC;
-    PaintBuffDesc.BindFlags      = BIND_UNIFORM_BUFFER;
-    PaintBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-    PaintBuffDesc.Size           = sizeof(float4); // Time, Chaos, ScreenSize.x, ScreenSize.y
-    m_pDevice->CreateBuffer(PaintBuffDesc, nullptr, &m_pPaintConstants);
-
     // === Crear SRBs ===
     if (m_pPaintParticlePSO)
     {
@@ -677,48 +2143,93 @@ void Tutorial14_ComputeShader::CreatePaintPipelines()
                 pSamplerVar->Set(pPaletteSampler);
             }
 
-            // Vincular buffer de constantes
-            auto* pConstantsVar = m_pPaintParticleSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbPaintConstants");
-            if (pConstantsVar)
-            {
-                pConstantsVar->Set(m_pPaintConstants);
-            }
+            // Vincular la ventana de constantes del asignador de frame
+            m_pFrameAllocator->BindConstants(m_pPaintParticleSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbPaintConstants"), sizeof(PaintConstants));
         }
     }
 
-    if (m_pRenderCanvasPSO)
+    RecreateRenderCanvasSRB();
+
+    // === Pipeline para remuestrear el canvas al cambiar de tamao ===
+    RefCntAutoPtr<IShader> pResampleCanvasPS;
     {
-        m_pRenderCanvasPSO->CreateShaderResourceBinding(&m_pRenderCanvasSRB, true);
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Resample Canvas PS";
+        ShaderCI.FilePath        = "ResampleCanvas.psh";
+        m_pDevice->CreateShader(ShaderCI, &pResampleCanvasPS);
+    }
+
+    GraphicsPipelineStateCreateInfo ResamplePSOCreateInfo;
+    ResamplePSOCreateInfo.PSODesc.Name         = "Resample Canvas PSO";
+    ResamplePSOCreateInfo.PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
+    ResamplePSOCreateInfo.pVS                  = pFullScreenVS;
+    ResamplePSOCreateInfo.pPS                  = pResampleCanvasPS;
+
+    auto& ResampleGraphicsPipeline                        = ResamplePSOCreateInfo.GraphicsPipeline;
+    ResampleGraphicsPipeline.NumRenderTargets             = 1;
+    ResampleGraphicsPipeline.RTVFormats[0]                = TEX_FORMAT_RGBA8_UNORM;
+    ResampleGraphicsPipeline.DSVFormat                    = TEX_FORMAT_UNKNOWN;
+    ResampleGraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    ResampleGraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_NONE;
+    ResampleGraphicsPipeline.DepthStencilDesc.DepthEnable = False;
+
+    // Copia directa, incluido el alfa acumulado
+    ResampleGraphicsPipeline.BlendDesc.RenderTargets[0].BlendEnable = False;
+
+    SamplerDesc ResampleSamDesc;
+    ResampleSamDesc.MinFilter = FILTER_TYPE_LINEAR;
+    ResampleSamDesc.MagFilter = FILTER_TYPE_LINEAR;
+    ResampleSamDesc.MipFilter = FILTER_TYPE_LINEAR;
+    ResampleSamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
+    ResampleSamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
+
+    ImmutableSamplerDesc ResampleSamplers[] = {{SHADER_TYPE_PIXEL, "g_SourceCanvas", ResampleSamDesc}};
+
+    ResamplePSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType  = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    ResamplePSOCreateInfo.PSODesc.ResourceLayout.ImmutableSamplers    = ResampleSamplers;
+    ResamplePSOCreateInfo.PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ResampleSamplers);
+
+    m_pDevice->CreateGraphicsPipelineState(ResamplePSOCreateInfo, &m_pResampleCanvasPSO);
+
+    LOG_INFO_MESSAGE("Paint pipelines created successfully");
+}
+
+void Tutorial14_ComputeShader::RecreateRenderCanvasSRB()
+{
+    if (!m_pRenderCanvasPSO)
+        return;
+
+    // El canvas se recrea al cambiar de tamao, as que el SRB se recrea con l
+    m_pRenderCanvasSRB.Release();
+    m_pRenderCanvasPSO->CreateShaderResourceBinding(&m_pRenderCanvasSRB, true);
 
-        // Vincular textura del canvas
-        if (m_pRenderCanvasSRB && m_pCanvasSRV)
+    // Vincular textura del canvas
+    if (m_pRenderCanvasSRB && m_pCanvasSRV)
+    {
+        auto* pCanvasVar = m_pRenderCanvasSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_CanvasTexture");
+        if (pCanvasVar)
         {
-            auto* pCanvasVar = m_pRenderCanvasSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_CanvasTexture");
-            if (pCanvasVar)
-            {
-                pCanvasVar->Set(m_pCanvasSRV);
-            }
+            pCanvasVar->Set(m_pCanvasSRV);
+        }
 
-            // Crear y vincular sampler
-            SamplerDesc SamDesc;
-            SamDesc.MinFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MagFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MipFilter = FILTER_TYPE_LINEAR;
-            SamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
+        // Crear y vincular sampler
+        SamplerDesc SamDesc;
+        SamDesc.MinFilter = FILTER_TYPE_LINEAR;
+        SamDesc.MagFilter = FILTER_TYPE_LINEAR;
+        SamDesc.MipFilter = FILTER_TYPE_LINEAR;
+        SamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
+        SamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
 
-            RefCntAutoPtr<ISampler> pSampler;
-            m_pDevice->CreateSampler(SamDesc, &pSampler);
+        RefCntAutoPtr<ISampler> pSampler;
+        m_pDevice->CreateSampler(SamDesc, &pSampler);
 
-            auto* pSamplerVar = m_pRenderCanvasSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
-            if (pSamplerVar)
-            {
-                pSamplerVar->Set(pSampler);
-            }
+        auto* pSamplerVar = m_pRenderCanvasSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
+        if (pSamplerVar)
+        {
+            pSamplerVar->Set(pSampler);
         }
     }
-
-    LOG_INFO_MESSAGE("Paint pipelines created successfully");
 }
 
 void Tutorial14_ComputeShader::RenderPaintCanvas()
@@ -729,11 +2240,11 @@ void Tutorial14_ComputeShader::RenderPaintCanvas()
     auto* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
 
     // Configurar render target
-    m_pImmediateContext->SetRenderTargets(1, &pRTV, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->SetRenderTargets(1, &pRTV, nullptr, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
 
     // Configurar pipeline
     m_pImmediateContext->SetPipelineState(m_pRenderCanvasPSO);
-    m_pImmediateContext->CommitShaderResources(m_pRenderCanvasSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->CommitShaderResources(m_pRenderCanvasSRB, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
 
     // Configurar viewport
     Viewport VP;
@@ -753,35 +2264,36 @@ void Tutorial14_ComputeShader::RenderPaintCanvas()
 
 void Tutorial14_ComputeShader::PaintParticlesToCanvas()
 {
+    if (m_PaintMethod == PaintMethod::TILED_COMPUTE && m_pTiledPaint)
+    {
+        m_pTiledPaint->Paint(static_cast<Uint32>(m_NumParticles));
+        return;
+    }
+
     if (!m_pPaintParticlePSO || !m_pPaintParticleSRB || !m_pCanvasRTV)
         return;
 
-    // Actualizar buffer de constantes de paint
-    if (m_pPaintConstants)
+    // Constantes de paint en el asignador de frame
     {
-        struct PaintConstants
-        {
-            float  Time;
-            float  Chaos;
-            float2 ScreenSize;
-        };
-
-        MapHelper<PaintConstants> Constants(m_pImmediateContext, m_pPaintConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-        Constants->Time       = m_fAccumulatedTime; // Pasar tiempo acumulado
-        Constants->Chaos      = 1.0f;
-        Constants->ScreenSize = float2(
-            static_cast<float>(m_pSwapChain->GetDesc().Width),
-            static_cast<float>(m_pSwapChain->GetDesc().Height));
+        PaintConstants Constants;
+        Constants.Time       = m_fAccumulatedTime; // Pasar tiempo acumulado
+        Constants.Chaos      = 1.0f;
+        Constants.ScreenSize = float2(
+            static_cast<float>(m_pCanvasTexture->GetDesc().Width),
+            static_cast<float>(m_pCanvasTexture->GetDesc().Height));
+
+        const Uint32 Offset = m_pFrameAllocator->Allocate(Constants);
+        m_pPaintParticleSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbPaintConstants")->SetBufferOffset(Offset);
     }
 
     // Configurar render target al canvas
     ITextureView* pCanvasRTVs[] = {m_pCanvasRTV};
-    m_pImmediateContext->SetRenderTargets(1, pCanvasRTVs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->SetRenderTargets(1, pCanvasRTVs, nullptr, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
 
-    // Configurar viewport para el canvas
+    // Configurar viewport para el canvas (su resolucin puede ser distinta de la ventana)
     Viewport VP;
-    VP.Width    = static_cast<float>(m_pSwapChain->GetDesc().Width);
-    VP.Height   = static_cast<float>(m_pSwapChain->GetDesc().Height);
+    VP.Width    = static_cast<float>(m_pCanvasTexture->GetDesc().Width);
+    VP.Height   = static_cast<float>(m_pCanvasTexture->GetDesc().Height);
     VP.MinDepth = 0.0f;
     VP.MaxDepth = 1.0f;
     VP.TopLeftX = 0.0f;
@@ -790,7 +2302,7 @@ void Tutorial14_ComputeShader::PaintParticlesToCanvas()
 
     // Configurar pipeline de pintura
     m_pImmediateContext->SetPipelineState(m_pPaintParticlePSO);
-    m_pImmediateContext->CommitShaderResources(m_pPaintParticleSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->CommitShaderResources(m_pPaintParticleSRB, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
 
     // Dibujar las partculas como instancias
     DrawAttribs drawAttrs;
@@ -808,10 +2320,31 @@ void Tutorial14_ComputeShader::ClearCanvas()
         m_pImmediateContext->ClearRenderTarget(m_pCanvasRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
         LOG_INFO_MESSAGE("Canvas cleared");
     }
+    if (m_pCanvasAutosave)
+    {
+        m_pCanvasAutosave->MarkAllDirty();
+    }
+}
+
+bool Tutorial14_ComputeShader::LoadCanvas(const std::string& Path)
+{
+    if (!m_pCanvasTexture)
+        return false;
+
+    // El fichero guarda la resolucin con la que se pint; se remuestrea a la actual
+    auto pLoadedCanvas = Tutorial14_CanvasAutosave::Load(Path, m_pDevice);
+    if (!pLoadedCanvas)
+        return false;
+
+    ResampleCanvas(pLoadedCanvas->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+    m_pCanvasAutosave->MarkAllDirty();
+    return true;
 }
 
 void Tutorial14_ComputeShader::RecreatePaintSRB()
 {
+    T14_TRACE_SCOPE("RecreatePaintSRB");
+
     if (!m_pPaintParticlePSO)
         return;
 
@@ -857,12 +2390,16 @@ void Tutorial14_ComputeShader::RecreatePaintSRB()
             pSamplerVar->Set(pPaletteSampler);
         }
 
-        // Vincular buffer de constantes
-        auto* pConstantsVar = m_pPaintParticleSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbPaintConstants");
-        if (pConstantsVar)
-        {
-            pConstantsVar->Set(m_pPaintConstants);
-        }
+        // Vincular la ventana de constantes del asignador de frame
+        m_pFrameAllocator->BindConstants(m_pPaintParticleSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbPaintConstants"), sizeof(PaintConstants));
+    }
+}
+
+Tutorial14_ComputeShader::~Tutorial14_ComputeShader()
+{
+    if (m_bDumpTraceOnExit)
+    {
+        Tutorial14_CPUTrace::WriteChromeTrace(m_TraceOutputPath);
     }
 }
 
@@ -870,17 +2407,48 @@ void Tutorial14_ComputeShader::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
 
+    Tutorial14_CPUTrace::SetThreadName("Main thread");
+
+    m_pGPUProfiler = std::make_unique<Tutorial14_GPUProfiler>(m_pDevice, m_pImmediateContext);
+
+    m_pFrameGraph = std::make_unique<Tutorial14_FrameGraph>(m_pDevice, m_pImmediateContext);
+    m_pFrameGraph->SetProfiler(m_pGPUProfiler.get());
+
     // Inicializar sistema de partculas
-    CreateConsantBuffer();
+    m_pFrameAllocator = std::make_unique<Tutorial14_FrameAllocator>(m_pDevice, m_pImmediateContext, !m_pDeferredContexts.empty());
+    m_pParticleSleep  = std::make_unique<Tutorial14_ParticleSleep>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pFrameAllocator.get(), m_ThreadGroupSize);
+    m_pNeighborList   = std::make_unique<Tutorial14_NeighborList>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pFrameAllocator.get(), m_ThreadGroupSize);
+    m_pSPHFluid       = std::make_unique<Tutorial14_SPHFluid>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pFrameAllocator.get(), m_ThreadGroupSize);
     CreateRenderParticlePSO();
     CreateUpdateParticlePSO();
+    m_pSimStats         = std::make_unique<Tutorial14_SimulationStats>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pFrameAllocator.get());
+    m_pAdaptiveTimeStep = std::make_unique<Tutorial14_AdaptiveTimeStep>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pFrameAllocator.get());
     CreateParticleBuffers();
 
+    // Contexto de la cola de cmputo pedido en ModifyEngineInitInfo()
+    if (InitInfo.NumImmediateCtx > 1)
+    {
+        IDeviceContext* pComputeContext = InitInfo.ppContexts[1];
+        if ((pComputeContext->GetDesc().QueueType & COMMAND_QUEUE_TYPE_COMPUTE) == COMMAND_QUEUE_TYPE_COMPUTE)
+            m_pComputeContext = pComputeContext;
+        else
+            LOG_WARNING_MESSAGE("Queue ", m_ComputeQueueId, " does not support compute; fluid simulation stays on the graphics queue");
+    }
+    else if (m_bAsyncCompute)
+    {
+        LOG_WARNING_MESSAGE("Async compute is not available on this device; fluid simulation stays on the graphics queue");
+    }
+
     // Crear sistema de fluidos independiente - pasar el SwapChain al constructor
     try
     {
         m_pFluidSim = std::make_unique<Tutorial14_FluidSimulation>(
-            m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pSwapChain);
+            m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pSwapChain, Tutorial14_FluidSimulation::DEFAULT_GRID_SIZE, m_pComputeContext);
+        m_pFluidSim->SetFrameAllocator(m_pFrameAllocator.get());
+        m_pFluidSim->SetTimeStepBuffer(m_pAdaptiveTimeStep->GetTimeStepBuffer());
+        m_pFluidSim->SetAdaptiveTimeStep(m_bAdaptiveTimeStep);
+        m_pFluidSim->SetAsyncCompute(m_bAsyncCompute);
+        m_pFluidSim->SetParticleBuffers(m_pParticleAttribsBuffer, m_pParticleListHeadsBuffer, m_pParticleListsBuffer, static_cast<Uint32>(m_NumParticles));
         LOG_INFO_MESSAGE("Tutorial14_FluidSimulation created successfully");
     }
     catch (const std::exception& e)
@@ -888,12 +2456,104 @@ void Tutorial14_ComputeShader::Initialize(const SampleInitInfo& InitInfo)
         LOG_ERROR_MESSAGE("Failed to create fluid simulation: %s", e.what());
         // Continuar sin fluidos si hay error
     }
+    if (m_pFluidSim)
+    {
+        m_pVelocityQuery = std::make_unique<Tutorial14_VelocityQuery>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pFrameAllocator.get());
+        if (!m_pVelocityQuery->IsValid())
+        {
+            LOG_WARNING_MESSAGE("Failed to create the velocity query pipeline; batched velocity queries are disabled");
+            m_pVelocityQuery.reset();
+        }
+    }
+    if (m_pFluidSim && m_pFluidSim->IsAsyncComputeSupported())
+    {
+        m_pParticlePipeline = std::make_unique<Tutorial14_ParticlePipeline>(m_pDevice, m_pImmediateContext, m_pComputeContext, m_pEngineFactory, m_ThreadGroupSize);
+        if (m_pParticlePipeline->IsValid())
+        {
+            m_pParticlePipeline->SetNumParticles(static_cast<Uint32>(m_NumParticles));
+            CreateParticleSRBs();
+        }
+        else
+        {
+            LOG_WARNING_MESSAGE("Failed to create the pipelined particle passes; particles stay on the graphics queue");
+            m_pParticlePipeline.reset();
+        }
+    }
+    m_CanvasScaleController.GetSettings().MaxScale = m_CanvasScale;
+    m_CanvasScaleController.Reset(m_CanvasScale, 0);
     CreatePaintSystem();
+
+    if (m_bLoadSnapshotOnStart)
+    {
+        LoadSnapshot(m_SnapshotPath);
+    }
+
+    Tutorial14_TrajectoryRecorder::ParticleLayout Layout;
+    Layout.Stride            = sizeof(ParticleAttribs);
+    Layout.PositionOffset    = offsetof(ParticleAttribs, f2Pos);
+    Layout.SpeedOffset       = offsetof(ParticleAttribs, f2Speed);
+    Layout.TemperatureOffset = offsetof(ParticleAttribs, fTemperature);
+    m_pTrajectoryRecorder    = std::make_unique<Tutorial14_TrajectoryRecorder>(m_pDevice, m_pImmediateContext, Layout);
+    if (m_bRecordOnStart)
+    {
+        m_pTrajectoryRecorder->Start(m_TrajectorySettings, static_cast<Uint32>(m_NumParticles));
+    }
+
+    m_pFrameCapture = std::make_unique<Tutorial14_FrameCapture>(m_pDevice, m_pImmediateContext);
+    if (m_bCaptureOnStart)
+    {
+        m_pFrameCapture->Start(m_CaptureSettings);
+    }
+
+    // Los tiles usan la misma codificacin que el back buffer para que la imagen
+    // exportada coincida con la que se ve en pantalla
+    const auto ColorFormat = m_pSwapChain->GetDesc().ColorBufferFormat;
+    const bool bSRGB       = ColorFormat == TEX_FORMAT_RGBA8_UNORM_SRGB || ColorFormat == TEX_FORMAT_BGRA8_UNORM_SRGB;
+    m_pCanvasExport        = std::make_unique<Tutorial14_CanvasExport>(m_pDevice, m_pImmediateContext, m_pEngineFactory,
+                                                                       bSRGB ? TEX_FORMAT_RGBA8_UNORM_SRGB : TEX_FORMAT_RGBA8_UNORM);
+
+    m_pCanvasAutosave = std::make_unique<Tutorial14_CanvasAutosave>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_pFrameAllocator.get());
+    if (!m_LoadCanvasPath.empty())
+    {
+        LoadCanvas(m_LoadCanvasPath);
+    }
+    if (m_bAutosaveOnStart && m_pCanvasTexture)
+    {
+        m_pCanvasAutosave->Start(m_AutosaveSettings, m_pCanvasTexture);
+    }
+
+    m_pCommandRecorder = std::make_unique<Tutorial14_CommandRecorder>(m_pImmediateContext, m_pDeferredContexts);
+    // Los pases diferidos del grafo leen las constantes del asignador de frame, que solo se
+    // pueden usar desde los contextos diferidos si el bfer no es dinmico
+    if (m_pFrameAllocator->SupportsDeferredContexts())
+    {
+        m_pFrameGraph->SetCommandRecorder(m_pCommandRecorder.get());
+    }
+
+    m_pSceneBatch = std::make_unique<Tutorial14_SceneBatch>(m_pDevice, m_pImmediateContext, m_pEngineFactory, m_ThreadGroupSize,
+                                                            m_pSwapChain->GetDesc().ColorBufferFormat,
+                                                            m_pSwapChain->GetDesc().DepthBufferFormat,
+                                                            m_ConvertPSOutputToGamma);
+    m_pSceneBatch->SetSettings(m_SceneBatchSettings, GetAspectRatio());
+
+    if (m_bRunBenchmarkOnStart)
+    {
+        StartBenchmark();
+    }
 }
 
 // Render a frame
 void Tutorial14_ComputeShader::Render()
 {
+    T14_TRACE_SCOPE("Render");
+
+    const auto RenderStartTime = std::chrono::high_resolution_clock::now();
+    m_pGPUProfiler->BeginFrame(m_FrameId);
+    m_pFrameCapture->BeginFrame(m_FrameId);
+    m_pSimStats->PollResults();
+    if (m_pVelocityQuery)
+        m_pVelocityQuery->Poll();
+
     auto* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
     auto* pDSV = m_pSwapChain->GetDepthBufferDSV();
 
@@ -909,99 +2569,437 @@ void Tutorial14_ComputeShader::Render()
     m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    // Actualizar la simulacin de fluidos si existe (sin renderizar la visualizacin)
-    if (m_pFluidSim)
+    if (m_VisualizationMode == VisualizationMode::SCENE_BATCH)
+    {
+        RenderSceneBatch(pRTV, pDSV);
+    }
+    else
     {
-        // Actualizar simulacin interna de fluidos
-        m_pFluidSim->Render();
+        // Los pases diferidos solo se miden uno a uno cuando se leen sus tiempos
+        m_pFrameGraph->SetPerPassTiming(m_bShowGPUProfiler || (m_pBenchmark && !m_pBenchmark->IsFinished()));
+        RenderParticleSystem(pRTV);
     }
 
-    // Renderizar partculas (sistema original)
+    // La interfaz se dibuja despus de Render(), as que no aparece en la captura
     {
-        struct Constants
-        {
-            uint  uiNumParticles;
-            float fDeltaTime;
-            float fDummy0;
-            float fDummy1;
+        Tutorial14_GPUProfiler::ScopedPass Pass{m_pGPUProfiler.get(), "Frame capture copy"};
+        m_pFrameCapture->Capture(Tutorial14_FrameCapture::SOURCE_BACK_BUFFER, pRTV->GetTexture());
+        m_pFrameCapture->Capture(Tutorial14_FrameCapture::SOURCE_CANVAS, m_pCanvasTexture);
+    }
+
+    if (m_pCanvasAutosave->IsSaving())
+    {
+        Tutorial14_GPUProfiler::ScopedPass Pass{m_pGPUProfiler.get(), "Canvas autosave copy"};
+        m_pCanvasAutosave->Update(m_FrameId);
+    }
 
-            float2 f2Scale;
-            int2   i2ParticleGridSize;
-        };
-        // Map the buffer and write current world-view-projection matrix
-        MapHelper<Constants> ConstData(m_pImmediateContext, m_Constants, MAP_WRITE, MAP_FLAG_DISCARD);
-        ConstData->uiNumParticles = static_cast<Uint32>(m_NumParticles);
-        ConstData->fDeltaTime     = std::min(m_fTimeDelta, 1.f / 60.f) * m_fSimulationSpeed;
+    if (m_ExportAtFrame != 0 && m_FrameId == m_ExportAtFrame && m_pCanvasTexture)
+    {
+        m_pCanvasExport->Start(m_ExportSettings, m_pCanvasTexture);
+    }
+    if (m_pCanvasExport->IsExporting())
+    {
+        Tutorial14_GPUProfiler::ScopedPass Pass{m_pGPUProfiler.get(), "Canvas export"};
+        m_pCanvasExport->Update();
+
+        // Restaurar el back buffer para la interfaz
+        m_pImmediateContext->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pImmediateContext->SetViewports(1, nullptr, 0, 0);
+    }
+
+    m_pGPUProfiler->EndFrame();
+    m_pFrameAllocator->EndFrame();
+    const double CPUSubmitMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - RenderStartTime).count();
+
+    // Las estadsticas del panel se actualizan al resolver; los frames solo se
+    // acumulan para el benchmark si hay uno en curso
+    Tutorial14_GPUProfiler::FrameTimings Timings;
+    while (m_pGPUProfiler->PopResolvedFrame(Timings))
+    {
+        if (m_pBenchmark)
+            m_pBenchmark->AddGPUTimings(Timings);
+        if (m_bDynamicCanvasScale && m_VisualizationMode == VisualizationMode::PAINT_CANVAS)
+            UpdateDynamicCanvasScale(Timings);
+    }
+    if (m_pBenchmark)
+    {
+        m_pBenchmark->EndFrame(CPUSubmitMs, m_LastFrameMs);
+    }
+
+    ++m_FrameId;
+}
+
+void Tutorial14_ComputeShader::RenderSceneBatch(ITextureView* pRTV, ITextureView* pDSV)
+{
+    if (!m_pSceneBatch->IsReady())
+        return;
 
-        float  AspectRatio = static_cast<float>(m_pSwapChain->GetDesc().Width) / static_cast<float>(m_pSwapChain->GetDesc().Height);
-        float2 f2Scale     = float2(std::sqrt(1.f / AspectRatio), std::sqrt(AspectRatio));
-        ConstData->f2Scale = f2Scale;
+    const float DeltaTime = std::min(m_fTimeDelta, 1.f / 60.f) * m_fSimulationSpeed;
+    m_pSceneBatch->BeginFrame(DeltaTime);
 
-        int iParticleGridWidth          = static_cast<int>(std::sqrt(static_cast<float>(m_NumParticles)) / f2Scale.x);
-        ConstData->i2ParticleGridSize.x = iParticleGridWidth;
-        ConstData->i2ParticleGridSize.y = m_NumParticles / iParticleGridWidth;
+    // Con un dispatch por escena la grabacin se reparte en rangos de escenas; con un
+    // dispatch por pase basta un rango, que se graba en paralelo con el dibujo
+    const Uint32 NumScenes = m_SceneBatchSettings.NumScenes;
+    const Uint32 NumRanges = m_SceneBatchSettings.DispatchPerScene ? std::min(NumScenes, m_pCommandRecorder->GetNumWorkers()) : 1;
+    for (Uint32 r = 0; r < NumRanges; ++r)
+    {
+        const Uint32 FirstScene = NumScenes * r / NumRanges;
+        const Uint32 EndScene   = NumScenes * (r + 1) / NumRanges;
+        m_pCommandRecorder->AddSegment("Scene batch simulation", [this, FirstScene, EndScene](IDeviceContext* pContext) {
+            m_pSceneBatch->RecordSimulation(pContext, FirstScene, EndScene - FirstScene);
+        });
     }
+    m_pCommandRecorder->AddSegment("Scene batch rendering", [this, pRTV, pDSV](IDeviceContext* pContext) {
+        // El back buffer ya est en RENDER_TARGET tras el borrado en el contexto inmediato.
+        // Viewport de todo el back buffer; cada escena se coloca en su celda en el shader.
+        ITextureView* ppRTVs[] = {pRTV};
+        pContext->SetRenderTargets(1, ppRTVs, pDSV, RESOURCE_STATE_TRANSITION_MODE_NONE);
+        pContext->SetViewports(1, nullptr, 0, 0);
+        m_pSceneBatch->RecordRender(pContext);
+    });
+    m_pCommandRecorder->Submit(m_pGPUProfiler.get());
+
+    m_pSceneBatch->EndFrame();
+
+    // Ejecutar las listas deja sin definir el estado del contexto inmediato
+    m_pImmediateContext->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->SetViewports(1, nullptr, 0, 0);
+}
+
+void Tutorial14_ComputeShader::RenderParticleSystem(ITextureView* pRTV)
+{
+    // Renderizar partculas (sistema original)
+    const float FrameSimTime = std::min(m_fTimeDelta, m_pAdaptiveTimeStep->GetSettings().MaxFrameTime) * m_fSimulationSpeed;
+
+    // Con el intervalo adaptativo el frame se divide en subpasos. El nmero se decide con
+    // el ltimo intervalo estable ledo de la GPU; el intervalo de cada subpaso lo elige
+    // la propia GPU, as que no hay que esperar a la lectura.
+    m_NumSubsteps = m_bAdaptiveTimeStep ? m_pAdaptiveTimeStep->GetNumSubsteps(FrameSimTime) : 1;
 
-    // Actualizar la textura de velocidad del fluido en el SRB si existe
-    if (m_pFluidSim && m_pMoveParticlesSRB)
+    const float fDeltaTime = std::min(m_fTimeDelta, 1.f / 60.f) * m_fSimulationSpeed;
+
+    float2 f2Scale;
+    int2   i2ParticleGridSize;
     {
-        // Obtener textura de velocidad del fluido
-        ITextureView* pFluidVelocitySRV = m_pFluidSim->GetVelocitySRV();
-        if (pFluidVelocitySRV)
+        GlobalConstants ConstData;
+        ConstData.uiNumParticles    = static_cast<Uint32>(m_NumParticles);
+        ConstData.fDeltaTime        = fDeltaTime;
+        ConstData.fAdaptiveTimeStep = m_bAdaptiveTimeStep ? 1.f : 0.f;
+        ConstData.fViewZoom         = m_fViewZoom;
+
+        float AspectRatio = static_cast<float>(m_pSwapChain->GetDesc().Width) / static_cast<float>(m_pSwapChain->GetDesc().Height);
+        f2Scale           = float2(std::sqrt(1.f / AspectRatio), std::sqrt(AspectRatio));
+        ConstData.f2Scale = f2Scale;
+
+        int iParticleGridWidth         = static_cast<int>(std::sqrt(static_cast<float>(m_NumParticles)) / f2Scale.x);
+        ConstData.i2ParticleGridSize.x = iParticleGridWidth;
+        ConstData.i2ParticleGridSize.y = m_NumParticles / iParticleGridWidth;
+        i2ParticleGridSize             = ConstData.i2ParticleGridSize;
+
+        ConstData.f2ViewCenter        = m_f2ViewCenter;
+        ConstData.f2FluidWindowCenter = m_f2FluidWindowCenter;
+
+        // Las constantes son las mismas en todos los subpasos: una asignacin por frame
+        const Uint32 Offset = m_pFrameAllocator->Allocate(ConstData);
+        m_pResetParticleListsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "Constants")->SetBufferOffset(Offset);
+        m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "Constants")->SetBufferOffset(Offset);
+        m_pCollideParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "Constants")->SetBufferOffset(Offset);
+        m_pUpdateParticleSpeedSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "Constants")->SetBufferOffset(Offset);
+        m_pRenderParticleSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferOffset(Offset);
+        for (auto& pSRB : m_pPipelinedRenderSRB)
         {
-            // Actualizar la variable en el SRB con la textura de velocidad actual
-            auto* pFluidVelocityVar = m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture");
-            if (pFluidVelocityVar)
+            if (pSRB)
+                pSRB->GetVariableByName(SHADER_TYPE_VERTEX, "Constants")->SetBufferOffset(Offset);
+        }
+    }
+
+    // Los pases se declaran aqu con los recursos que usan y se ejecutan en Execute(), que
+    // emite antes de cada uno las barreras necesarias
+    Tutorial14_FrameGraph& Graph = *m_pFrameGraph;
+
+    const auto ParticlesId      = Graph.ImportBuffer(m_pParticleAttribsBuffer);
+    const auto MovedParticlesId = Graph.ImportBuffer(m_pMovedParticleAttribsBuffer);
+    const auto ListHeadsId      = Graph.ImportBuffer(m_pParticleListHeadsBuffer);
+    const auto ListsId          = Graph.ImportBuffer(m_pParticleListsBuffer);
+    const auto TimeStepId       = Graph.ImportBuffer(m_pAdaptiveTimeStep->GetTimeStepBuffer());
+    const auto BackBufferId     = Graph.ImportTexture(pRTV->GetTexture());
+
+    // Con las partculas dormidas activadas los pases de movimiento y colisin se compilan
+    // para la lista de activas y se lanzan con los argumentos indirectos de la clasificacin
+    const bool bParticleSleep   = IsParticleSleepEnabled();
+    const auto ActiveListId     = Graph.ImportBuffer(bParticleSleep ? m_pParticleSleep->GetActiveListBuffer() : nullptr);
+    const auto WakeFlagsId      = Graph.ImportBuffer(bParticleSleep ? m_pParticleSleep->GetWakeFlagsBuffer() : nullptr);
+    const auto ActiveArgsId     = Graph.ImportBuffer(bParticleSleep ? m_pParticleSleep->GetIndirectArgsBuffer() : nullptr);
+    IBuffer*   pActiveArgs      = bParticleSleep ? m_pParticleSleep->GetIndirectArgsBuffer() : nullptr;
+    const auto ActiveArgsState  = RESOURCE_STATE_INDIRECT_ARGUMENT | RESOURCE_STATE_SHADER_RESOURCE;
+
+    // En el modo SPH sus pases sustituyen a los de colisin, as que las listas de vecinas
+    // no se usan
+    const bool bSPHFluid = m_bSPHFluid && m_pSPHFluid->IsValid() && !m_bWorldMode;
+
+    // Con listas de vecinas las colisiones leen las listas en lugar de la rejilla
+    const bool bNeighborList    = IsNeighborListEnabled() && !bSPHFluid;
+    const auto NeighborListsId  = Graph.ImportBuffer(bNeighborList ? m_pNeighborList->GetNeighborListsBuffer() : nullptr);
+    const auto NeighborCountsId = Graph.ImportBuffer(bNeighborList ? m_pNeighborList->GetNeighborCountsBuffer() : nullptr);
+
+    // Los pases de dispatch solo graban en su contexto, con las constantes fijadas arriba,
+    // as que se pueden grabar en paralelo
+    const Uint32 NumGroups       = (m_NumParticles + m_ThreadGroupSize - 1) / m_ThreadGroupSize;
+    auto         AddDispatchPass = [&Graph, NumGroups](const char* Name, IPipelineState* pPSO, IShaderResourceBinding* pSRB, IBuffer* pIndirectArgs, std::initializer_list<Tutorial14_FrameGraph::Access> Accesses) {
+        Graph.AddDeferredPass(Name, Accesses, [pPSO, pSRB, pIndirectArgs, NumGroups](IDeviceContext* pCtx) {
+            pCtx->SetPipelineState(pPSO);
+            pCtx->CommitShaderResources(pSRB, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+            if (pIndirectArgs != nullptr)
+            {
+                pCtx->DispatchComputeIndirect(DispatchComputeIndirectAttribs{pIndirectArgs, Tutorial14_FrameGraph::PASS_TRANSITION_MODE});
+            }
+            else
             {
-                pFluidVelocityVar->Set(pFluidVelocitySRV);
+                DispatchComputeAttribs DispatAttribs;
+                DispatAttribs.ThreadGroupCountX = NumGroups;
+                pCtx->DispatchCompute(DispatAttribs);
             }
+        });
+    };
+
+    // En la cola de cmputo el fluido avanza todos los subpasos de una vez, solapado con el
+    // resto del frame; el hilo de simulacin graba esos pasos mientras este hilo graba el
+    // frame, y las partculas usan el campo del frame anterior. Con las partculas
+    // canalizadas el hilo graba tambin sus subpasos del frame siguiente tras los del fluido,
+    // y este frame dibuja el estado publicado por el paso anterior.
+    const bool bAsyncFluid         = m_pFluidSim && m_pFluidSim->IsAsyncCompute();
+    const bool bPipelinedParticles = IsParticlePipelineEnabled();
+    if (bPipelinedParticles && !m_bParticlesPipelined)
+    {
+        // El primer paso parte del estado de la cola grfica
+        m_pParticlePipeline->Begin(m_pParticleAttribsBuffer);
+        m_pFluidSim->ReleaseToComputeQueue();
+    }
+    if (bAsyncFluid)
+    {
+        Tutorial14_FluidSimulation::AsyncStepCallback ParticleStep;
+        if (bPipelinedParticles)
+        {
+            ParticleStep = [this, NumSubsteps = m_NumSubsteps, fDeltaTime, f2Scale, i2ParticleGridSize](IDeviceContext* pComputeContext, ITextureView* pVelocitySRV, Uint32 PublishIndex) {
+                m_pParticlePipeline->RecordStep(pComputeContext, NumSubsteps, fDeltaTime, f2Scale, i2ParticleGridSize, pVelocitySRV, PublishIndex);
+            };
         }
+        m_pFluidSim->SubmitAsyncStep(m_NumSubsteps, std::move(ParticleStep));
+    }
+    // La cola grfica ya espera al ltimo paso de la cola de cmputo
+    if (!bPipelinedParticles)
+    {
+        StopParticlePipeline();
     }
+    m_bParticlesPipelined = bPipelinedParticles;
 
-    // Viewport para toda la ejecucin
-    Viewport VP;
-    VP.Width    = static_cast<float>(m_pSwapChain->GetDesc().Width);
-    VP.Height   = static_cast<float>(m_pSwapChain->GetDesc().Height);
-    VP.MinDepth = 0.0f;
-    VP.MaxDepth = 1.0f;
-    VP.TopLeftX = 0.0f;
-    VP.TopLeftY = 0.0f;
-    m_pImmediateContext->SetViewports(1, &VP, 0, 0);
+    // Tras cada paso sncrono del fluido el campo actual vuelve a estar en la misma textura,
+    // as que todos los subpasos leen la misma
+    ITextureView* pFluidVelocitySRV = m_pFluidSim ? m_pFluidSim->GetVelocitySRV() : nullptr;
+    const auto    FluidVelocityId   = Graph.ImportTexture(pFluidVelocitySRV ? pFluidVelocitySRV->GetTexture() : nullptr);
+    if (pFluidVelocitySRV && m_pMoveParticlesSRB)
+    {
+        // Actualizar la variable en el SRB con la textura de velocidad actual
+        auto* pFluidVelocityVar = m_pMoveParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture");
+        if (pFluidVelocityVar)
+        {
+            pFluidVelocityVar->Set(pFluidVelocitySRV);
+        }
+    }
 
-    // Asegurar que las scissor rects estn configuradas correctamente
-    Rect scissorRect;
-    scissorRect.left   = 0;
-    scissorRect.top    = 0;
-    scissorRect.right  = static_cast<long>(VP.Width);
-    scissorRect.bottom = static_cast<long>(VP.Height);
-    m_pImmediateContext->SetScissorRects(1, &scissorRect, 0, 0);
+    // Las partculas canalizadas ya avanzan en la cola de cmputo
+    const Uint32 NumGraphicsSubsteps = bPipelinedParticles ? 0 : m_NumSubsteps;
+    for (Uint32 Substep = 0; Substep < NumGraphicsSubsteps; ++Substep)
+    {
+        if (m_bAdaptiveTimeStep)
+        {
+            Graph.AddPass("Adaptive time step",
+                          {
+                              {ParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {FluidVelocityId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {TimeStepId, RESOURCE_STATE_UNORDERED_ACCESS},
+                          },
+                          [this, FrameSimTime, f2Scale, i2ParticleGridSize, pFluidVelocitySRV](IDeviceContext*) {
+                              m_pAdaptiveTimeStep->ComputeTimeStep(static_cast<Uint32>(m_NumParticles),
+                                                                   FrameSimTime / static_cast<float>(m_NumSubsteps),
+                                                                   f2Scale,
+                                                                   i2ParticleGridSize,
+                                                                   pFluidVelocitySRV,
+                                                                   m_pFluidSim ? m_pFluidSim->GetGridSize() : 0,
+                                                                   Tutorial14_FluidSimulation::TIME_STEP_SCALE);
+                          });
+        }
+
+        // Un paso de la simulacin de fluidos (sin renderizar la visualizacin)
+        if (m_pFluidSim)
+        {
+            m_pFluidSim->AddSolverPasses(Graph);
+        }
 
-    DispatchComputeAttribs DispatAttribs;
-    DispatAttribs.ThreadGroupCountX = (m_NumParticles + m_ThreadGroupSize - 1) / m_ThreadGroupSize;
+        AddDispatchPass("Reset particle lists", m_pResetParticleListsPSO, m_pResetParticleListsSRB, nullptr,
+                        {
+                            {ListHeadsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                        });
+        if (bParticleSleep)
+        {
+            Graph.AddPass("Particle sleep",
+                          {
+                              {ParticlesId, RESOURCE_STATE_UNORDERED_ACCESS},
+                              {MovedParticlesId, RESOURCE_STATE_UNORDERED_ACCESS},
+                              {ListHeadsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                              {ListsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                              {FluidVelocityId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {TimeStepId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {ActiveListId, RESOURCE_STATE_UNORDERED_ACCESS},
+                              {WakeFlagsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                              {ActiveArgsId, RESOURCE_STATE_COPY_DEST},
+                          },
+                          [this, fDeltaTime, f2Scale, i2ParticleGridSize, pFluidVelocitySRV](IDeviceContext*) {
+                              m_pParticleSleep->Classify(static_cast<Uint32>(m_NumParticles), fDeltaTime, m_bAdaptiveTimeStep,
+                                                         f2Scale, i2ParticleGridSize, pFluidVelocitySRV);
+                          });
+        }
+        AddDispatchPass("Move particles", m_pMoveParticlesPSO, m_pMoveParticlesSRB, pActiveArgs,
+                        {
+                            {ParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                            {FluidVelocityId, RESOURCE_STATE_SHADER_RESOURCE},
+                            {TimeStepId, RESOURCE_STATE_SHADER_RESOURCE},
+                            {ActiveListId, RESOURCE_STATE_SHADER_RESOURCE},
+                            {ActiveArgsId, ActiveArgsState},
+                            {MovedParticlesId, RESOURCE_STATE_UNORDERED_ACCESS},
+                            {ListHeadsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                            {ListsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                        });
+        if (bNeighborList)
+        {
+            Graph.AddPass("Neighbor lists",
+                          {
+                              {MovedParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {ListHeadsId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {ListsId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {NeighborListsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                              {NeighborCountsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                          },
+                          [this, f2Scale, i2ParticleGridSize](IDeviceContext*) {
+                              m_pNeighborList->Update(static_cast<Uint32>(m_NumParticles), f2Scale, i2ParticleGridSize);
+                          });
+        }
+        if (bSPHFluid)
+        {
+            m_pSPHFluid->AddPasses(Graph, static_cast<Uint32>(m_NumParticles), fDeltaTime, m_bAdaptiveTimeStep, f2Scale, i2ParticleGridSize);
+        }
+        else
+        {
+            AddDispatchPass("Collide particles", m_pCollideParticlesPSO, m_pCollideParticlesSRB, pActiveArgs,
+                            {
+                                {MovedParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {ListHeadsId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {ListsId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {NeighborListsId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {NeighborCountsId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {ActiveListId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {ActiveArgsId, ActiveArgsState},
+                                {ParticlesId, RESOURCE_STATE_UNORDERED_ACCESS},
+                                {WakeFlagsId, RESOURCE_STATE_UNORDERED_ACCESS},
+                            });
+            AddDispatchPass("Update particle speed", m_pUpdateParticleSpeedPSO, m_pUpdateParticleSpeedSRB, pActiveArgs,
+                            {
+                                {MovedParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {ListHeadsId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {ListsId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {NeighborListsId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {NeighborCountsId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {ActiveListId, RESOURCE_STATE_SHADER_RESOURCE},
+                                {ActiveArgsId, ActiveArgsState},
+                                {ParticlesId, RESOURCE_STATE_UNORDERED_ACCESS},
+                            });
+        }
 
-    m_pImmediateContext->SetPipelineState(m_pResetParticleListsPSO);
-    m_pImmediateContext->CommitShaderResources(m_pResetParticleListsSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_pImmediateContext->DispatchCompute(DispatAttribs);
+        // El momento depositado lo aplica el pase de fuerza del siguiente subpaso. El depsito
+        // sita las partculas en la rejilla densa, as que no se hace en el modo mundo.
+        if (m_pFluidSim && !m_bWorldMode)
+        {
+            m_pFluidSim->AddCouplingPass(Graph, f2Scale, i2ParticleGridSize);
+        }
+    }
 
-    m_pImmediateContext->SetPipelineState(m_pMoveParticlesPSO);
-    m_pImmediateContext->CommitShaderResources(m_pMoveParticlesSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_pImmediateContext->DispatchCompute(DispatAttribs);
+    if (m_pTrajectoryRecorder->IsRecording())
+    {
+        Graph.AddPass("Trajectory capture",
+                      {
+                          {ParticlesId, RESOURCE_STATE_COPY_SOURCE},
+                      },
+                      [this](IDeviceContext*) {
+                          m_pTrajectoryRecorder->Capture(m_pParticleAttribsBuffer, m_FrameId);
+                      });
+    }
 
-    m_pImmediateContext->SetPipelineState(m_pCollideParticlesPSO);
-    m_pImmediateContext->CommitShaderResources(m_pCollideParticlesSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_pImmediateContext->DispatchCompute(DispatAttribs);
+    if (m_bComputeStats)
+    {
+        Graph.AddPass("Simulation statistics",
+                      {
+                          {ParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                          {ListHeadsId, RESOURCE_STATE_SHADER_RESOURCE},
+                          {ListsId, RESOURCE_STATE_SHADER_RESOURCE},
+                          {FluidVelocityId, RESOURCE_STATE_SHADER_RESOURCE},
+                      },
+                      [this, i2ParticleGridSize, pFluidVelocitySRV](IDeviceContext*) {
+                          m_pSimStats->Compute(static_cast<Uint32>(m_NumParticles),
+                                               static_cast<Uint32>(i2ParticleGridSize.x * i2ParticleGridSize.y),
+                                               pFluidVelocitySRV,
+                                               m_pFluidSim ? m_pFluidSim->GetGridSize() : 0,
+                                               m_FrameId);
+                      });
+    }
 
-    m_pImmediateContext->SetPipelineState(m_pUpdateParticleSpeedPSO);
-    // Use the same SRB
-    m_pImmediateContext->CommitShaderResources(m_pCollideParticlesSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_pImmediateContext->DispatchCompute(DispatAttribs);
+    if (m_pVelocityQuery && pFluidVelocitySRV)
+    {
+        Graph.AddPass("Velocity queries",
+                      {
+                          {FluidVelocityId, RESOURCE_STATE_SHADER_RESOURCE},
+                      },
+                      [this, pFluidVelocitySRV](IDeviceContext*) {
+                          m_pVelocityQuery->Dispatch(pFluidVelocitySRV, m_f2FluidWindowCenter);
+                      });
+    }
 
-    m_pImmediateContext->SetPipelineState(m_pRenderParticlePSO);
-    m_pImmediateContext->CommitShaderResources(m_pRenderParticleSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    DrawAttribs drawAttrs;
-    drawAttrs.NumVertices  = 4;
-    drawAttrs.NumInstances = static_cast<Uint32>(m_NumParticles);
-    m_pImmediateContext->Draw(drawAttrs);
+    // Las partculas canalizadas se dibujan desde el bfer publicado con el campo del fluido
+    const Uint32            PublishedIndex    = bPipelinedParticles ? m_pFluidSim->GetPublishedIndex() : 0;
+    IShaderResourceBinding* pRenderSRB        = bPipelinedParticles ? m_pPipelinedRenderSRB[PublishedIndex].RawPtr() : m_pRenderParticleSRB.RawPtr();
+    const auto              RenderParticlesId = bPipelinedParticles ? Graph.ImportBuffer(m_pParticlePipeline->GetPublishedBuffer(PublishedIndex)) : ParticlesId;
+    Graph.AddDeferredPass("Particle rendering",
+                          {
+                              {RenderParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {BackBufferId, RESOURCE_STATE_RENDER_TARGET},
+                          },
+                          [this, pRTV, pRenderSRB](IDeviceContext* pCtx) {
+                              pCtx->SetRenderTargets(1, &pRTV, nullptr, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+
+                              // Viewport para toda la ejecucin
+                              Viewport VP;
+                              VP.Width    = static_cast<float>(m_pSwapChain->GetDesc().Width);
+                              VP.Height   = static_cast<float>(m_pSwapChain->GetDesc().Height);
+                              VP.MinDepth = 0.0f;
+                              VP.MaxDepth = 1.0f;
+                              VP.TopLeftX = 0.0f;
+                              VP.TopLeftY = 0.0f;
+                              pCtx->SetViewports(1, &VP, 0, 0);
+
+                              // Asegurar que las scissor rects estn configuradas correctamente
+                              Rect scissorRect;
+                              scissorRect.left   = 0;
+                              scissorRect.top    = 0;
+                              scissorRect.right  = static_cast<long>(VP.Width);
+                              scissorRect.bottom = static_cast<long>(VP.Height);
+                              pCtx->SetScissorRects(1, &scissorRect, 0, 0);
+
+                              pCtx->SetPipelineState(m_pRenderParticlePSO);
+                              pCtx->CommitShaderResources(pRenderSRB, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+                              DrawAttribs drawAttrs;
+                              drawAttrs.NumVertices  = 4;
+                              drawAttrs.NumInstances = static_cast<Uint32>(m_NumParticles);
+                              pCtx->Draw(drawAttrs);
+                          });
 
     // Renderizar segn el modo seleccionado
     if (m_VisualizationMode == VisualizationMode::FLUID_VISUALIZATION)
@@ -1009,31 +3007,148 @@ void Tutorial14_ComputeShader::Render()
         // Renderizar visualizacin del fluido al final (para que aparezca encima)
         if (m_pFluidSim && m_bShowFluidVisualization)
         {
-            m_pFluidSim->RenderFluidVisualization(pRTV);
+            m_pFluidSim->AddVisualizationPass(Graph, pRTV, m_f2ViewCenter, m_fViewZoom, m_f2FluidWindowCenter);
         }
     }
-    else if (m_VisualizationMode == VisualizationMode::PAINT_CANVAS)
+    else if (m_VisualizationMode == VisualizationMode::PAINT_CANVAS && !m_bWorldMode)
     {
-        // Pintar las partculas al canvas
-        PaintParticlesToCanvas();
+        const auto CanvasId = Graph.ImportTexture(m_pCanvasTexture);
+
+        // Pintar las partculas al canvas; el mtodo por tiles lo escribe como UAV
+        const bool bTiledPaint = m_PaintMethod == PaintMethod::TILED_COMPUTE && m_pTiledPaint;
+        Graph.AddPass("Paint splat",
+                      {
+                          {ParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                          {Graph.ImportTexture(m_pColorPaletteTexture), RESOURCE_STATE_SHADER_RESOURCE},
+                          {CanvasId, bTiledPaint ? RESOURCE_STATE_UNORDERED_ACCESS : RESOURCE_STATE_RENDER_TARGET},
+                      },
+                      [this](IDeviceContext*) {
+                          PaintParticlesToCanvas();
+                      });
+
+        if (m_pCanvasAutosave->IsSaving())
+        {
+            Graph.AddPass("Canvas dirty tiles",
+                          {
+                              {ParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                          },
+                          [this](IDeviceContext*) {
+                              m_pCanvasAutosave->MarkDirty(m_pParticleAttribsBuffer, static_cast<Uint32>(m_NumParticles));
+                          });
+        }
 
         // Renderizar el canvas final
-        RenderPaintCanvas();
+        Graph.AddPass("Canvas composite",
+                      {
+                          {CanvasId, RESOURCE_STATE_SHADER_RESOURCE},
+                          {BackBufferId, RESOURCE_STATE_RENDER_TARGET},
+                      },
+                      [this](IDeviceContext*) {
+                          RenderPaintCanvas();
+                      });
+    }
+
+    Graph.Execute();
+
+    // Ejecutar las listas de los pases diferidos deja sin definir el estado del contexto inmediato
+    if (Graph.GetStatistics().NumDeferredSegments > 0)
+    {
+        m_pImmediateContext->SetRenderTargets(1, &pRTV, m_pSwapChain->GetDepthBufferDSV(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pImmediateContext->SetViewports(1, nullptr, 0, 0);
+    }
+
+    if (m_bAdaptiveTimeStep)
+    {
+        m_pAdaptiveTimeStep->EnqueueReadback();
+    }
+    if (bParticleSleep)
+    {
+        m_pParticleSleep->EnqueueReadback();
+    }
+    if (bNeighborList)
+    {
+        m_pNeighborList->EnqueueReadback();
+    }
+
+    if (bAsyncFluid)
+    {
+        m_pFluidSim->EndGraphicsFrame();
     }
 }
 
 void Tutorial14_ComputeShader::Update(double CurrTime, double ElapsedTime)
 {
+    T14_TRACE_SCOPE("Update");
+
     SampleBase::Update(CurrTime, ElapsedTime);
+    m_pFrameAllocator->BeginFrame();
     UpdateUI();
 
-    m_fTimeDelta = static_cast<float>(ElapsedTime);
+    if (ImGui::IsKeyPressed(ImGuiKey_F9, false))
+    {
+        Tutorial14_CPUTrace::WriteChromeTrace(m_TraceOutputPath);
+    }
+
+    m_LastFrameMs = ElapsedTime * 1000.0;
+    m_fTimeDelta  = static_cast<float>(ElapsedTime);
+    if (m_pBenchmark && !m_pBenchmark->IsFinished())
+    {
+        if (const auto* pCase = m_pBenchmark->BeginFrame(m_FrameId))
+        {
+            ApplyBenchmarkCase(*pCase);
+        }
+        // Paso fijo para que el barrido sea reproducible
+        m_fTimeDelta = Tutorial14_Benchmark::FIXED_TIME_STEP;
+    }
+    else if (m_pBenchmark)
+    {
+        // El barrido ha terminado; solo la primera vez hay algo que restaurar
+        RestoreBenchmarkSettings();
+    }
     m_fAccumulatedTime += m_fTimeDelta;
 
     // Actualizar sistema de fluidos si existe
     if (m_pFluidSim)
     {
-        m_pFluidSim->Update(static_cast<float>(ElapsedTime), m_fSimulationSpeed, m_fViscosity);
+        if (m_bWorldMode)
+        {
+            UpdateFluidWindow();
+        }
+        m_pFluidSim->Update(m_fTimeDelta, m_fSimulationSpeed, m_fViscosity);
+    }
+
+    // Una sonda en vuelo como mucho: si la copia tarda, no se acumulan consultas
+    if (m_pVelocityQuery && m_bProbeFluidVelocity && !m_bProbePending)
+    {
+        constexpr Uint32    ProbeGridSize = 64;
+        std::vector<float2> Positions(ProbeGridSize * ProbeGridSize);
+        for (Uint32 y = 0; y < ProbeGridSize; ++y)
+        {
+            for (Uint32 x = 0; x < ProbeGridSize; ++x)
+            {
+                // La rejilla de sondas cubre la ventana del campo
+                Positions[x + y * ProbeGridSize] = m_f2FluidWindowCenter + float2{(static_cast<float>(x) + 0.5f) / ProbeGridSize * 2.f - 1.f,
+                                                                                  (static_cast<float>(y) + 0.5f) / ProbeGridSize * 2.f - 1.f};
+            }
+        }
+
+        const Uint64 SubmitFrame = m_FrameId;
+        m_bProbePending          = m_pVelocityQuery->Submit(
+            Positions.data(), static_cast<Uint32>(Positions.size()),
+            [this, SubmitFrame](const float2* pVelocities, Uint32 NumPositions) {
+                float SpeedSum = 0;
+                float MaxSpeed = 0;
+                for (Uint32 i = 0; i < NumPositions; ++i)
+                {
+                    const float Speed = length(pVelocities[i]);
+                    SpeedSum += Speed;
+                    MaxSpeed = std::max(MaxSpeed, Speed);
+                }
+                m_ProbeMeanSpeed     = NumPositions > 0 ? SpeedSum / static_cast<float>(NumPositions) : 0.f;
+                m_ProbeMaxSpeed      = MaxSpeed;
+                m_ProbeLatencyFrames = m_FrameId - SubmitFrame;
+                m_bProbePending      = false;
+            });
     }
 }
 
@@ -5,6 +5,25 @@
 #include "BasicMath.hpp"
 #include <memory>
 #include "Tutorial14_FluidSimulation.hpp"
+#include "Tutorial14_GPUProfiler.hpp"
+#include "Tutorial14_Benchmark.hpp"
+#include "Tutorial14_SimulationStats.hpp"
+#include "Tutorial14_AdaptiveTimeStep.hpp"
+#include "Tutorial14_TrajectoryRecorder.hpp"
+#include "Tutorial14_FrameCapture.hpp"
+#include "Tutorial14_TiledPaint.hpp"
+#include "Tutorial14_CanvasScaleController.hpp"
+#include "Tutorial14_CanvasExport.hpp"
+#include "Tutorial14_CanvasAutosave.hpp"
+#include "Tutorial14_SceneBatch.hpp"
+#include "Tutorial14_CommandRecorder.hpp"
+#include "Tutorial14_VelocityQuery.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_FrameGraph.hpp"
+#include "Tutorial14_ParticleSleep.hpp"
+#include "Tutorial14_NeighborList.hpp"
+#include "Tutorial14_SPHFluid.hpp"
+#include "Tutorial14_ParticlePipeline.hpp"
 
 namespace Diligent
 {
@@ -12,27 +31,72 @@ namespace Diligent
 enum class VisualizationMode
 {
     FLUID_VISUALIZATION, // Sistema actual con fluidos visibles
-    PAINT_CANVAS         // Solo el canvas pintado
+    PAINT_CANVAS,        // Solo el canvas pintado
+    SCENE_BATCH          // Muchas escenas independientes simuladas en lote (Tutorial14_SceneBatch)
+};
+
+enum class PaintMethod
+{
+    RASTER,       // Un quad con blending por partcula (PaintParticle.vsh/psh)
+    TILED_COMPUTE // Trazos agrupados por tiles en compute (Tutorial14_TiledPaint)
 };
 
 class Tutorial14_ComputeShader final : public SampleBase
 {
 public:
+    ~Tutorial14_ComputeShader();
+
     virtual void ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs) override final;
 
+    virtual CommandLineStatus ProcessCommandLine(int argc, const char* const* argv) override final;
+
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
 
     virtual void Render() override final;
     virtual void Update(double CurrTime, double ElapsedTime) override final;
 
+    virtual void WindowResize(Uint32 Width, Uint32 Height) override final;
+
     virtual const Char* GetSampleName() const override final { return "Tutorial14: Compute Shader"; }
 
 private:
     void CreateRenderParticlePSO();
     void CreateUpdateParticlePSO();
-    void CreateParticleBuffers();
-    void CreateConsantBuffer();
+    // Sin datos iniciales las partculas se generan de forma pseudoaleatoria
+    void CreateParticleBuffers(const void* pParticleData  = nullptr,
+                               const void* pListHeadsData = nullptr,
+                               const void* pListsData     = nullptr);
+    // SRBs de los pases de partculas; tambin tras recrear sus pipelines
+    void CreateParticleSRBs();
+    bool IsParticleSleepEnabled() const { return m_bParticleSleep && m_pParticleSleep && m_pParticleSleep->IsValid() && !m_bWorldMode; }
+    bool IsNeighborListEnabled() const { return m_bNeighborList && m_pNeighborList && m_pNeighborList->IsValid() && !m_bWorldMode; }
+    // Las partculas se simulan en la cola de cmputo (Tutorial14_ParticlePipeline) si el
+    // fluido es asncrono y ningn mdulo activo usa sus bferes en la cola grfica
+    bool IsParticlePipelineEnabled() const;
+    // Devuelve el estado de las partculas canalizadas a los bferes principales; la cola
+    // grfica debe esperar ya al ltimo paso de la cola de cmputo
+    void StopParticlePipeline();
+    // Recompila los pases de partculas con o sin la rejilla hash y devuelve la cmara y la
+    // ventana del fluido al origen
+    void SetWorldMode(bool bWorldMode);
+    // Desplaza la ventana del fluido hacia la cmara
+    void UpdateFluidWindow();
     void UpdateUI();
+    void UpdateProfilerUI();
+    void UpdateStatsUI();
+    void UpdateTimeStepUI();
+    void UpdateRecorderUI();
+    void UpdateCaptureUI();
+    void UpdateCanvasExportUI();
+    void UpdateCanvasAutosaveUI();
+    void UpdateCanvasScaleUI();
+    void UpdateSceneBatchUI();
+    void UpdateVelocityQueryUI();
+    void UpdateParticleSleepUI();
+    void UpdateNeighborListUI();
+    void UpdateSPHFluidUI();
+    void UpdateWorldUI();
+    void UpdateDynamicCanvasScale(const Tutorial14_GPUProfiler::FrameTimings& Timings);
 
     // Paint System Methods
     void CreatePaintSystem();
@@ -42,7 +106,43 @@ private:
     void RenderPaintCanvas();
     void PaintParticlesToCanvas();
     void ClearCanvas();
+    bool LoadCanvas(const std::string& Path);
     void RecreatePaintSRB();
+    void RecreateRenderCanvasSRB();
+    // Copia el contenido de otro canvas, de cualquier tamao, al canvas actual
+    void ResampleCanvas(ITextureView* pSrcCanvasSRV);
+    float GetCanvasScale() const;
+
+    // Benchmark
+    void StartBenchmark();
+    void ApplyBenchmarkCase(const BenchmarkCase& Case);
+    // Vuelve a los ajustes que haba al empezar el barrido (al terminar o al abortarlo)
+    void RestoreBenchmarkSettings();
+    // Cambia las opciones de la simulacin que fija el barrido y recompila lo necesario;
+    // despus hay que recrear los bferes de partculas
+    void ApplySimulationOptions(bool  bParticleSleep,
+                                bool  bNeighborList,
+                                bool  bSPHFluid,
+                                float ParticleCoupling,
+                                bool  bAsyncCompute,
+                                bool  bPipelinedParticles,
+                                int   ThreadGroupSize);
+
+    // Instantneas del estado de la simulacin (Tutorial14_Snapshot)
+    bool SaveSnapshot(const std::string& Path);
+    bool LoadSnapshot(const std::string& Path);
+
+    // Simulacin y dibujo del sistema principal y del lote de escenas
+    void RenderParticleSystem(ITextureView* pRTV);
+    void RenderSceneBatch(ITextureView* pRTV, ITextureView* pDSV);
+    float GetAspectRatio() const;
+
+    // Partculas canalizadas con el fluido asncrono. Se declara antes que m_pFluidSim para
+    // destruirse despus de su hilo de simulacin, que graba los pasos de partculas.
+    std::unique_ptr<Tutorial14_ParticlePipeline> m_pParticlePipeline;
+    RefCntAutoPtr<IShaderResourceBinding>        m_pPipelinedRenderSRB[Tutorial14_ParticlePipeline::NUM_PUBLISHED_BUFFERS];
+    bool                                         m_bPipelinedParticles = true;
+    bool                                         m_bParticlesPipelined = false; // El ltimo frame dibuj los bferes publicados
 
     // Sistema de fluidos independiente
     std::unique_ptr<Tutorial14_FluidSimulation> m_pFluidSim;
@@ -64,7 +164,14 @@ private:
     RefCntAutoPtr<IPipelineState>         m_pRenderCanvasPSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pRenderCanvasSRB;
 
-    RefCntAutoPtr<IBuffer> m_pPaintConstants;
+    PaintMethod                            m_PaintMethod = PaintMethod::RASTER;
+    std::unique_ptr<Tutorial14_TiledPaint> m_pTiledPaint;
+
+    // Resolucin del canvas respecto a la ventana, fija o ajustada al presupuesto de GPU
+    RefCntAutoPtr<IPipelineState>    m_pResampleCanvasPSO;
+    float                            m_CanvasScale         = 1.0f;
+    bool                             m_bDynamicCanvasScale = false;
+    Tutorial14_CanvasScaleController m_CanvasScaleController;
 
     // Variable para controlar visualizacin de fluidos
     bool m_bShowFluidVisualization = true;
@@ -84,15 +191,144 @@ private:
     RefCntAutoPtr<IPipelineState>         m_pCollideParticlesPSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pCollideParticlesSRB;
     RefCntAutoPtr<IPipelineState>         m_pUpdateParticleSpeedPSO;
-    RefCntAutoPtr<IBuffer>                m_Constants;
+    RefCntAutoPtr<IShaderResourceBinding> m_pUpdateParticleSpeedSRB;
     RefCntAutoPtr<IBuffer>                m_pParticleAttribsBuffer;
+    RefCntAutoPtr<IBuffer>                m_pMovedParticleAttribsBuffer; // Salida del pase de movimiento
     RefCntAutoPtr<IBuffer>                m_pParticleListsBuffer;
     RefCntAutoPtr<IBuffer>                m_pParticleListHeadsBuffer;
     RefCntAutoPtr<IResourceMapping>       m_pResMapping;
 
+    // Constantes dinmicas de todo el frame (partculas, paint y fluido)
+    std::unique_ptr<Tutorial14_FrameAllocator> m_pFrameAllocator;
+
+    // Partculas dormidas: con m_bParticleSleep los pases de movimiento y colisin solo
+    // procesan las partculas activas
+    std::unique_ptr<Tutorial14_ParticleSleep> m_pParticleSleep;
+    bool                                      m_bParticleSleep = false;
+
+    // Listas de vecinas de Verlet: con m_bNeighborList los pases de colisin recorren las
+    // listas en lugar de la rejilla
+    std::unique_ptr<Tutorial14_NeighborList> m_pNeighborList;
+    bool                                     m_bNeighborList = false;
+
+    // Modo de fluido SPH: con m_bSPHFluid sus pases sustituyen a los de colisin
+    std::unique_ptr<Tutorial14_SPHFluid> m_pSPHFluid;
+    bool                                 m_bSPHFluid = false;
+
+    // Modo mundo: las partculas se mueven por [-WORLD_HALF_SIZE, WORLD_HALF_SIZE], la rejilla
+    // de colisiones es una tabla hash (WORLD_GRID) y el campo del fluido es una ventana de
+    // [-1,1] que sigue a la cmara. Las partculas dormidas, las listas de vecinas, el modo SPH
+    // y el acoplamiento con el fluido usan la rejilla densa y no se aplican en este modo.
+    static constexpr float WORLD_HALF_SIZE = 16.f;
+
+    bool   m_bWorldMode = false;
+    float2 m_f2ViewCenter;
+    float  m_fViewZoom = 1.f;
+    float2 m_f2FluidWindowCenter;
+
+    // Pases de la simulacin y del dibujo de partculas; emite las barreras de cada frame
+    std::unique_ptr<Tutorial14_FrameGraph> m_pFrameGraph;
+
     float m_fTimeDelta       = 0;
     float m_fSimulationSpeed = 1;
     float m_fAccumulatedTime = 0;
+
+    // Estadsticas de la simulacin calculadas en la GPU. Desactivadas por defecto: sus
+    // reducciones y lecturas no forman parte de la simulacin medida por el benchmark.
+    std::unique_ptr<Tutorial14_SimulationStats> m_pSimStats;
+    bool                                        m_bComputeStats = false;
+
+    // Consultas por lotes del campo de velocidad. La sonda de ejemplo pide una rejilla
+    // de posiciones cada frame y muestra el resultado cuando llega.
+    std::unique_ptr<Tutorial14_VelocityQuery> m_pVelocityQuery;
+    bool                                      m_bProbeFluidVelocity = false;
+    bool                                      m_bProbePending       = false;
+    float                                     m_ProbeMeanSpeed      = 0;
+    float                                     m_ProbeMaxSpeed       = 0;
+    Uint64                                    m_ProbeLatencyFrames  = 0;
+
+    // Intervalo de tiempo adaptativo (CFL) con subpasos
+    std::unique_ptr<Tutorial14_AdaptiveTimeStep> m_pAdaptiveTimeStep;
+    bool                                         m_bAdaptiveTimeStep = false;
+    Uint32                                       m_NumSubsteps       = 1;
+
+    // Medicin de rendimiento
+    std::unique_ptr<Tutorial14_GPUProfiler> m_pGPUProfiler;
+    bool                                    m_bShowGPUProfiler = false;
+    std::unique_ptr<Tutorial14_Benchmark>   m_pBenchmark;
+    Tutorial14_Benchmark::Settings          m_BenchmarkSettings;
+    bool                                    m_bRunBenchmarkOnStart = false;
+
+    // Ajustes del usuario que sobrescriben los casos del barrido
+    struct BenchmarkRestoreState
+    {
+        int               NumParticles           = 0;
+        int               ThreadGroupSize        = 0;
+        Uint32            FluidGridSize          = 0;
+        bool              AdaptiveTimeStep       = false;
+        bool              ComputeStats           = false;
+        bool              DynamicCanvasScale     = false;
+        VisualizationMode Mode                   = VisualizationMode::FLUID_VISUALIZATION;
+        bool              ShowFluidVisualization = true;
+        PaintMethod       Paint                  = PaintMethod::RASTER;
+        bool              ParticleSleep          = false;
+        bool              NeighborList           = false;
+        bool              SPHFluid               = false;
+        float             ParticleCoupling       = 0;
+        bool              AsyncCompute           = false;
+        bool              PipelinedParticles     = true;
+        bool              WorldMode              = false;
+        float2            ViewCenter;
+        float             ViewZoom = 1.f;
+    };
+    BenchmarkRestoreState m_BenchmarkRestoreState;
+    bool                  m_bBenchmarkSettingsSaved = false;
+
+    Uint64 m_FrameId     = 0;
+    double m_LastFrameMs = 0;
+
+    // Traza de CPU
+    std::string m_TraceOutputPath  = "Tutorial14_CPUTrace.json";
+    bool        m_bDumpTraceOnExit = false;
+
+    // Instantneas
+    std::string m_SnapshotPath         = "Tutorial14_Snapshot.t14s";
+    bool        m_bLoadSnapshotOnStart = false;
+
+    // Grabacin de trayectorias
+    std::unique_ptr<Tutorial14_TrajectoryRecorder> m_pTrajectoryRecorder;
+    Tutorial14_TrajectoryRecorder::Settings        m_TrajectorySettings;
+    bool                                           m_bRecordOnStart = false;
+
+    // Captura de frames
+    std::unique_ptr<Tutorial14_FrameCapture> m_pFrameCapture;
+    Tutorial14_FrameCapture::Settings        m_CaptureSettings;
+    bool                                     m_bCaptureOnStart = false;
+
+    // Exportacin del canvas a alta resolucin
+    std::unique_ptr<Tutorial14_CanvasExport> m_pCanvasExport;
+    Tutorial14_CanvasExport::Settings        m_ExportSettings;
+    Uint64                                   m_ExportAtFrame = 0; // 0: solo desde la interfaz
+
+    // Guardado incremental del canvas
+    std::unique_ptr<Tutorial14_CanvasAutosave> m_pCanvasAutosave;
+    Tutorial14_CanvasAutosave::Settings        m_AutosaveSettings;
+    bool                                       m_bAutosaveOnStart = false;
+    std::string                                m_LoadCanvasPath;
+
+    // Lote de escenas independientes
+    std::unique_ptr<Tutorial14_SceneBatch> m_pSceneBatch;
+    Tutorial14_SceneBatch::Settings        m_SceneBatchSettings;
+
+    // Grabacin de comandos en paralelo con contextos diferidos
+    std::unique_ptr<Tutorial14_CommandRecorder> m_pCommandRecorder;
+    int                                         m_NumDeferredContexts = -1; // -1: GetDefaultNumContexts()
+
+    // Simulacin de fluidos en una cola de cmputo asncrona (solo D3D12 y Vulkan)
+    ImmediateContextCreateInfo    m_ImmediateContextCI[2];
+    RefCntAutoPtr<IDeviceContext> m_pComputeContext;
+    bool                          m_bAsyncCompute  = false;
+    int                           m_ComputeQueueId = 1; // ndice de la cola en GraphicsAdapterInfo::Queues
 };
 
 } // namespace Diligent
\ No newline at end of file
@@ -1,7 +1,12 @@
 #include "Tutorial14_FluidSimulation.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_FrameGraph.hpp"
+#include "Tutorial14_CPUTrace.hpp"
 #include "GraphicsTypes.h"
 #include "ShaderMacroHelper.hpp"
 #include "RefCntAutoPtr.hpp"
+#include <algorithm>
+#include <cmath>
 #include <random> // Aadir para usar mt19937 y uniform_real_distribution
 
 namespace Diligent
@@ -10,17 +15,26 @@ namespace Diligent
 Tutorial14_FluidSimulation::Tutorial14_FluidSimulation(IRenderDevice*  pDevice,
                                                        IDeviceContext* pContext,
                                                        IEngineFactory* pEngineFactory,
-                                                       ISwapChain*     pSwapChain) :
+                                                       ISwapChain*     pSwapChain,
+                                                       Uint32          GridSize,
+                                                       IDeviceContext* pComputeContext) :
     m_pDevice(pDevice),
     m_pContext(pContext),
+    m_pComputeContext(pComputeContext),
     m_pEngineFactory(pEngineFactory),
-    m_pSwapChain(pSwapChain) // Guardar el SwapChain
+    m_pSwapChain(pSwapChain), // Guardar el SwapChain
+    m_GridSize(GridSize)
 {
+    m_ImmediateContextMask = Uint64{1} << m_pContext->GetDesc().ContextId;
+    if (m_pComputeContext)
+        m_ImmediateContextMask |= Uint64{1} << m_pComputeContext->GetDesc().ContextId;
+
     try
     {
         CreateConstantsBuffer();
         CreateTextures();
         CreatePipelines();
+        CreateFences();
     }
     catch (const std::exception& e)
     {
@@ -29,9 +43,105 @@ Tutorial14_FluidSimulation::Tutorial14_FluidSimulation(IRenderDevice*  pDevice,
     }
 }
 
+void Tutorial14_FluidSimulation::SetGridSize(Uint32 GridSize)
+{
+    // Las texturas de velocidad dependen del tamao de la rejilla, as que se recrean
+    // desde cero. Esto tambin reinicia el campo y la fuerza, de modo que dos llamadas
+    // con el mismo tamao producen simulaciones idnticas.
+    WaitForAsyncStep();
+
+    m_GridSize     = GridSize;
+    m_Timer        = 0.0f;
+    m_LastForcePos = float2(0, 0);
+
+    m_pVelocityTexture1.Release();
+    m_pVelocityTexture2.Release();
+    for (auto& pTexture : m_pPublishedVelocityTexture)
+        pTexture.Release();
+    m_pMomentumBuffer.Release();
+    CreateTextures();
+
+    // Los SRBs del pase de fuerza y del depsito referencian el acumulador del momento
+    if (m_pForceSRB || m_pCouplingSRB)
+        RecreateShaderResourceBindings();
+}
+
+void Tutorial14_FluidSimulation::ShiftWindow(const int2& Offset)
+{
+    T14_TRACE_SCOPE("FluidSimulation::ShiftWindow");
+
+    if (Offset.x == 0 && Offset.y == 0)
+        return;
+
+    if (!m_pWindowShiftSRB || !m_pFrameAllocator)
+    {
+        LOG_ERROR_MESSAGE("Fluid window shift is not available; the velocity field is not moved");
+        return;
+    }
+
+    // El paso asncrono en curso escribe las texturas del solver
+    WaitForAsyncStep();
+
+    WindowShiftConstants Constants;
+    Constants.i2Offset   = Offset;
+    Constants.i2Padding0 = int2(0, 0);
+    m_pWindowShiftSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "cbWindowShiftConstants")->SetBufferOffset(m_pFrameAllocator->Allocate(Constants));
+
+    // Tras Render() el resultado est en la textura anterior; el pase escribe en la otra el
+    // campo desplazado, con ceros en lo que entra en la ventana, y se intercambian
+    DispatchSolverPass(m_pContext, m_pWindowShiftPSO, m_pWindowShiftSRB, m_pPreviousVelocitySRV, m_pCurrentVelocityUAV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    SwapVelocityTextures();
+
+    if (m_bAsyncCompute)
+        PublishFromGraphicsQueue();
+}
+
+Tutorial14_FluidSimulation::State Tutorial14_FluidSimulation::GetState() const
+{
+    // El hilo de simulacin intercambia las texturas del solver
+    if (m_pSimulationThread)
+        m_pSimulationThread->WaitIdle();
+
+    State FluidState;
+    FluidState.GridSize            = m_GridSize;
+    FluidState.CurrentTextureIndex = m_CurrentTextureIndex;
+    FluidState.Timer               = m_Timer;
+    FluidState.LastForcePos        = m_LastForcePos;
+    return FluidState;
+}
+
+void Tutorial14_FluidSimulation::RestoreState(const State& FluidState, const void* pVelocityData1, const void* pVelocityData2)
+{
+    SetGridSize(FluidState.GridSize);
+
+    TextureSubResData SubResData;
+    SubResData.Stride = m_GridSize * 2 * sizeof(float);
+
+    Box UpdateBox;
+    UpdateBox.MaxX = m_GridSize;
+    UpdateBox.MaxY = m_GridSize;
+
+    SubResData.pData = pVelocityData1;
+    m_pContext->UpdateTexture(m_pVelocityTexture1, 0, 0, UpdateBox, SubResData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    SubResData.pData = pVelocityData2;
+    m_pContext->UpdateTexture(m_pVelocityTexture2, 0, 0, UpdateBox, SubResData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    // SetGridSize() deja activa la primera textura
+    if (FluidState.CurrentTextureIndex != m_CurrentTextureIndex)
+        SwapVelocityTextures();
+
+    m_Timer        = FluidState.Timer;
+    m_LastForcePos = FluidState.LastForcePos;
+
+    if (m_bAsyncCompute)
+        PublishFromGraphicsQueue();
+}
+
 // Definir el destructor correctamente
 Tutorial14_FluidSimulation::~Tutorial14_FluidSimulation()
 {
+    WaitForAsyncStep();
+
     // Los recursos se liberan automticamente por RefCntAutoPtr
     LOG_INFO_MESSAGE("Tutorial14_FluidSimulation destroyed");
 }
@@ -39,28 +149,29 @@ Tutorial14_FluidSimulation::~Tutorial14_FluidSimulation()
 // Inicializacin mejorada del campo de velocidad
 void Tutorial14_FluidSimulation::CreateTextures()
 {
+    T14_TRACE_SCOPE("FluidSimulation::CreateTextures");
+
     // Crear textura de velocidad con valores iniciales
     TextureDesc VelocityTexDesc;
     VelocityTexDesc.Name                = "Velocity texture 1";
     VelocityTexDesc.Type                = RESOURCE_DIM_TEX_2D;
-    VelocityTexDesc.Width               = GRID_SIZE;
-    VelocityTexDesc.Height              = GRID_SIZE;
-    VelocityTexDesc.Format              = VELOCITY_FORMAT;
-    VelocityTexDesc.BindFlags           = BIND_SHADER_RESOURCE | BIND_RENDER_TARGET;
-    VelocityTexDesc.ClearValue.Format   = VELOCITY_FORMAT;
-    VelocityTexDesc.ClearValue.Color[0] = 0.0f;
-    VelocityTexDesc.ClearValue.Color[1] = 0.0f;
+    VelocityTexDesc.Width               = m_GridSize;
+    VelocityTexDesc.Height              = m_GridSize;
+    VelocityTexDesc.Format               = VELOCITY_FORMAT;
+    VelocityTexDesc.BindFlags            = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    VelocityTexDesc.ImmediateContextMask = m_ImmediateContextMask;
 
     // Inicializar con patrones de fluido ms diversos
-    std::vector<float> InitialVelocityData(GRID_SIZE * GRID_SIZE * 2, 0.0f);
+    std::vector<float> InitialVelocityData(m_GridSize * m_GridSize * 2, 0.0f);
 
     // Crear diferentes estructuras de flujo para diversidad de colores
-    for (int y = 0; y < GRID_SIZE; y++)
+    const int GridSize = static_cast<int>(m_GridSize);
+    for (int y = 0; y < GridSize; y++)
     {
-        for (int x = 0; x < GRID_SIZE; x++)
+        for (int x = 0; x < GridSize; x++)
         {
-            float fx = static_cast<float>(x) / GRID_SIZE;
-            float fy = static_cast<float>(y) / GRID_SIZE;
+            float fx = static_cast<float>(x) / m_GridSize;
+            float fy = static_cast<float>(y) / m_GridSize;
 
             // Centro normalizado
             float nx = fx - 0.5f;
@@ -127,7 +238,7 @@ void Tutorial14_FluidSimulation::CreateTextures()
             float vy = vy1 + vy2 + vy3 + vy4 + vy5;
 
             // Almacenar el resultado
-            int index                      = (y * GRID_SIZE + x) * 2;
+            int index                      = (y * GridSize + x) * 2;
             InitialVelocityData[index]     = vx;
             InitialVelocityData[index + 1] = vy;
         }
@@ -136,7 +247,7 @@ void Tutorial14_FluidSimulation::CreateTextures()
     TextureData       InitData;
     TextureSubResData SubResData;
     SubResData.pData         = InitialVelocityData.data();
-    SubResData.Stride        = GRID_SIZE * 2 * sizeof(float);
+    SubResData.Stride        = m_GridSize * 2 * sizeof(float);
     InitData.pSubResources   = &SubResData;
     InitData.NumSubresources = 1;
 
@@ -147,29 +258,70 @@ void Tutorial14_FluidSimulation::CreateTextures()
     VelocityTexDesc.Name = "Velocity texture 2";
     m_pDevice->CreateTexture(VelocityTexDesc, &InitData, &m_pVelocityTexture2);
 
+    // Campos publicados por la cola de cmputo; la cola grfica solo los lee
+    if (m_pComputeContext)
+    {
+        VelocityTexDesc.BindFlags = BIND_SHADER_RESOURCE;
+        static constexpr const char* PublishedNames[NUM_PUBLISHED_FIELDS] = {"Published velocity texture 0", "Published velocity texture 1", "Published velocity texture 2"};
+        for (Uint32 i = 0; i < NUM_PUBLISHED_FIELDS; ++i)
+        {
+            VelocityTexDesc.Name = PublishedNames[i];
+            m_pDevice->CreateTexture(VelocityTexDesc, &InitData, &m_pPublishedVelocityTexture[i]);
+            if (!m_pPublishedVelocityTexture[i])
+            {
+                LOG_ERROR_MESSAGE("Failed to create published velocity textures");
+                throw std::runtime_error("Failed to create published velocity textures");
+            }
+            m_pPublishedVelocitySRV[i]      = m_pPublishedVelocityTexture[i]->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+            m_PublishedReleaseFenceValue[i] = m_GraphicsFenceValue;
+        }
+        m_PublishedIndex   = 0;
+        m_LastWrittenIndex = 0;
+    }
+
+    // Acumulador del momento de las partculas; el pase de fuerza lo deja a cero tras leerlo
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "Particle momentum buffer";
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(ParticleMomentum);
+        BuffDesc.Size              = Uint64{sizeof(ParticleMomentum)} * m_GridSize * m_GridSize;
+
+        std::vector<ParticleMomentum> ZeroMomentum(m_GridSize * m_GridSize);
+        BufferData                    MomentumData{ZeroMomentum.data(), BuffDesc.Size};
+        m_pDevice->CreateBuffer(BuffDesc, &MomentumData, &m_pMomentumBuffer);
+        if (!m_pMomentumBuffer)
+        {
+            LOG_ERROR_MESSAGE("Failed to create particle momentum buffer");
+            throw std::runtime_error("Failed to create particle momentum buffer");
+        }
+    }
+
     // Inicializar punteros a vistas de textura
     if (m_pVelocityTexture1 && m_pVelocityTexture2)
     {
         // Configurar vistas iniciales
-        ITextureView* pRTV1 = m_pVelocityTexture1->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+        ITextureView* pUAV1 = m_pVelocityTexture1->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS);
         ITextureView* pSRV1 = m_pVelocityTexture1->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
-        ITextureView* pRTV2 = m_pVelocityTexture2->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET);
+        ITextureView* pUAV2 = m_pVelocityTexture2->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS);
         ITextureView* pSRV2 = m_pVelocityTexture2->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
 
         // Inicializar al primer buffer como "actual"
         m_CurrentTextureIndex  = 0;
-        m_pCurrentVelocityRTV  = pRTV1;
+        m_pCurrentVelocityUAV  = pUAV1;
         m_pCurrentVelocitySRV  = pSRV1;
         m_pPreviousVelocitySRV = pSRV2;
 
         // Guardar vistas para referencia posterior
-        m_pVelocityRTV1 = pRTV1;
+        m_pVelocityUAV1 = pUAV1;
         m_pVelocitySRV1 = pSRV1;
-        m_pVelocityRTV2 = pRTV2;
+        m_pVelocityUAV2 = pUAV2;
         m_pVelocitySRV2 = pSRV2;
 
         // Mantener compatibilidad con cdigo existente
-        m_pVelocityRTV = m_pCurrentVelocityRTV;
+        m_pVelocityUAV = m_pCurrentVelocityUAV;
         m_pVelocitySRV = m_pCurrentVelocitySRV;
     }
     else
@@ -181,32 +333,23 @@ void Tutorial14_FluidSimulation::CreateTextures()
 
 void Tutorial14_FluidSimulation::CreateConstantsBuffer()
 {
-    struct FluidShaderConstants
-    {
-        float TimeStep;
-        float Viscosity;
-        float GridScale;
-        float Padding0;
-
-        float2 InverseGridSize;
-        float2 ForcePosition;
-
-        float2 ForceVector;
-        float  ForceRadius;
-        float  Padding1;
-    };
+    // Las constantes de la cola grfica se escriben en el asignador de frame. Los bferes
+    // dinmicos solo pueden mapearse en el contexto que los usa, as que el paso asncrono
+    // tiene el suyo.
+    if (!m_pComputeContext)
+        return;
 
     BufferDesc BuffDesc;
-    BuffDesc.Name           = "Fluid constants buffer";
-    BuffDesc.Usage          = USAGE_DYNAMIC;
-    BuffDesc.BindFlags      = BIND_UNIFORM_BUFFER;
-    BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
-    BuffDesc.Size           = sizeof(FluidShaderConstants);
-
-    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pConstantsBuffer);
-    if (!m_pConstantsBuffer)
+    BuffDesc.Name                 = "Async fluid constants buffer";
+    BuffDesc.Usage                = USAGE_DYNAMIC;
+    BuffDesc.BindFlags            = BIND_UNIFORM_BUFFER;
+    BuffDesc.CPUAccessFlags       = CPU_ACCESS_WRITE;
+    BuffDesc.Size                 = sizeof(FluidShaderConstants);
+    BuffDesc.ImmediateContextMask = Uint64{1} << m_pComputeContext->GetDesc().ContextId;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pAsyncConstantsBuffer);
+    if (!m_pAsyncConstantsBuffer)
     {
-        LOG_ERROR_MESSAGE("Failed to create fluid constants buffer");
+        LOG_ERROR_MESSAGE("Failed to create async fluid constants buffer");
     }
 }
 
@@ -222,6 +365,160 @@ void Tutorial14_FluidSimulation::CreatePipelines()
     ShaderCI.Desc.UseCombinedTextureSamplers = true;
     ShaderCI.pShaderSourceStreamFactory      = pShaderSourceFactory;
 
+    SamplerDesc LinearClampSampler;
+    LinearClampSampler.MinFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.MagFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.MipFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.AddressU  = TEXTURE_ADDRESS_CLAMP;
+    LinearClampSampler.AddressV  = TEXTURE_ADDRESS_CLAMP;
+    LinearClampSampler.AddressW  = TEXTURE_ADDRESS_CLAMP;
+
+    // Pases de fuerza y adveccin. La variante asncrona se crea para la cola de cmputo
+    // y no lee el intervalo adaptativo, que vive en la cola grfica.
+    {
+        ComputePipelineStateCreateInfo PSOCreateInfo;
+        PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+        PSODesc.PipelineType                       = PIPELINE_TYPE_COMPUTE;
+        PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+        // clang-format off
+        ShaderResourceVariableDesc Vars[] = 
+        {
+            // Esttica en la variante asncrona; mutable en la sncrona, que la enlaza al asignador de frame
+            {SHADER_TYPE_COMPUTE, "cbFluidConstants",  SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+            {SHADER_TYPE_COMPUTE, "g_TimeStep",        SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+            // Las texturas de entrada y salida alternan en cada pase
+            {SHADER_TYPE_COMPUTE, "g_VelocityTexture", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC},
+            {SHADER_TYPE_COMPUTE, "g_OutVelocity",     SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}
+        };
+        // clang-format on
+        PSODesc.ResourceLayout.Variables    = Vars;
+        PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+        ImmutableSamplerDesc ImtblSamplers[] = {{SHADER_TYPE_COMPUTE, "g_VelocityTexture", LinearClampSampler}};
+        PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+        PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.FilePath        = "fluid_solver.csh";
+
+        auto CreatePSO = [&](int Pass, bool bAsync, const char* Name, RefCntAutoPtr<IPipelineState>& pPSO, RefCntAutoPtr<IShaderResourceBinding>& pSRB) {
+            ShaderMacroHelper Macros;
+            Macros.AddShaderMacro("FLUID_GROUP_SIZE", static_cast<int>(FLUID_GROUP_SIZE));
+            Macros.AddShaderMacro("FLUID_PASS", Pass);
+            Macros.AddShaderMacro("ADAPTIVE_TIME_STEP", bAsync ? 0 : 1);
+            Macros.AddShaderMacro("PARTICLE_COUPLING", Pass == 0 && !bAsync ? 1 : 0);
+            ShaderCI.Macros    = Macros;
+            ShaderCI.Desc.Name = Name;
+            Vars[0].Type       = bAsync ? SHADER_RESOURCE_VARIABLE_TYPE_STATIC : SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+            RefCntAutoPtr<IShader> pCS;
+            m_pDevice->CreateShader(ShaderCI, &pCS);
+            if (!pCS)
+            {
+                LOG_ERROR_MESSAGE("Failed to create shader ", Name);
+                return;
+            }
+
+            PSODesc.Name                 = Name;
+            PSODesc.ImmediateContextMask = bAsync ? Uint64{1} << m_pComputeContext->GetDesc().ContextId : Uint64{1} << m_pContext->GetDesc().ContextId;
+            PSOCreateInfo.pCS            = pCS;
+            m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+            if (!pPSO)
+            {
+                LOG_ERROR_MESSAGE("Failed to create PSO ", Name);
+                return;
+            }
+
+            // El SRB del paso sncrono se crea en RecreateShaderResourceBindings(), cuando
+            // ya se conoce el bfer del intervalo adaptativo
+            if (bAsync)
+            {
+                pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "cbFluidConstants")->Set(m_pAsyncConstantsBuffer);
+                pPSO->CreateShaderResourceBinding(&pSRB, true);
+            }
+        };
+
+        CreatePSO(0, false, "Fluid force CS", m_pForcePSO, m_pForceSRB);
+        CreatePSO(1, false, "Fluid advection CS", m_pAdvectionPSO, m_pAdvectionSRB);
+        if (m_pComputeContext)
+        {
+            CreatePSO(0, true, "Async fluid force CS", m_pAsyncForcePSO, m_pAsyncForceSRB);
+            CreatePSO(1, true, "Async fluid advection CS", m_pAsyncAdvectionPSO, m_pAsyncAdvectionSRB);
+        }
+    }
+
+    // Desplazamiento de la ventana del campo. El SRB se crea en RecreateShaderResourceBindings(),
+    // que enlaza las constantes al asignador de frame.
+    {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("FLUID_GROUP_SIZE", static_cast<int>(FLUID_GROUP_SIZE));
+
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Fluid window shift CS";
+        ShaderCI.FilePath        = "fluid_window_shift.csh";
+        ShaderCI.Macros          = Macros;
+
+        RefCntAutoPtr<IShader> pWindowShiftCS;
+        m_pDevice->CreateShader(ShaderCI, &pWindowShiftCS);
+        if (pWindowShiftCS)
+        {
+            ComputePipelineStateCreateInfo PSOCreateInfo;
+            PSOCreateInfo.PSODesc.Name                               = "Fluid window shift PSO";
+            PSOCreateInfo.PSODesc.PipelineType                       = PIPELINE_TYPE_COMPUTE;
+            PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+            // Las texturas de entrada y salida alternan, como en los pases del solver
+            // clang-format off
+            ShaderResourceVariableDesc Vars[] =
+            {
+                {SHADER_TYPE_COMPUTE, "g_VelocityTexture", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC},
+                {SHADER_TYPE_COMPUTE, "g_OutVelocity",     SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}
+            };
+            // clang-format on
+            PSOCreateInfo.PSODesc.ResourceLayout.Variables    = Vars;
+            PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+            PSOCreateInfo.pCS = pWindowShiftCS;
+            m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pWindowShiftPSO);
+        }
+
+        if (!m_pWindowShiftPSO)
+            LOG_ERROR_MESSAGE("Failed to create fluid window shift PSO");
+    }
+
+    // Depsito del momento de las partculas. El SRB se crea en RecreateShaderResourceBindings()
+    // cuando se conocen los bferes de las partculas.
+    {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("COUPLING_TILE_SIZE", static_cast<int>(COUPLING_TILE_SIZE));
+
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_COMPUTE;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Fluid coupling CS";
+        ShaderCI.FilePath        = "fluid_coupling.csh";
+        ShaderCI.Macros          = Macros;
+
+        RefCntAutoPtr<IShader> pCouplingCS;
+        m_pDevice->CreateShader(ShaderCI, &pCouplingCS);
+        if (pCouplingCS)
+        {
+            ComputePipelineStateCreateInfo PSOCreateInfo;
+            PSOCreateInfo.PSODesc.Name                               = "Fluid coupling PSO";
+            PSOCreateInfo.PSODesc.PipelineType                       = PIPELINE_TYPE_COMPUTE;
+            PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+            PSOCreateInfo.pCS = pCouplingCS;
+            m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pCouplingPSO);
+        }
+
+        if (!m_pCouplingPSO)
+            LOG_ERROR_MESSAGE("Failed to create fluid coupling PSO; particles will not affect the fluid");
+    }
+
     // Vertex shader fullscreen quad
     RefCntAutoPtr<IShader> pFullScreenQuadVS;
     {
@@ -229,6 +526,7 @@ void Tutorial14_FluidSimulation::CreatePipelines()
         ShaderCI.EntryPoint      = "main";
         ShaderCI.Desc.Name       = "Full-screen quad VS";
         ShaderCI.FilePath        = "FluidVertexShader.fx";
+        ShaderCI.Macros          = {};
         m_pDevice->CreateShader(ShaderCI, &pFullScreenQuadVS);
         if (!pFullScreenQuadVS)
         {
@@ -237,240 +535,213 @@ void Tutorial14_FluidSimulation::CreatePipelines()
         }
     }
 
-    // Pixel shader para adveccin
-    RefCntAutoPtr<IShader> pAdvectionPS;
+    // Pixel shaders para visualizacin: colores de la rejilla y composicin en pantalla
+    RefCntAutoPtr<IShader> pVisualizationColorsPS;
+    RefCntAutoPtr<IShader> pVisualizationPS;
     {
         ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
         ShaderCI.EntryPoint      = "main";
-        ShaderCI.Desc.Name       = "Advection PS";
-        ShaderCI.FilePath        = "FluidPixelShader.fx";
-        m_pDevice->CreateShader(ShaderCI, &pAdvectionPS);
-        if (!pAdvectionPS)
+        ShaderCI.FilePath        = "FluidVisualizationShader.fx";
+
+        ShaderMacroHelper ColorsMacros;
+        ColorsMacros.AddShaderMacro("FLUID_VISUALIZATION_PASS", 0);
+        ShaderCI.Desc.Name = "Visualization colors PS";
+        ShaderCI.Macros    = ColorsMacros;
+        m_pDevice->CreateShader(ShaderCI, &pVisualizationColorsPS);
+
+        ShaderMacroHelper CompositeMacros;
+        CompositeMacros.AddShaderMacro("FLUID_VISUALIZATION_PASS", 1);
+        ShaderCI.Desc.Name = "Visualization PS";
+        ShaderCI.Macros    = CompositeMacros;
+        m_pDevice->CreateShader(ShaderCI, &pVisualizationPS);
+        if (!pVisualizationColorsPS || !pVisualizationPS)
         {
-            LOG_ERROR_MESSAGE("Failed to create advection pixel shader");
+            LOG_ERROR_MESSAGE("Failed to create visualization pixel shader");
             return;
         }
     }
 
-    // Pixel shader para fuerzas
-    RefCntAutoPtr<IShader> pForcePS;
+    // PSO de los colores de la rejilla: se dibuja sin mezcla en una textura temporal del grafo
     {
-        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
-        ShaderCI.EntryPoint      = "main";
-        ShaderCI.Desc.Name       = "Force PS";
-        ShaderCI.FilePath        = "FluidForceShader.fx";
-        m_pDevice->CreateShader(ShaderCI, &pForcePS);
-        if (!pForcePS)
+        GraphicsPipelineStateCreateInfo PSOCreateInfo;
+        PSOCreateInfo.PSODesc.Name         = "Visualization colors PSO";
+        PSOCreateInfo.PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
+
+        PSOCreateInfo.pVS = pFullScreenQuadVS;
+        PSOCreateInfo.pPS = pVisualizationColorsPS;
+
+        auto& GraphicsPipeline                  = PSOCreateInfo.GraphicsPipeline;
+        GraphicsPipeline.PrimitiveTopology      = PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+        GraphicsPipeline.NumRenderTargets       = 1;
+        GraphicsPipeline.RTVFormats[0]          = VISUALIZATION_COLORS_FORMAT;
+        GraphicsPipeline.DSVFormat              = TEX_FORMAT_UNKNOWN;
+        GraphicsPipeline.RasterizerDesc.CullMode = CULL_MODE_NONE;
+
+        PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+        // La textura visualizada cambia con cada intercambio y, en modo asncrono, cada frame
+        ShaderResourceVariableDesc ColorsVars[] = {{SHADER_TYPE_PIXEL, "g_VelocityTexture", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}};
+        PSOCreateInfo.PSODesc.ResourceLayout.Variables    = ColorsVars;
+        PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(ColorsVars);
+
+        m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pVisualizationColorsPSO);
+        if (!m_pVisualizationColorsPSO)
         {
-            LOG_ERROR_MESSAGE("Failed to create force pixel shader");
+            LOG_ERROR_MESSAGE("Failed to create visualization colors PSO");
             return;
         }
+        m_pVisualizationColorsPSO->CreateShaderResourceBinding(&m_pVisualizationColorsSRB, true);
     }
 
-    // Configurar PSO para adveccin
+    // Configurar PSO para visualizacin
     GraphicsPipelineStateCreateInfo PSOCreateInfo;
-    PSOCreateInfo.PSODesc.Name         = "Advection PSO";
+    PSOCreateInfo.PSODesc.Name         = "Visualization PSO";
     PSOCreateInfo.PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
 
     PSOCreateInfo.pVS = pFullScreenQuadVS;
-    PSOCreateInfo.pPS = pAdvectionPS;
+    PSOCreateInfo.pPS = pVisualizationPS;
 
     auto& GraphicsPipeline             = PSOCreateInfo.GraphicsPipeline;
     GraphicsPipeline.PrimitiveTopology = PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
     GraphicsPipeline.NumRenderTargets  = 1;
-    GraphicsPipeline.RTVFormats[0]     = VELOCITY_FORMAT;
+    GraphicsPipeline.RTVFormats[0]     = m_pSwapChain->GetDesc().ColorBufferFormat;
     GraphicsPipeline.DSVFormat         = TEX_FORMAT_UNKNOWN;
 
-    auto& BlendDesc                        = GraphicsPipeline.BlendDesc;
-    BlendDesc.RenderTargets[0].BlendEnable = False;
-
     auto& RasterizerDesc    = GraphicsPipeline.RasterizerDesc;
     RasterizerDesc.CullMode = CULL_MODE_NONE;
 
-    PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
-
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pAdvectionPSO);
-
-    if (m_pAdvectionPSO)
-    {
-        m_pAdvectionPSO->CreateShaderResourceBinding(&m_pAdvectionSRB, true);
-
-        if (m_pVelocitySRV && m_pAdvectionSRB)
-        {
-            auto* pVelocityVar = m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-            if (pVelocityVar)
-            {
-                pVelocityVar->Set(m_pVelocitySRV);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'g_VelocityTexture' not found in advection shader");
-            }
-
-            // Configurar sampler para adveccin
-            SamplerDesc SamDesc;
-            SamDesc.MinFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MagFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MipFilter = FILTER_TYPE_LINEAR;
-            SamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressW  = TEXTURE_ADDRESS_CLAMP;
-
-            RefCntAutoPtr<ISampler> pSampler;
-            m_pDevice->CreateSampler(SamDesc, &pSampler);
-
-            auto* pSamplerVar = m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
-            if (pSamplerVar)
-            {
-                pSamplerVar->Set(pSampler);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'g_LinearSampler' not found in advection shader");
-            }
+    // Habilitar blending para la visualizacin
+    auto& BlendDesc                        = GraphicsPipeline.BlendDesc;
+    BlendDesc.RenderTargets[0].BlendEnable = True;
+    BlendDesc.RenderTargets[0].SrcBlend    = BLEND_FACTOR_SRC_ALPHA;
+    BlendDesc.RenderTargets[0].DestBlend   = BLEND_FACTOR_INV_SRC_ALPHA;
 
-            // Vincular buffer de constantes
-            auto* pConstantsVar = m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbFluidConstants");
-            if (pConstantsVar)
-            {
-                pConstantsVar->Set(m_pConstantsBuffer);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'cbFluidConstants' not found in advection shader");
-            }
-        }
-    }
-    else
-    {
-        LOG_ERROR_MESSAGE("Failed to create advection PSO");
-    }
+    PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
 
-    // Configurar PSO para fuerzas
-    PSOCreateInfo.PSODesc.Name = "Force PSO";
-    PSOCreateInfo.pPS          = pForcePS;
+    // La textura temporal de colores puede ser otra textura fsica en cada frame
+    ShaderResourceVariableDesc VisualizationVars[] = {{SHADER_TYPE_PIXEL, "g_VisualizationColors", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}};
+    PSOCreateInfo.PSODesc.ResourceLayout.Variables    = VisualizationVars;
+    PSOCreateInfo.PSODesc.ResourceLayout.NumVariables = _countof(VisualizationVars);
 
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pForcePSO);
+    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pVisualizationPSO);
 
-    if (m_pForcePSO)
+    if (m_pVisualizationPSO)
     {
-        m_pForcePSO->CreateShaderResourceBinding(&m_pForceSRB, true);
-
-        if (m_pVelocitySRV && m_pForceSRB)
-        {
-            auto* pVelocityVar = m_pForceSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-            if (pVelocityVar)
-            {
-                pVelocityVar->Set(m_pVelocitySRV);
-            }
-
-            // Configurar sampler para fuerzas
-            SamplerDesc SamDesc;
-            SamDesc.MinFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MagFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MipFilter = FILTER_TYPE_LINEAR;
-            SamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressW  = TEXTURE_ADDRESS_CLAMP;
-
-            RefCntAutoPtr<ISampler> pSampler;
-            m_pDevice->CreateSampler(SamDesc, &pSampler);
-
-            auto* pSamplerVar = m_pForceSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
-            if (pSamplerVar)
-            {
-                pSamplerVar->Set(pSampler);
-            }
-
-            // Vincular buffer de constantes
-            auto* pConstantsVar = m_pForceSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbFluidConstants");
-            if (pConstantsVar)
-            {
-                pConstantsVar->Set(m_pConstantsBuffer);
-            }
-        }
+        // El SRB se crea en RecreateShaderResourceBindings(), que enlaza las constantes
+        m_pDevice->CreateSampler(LinearClampSampler, &m_pLinearSampler);
     }
     else
     {
-        LOG_ERROR_MESSAGE("Failed to create force PSO");
+        LOG_ERROR_MESSAGE("Failed to create visualization PSO");
     }
+}
 
-    // Pixel shader para visualizacin
-    RefCntAutoPtr<IShader> pVisualizationPS;
+void Tutorial14_FluidSimulation::CreateFences()
+{
+    if (!m_pComputeContext)
+        return;
+
+    // Las dos colas esperan en la GPU a la valla de la otra
+    FenceDesc Desc;
+    Desc.Type = FENCE_TYPE_GENERAL;
+
+    Desc.Name = "Fluid compute fence";
+    m_pDevice->CreateFence(Desc, &m_pComputeFence);
+    Desc.Name = "Fluid graphics fence";
+    m_pDevice->CreateFence(Desc, &m_pGraphicsFence);
+    if (!m_pComputeFence || !m_pGraphicsFence)
     {
-        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
-        ShaderCI.EntryPoint      = "main";
-        ShaderCI.Desc.Name       = "Visualization PS";
-        ShaderCI.FilePath        = "FluidVisualizationShader.fx";
-        m_pDevice->CreateShader(ShaderCI, &pVisualizationPS);
-        if (!pVisualizationPS)
-        {
-            LOG_ERROR_MESSAGE("Failed to create visualization pixel shader");
-            return;
-        }
+        LOG_ERROR_MESSAGE("Failed to create fluid fences; async compute is disabled");
+        m_pComputeContext = nullptr;
+        return;
     }
 
-    // Configurar PSO para visualizacin
-    PSOCreateInfo.PSODesc.Name = "Visualization PSO";
-    PSOCreateInfo.pPS          = pVisualizationPS;
-
-    // Habilitar blending para la visualizacin
-    BlendDesc.RenderTargets[0].BlendEnable = True;
-    BlendDesc.RenderTargets[0].SrcBlend    = BLEND_FACTOR_SRC_ALPHA;
-    BlendDesc.RenderTargets[0].DestBlend   = BLEND_FACTOR_INV_SRC_ALPHA;
-
-    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pVisualizationPSO);
+    m_pSimulationThread = std::make_unique<Tutorial14_ThreadPool>(1, "Fluid simulation");
+}
 
-    if (m_pVisualizationPSO)
-    {
-        m_pVisualizationPSO->CreateShaderResourceBinding(&m_pVisualizationSRB, true);
+void Tutorial14_FluidSimulation::AddVisualizationPass(Tutorial14_FrameGraph& Graph,
+                                                      ITextureView*          pRTV,
+                                                      const float2&          f2ViewCenter,
+                                                      float                  fViewZoom,
+                                                      const float2&          f2FluidWindowCenter)
+{
+    if (!m_pVisualizationPSO || !m_pVisualizationSRB || !m_pVisualizationColorsSRB || !pRTV || !m_pFrameAllocator)
+        return;
+
+    VisualizationConstants Constants;
+    Constants.f2ViewCenter        = f2ViewCenter;
+    Constants.f2FluidWindowCenter = f2FluidWindowCenter;
+    Constants.fViewZoom           = fViewZoom;
+    const Uint32 ConstantsOffset  = m_pFrameAllocator->Allocate(Constants);
+
+    // Los colores solo viven entre los dos pases: textura temporal del grafo, que la
+    // comparte con otras temporales compatibles que no se solapen con ella
+    TextureDesc ColorsDesc;
+    ColorsDesc.Name      = "Fluid visualization colors";
+    ColorsDesc.Type      = RESOURCE_DIM_TEX_2D;
+    ColorsDesc.Width     = m_GridSize;
+    ColorsDesc.Height    = m_GridSize;
+    ColorsDesc.Format    = VISUALIZATION_COLORS_FORMAT;
+    ColorsDesc.BindFlags = BIND_RENDER_TARGET | BIND_SHADER_RESOURCE;
+    const auto ColorsId  = Graph.CreateTransientTexture(ColorsDesc);
+
+    Graph.AddDeferredPass("Fluid visualization colors",
+                          {
+                              {Graph.ImportTexture(GetVelocitySRV()->GetTexture()), RESOURCE_STATE_SHADER_RESOURCE},
+                              {ColorsId, RESOURCE_STATE_RENDER_TARGET},
+                          },
+                          [this, &Graph, ColorsId](IDeviceContext* pCtx) {
+                              if (ITexture* pColors = Graph.GetTexture(ColorsId))
+                                  RenderVisualizationColors(pCtx, pColors->GetDefaultView(TEXTURE_VIEW_RENDER_TARGET), Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+                          });
+
+    Graph.AddDeferredPass("Fluid visualization",
+                          {
+                              {ColorsId, RESOURCE_STATE_SHADER_RESOURCE},
+                              {Graph.ImportTexture(pRTV->GetTexture()), RESOURCE_STATE_RENDER_TARGET},
+                          },
+                          [this, &Graph, ColorsId, pRTV, ConstantsOffset](IDeviceContext* pCtx) {
+                              if (ITexture* pColors = Graph.GetTexture(ColorsId))
+                                  RenderFluidVisualization(pCtx, pColors->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE), pRTV, ConstantsOffset, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+                          });
+}
 
-        if (m_pVelocitySRV && m_pVisualizationSRB)
-        {
-            auto* pVelocityVar = m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-            if (pVelocityVar)
-            {
-                pVelocityVar->Set(m_pVelocitySRV);
-            }
+void Tutorial14_FluidSimulation::RenderVisualizationColors(IDeviceContext* pCtx, ITextureView* pColorsRTV, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode)
+{
+    pCtx->SetRenderTargets(1, &pColorsRTV, nullptr, StateTransitionMode);
 
-            // Configurar sampler para visualizacin
-            SamplerDesc SamDesc;
-            SamDesc.MinFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MagFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MipFilter = FILTER_TYPE_LINEAR;
-            SamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressW  = TEXTURE_ADDRESS_CLAMP;
+    m_pVisualizationColorsSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture")->Set(GetVelocitySRV());
+    pCtx->SetPipelineState(m_pVisualizationColorsPSO);
+    pCtx->CommitShaderResources(m_pVisualizationColorsSRB, StateTransitionMode);
 
-            RefCntAutoPtr<ISampler> pSampler;
-            m_pDevice->CreateSampler(SamDesc, &pSampler);
+    // Una celda de la rejilla por pxel
+    Viewport VP;
+    VP.Width    = static_cast<float>(m_GridSize);
+    VP.Height   = static_cast<float>(m_GridSize);
+    VP.MinDepth = 0.0f;
+    VP.MaxDepth = 1.0f;
+    pCtx->SetViewports(1, &VP, 0, 0);
 
-            auto* pSamplerVar = m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
-            if (pSamplerVar)
-            {
-                pSamplerVar->Set(pSampler);
-            }
-        }
-    }
-    else
-    {
-        LOG_ERROR_MESSAGE("Failed to create visualization PSO");
-    }
+    DrawAttribs drawAttrs;
+    drawAttrs.NumVertices = 4;
+    pCtx->Draw(drawAttrs);
 }
 
 // Ajustar el mtodo RenderFluidVisualization para cubrir mejor la pantalla
-void Tutorial14_FluidSimulation::RenderFluidVisualization(ITextureView* pRTV)
+void Tutorial14_FluidSimulation::RenderFluidVisualization(IDeviceContext* pCtx, ITextureView* pColorsSRV, ITextureView* pRTV, Uint32 ConstantsOffset, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode)
 {
     try
     {
         if (m_pVisualizationPSO && m_pVisualizationSRB && pRTV)
         {
             // Configurar render target con el RTV proporcionado
-            m_pContext->SetRenderTargets(1, &pRTV, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            pCtx->SetRenderTargets(1, &pRTV, nullptr, StateTransitionMode);
 
             // Establecer pipeline y recursos
-            m_pContext->SetPipelineState(m_pVisualizationPSO);
-            m_pContext->CommitShaderResources(m_pVisualizationSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+            m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VisualizationColors")->Set(pColorsSRV);
+            m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbVisualizationConstants")->SetBufferOffset(ConstantsOffset);
+            pCtx->SetPipelineState(m_pVisualizationPSO);
+            pCtx->CommitShaderResources(m_pVisualizationSRB, StateTransitionMode);
 
             // Obtener dimensiones exactas de la ventana
             float screenWidth  = static_cast<float>(m_pSwapChain->GetDesc().Width);
@@ -485,7 +756,7 @@ void Tutorial14_FluidSimulation::RenderFluidVisualization(ITextureView* pRTV)
             VP.TopLeftX = 0.0f;
             VP.TopLeftY = 0.0f;
 
-            m_pContext->SetViewports(1, &VP, 0, 0);
+            pCtx->SetViewports(1, &VP, 0, 0);
 
             // Asegurarse que las scissor rects tambin estn configuradas correctamente
             Rect scissorRect;
@@ -493,12 +764,12 @@ void Tutorial14_FluidSimulation::RenderFluidVisualization(ITextureView* pRTV)
             scissorRect.top    = 0;
             scissorRect.right  = static_cast<long>(screenWidth);
             scissorRect.bottom = static_cast<long>(screenHeight);
-            m_pContext->SetScissorRects(1, &scissorRect, 0, 0);
+            pCtx->SetScissorRects(1, &scissorRect, 0, 0);
 
             // Dibujar quad que cubra exactamente toda la pantalla
             DrawAttribs drawAttrs;
             drawAttrs.NumVertices = 4;
-            m_pContext->Draw(drawAttrs);
+            pCtx->Draw(drawAttrs);
         }
     }
     catch (const std::exception& e)
@@ -509,120 +780,237 @@ void Tutorial14_FluidSimulation::RenderFluidVisualization(ITextureView* pRTV)
 
 void Tutorial14_FluidSimulation::Update(float deltaTime, float simulationSpeed, float viscosity)
 {
+    T14_TRACE_SCOPE("FluidSimulation::Update");
+
     m_Timer += deltaTime;
 
-    // Actualizar buffer de constantes
-    if (m_pConstantsBuffer)
-    {
-        struct FluidShaderConstants
-        {
-            float TimeStep;
-            float Viscosity;
-            float GridScale;
-            float Padding0;
+    // Calcular posicin y fuerza circular con menor velocidad de cambio
+    float2 forcePos;
+    // Reducir la velocidad del movimiento de la fuerza
+    forcePos.x = sin(m_Timer * 0.3f) * 0.5f; // Reducido de 0.5 a 0.3
+    forcePos.y = cos(m_Timer * 0.3f) * 0.5f;
 
-            float2 InverseGridSize;
-            float2 ForcePosition;
+    float2 force;
+    if (m_LastForcePos.x != 0 || m_LastForcePos.y != 0)
+    {
+        // Reducir la magnitud de la fuerza
+        force = (forcePos - m_LastForcePos) * 3.0f; // Reducido de 5.0 a 3.0
+    }
+    else
+    {
+        force = float2(0.05f, 0.05f); // Reducido de 0.1 a 0.05
+    }
 
-            float2 ForceVector;
-            float  ForceRadius;
-            float  Padding1;
-        };
+    // Reducir el time step para el fluido para ralentizar el movimiento
+    m_Constants.TimeStep        = deltaTime * simulationSpeed * TIME_STEP_SCALE; // Factor adicional de 0.7
+    m_Constants.Viscosity       = viscosity * 1.5f;                              // Aumentar la viscosidad efectiva
+    m_Constants.GridScale       = 1.0f;
+    m_Constants.InverseGridSize = float2(1.0f / m_GridSize, 1.0f / m_GridSize);
+    m_Constants.ForcePosition   = forcePos;
+    m_Constants.ForceVector     = force;
+    m_Constants.ForceRadius     = 0.18f; // Aumentado de 0.15 a 0.18 para fuerzas ms suaves
+    // En modo adaptativo los shaders leen el intervalo de g_TimeStep y lo escalan por este factor
+    m_Constants.AdaptiveTimeStepScale = m_bAdaptiveTimeStep && !m_bAsyncCompute ? TIME_STEP_SCALE : 0.0f;
+    m_Constants.ParticleCoupling      = m_bAsyncCompute ? 0.0f : m_ParticleCoupling;
+
+    m_LastForcePos = forcePos;
+
+    // En modo asncrono las constantes se escriben en SubmitAsyncStep()
+    if (m_pFrameAllocator && !m_bAsyncCompute)
+    {
+        m_ConstantsOffset = m_pFrameAllocator->Allocate(m_Constants);
+    }
+}
 
-        // Calcular posicin y fuerza circular con menor velocidad de cambio
-        float2 forcePos;
-        // Reducir la velocidad del movimiento de la fuerza
-        forcePos.x = sin(m_Timer * 0.3f) * 0.5f; // Reducido de 0.5 a 0.3
-        forcePos.y = cos(m_Timer * 0.3f) * 0.5f;
+void Tutorial14_FluidSimulation::AddSolverPasses(Tutorial14_FrameGraph& Graph)
+{
+    T14_TRACE_SCOPE("FluidSimulation::AddSolverPasses");
+
+    if (m_bAsyncCompute || !m_pFrameAllocator || !m_pForceSRB || !m_pAdvectionSRB)
+        return;
+
+    // Cada pase intercambia las texturas al ejecutarse. Tras los dos pases los ndices
+    // vuelven a ser los actuales, as que los accesos se pueden declarar ya: la fuerza lee
+    // la textura anterior y escribe la actual, y la adveccin al revs.
+    const auto CurrentId  = Graph.ImportTexture(m_pCurrentVelocitySRV->GetTexture());
+    const auto PreviousId = Graph.ImportTexture(m_pPreviousVelocitySRV->GetTexture());
+    const auto TimeStepId = Graph.ImportBuffer(m_pTimeStepBuffer);
+
+    // Paso 1: Aplicar fuerzas al campo de velocidad (y el momento depositado por las partculas)
+    Graph.AddPass("Fluid force",
+                  {
+                      {PreviousId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {CurrentId, RESOURCE_STATE_UNORDERED_ACCESS},
+                      {TimeStepId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {Graph.ImportBuffer(m_pMomentumBuffer), RESOURCE_STATE_UNORDERED_ACCESS},
+                  },
+                  [this](IDeviceContext* pCtx) {
+                      m_pForceSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "cbFluidConstants")->SetBufferOffset(m_ConstantsOffset);
+                      DispatchSolverPass(pCtx, m_pForcePSO, m_pForceSRB, m_pPreviousVelocitySRV, m_pCurrentVelocityUAV, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+                      SwapVelocityTextures();
+                  });
+
+    // Paso 2: Adveccin del campo de velocidad
+    Graph.AddPass("Fluid advection",
+                  {
+                      {CurrentId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {PreviousId, RESOURCE_STATE_UNORDERED_ACCESS},
+                      {TimeStepId, RESOURCE_STATE_SHADER_RESOURCE},
+                  },
+                  [this](IDeviceContext* pCtx) {
+                      m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "cbFluidConstants")->SetBufferOffset(m_ConstantsOffset);
+                      DispatchSolverPass(pCtx, m_pAdvectionPSO, m_pAdvectionSRB, m_pPreviousVelocitySRV, m_pCurrentVelocityUAV, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+                      SwapVelocityTextures();
+                  });
+}
 
-        float2 force;
-        if (m_LastForcePos.x != 0 || m_LastForcePos.y != 0)
-        {
-            // Reducir la magnitud de la fuerza
-            force = (forcePos - m_LastForcePos) * 3.0f; // Reducido de 5.0 a 3.0
-        }
-        else
-        {
-            force = float2(0.05f, 0.05f); // Reducido de 0.1 a 0.05
-        }
+void Tutorial14_FluidSimulation::DispatchSolverPass(IDeviceContext*                pCtx,
+                                                    IPipelineState*                pPSO,
+                                                    IShaderResourceBinding*        pSRB,
+                                                    ITextureView*                  pInput,
+                                                    ITextureView*                  pOutput,
+                                                    RESOURCE_STATE_TRANSITION_MODE StateTransitionMode)
+{
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_VelocityTexture")->Set(pInput);
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutVelocity")->Set(pOutput);
 
-        MapHelper<FluidShaderConstants> Constants(m_pContext, m_pConstantsBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
-        // Reducir el time step para el fluido para ralentizar el movimiento
-        Constants->TimeStep        = deltaTime * simulationSpeed * 0.7f; // Factor adicional de 0.7
-        Constants->Viscosity       = viscosity * 1.5f;                   // Aumentar la viscosidad efectiva
-        Constants->GridScale       = 1.0f;
-        Constants->InverseGridSize = float2(1.0f / GRID_SIZE, 1.0f / GRID_SIZE);
-        Constants->ForcePosition   = forcePos;
-        Constants->ForceVector     = force;
-        Constants->ForceRadius     = 0.18f; // Aumentado de 0.15 a 0.18 para fuerzas ms suaves
+    pCtx->SetPipelineState(pPSO);
+    pCtx->CommitShaderResources(pSRB, StateTransitionMode);
 
-        m_LastForcePos = forcePos;
-    }
+    DispatchComputeAttribs DispatchAttribs;
+    DispatchAttribs.ThreadGroupCountX = (m_GridSize + FLUID_GROUP_SIZE - 1) / FLUID_GROUP_SIZE;
+    DispatchAttribs.ThreadGroupCountY = DispatchAttribs.ThreadGroupCountX;
+    pCtx->DispatchCompute(DispatchAttribs);
 }
 
-void Tutorial14_FluidSimulation::Render()
+void Tutorial14_FluidSimulation::SetAsyncCompute(bool bAsync)
 {
-    try
-    {
-        // Paso 1: Aplicar fuerzas al campo de velocidad
-        if (m_pForcePSO && m_pForceSRB && m_pCurrentVelocityRTV)
-        {
-            // Configurar render target - esto renderiza a la textura actual
-            ITextureView* pRTVs[] = {m_pCurrentVelocityRTV};
-            m_pContext->SetRenderTargets(1, pRTVs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    bAsync = bAsync && m_pComputeContext != nullptr && m_pAsyncForcePSO && m_pAsyncAdvectionPSO;
+    if (bAsync == m_bAsyncCompute)
+        return;
 
-            // Establecer pipeline y recursos
-            m_pContext->SetPipelineState(m_pForcePSO);
-            m_pContext->CommitShaderResources(m_pForceSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    if (bAsync)
+    {
+        // Las texturas del solver se han usado hasta ahora en la cola grfica
+        PublishFromGraphicsQueue();
+    }
+    else
+    {
+        // El paso sncrono contina desde el ltimo resultado de la cola de cmputo
+        m_pSimulationThread->WaitIdle();
+        m_pContext->DeviceWaitForFence(m_pComputeFence, m_ComputeFenceValue);
+    }
+    m_bAsyncCompute = bAsync;
+}
 
-            // Dibujar quad para aplicar fuerzas
-            DrawFullScreenQuad();
-        }
+void Tutorial14_FluidSimulation::PublishFromGraphicsQueue()
+{
+    // Tras Render() el resultado de la adveccin queda en la textura anterior
+    CopyTextureAttribs CopyAttribs;
+    CopyAttribs.pSrcTexture              = m_pPreviousVelocitySRV->GetTexture();
+    CopyAttribs.SrcTextureTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+    CopyAttribs.pDstTexture              = m_pPublishedVelocityTexture[m_LastWrittenIndex];
+    CopyAttribs.DstTextureTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+    m_pContext->CopyTexture(CopyAttribs);
+
+    StateTransitionDesc Barrier{m_pPublishedVelocityTexture[m_LastWrittenIndex], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE};
+    m_pContext->TransitionResourceStates(1, &Barrier);
+    m_PublishedIndex = m_LastWrittenIndex;
+
+    // La cola de cmputo no debe tocar las texturas hasta que termine esta copia
+    ReleaseToComputeQueue();
+}
 
-        // Intercambiar texturas tras aplicar fuerzas
-        SwapVelocityTextures();
+void Tutorial14_FluidSimulation::ReleaseToComputeQueue()
+{
+    m_pContext->EnqueueSignal(m_pGraphicsFence, ++m_GraphicsFenceValue);
+    for (auto& ReleaseValue : m_PublishedReleaseFenceValue)
+        ReleaseValue = m_GraphicsFenceValue;
+}
 
-        // Paso 2: Adveccin del campo de velocidad
-        if (m_pAdvectionPSO && m_pAdvectionSRB && m_pCurrentVelocityRTV)
-        {
-            // Configurar render target
-            ITextureView* pRTVs[] = {m_pCurrentVelocityRTV};
-            m_pContext->SetRenderTargets(1, pRTVs, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+void Tutorial14_FluidSimulation::SubmitAsyncStep(Uint32 NumSteps, AsyncStepCallback StepCallback)
+{
+    T14_TRACE_SCOPE("FluidSimulation::SubmitAsyncStep");
+
+    if (!m_bAsyncCompute)
+        return;
+
+    // El hilo de simulacin ha enviado ya el paso anterior, que se ha solapado con el frame
+    // previo; la cola grfica lee su resultado
+    m_pSimulationThread->WaitIdle();
+    m_pContext->DeviceWaitForFence(m_pComputeFence, m_ComputeFenceValue);
+    m_PublishedIndex = m_LastWrittenIndex;
+
+    // El paso de este frame escribe la textura que ley el frame de hace dos. Las constantes
+    // se copian porque Update() las reescribe mientras el hilo graba.
+    const Uint32 WriteIndex  = (m_PublishedIndex + 1) % NUM_PUBLISHED_FIELDS;
+    const Uint64 WaitValue   = m_PublishedReleaseFenceValue[WriteIndex];
+    const Uint64 SignalValue = ++m_ComputeFenceValue;
+    m_LastWrittenIndex       = WriteIndex;
+
+    m_pSimulationThread->Enqueue([this, NumSteps, WriteIndex, WaitValue, SignalValue, Constants = m_Constants, StepCallback = std::move(StepCallback)]() {
+        RecordAsyncStep(NumSteps, WriteIndex, WaitValue, SignalValue, Constants, StepCallback);
+    });
+}
 
-            // Establecer pipeline y recursos
-            m_pContext->SetPipelineState(m_pAdvectionPSO);
-            m_pContext->CommitShaderResources(m_pAdvectionSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+void Tutorial14_FluidSimulation::RecordAsyncStep(Uint32                      NumSteps,
+                                                 Uint32                      WriteIndex,
+                                                 Uint64                      WaitValue,
+                                                 Uint64                      SignalValue,
+                                                 const FluidShaderConstants& Constants,
+                                                 const AsyncStepCallback&    StepCallback)
+{
+    T14_TRACE_SCOPE("FluidSimulation::RecordAsyncStep");
 
-            // Dibujar quad para adveccin
-            DrawFullScreenQuad();
-        }
+    IDeviceContext* pCtx = m_pComputeContext;
+    pCtx->DeviceWaitForFence(m_pGraphicsFence, WaitValue);
 
-        // Intercambiar texturas tras adveccin
-        SwapVelocityTextures();
+    {
+        MapHelper<FluidShaderConstants> MappedConstants(pCtx, m_pAsyncConstantsBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+        *MappedConstants = Constants;
     }
-    catch (const std::exception& e)
+
+    for (Uint32 Step = 0; Step < NumSteps; ++Step)
     {
-        LOG_ERROR_MESSAGE("Error in Tutorial14_FluidSimulation::Render: %s", e.what());
+        DispatchSolverPass(pCtx, m_pAsyncForcePSO, m_pAsyncForceSRB, m_pPreviousVelocitySRV, m_pCurrentVelocityUAV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        SwapVelocityTextures();
+        DispatchSolverPass(pCtx, m_pAsyncAdvectionPSO, m_pAsyncAdvectionSRB, m_pPreviousVelocitySRV, m_pCurrentVelocityUAV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        SwapVelocityTextures();
     }
+
+    CopyTextureAttribs CopyAttribs;
+    CopyAttribs.pSrcTexture              = m_pPreviousVelocitySRV->GetTexture();
+    CopyAttribs.SrcTextureTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+    CopyAttribs.pDstTexture              = m_pPublishedVelocityTexture[WriteIndex];
+    CopyAttribs.DstTextureTransitionMode = RESOURCE_STATE_TRANSITION_MODE_TRANSITION;
+    pCtx->CopyTexture(CopyAttribs);
+
+    StateTransitionDesc Barrier{m_pPublishedVelocityTexture[WriteIndex], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE};
+    pCtx->TransitionResourceStates(1, &Barrier);
+
+    if (StepCallback)
+        StepCallback(pCtx, m_pPublishedVelocitySRV[WriteIndex], WriteIndex);
+
+    pCtx->EnqueueSignal(m_pComputeFence, SignalValue);
+    pCtx->Flush();
 }
 
-void Tutorial14_FluidSimulation::DrawFullScreenQuad()
+void Tutorial14_FluidSimulation::EndGraphicsFrame()
 {
-    // Configurar viewport para cubrir toda la pantalla
-    Viewport VP;
-    VP.Width    = static_cast<float>(GRID_SIZE); 
-    VP.Height   = static_cast<float>(GRID_SIZE); 
-    VP.MinDepth = 0.0f;
-    VP.MaxDepth = 1.0f;
-    VP.TopLeftX = 0.0f;
-    VP.TopLeftY = 0.0f;
+    if (!m_bAsyncCompute)
+        return;
 
-    m_pContext->SetViewports(1, &VP, 0, 0);
+    // Se seala con el siguiente Flush() del contexto grfico (Present)
+    m_pContext->EnqueueSignal(m_pGraphicsFence, ++m_GraphicsFenceValue);
+    m_PublishedReleaseFenceValue[m_PublishedIndex] = m_GraphicsFenceValue;
+}
 
-    // Dibujar un quad
-    DrawAttribs drawAttrs;
-    drawAttrs.NumVertices = 4;
-    m_pContext->Draw(drawAttrs);
+void Tutorial14_FluidSimulation::WaitForAsyncStep()
+{
+    if (m_pSimulationThread)
+        m_pSimulationThread->WaitIdle();
+    if (m_pComputeFence && m_ComputeFenceValue > 0)
+        m_pComputeFence->Wait(m_ComputeFenceValue);
 }
 
 void Tutorial14_FluidSimulation::SwapVelocityTextures()
@@ -631,227 +1019,164 @@ void Tutorial14_FluidSimulation::SwapVelocityTextures()
 
     if (m_CurrentTextureIndex == 0)
     {
-        m_pCurrentVelocityRTV  = m_pVelocityRTV1;
+        m_pCurrentVelocityUAV  = m_pVelocityUAV1;
         m_pCurrentVelocitySRV  = m_pVelocitySRV1;
         m_pPreviousVelocitySRV = m_pVelocitySRV2;
     }
     else
     {
-        m_pCurrentVelocityRTV  = m_pVelocityRTV2;
+        m_pCurrentVelocityUAV  = m_pVelocityUAV2;
         m_pCurrentVelocitySRV  = m_pVelocitySRV2;
         m_pPreviousVelocitySRV = m_pVelocitySRV1;
     }
 
-    // Actualizar m_pVelocityRTV y m_pVelocitySRV para mantener compatibilidad con el cdigo existente
-    m_pVelocityRTV = m_pCurrentVelocityRTV;
+    // Actualizar m_pVelocityUAV y m_pVelocitySRV para mantener compatibilidad con el cdigo existente
+    m_pVelocityUAV = m_pCurrentVelocityUAV;
     m_pVelocitySRV = m_pCurrentVelocitySRV;
-
-    // Recrear los SRBs con las nuevas texturas
-    RecreateShaderResourceBindings();
 }
 
-void Tutorial14_FluidSimulation::UpdateTextureBindings()
+void Tutorial14_FluidSimulation::RecreateShaderResourceBindings()
 {
-    // Actualizar binding para shader de adveccin
-    if (m_pAdvectionSRB)
+    T14_TRACE_SCOPE("FluidSimulation::RecreateShaderResourceBindings");
+
+    // Los SRBs copian las variables estticas del PSO al crearse
+    if (m_pForcePSO)
     {
-        auto* pVelocityVar = m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-        if (pVelocityVar)
-        {
-            pVelocityVar->Set(m_pPreviousVelocitySRV); // Usamos la textura previa para leer
-        }
+        m_pForceSRB.Release();
+        m_pForcePSO->CreateShaderResourceBinding(&m_pForceSRB, true);
+        m_pForceSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleMomentum")->Set(m_pMomentumBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+        if (m_pFrameAllocator)
+            m_pFrameAllocator->BindConstants(m_pForceSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "cbFluidConstants"), sizeof(FluidShaderConstants));
     }
 
-    // Actualizar binding para shader de fuerzas
-    if (m_pForceSRB)
+    if (m_pAdvectionPSO)
     {
-        auto* pVelocityVar = m_pForceSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-        if (pVelocityVar)
-        {
-            pVelocityVar->Set(m_pPreviousVelocitySRV); // Usamos la textura previa para leer
-        }
+        m_pAdvectionSRB.Release();
+        m_pAdvectionPSO->CreateShaderResourceBinding(&m_pAdvectionSRB, true);
+        if (m_pFrameAllocator)
+            m_pFrameAllocator->BindConstants(m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "cbFluidConstants"), sizeof(FluidShaderConstants));
     }
 
-    // Actualizar binding para shader de visualizacin
-    if (m_pVisualizationSRB)
+    if (m_pWindowShiftPSO)
     {
-        auto* pVelocityVar = m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-        if (pVelocityVar)
-        {
-            pVelocityVar->Set(m_pCurrentVelocitySRV); // Usamos la textura actual para visualizar
-        }
+        m_pWindowShiftSRB.Release();
+        m_pWindowShiftPSO->CreateShaderResourceBinding(&m_pWindowShiftSRB, true);
+        if (m_pFrameAllocator)
+            m_pFrameAllocator->BindConstants(m_pWindowShiftSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "cbWindowShiftConstants"), sizeof(WindowShiftConstants));
     }
-}
 
-void Tutorial14_FluidSimulation::RecreateShaderResourceBindings()
-{
-    // Recrear SRB para adveccin
-    if (m_pAdvectionPSO)
+    if (m_pVisualizationPSO)
     {
-        m_pAdvectionSRB.Release();
-        m_pAdvectionPSO->CreateShaderResourceBinding(&m_pAdvectionSRB, true);
+        m_pVisualizationSRB.Release();
+        m_pVisualizationPSO->CreateShaderResourceBinding(&m_pVisualizationSRB, true);
 
-        if (m_pAdvectionSRB)
+        auto* pSamplerVar = m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
+        if (pSamplerVar)
         {
-            auto* pVelocityVar = m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-            if (pVelocityVar)
-            {
-                pVelocityVar->Set(m_pPreviousVelocitySRV);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'g_VelocityTexture' not found in advection shader");
-            }
-
-            // Reconfigurar sampler
-            SamplerDesc SamDesc;
-            SamDesc.MinFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MagFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MipFilter = FILTER_TYPE_LINEAR;
-            SamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressW  = TEXTURE_ADDRESS_CLAMP;
-
-            RefCntAutoPtr<ISampler> pSampler;
-            m_pDevice->CreateSampler(SamDesc, &pSampler);
-
-            auto* pSamplerVar = m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
-            if (pSamplerVar)
-            {
-                pSamplerVar->Set(pSampler);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'g_LinearSampler' not found in advection shader");
-            }
-
-            // Vincular buffer de constantes
-            auto* pConstantsVar = m_pAdvectionSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbFluidConstants");
-            if (pConstantsVar)
-            {
-                pConstantsVar->Set(m_pConstantsBuffer);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'cbFluidConstants' not found in advection shader");
-            }
+            pSamplerVar->Set(m_pLinearSampler);
         }
         else
         {
-            LOG_ERROR_MESSAGE("Failed to create advection SRB");
+            LOG_ERROR_MESSAGE("Variable 'g_LinearSampler' not found in visualization shader");
         }
+        if (m_pFrameAllocator)
+            m_pFrameAllocator->BindConstants(m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbVisualizationConstants"), sizeof(VisualizationConstants));
     }
 
-    // Recrear SRB para fuerzas
-    if (m_pForcePSO)
+    RecreateCouplingSRB();
+}
+
+void Tutorial14_FluidSimulation::RecreateCouplingSRB()
+{
+    m_pCouplingSRB.Release();
+    if (m_pCouplingPSO && m_pParticleAttribs)
     {
-        m_pForceSRB.Release();
-        m_pForcePSO->CreateShaderResourceBinding(&m_pForceSRB, true);
+        m_pCouplingPSO->CreateShaderResourceBinding(&m_pCouplingSRB, true);
+        m_pCouplingSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(m_pParticleAttribs->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+        m_pCouplingSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(m_pParticleListHeads->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+        m_pCouplingSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(m_pParticleLists->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+        m_pCouplingSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleMomentum")->Set(m_pMomentumBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+        if (m_pFrameAllocator)
+            m_pFrameAllocator->BindConstants(m_pCouplingSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "FluidCouplingConstantsBuffer"), sizeof(FluidCouplingConstants));
+    }
+}
 
-        if (m_pForceSRB)
-        {
-            auto* pVelocityVar = m_pForceSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-            if (pVelocityVar)
-            {
-                pVelocityVar->Set(m_pPreviousVelocitySRV);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'g_VelocityTexture' not found in force shader");
-            }
+void Tutorial14_FluidSimulation::SetFrameAllocator(Tutorial14_FrameAllocator* pFrameAllocator)
+{
+    m_pFrameAllocator = pFrameAllocator;
+    RecreateShaderResourceBindings();
+}
 
-            // Reconfigurar sampler
-            SamplerDesc SamDesc;
-            SamDesc.MinFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MagFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MipFilter = FILTER_TYPE_LINEAR;
-            SamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressW  = TEXTURE_ADDRESS_CLAMP;
+void Tutorial14_FluidSimulation::SetParticleBuffers(IBuffer* pParticleAttribs, IBuffer* pParticleListHeads, IBuffer* pParticleLists, Uint32 NumParticles)
+{
+    m_pParticleAttribs   = pParticleAttribs;
+    m_pParticleListHeads = pParticleListHeads;
+    m_pParticleLists     = pParticleLists;
 
-            RefCntAutoPtr<ISampler> pSampler;
-            m_pDevice->CreateSampler(SamDesc, &pSampler);
+    // Tamao tpico de las partculas, el mismo que usa CreateParticleBuffers()
+    const float fSize   = std::min(0.05f, 0.7f / std::sqrt(static_cast<float>(std::max(NumParticles, 1u))));
+    m_ParticleMassScale = 1.0f / (fSize * fSize);
 
-            auto* pSamplerVar = m_pForceSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
-            if (pSamplerVar)
-            {
-                pSamplerVar->Set(pSampler);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'g_LinearSampler' not found in force shader");
-            }
+    RecreateCouplingSRB();
+}
 
-            // Vincular buffer de constantes
-            auto* pConstantsVar = m_pForceSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbFluidConstants");
-            if (pConstantsVar)
-            {
-                pConstantsVar->Set(m_pConstantsBuffer);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'cbFluidConstants' not found in force shader");
-            }
-        }
-        else
-        {
-            LOG_ERROR_MESSAGE("Failed to create force SRB");
-        }
-    }
+void Tutorial14_FluidSimulation::AddCouplingPass(Tutorial14_FrameGraph& Graph, const float2& f2Scale, const int2& i2ParticleGridSize)
+{
+    if (m_ParticleCoupling <= 0 || m_bAsyncCompute || !m_pCouplingSRB || !m_pFrameAllocator)
+        return;
+
+    FluidCouplingConstants Constants;
+    Constants.uiFluidGridSize    = m_GridSize;
+    Constants.fMassScale         = m_ParticleMassScale;
+    Constants.f2Scale            = f2Scale;
+    Constants.i2ParticleGridSize = i2ParticleGridSize;
+    Constants.f2Padding0         = float2(0, 0);
+
+    // Cada subpaso tiene su propio desplazamiento
+    const Uint32 Offset = m_pFrameAllocator->Allocate(Constants);
+
+    Graph.AddPass("Fluid coupling",
+                  {
+                      {Graph.ImportBuffer(m_pParticleAttribs), RESOURCE_STATE_SHADER_RESOURCE},
+                      {Graph.ImportBuffer(m_pParticleListHeads), RESOURCE_STATE_SHADER_RESOURCE},
+                      {Graph.ImportBuffer(m_pParticleLists), RESOURCE_STATE_SHADER_RESOURCE},
+                      {Graph.ImportBuffer(m_pMomentumBuffer), RESOURCE_STATE_UNORDERED_ACCESS},
+                  },
+                  [this, Offset](IDeviceContext* pCtx) {
+                      m_pCouplingSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "FluidCouplingConstantsBuffer")->SetBufferOffset(Offset);
+                      pCtx->SetPipelineState(m_pCouplingPSO);
+                      pCtx->CommitShaderResources(m_pCouplingSRB, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+
+                      // Un grupo por tile de la rejilla del fluido
+                      DispatchComputeAttribs DispatchAttribs;
+                      DispatchAttribs.ThreadGroupCountX = (m_GridSize + COUPLING_TILE_SIZE - 1) / COUPLING_TILE_SIZE;
+                      DispatchAttribs.ThreadGroupCountY = DispatchAttribs.ThreadGroupCountX;
+                      pCtx->DispatchCompute(DispatchAttribs);
+                  });
+}
 
-    // Recrear SRB para visualizacin
-    if (m_pVisualizationPSO)
+void Tutorial14_FluidSimulation::SetTimeStepBuffer(IBuffer* pTimeStepBuffer)
+{
+    m_pTimeStepBuffer = pTimeStepBuffer;
+    if (!m_pTimeStepBuffer)
+        return;
+
+    for (IPipelineState* pPSO : {m_pForcePSO.RawPtr(), m_pAdvectionPSO.RawPtr()})
     {
-        m_pVisualizationSRB.Release();
-        m_pVisualizationPSO->CreateShaderResourceBinding(&m_pVisualizationSRB, true);
+        if (pPSO == nullptr)
+            continue;
 
-        if (m_pVisualizationSRB)
+        auto* pTimeStepVar = pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "g_TimeStep");
+        if (pTimeStepVar)
         {
-            auto* pVelocityVar = m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_VelocityTexture");
-            if (pVelocityVar)
-            {
-                pVelocityVar->Set(m_pCurrentVelocitySRV); // Importante! Usamos la textura actual para visualizacin
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'g_VelocityTexture' not found in visualization shader");
-            }
-
-            // Reconfigurar sampler
-            SamplerDesc SamDesc;
-            SamDesc.MinFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MagFilter = FILTER_TYPE_LINEAR;
-            SamDesc.MipFilter = FILTER_TYPE_LINEAR;
-            SamDesc.AddressU  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressV  = TEXTURE_ADDRESS_CLAMP;
-            SamDesc.AddressW  = TEXTURE_ADDRESS_CLAMP;
-
-            RefCntAutoPtr<ISampler> pSampler;
-            m_pDevice->CreateSampler(SamDesc, &pSampler);
-
-            auto* pSamplerVar = m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_LinearSampler");
-            if (pSamplerVar)
-            {
-                pSamplerVar->Set(pSampler);
-            }
-            else
-            {
-                LOG_ERROR_MESSAGE("Variable 'g_LinearSampler' not found in visualization shader");
-            }
-
-            // Nota: El shader de visualizacin podra no necesitar el buffer de constantes
-            // pero lo aadimos por consistencia
-            auto* pConstantsVar = m_pVisualizationSRB->GetVariableByName(SHADER_TYPE_PIXEL, "cbFluidConstants");
-            if (pConstantsVar)
-            {
-                pConstantsVar->Set(m_pConstantsBuffer);
-            }
+            pTimeStepVar->Set(m_pTimeStepBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
         }
         else
         {
-            LOG_ERROR_MESSAGE("Failed to create visualization SRB");
+            LOG_ERROR_MESSAGE("Variable 'g_TimeStep' not found in fluid shader");
         }
     }
+    RecreateShaderResourceBindings();
 }
 
 float2 Tutorial14_FluidSimulation::GetVelocityAt(const float2& position)
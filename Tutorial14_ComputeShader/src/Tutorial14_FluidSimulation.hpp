@@ -6,43 +6,228 @@
 #include "DeviceContext.h"
 #include "EngineFactory.h"
 #include "SwapChain.h"
+#include "Tutorial14_ThreadPool.hpp"
+#include <functional>
+#include <memory>
 
 namespace Diligent
 {
 
+class Tutorial14_FrameAllocator;
+class Tutorial14_FrameGraph;
+
 class Tutorial14_FluidSimulation
 {
 public:
+    // Tamao de la rejilla de velocidad por defecto
+    static constexpr Uint32 DEFAULT_GRID_SIZE = 256;
+
+    // Factor que se aplica al intervalo de tiempo para ralentizar el fluido
+    static constexpr float TIME_STEP_SCALE = 0.7f;
+
+    // Campos publicados del modo asncrono (anillo de m_pPublishedVelocityTexture)
+    static constexpr Uint32 NUM_PUBLISHED_FIELDS = 3;
+
+    // pComputeContext: contexto inmediato opcional de una cola de cmputo. Si se proporciona,
+    // las texturas y pipelines del solver se crean tambin para esa cola y se puede activar
+    // el modo asncrono.
     Tutorial14_FluidSimulation(IRenderDevice*  pDevice,
                                IDeviceContext* pContext,
                                IEngineFactory* pEngineFactory,
-                               ISwapChain*     pSwapChain);
+                               ISwapChain*     pSwapChain,
+                               Uint32          GridSize        = DEFAULT_GRID_SIZE,
+                               IDeviceContext* pComputeContext = nullptr);
 
     // Destructor declarado explcitamente
     ~Tutorial14_FluidSimulation();
 
     void Update(float deltaTime, float simulationSpeed, float viscosity);
-    void Render();
 
-    // Mtodo para renderizar visualizacin al backbuffer
-    void RenderFluidVisualization(ITextureView* pRTV);
+    // Aade al grafo los pases de fuerza y adveccin de un paso sncrono. Cada llamada es un
+    // paso; no hace nada en modo asncrono.
+    void AddSolverPasses(Tutorial14_FrameGraph& Graph);
+
+    // Aade al grafo los pases que dibujan el campo de velocidad sobre pRTV: los colores
+    // de la rejilla en una textura temporal y su composicin en pantalla. La composicin usa
+    // la cmara del modo mundo y la posicin de la ventana del campo (ShiftWindow()); fuera
+    // de ese modo, centro y ventana en el origen y zoom 1.
+    void AddVisualizationPass(Tutorial14_FrameGraph& Graph,
+                              ITextureView*          pRTV,
+                              const float2&          f2ViewCenter,
+                              float                  fViewZoom,
+                              const float2&          f2FluidWindowCenter);
 
-    // Mtodo para consultar velocidad en una posicin especfica
+    // Aproximacin analtica en la CPU de la velocidad en una posicin, sin leer el campo
+    // simulado. Para muestrear el campo real en muchos puntos usar Tutorial14_VelocityQuery.
     float2 GetVelocityAt(const float2& position);
 
-    // Getter para la textura de velocidad
-    ITextureView* GetVelocitySRV() const { return m_pVelocitySRV; }
+    // Getter para la textura de velocidad. En modo asncrono es el campo publicado por el
+    // paso del frame anterior.
+    ITextureView* GetVelocitySRV() const { return m_bAsyncCompute ? m_pPublishedVelocitySRV[m_PublishedIndex] : m_pVelocitySRV; }
+
+    // Cambia la resolucin de la rejilla y reinicia el campo de velocidad
+    void   SetGridSize(Uint32 GridSize);
+    Uint32 GetGridSize() const { return m_GridSize; }
+
+    // Ventana deslizante (modo mundo): desplaza el campo Offset texels, de modo que el texel
+    // (x, y) pasa a tener la velocidad que tena el (x + Offset.x, y + Offset.y). Las zonas
+    // que entran en la ventana empiezan en reposo. Es un dispatch en la cola grfica, as
+    // que puede llamarse en cada frame; necesita el asignador de SetFrameAllocator().
+    void ShiftWindow(const int2& Offset);
+
+    // Estado que no est en las texturas de velocidad, para las instantneas
+    struct State
+    {
+        Uint32 GridSize            = 0;
+        int    CurrentTextureIndex = 0;
+        float  Timer               = 0;
+        float2 LastForcePos;
+    };
+    State GetState() const;
+
+    // Texturas de velocidad del doble bfer (Index 0 o 1)
+    ITexture* GetVelocityTexture(int Index) const { return Index == 0 ? m_pVelocityTexture1 : m_pVelocityTexture2; }
+
+    // Recrea la rejilla con el tamao de FluidState y sube los campos de velocidad
+    // (GridSize x GridSize texels de VELOCITY_FORMAT, filas sin relleno)
+    void RestoreState(const State& FluidState, const void* pVelocityData1, const void* pVelocityData2);
+
+    // Asignador en el que se escriben las constantes del paso sncrono y del depsito del
+    // momento. Sin l los pases de la cola grfica no se ejecutan.
+    void SetFrameAllocator(Tutorial14_FrameAllocator* pFrameAllocator);
+
+    // Bfer con el intervalo de tiempo calculado en la GPU (Tutorial14_AdaptiveTimeStep).
+    // Los shaders lo leen en lugar del intervalo de Update() si el modo adaptativo est activo.
+    void SetTimeStepBuffer(IBuffer* pTimeStepBuffer);
+    void SetAdaptiveTimeStep(bool bAdaptive) { m_bAdaptiveTimeStep = bAdaptive; }
+
+    // Modo asncrono: el solver se ejecuta en la cola de cmputo solapado con el trabajo
+    // grfico del frame, y las partculas leen el campo del frame anterior. El intervalo
+    // adaptativo no se aplica al fluido en este modo.
+    bool IsAsyncComputeSupported() const { return m_pComputeContext != nullptr; }
+    bool IsAsyncCompute() const { return m_bAsyncCompute; }
+    void SetAsyncCompute(bool bAsync);
+
+    // Trabajo que el hilo de simulacin graba en el contexto de cmputo tras los pasos del
+    // fluido y antes de sealar el paso. pVelocitySRV es el campo publicado PublishIndex, que
+    // la cola grfica leer en el siguiente frame; lo que el llamador publique con el mismo
+    // ndice queda protegido por las mismas vallas que el campo.
+    using AsyncStepCallback = std::function<void(IDeviceContext* pComputeContext, ITextureView* pVelocitySRV, Uint32 PublishIndex)>;
+
+    // Modo asncrono, una vez por frame antes de usar GetVelocitySRV(): la cola grfica espera
+    // al paso anterior y el hilo de simulacin graba y enva NumSteps pasos de fuerza y
+    // adveccin, seguidos de StepCallback, a la cola de cmputo mientras el hilo principal
+    // graba el frame
+    void SubmitAsyncStep(Uint32 NumSteps, AsyncStepCallback StepCallback = nullptr);
+    // Modo asncrono, tras el ltimo uso del campo en el frame: permite a la cola de cmputo
+    // sobrescribir el campo que se ha ledo
+    void EndGraphicsFrame();
+    // Modo asncrono: el siguiente paso de la cola de cmputo espera a todo lo enviado hasta
+    // ahora a la cola grfica, tambin a lo que use recursos propios del llamador
+    void ReleaseToComputeQueue();
+    // ndice del anillo que lee la cola grfica en este frame (GetVelocitySRV())
+    Uint32 GetPublishedIndex() const { return m_PublishedIndex; }
+    // Espera a que el hilo de simulacin enve su paso y la cola de cmputo lo termine
+    void WaitForAsyncStep();
+
+    // Acoplamiento en dos sentidos: las partculas depositan su momento en la rejilla y el
+    // pase de fuerza del siguiente paso lo aplica al campo. 0 lo desactiva. No se aplica en
+    // modo asncrono.
+    void  SetParticleCoupling(float Coupling) { m_ParticleCoupling = Coupling; }
+    float GetParticleCoupling() const { return m_ParticleCoupling; }
+
+    // Bferes de la simulacin de partculas que lee el depsito del momento
+    void SetParticleBuffers(IBuffer* pParticleAttribs, IBuffer* pParticleListHeads, IBuffer* pParticleLists, Uint32 NumParticles);
+    // Aade el pase de depsito del momento. Tras el pase de velocidad de las partculas,
+    // con las listas del ltimo pase de movimiento.
+    void AddCouplingPass(Tutorial14_FrameGraph& Graph, const float2& f2Scale, const int2& i2ParticleGridSize);
 
 private:
     // Constantes
-    static constexpr Uint32         GRID_SIZE       = 256;
-    static constexpr TEXTURE_FORMAT VELOCITY_FORMAT = TEX_FORMAT_RG32_FLOAT;
+    static constexpr TEXTURE_FORMAT VELOCITY_FORMAT    = TEX_FORMAT_RG32_FLOAT;
+    static constexpr Uint32         FLUID_GROUP_SIZE   = 16;
+    static constexpr Uint32         COUPLING_TILE_SIZE = 8;
+
+    struct FluidShaderConstants
+    {
+        float TimeStep              = 0;
+        float Viscosity             = 0;
+        float GridScale             = 1;
+        float AdaptiveTimeStepScale = 0;
+
+        float2 InverseGridSize;
+        float2 ForcePosition;
+
+        float2 ForceVector;
+        float  ForceRadius      = 0;
+        float  ParticleCoupling = 0;
+    };
+
+    // Espejo de FluidCouplingConstants en fluid_coupling.fxh
+    struct FluidCouplingConstants
+    {
+        Uint32 uiFluidGridSize = 0;
+        float  fMassScale      = 1;
+        float2 f2Scale;
+
+        int2   i2ParticleGridSize;
+        float2 f2Padding0;
+    };
+
+    // Espejo de cbWindowShiftConstants en fluid_window_shift.csh
+    struct WindowShiftConstants
+    {
+        int2 i2Offset;
+        int2 i2Padding0;
+    };
+
+    // Espejo de cbVisualizationConstants en FluidVisualizationShader.fx
+    struct VisualizationConstants
+    {
+        float2 f2ViewCenter;
+        float2 f2FluidWindowCenter;
+
+        float fViewZoom     = 1;
+        float f3Padding0[3] = {};
+    };
+
+    // Espejo de ParticleMomentum en fluid_coupling.fxh
+    struct ParticleMomentum
+    {
+        Int32 iMomentumX = 0;
+        Int32 iMomentumY = 0;
+        Int32 iMass      = 0;
+        Int32 iPadding0  = 0;
+    };
 
     // Mtodos de inicializacin
     void CreateTextures();
     void CreateConstantsBuffer();
     void CreatePipelines();
-    void DrawFullScreenQuad();
+
+    void CreateFences();
+
+    // Pase de fuerza o adveccin: lee pInput y escribe pOutput
+    void DispatchSolverPass(IDeviceContext*                pCtx,
+                            IPipelineState*                pPSO,
+                            IShaderResourceBinding*        pSRB,
+                            ITextureView*                  pInput,
+                            ITextureView*                  pOutput,
+                            RESOURCE_STATE_TRANSITION_MODE StateTransitionMode);
+
+    void RenderVisualizationColors(IDeviceContext* pCtx, ITextureView* pColorsRTV, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode);
+    void RenderFluidVisualization(IDeviceContext* pCtx, ITextureView* pColorsSRV, ITextureView* pRTV, Uint32 ConstantsOffset, RESOURCE_STATE_TRANSITION_MODE StateTransitionMode);
+
+    // Copia el resultado del solver al campo publicado desde la cola grfica
+    void PublishFromGraphicsQueue();
+    // Se ejecuta en el hilo de simulacin: graba los pasos en el contexto de cmputo, copia el
+    // resultado al campo publicado WriteIndex, graba StepCallback y seala SignalValue
+    void RecordAsyncStep(Uint32                      NumSteps,
+                         Uint32                      WriteIndex,
+                         Uint64                      WaitValue,
+                         Uint64                      SignalValue,
+                         const FluidShaderConstants& Constants,
+                         const AsyncStepCallback&    StepCallback);
 
     // Visualizacin
     void RenderFluidVisualizationInternal();
@@ -50,38 +235,49 @@ private:
 
     //Funciones
     void SwapVelocityTextures();
-    void UpdateTextureBindings();
     void RecreateShaderResourceBindings();
+    void RecreateCouplingSRB();
 
     // Dispositivos de renderizado
-    IRenderDevice*  m_pDevice        = nullptr;
-    IDeviceContext* m_pContext       = nullptr;
-    IEngineFactory* m_pEngineFactory = nullptr;
-    ISwapChain*     m_pSwapChain     = nullptr; // Ahora guardamos una referencia al SwapChain
+    IRenderDevice*  m_pDevice         = nullptr;
+    IDeviceContext* m_pContext        = nullptr;
+    IDeviceContext* m_pComputeContext = nullptr;
+    IEngineFactory* m_pEngineFactory  = nullptr;
+    ISwapChain*     m_pSwapChain      = nullptr; // Ahora guardamos una referencia al SwapChain
+
+    // Contextos inmediatos que usan las texturas y pipelines del solver
+    Uint64 m_ImmediateContextMask = 1;
+
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
 
     // Recursos de fluidos
     RefCntAutoPtr<ITexture> m_pVelocityTexture;
     RefCntAutoPtr<ITexture> m_pVelocityTexture1;
     RefCntAutoPtr<ITexture> m_pVelocityTexture2;
-    RefCntAutoPtr<IBuffer>  m_pConstantsBuffer;
     RefCntAutoPtr<ITexture> m_pStagingTexture;
 
+    // Constantes del ltimo Update() y su desplazamiento en el asignador de frame; en modo
+    // asncrono se escriben en el contexto de cmputo
+    FluidShaderConstants   m_Constants;
+    Uint32                 m_ConstantsOffset = 0;
+    RefCntAutoPtr<IBuffer> m_pAsyncConstantsBuffer;
+
     // Referencias a vistas de textura actual y anterior
-    ITextureView* m_pCurrentVelocityRTV  = nullptr;
+    ITextureView* m_pCurrentVelocityUAV  = nullptr;
     ITextureView* m_pCurrentVelocitySRV  = nullptr;
     ITextureView* m_pPreviousVelocitySRV = nullptr;
 
     // Mantener referencias especficas a cada textura para facilitar el intercambio
-    ITextureView* m_pVelocityRTV1 = nullptr;
+    ITextureView* m_pVelocityUAV1 = nullptr;
     ITextureView* m_pVelocitySRV1 = nullptr;
-    ITextureView* m_pVelocityRTV2 = nullptr;
+    ITextureView* m_pVelocityUAV2 = nullptr;
     ITextureView* m_pVelocitySRV2 = nullptr;
 
     // ndice de textura actual (0 o 1)
     int m_CurrentTextureIndex = 0;
 
     // Vistas de textura
-    ITextureView* m_pVelocityRTV = nullptr;
+    ITextureView* m_pVelocityUAV = nullptr;
     ITextureView* m_pVelocitySRV = nullptr;
 
     // Pipeline state y SRB para adveccin
@@ -92,9 +288,60 @@ private:
     RefCntAutoPtr<IPipelineState>         m_pForcePSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pForceSRB;
 
+    // Variantes del solver para la cola de cmputo (sin intervalo adaptativo)
+    RefCntAutoPtr<IPipelineState>         m_pAsyncAdvectionPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pAsyncAdvectionSRB;
+    RefCntAutoPtr<IPipelineState>         m_pAsyncForcePSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pAsyncForceSRB;
+
+    // Modo asncrono. Las texturas publicadas forman un anillo de tres: la cola de cmputo
+    // escribe el paso N mientras la cola grfica lee el paso N-1, y la textura del paso N-2
+    // puede seguir en uso por el frame anterior. Cada textura guarda el valor de la valla
+    // grfica que la libera, de modo que el cmputo solo espera al frame de hace dos.
+    bool                    m_bAsyncCompute = false;
+    RefCntAutoPtr<ITexture> m_pPublishedVelocityTexture[NUM_PUBLISHED_FIELDS];
+    ITextureView*           m_pPublishedVelocitySRV[NUM_PUBLISHED_FIELDS]       = {};
+    Uint64                  m_PublishedReleaseFenceValue[NUM_PUBLISHED_FIELDS] = {};
+    Uint32                  m_PublishedIndex                                   = 0; // Textura que lee la cola grfica
+    Uint32                  m_LastWrittenIndex                                 = 0; // Textura del ltimo paso enviado
+    RefCntAutoPtr<IFence>   m_pComputeFence;
+    RefCntAutoPtr<IFence>   m_pGraphicsFence;
+    Uint64                  m_ComputeFenceValue  = 0;
+    Uint64                  m_GraphicsFenceValue = 0;
+
+    // Hilo que graba el contexto de cmputo. Mientras tiene un trabajo en curso es el nico
+    // que toca las texturas del solver; el hilo principal solo usa las texturas publicadas.
+    std::unique_ptr<Tutorial14_ThreadPool> m_pSimulationThread;
+
+    // Desplazamiento de la ventana del campo (ShiftWindow())
+    RefCntAutoPtr<IPipelineState>         m_pWindowShiftPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pWindowShiftSRB;
+
+    // Acoplamiento con las partculas. El acumulador tiene un ParticleMomentum por texel.
+    float                                 m_ParticleCoupling  = 2.0f;
+    float                                 m_ParticleMassScale = 1.0f;
+    RefCntAutoPtr<IBuffer>                m_pMomentumBuffer;
+    RefCntAutoPtr<IPipelineState>         m_pCouplingPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pCouplingSRB;
+    RefCntAutoPtr<IBuffer>                m_pParticleAttribs;
+    RefCntAutoPtr<IBuffer>                m_pParticleListHeads;
+    RefCntAutoPtr<IBuffer>                m_pParticleLists;
+
     // Pipeline state y SRB para visualizacin
+    static constexpr TEXTURE_FORMAT VISUALIZATION_COLORS_FORMAT = TEX_FORMAT_RGBA8_UNORM;
+
+    RefCntAutoPtr<IPipelineState>         m_pVisualizationColorsPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pVisualizationColorsSRB;
     RefCntAutoPtr<IPipelineState>         m_pVisualizationPSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pVisualizationSRB;
+    RefCntAutoPtr<ISampler>               m_pLinearSampler;
+
+    // Resolucin de la rejilla de velocidad (m_GridSize x m_GridSize)
+    Uint32 m_GridSize = DEFAULT_GRID_SIZE;
+
+    // Intervalo de tiempo adaptativo
+    RefCntAutoPtr<IBuffer> m_pTimeStepBuffer;
+    bool                   m_bAdaptiveTimeStep = false;
 
     // Variables de simulacin
     float  m_Timer        = 0.0f;
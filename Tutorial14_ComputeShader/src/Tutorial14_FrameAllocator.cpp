@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cstring>
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Align.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+
+namespace Diligent
+{
+
+Tutorial14_FrameAllocator::Tutorial14_FrameAllocator(IRenderDevice*  pDevice,
+                                                     IDeviceContext* pContext,
+                                                     bool            bDeferredContexts,
+                                                     Uint32          FrameSize) :
+    m_pContext(pContext)
+{
+    const auto& AdapterInfo = pDevice->GetAdapterInfo();
+
+    // Los desplazamientos dinmicos y el tamao de la ventana deben ser mltiplos de la
+    // alineacin de los bferes de constantes (256 bytes en D3D11 y D3D12)
+    m_Alignment = std::max(AdapterInfo.Buffer.ConstantBufferOffsetAlignment, 16u);
+    m_FrameSize = AlignUp(std::max(FrameSize, m_Alignment), m_Alignment);
+
+    const bool bUnified = AdapterInfo.Memory.UnifiedMemory != 0 && (AdapterInfo.Memory.UnifiedMemoryCPUAccess & CPU_ACCESS_WRITE) != 0;
+    if (bUnified)
+    {
+        FenceDesc FDesc;
+        FDesc.Name = "Frame allocator fence";
+        pDevice->CreateFence(FDesc, &m_pFence);
+
+        BufferDesc BuffDesc;
+        BuffDesc.Name           = "Frame constants ring";
+        BuffDesc.Usage          = USAGE_UNIFIED;
+        BuffDesc.BindFlags      = BIND_UNIFORM_BUFFER;
+        BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        BuffDesc.Size           = Uint64{m_FrameSize} * NUM_FRAMES_IN_FLIGHT;
+        if (m_pFence)
+            pDevice->CreateBuffer(BuffDesc, nullptr, &m_pBuffer);
+
+        if (m_pBuffer)
+        {
+            // Mapeado persistente: la fence de cada frame impide sobrescribir una regin en uso
+            void* pMappedData = nullptr;
+            m_pContext->MapBuffer(m_pBuffer, MAP_WRITE, MAP_FLAG_NO_OVERWRITE, pMappedData);
+            m_pMappedData = static_cast<Uint8*>(pMappedData);
+        }
+        if (m_pMappedData == nullptr)
+        {
+            LOG_WARNING_MESSAGE("Failed to create a persistently mapped constants ring; falling back to a dynamic buffer");
+            m_pBuffer.Release();
+            m_pFence.Release();
+        }
+    }
+
+    // En D3D11 los bferes de constantes solo se pueden actualizar enteros
+    if (!m_pBuffer && bDeferredContexts && pDevice->GetDeviceInfo().Type != RENDER_DEVICE_TYPE_D3D11)
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name      = "Frame constants buffer";
+        BuffDesc.Usage     = USAGE_DEFAULT;
+        BuffDesc.BindFlags = BIND_UNIFORM_BUFFER;
+        BuffDesc.Size      = m_FrameSize;
+        pDevice->CreateBuffer(BuffDesc, nullptr, &m_pBuffer);
+        m_bUpdateBuffer = m_pBuffer != nullptr;
+    }
+
+    if (!m_pBuffer)
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name           = "Frame constants buffer";
+        BuffDesc.Usage          = USAGE_DYNAMIC;
+        BuffDesc.BindFlags      = BIND_UNIFORM_BUFFER;
+        BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        BuffDesc.Size           = m_FrameSize;
+        pDevice->CreateBuffer(BuffDesc, nullptr, &m_pBuffer);
+        if (!m_pBuffer)
+        {
+            LOG_ERROR_MESSAGE("Failed to create frame constants buffer");
+        }
+    }
+
+    m_Stats.FrameSize = m_FrameSize;
+}
+
+Tutorial14_FrameAllocator::~Tutorial14_FrameAllocator()
+{
+    if (m_pMappedData != nullptr)
+    {
+        m_pContext->UnmapBuffer(m_pBuffer, MAP_WRITE);
+    }
+}
+
+void Tutorial14_FrameAllocator::BindConstants(IShaderResourceVariable* pVar, Uint32 Size) const
+{
+    if (pVar == nullptr || !m_pBuffer)
+        return;
+
+    pVar->SetBufferRange(m_pBuffer, 0, AlignUp(Size, m_Alignment));
+}
+
+void Tutorial14_FrameAllocator::BeginFrame()
+{
+    if (IsPersistent())
+    {
+        m_Region = (m_Region + 1) % NUM_FRAMES_IN_FLIGHT;
+        if (m_pFence->GetCompletedValue() < m_RegionFence[m_Region])
+        {
+            T14_TRACE_SCOPE("Wait for frame constants");
+            ++m_Stats.NumFenceStalls;
+            m_pFence->Wait(m_RegionFence[m_Region]);
+        }
+    }
+
+    m_FrameOffset    = 0;
+    m_NumAllocations = 0;
+    m_bOverflowed    = false;
+}
+
+void Tutorial14_FrameAllocator::EndFrame()
+{
+    m_Stats.UsedBytes      = m_FrameOffset;
+    m_Stats.PeakUsedBytes  = std::max(m_Stats.PeakUsedBytes, m_FrameOffset);
+    m_Stats.NumAllocations = m_NumAllocations;
+
+    if (IsPersistent())
+    {
+        m_RegionFence[m_Region] = m_NextFenceValue;
+        m_pContext->EnqueueSignal(m_pFence, m_NextFenceValue++);
+    }
+}
+
+Uint32 Tutorial14_FrameAllocator::Allocate(const void* pData, Uint32 Size)
+{
+    const Uint32 AlignedSize = AlignUp(Size, m_Alignment);
+    if (!m_pBuffer || AlignedSize > m_FrameSize)
+    {
+        LOG_ERROR_MESSAGE("Frame constants allocation of ", Size, " bytes does not fit in the ", m_FrameSize, "-byte frame budget");
+        return 0;
+    }
+
+    if (m_FrameOffset + AlignedSize > m_FrameSize)
+    {
+        if (!m_bOverflowed)
+            LOG_ERROR_MESSAGE("Frame constants budget of ", m_FrameSize, " bytes exceeded; increase the frame size");
+        m_bOverflowed = true;
+        m_FrameOffset = 0;
+    }
+
+    const Uint32 Offset = (IsPersistent() ? m_Region * m_FrameSize : 0) + m_FrameOffset;
+    if (IsPersistent())
+    {
+        std::memcpy(m_pMappedData + Offset, pData, Size);
+    }
+    else if (m_bUpdateBuffer)
+    {
+        // La copia va en orden con los comandos del contexto inmediato, as que no pisa
+        // los datos de frames anteriores que la GPU an no ha ledo
+        m_pContext->UpdateBuffer(m_pBuffer, Offset, Size, pData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        // Los pases del grafo no hacen transiciones implcitas: el bfer vuelve a quedar
+        // como bfer de constantes
+        StateTransitionDesc Barrier{m_pBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE};
+        m_pContext->TransitionResourceStates(1, &Barrier);
+    }
+    else
+    {
+        // Un solo DISCARD por frame; el resto de asignaciones escriben detrs sin renombrar
+        void* pMappedData = nullptr;
+        m_pContext->MapBuffer(m_pBuffer, MAP_WRITE, m_NumAllocations == 0 ? MAP_FLAG_DISCARD : MAP_FLAG_NO_OVERWRITE, pMappedData);
+        if (pMappedData != nullptr)
+        {
+            std::memcpy(static_cast<Uint8*>(pMappedData) + Offset, pData, Size);
+        }
+        m_pContext->UnmapBuffer(m_pBuffer, MAP_WRITE);
+    }
+
+    m_FrameOffset += AlignedSize;
+    ++m_NumAllocations;
+    return Offset;
+}
+
+} // namespace Diligent
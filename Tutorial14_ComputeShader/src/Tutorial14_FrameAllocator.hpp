@@ -0,0 +1,105 @@
+#pragma once
+
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Asignador lineal de constantes por frame. Todas las constantes dinmicas del frame
+// se escriben seguidas en un nico bfer, alineadas a ConstantBufferOffsetAlignment, y
+// cada draw o dispatch elige las suyas con un desplazamiento dinmico
+// (IShaderResourceVariable::SetBufferOffset) en lugar de mapear su propio bfer con
+// MAP_FLAG_DISCARD.
+//
+// Si el adaptador tiene memoria unificada escribible por la CPU, el bfer se mapea una
+// sola vez y se divide en NUM_FRAMES_IN_FLIGHT regiones; una fence marca el final de
+// cada frame y BeginFrame() espera a que la GPU libere la regin antes de reutilizarla.
+// Si no, el bfer es dinmico: la primera asignacin del frame lo mapea con
+// MAP_FLAG_DISCARD y las siguientes con MAP_FLAG_NO_OVERWRITE, y el motor se encarga de
+// renombrar la memoria de los frames en vuelo.
+//
+// Los datos de un bfer dinmico son propios del contexto que lo mapea, as que los
+// contextos diferidos no pueden leerlo. Si se van a usar contextos diferidos y no hay
+// memoria unificada, el bfer es USAGE_DEFAULT y cada asignacin se copia con
+// UpdateBuffer() en el contexto inmediato, antes de ejecutar las listas que la leen.
+class Tutorial14_FrameAllocator
+{
+public:
+    static constexpr Uint32 NUM_FRAMES_IN_FLIGHT = 3;
+    static constexpr Uint32 DEFAULT_FRAME_SIZE   = 64 << 10;
+
+    Tutorial14_FrameAllocator(IRenderDevice*  pDevice,
+                              IDeviceContext* pContext,
+                              bool            bDeferredContexts,
+                              Uint32          FrameSize = DEFAULT_FRAME_SIZE);
+    ~Tutorial14_FrameAllocator();
+
+    // clang-format off
+    Tutorial14_FrameAllocator(const Tutorial14_FrameAllocator&)            = delete;
+    Tutorial14_FrameAllocator& operator=(const Tutorial14_FrameAllocator&) = delete;
+    // clang-format on
+
+    bool IsValid() const { return m_pBuffer != nullptr; }
+    bool IsPersistent() const { return m_pMappedData != nullptr; }
+    // Las constantes se pueden leer desde contextos diferidos
+    bool SupportsDeferredContexts() const { return IsPersistent() || m_bUpdateBuffer; }
+
+    IBuffer* GetBuffer() const { return m_pBuffer; }
+
+    // Enlaza el bfer a una variable de constantes con una ventana de Size bytes; la
+    // posicin de la ventana se fija antes de cada CommitShaderResources() con
+    // SetBufferOffset() y el desplazamiento que devuelve Allocate()
+    void BindConstants(IShaderResourceVariable* pVar, Uint32 Size) const;
+
+    // Al principio y al final de cada frame, antes y despus de todas las asignaciones
+    void BeginFrame();
+    void EndFrame();
+
+    // Copia Size bytes al bfer y devuelve su desplazamiento. Si el presupuesto del frame
+    // se agota se registra un error y se reutiliza el principio del frame.
+    Uint32 Allocate(const void* pData, Uint32 Size);
+
+    template <typename DataType>
+    Uint32 Allocate(const DataType& Data)
+    {
+        return Allocate(&Data, static_cast<Uint32>(sizeof(DataType)));
+    }
+
+    struct Statistics
+    {
+        Uint32 UsedBytes      = 0; // Del ltimo frame terminado
+        Uint32 PeakUsedBytes  = 0;
+        Uint32 NumAllocations = 0; // Del ltimo frame terminado
+        Uint32 FrameSize      = 0;
+        Uint64 NumFenceStalls = 0; // Veces que BeginFrame() tuvo que esperar a la GPU
+    };
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+private:
+    IDeviceContext* m_pContext = nullptr;
+
+    RefCntAutoPtr<IBuffer> m_pBuffer;
+    RefCntAutoPtr<IFence>  m_pFence;
+    Uint8*                 m_pMappedData   = nullptr;
+    bool                   m_bUpdateBuffer = false;
+
+    Uint32 m_FrameSize = 0;
+    Uint32 m_Alignment = 256;
+
+    // Regin del frame actual y valor de fence que la libera en cada regin
+    Uint32 m_Region                            = 0;
+    Uint64 m_RegionFence[NUM_FRAMES_IN_FLIGHT] = {};
+    Uint64 m_NextFenceValue                    = 1;
+
+    Uint32 m_FrameOffset    = 0;
+    Uint32 m_NumAllocations = 0;
+    bool   m_bOverflowed    = false;
+
+    Statistics m_Stats;
+};
+
+} // namespace Diligent
@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <cstdio>
+#include "Tutorial14_FrameCapture.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "Image.h"
+#include "DataBlob.h"
+
+namespace Diligent
+{
+
+namespace
+{
+
+bool IsBGRA(TEXTURE_FORMAT Format)
+{
+    return Format == TEX_FORMAT_BGRA8_UNORM || Format == TEX_FORMAT_BGRA8_UNORM_SRGB;
+}
+
+bool IsSupportedFormat(TEXTURE_FORMAT Format)
+{
+    return IsBGRA(Format) || Format == TEX_FORMAT_RGBA8_UNORM || Format == TEX_FORMAT_RGBA8_UNORM_SRGB;
+}
+
+Uint8 ToByte(float Value)
+{
+    return static_cast<Uint8>(std::min(std::max(Value + 0.5f, 0.f), 255.f));
+}
+
+} // namespace
+
+Tutorial14_FrameCapture::Tutorial14_FrameCapture(IRenderDevice* pDevice, IDeviceContext* pContext) :
+    m_pDevice(pDevice),
+    m_pContext(pContext)
+{
+    FenceDesc FDesc;
+    FDesc.Name = "Frame capture fence";
+    m_pDevice->CreateFence(FDesc, &m_pFence);
+
+    for (Uint32 Source = 0; Source < SOURCE_COUNT; ++Source)
+    {
+        auto& CaptureStream  = m_Streams[Source];
+        CaptureStream.Source = static_cast<SOURCE>(Source);
+        for (Uint32 i = 0; i < NUM_SLOTS_PER_SOURCE; ++i)
+            CaptureStream.Slots.emplace_back(std::make_unique<Slot>());
+    }
+}
+
+Tutorial14_FrameCapture::~Tutorial14_FrameCapture()
+{
+    Stop();
+}
+
+const char* Tutorial14_FrameCapture::GetSourceName(SOURCE Source)
+{
+    switch (Source)
+    {
+        case SOURCE_BACK_BUFFER: return "backbuffer";
+        case SOURCE_CANVAS: return "canvas";
+        default: return "unknown";
+    }
+}
+
+bool Tutorial14_FrameCapture::Start(const Settings& CaptureSettings)
+{
+    Stop();
+
+    if (!m_pFence)
+    {
+        LOG_ERROR_MESSAGE("Frame capture fence is not available");
+        return false;
+    }
+
+    m_Settings               = CaptureSettings;
+    m_Settings.FrameInterval = std::max(m_Settings.FrameInterval, 1u);
+    m_Settings.FrameRate     = std::max(m_Settings.FrameRate, 1u);
+
+    for (auto& CaptureStream : m_Streams)
+    {
+        CaptureStream.NextSequence   = 0;
+        CaptureStream.SubmitSequence = 0;
+        CaptureStream.VideoWidth     = 0;
+        CaptureStream.VideoHeight    = 0;
+        if (m_Settings.Format != FORMAT::Y4M || !m_Settings.Sources[CaptureStream.Source])
+            continue;
+
+        const std::string Path = m_Settings.OutputPrefix + "_" + GetSourceName(CaptureStream.Source) + ".y4m";
+        CaptureStream.VideoFile.open(Path, std::ios::binary | std::ios::trunc);
+        if (!CaptureStream.VideoFile)
+        {
+            LOG_ERROR_MESSAGE("Failed to open capture file ", Path);
+            for (auto& OpenedStream : m_Streams)
+                OpenedStream.VideoFile.close();
+            return false;
+        }
+    }
+
+    m_pEncoders = std::make_unique<Tutorial14_ThreadPool>(m_Settings.NumThreads != 0 ? m_Settings.NumThreads : Tutorial14_ThreadPool::GetDefaultNumThreads(),
+                                                          "Capture encoder");
+
+    m_CapturedFrames = 0;
+    m_DroppedFrames  = 0;
+    m_EncodedFrames  = 0;
+    m_bCaptureFrame  = false;
+    m_bCapturing     = true;
+    return true;
+}
+
+void Tutorial14_FrameCapture::Stop()
+{
+    if (!m_bCapturing)
+        return;
+
+    T14_TRACE_SCOPE("FrameCapture::Stop");
+
+    // Terminar las copias en vuelo, codificarlas y liberar todas las ranuras
+    m_pContext->WaitForIdle();
+    for (auto& CaptureStream : m_Streams)
+        ProcessSlots(CaptureStream);
+    m_pEncoders->WaitIdle();
+    for (auto& CaptureStream : m_Streams)
+    {
+        ProcessSlots(CaptureStream);
+        CaptureStream.VideoFile.close();
+    }
+    m_pEncoders.reset();
+    m_bCapturing = false;
+
+    const auto Stats = GetStatistics();
+    LOG_INFO_MESSAGE("Frame capture finished: ", Stats.EncodedFrames, " frames encoded, ", Stats.DroppedFrames, " dropped");
+}
+
+void Tutorial14_FrameCapture::BeginFrame(Uint64 FrameId)
+{
+    m_FrameId = FrameId;
+    if (!m_bCapturing)
+        return;
+
+    T14_TRACE_SCOPE("FrameCapture::BeginFrame");
+
+    for (auto& CaptureStream : m_Streams)
+        ProcessSlots(CaptureStream);
+
+    m_bCaptureFrame = FrameId % m_Settings.FrameInterval == 0;
+}
+
+void Tutorial14_FrameCapture::Capture(SOURCE Source, ITexture* pTexture)
+{
+    if (!m_bCapturing || !m_bCaptureFrame || !m_Settings.Sources[Source] || pTexture == nullptr)
+        return;
+
+    const auto& SrcDesc = pTexture->GetDesc();
+    if (!IsSupportedFormat(SrcDesc.Format) || SrcDesc.SampleCount > 1)
+    {
+        LOG_ERROR_MESSAGE("Capture of ", GetSourceName(Source), " is disabled: only single-sampled RGBA8/BGRA8 textures are supported");
+        m_Settings.Sources[Source] = false;
+        return;
+    }
+
+    auto& CaptureStream = m_Streams[Source];
+
+    Slot* pSlot = nullptr;
+    for (auto& pCandidate : CaptureStream.Slots)
+    {
+        if (pCandidate->State.load() == SLOT_STATE_FREE)
+        {
+            pSlot = pCandidate.get();
+            break;
+        }
+    }
+    if (pSlot == nullptr)
+    {
+        // Todas las ranuras esperan a la GPU o a los codificadores
+        ++m_DroppedFrames;
+        return;
+    }
+
+    if (pSlot->pStagingTexture)
+    {
+        const auto& StagingDesc = pSlot->pStagingTexture->GetDesc();
+        if (StagingDesc.Width != SrcDesc.Width || StagingDesc.Height != SrcDesc.Height || StagingDesc.Format != SrcDesc.Format)
+            pSlot->pStagingTexture.Release();
+    }
+    if (!pSlot->pStagingTexture)
+    {
+        TextureDesc StagingDesc;
+        StagingDesc.Name           = "Frame capture staging texture";
+        StagingDesc.Type           = RESOURCE_DIM_TEX_2D;
+        StagingDesc.Width          = SrcDesc.Width;
+        StagingDesc.Height         = SrcDesc.Height;
+        StagingDesc.Format         = SrcDesc.Format;
+        StagingDesc.Usage          = USAGE_STAGING;
+        StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+        m_pDevice->CreateTexture(StagingDesc, nullptr, &pSlot->pStagingTexture);
+        if (!pSlot->pStagingTexture)
+        {
+            LOG_ERROR_MESSAGE("Failed to create frame capture staging texture");
+            ++m_DroppedFrames;
+            return;
+        }
+    }
+
+    m_pContext->CopyTexture(CopyTextureAttribs{pTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                               pSlot->pStagingTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION});
+
+    pSlot->FenceValue = m_NextFenceValue++;
+    pSlot->FrameId    = m_FrameId;
+    pSlot->State.store(SLOT_STATE_COPYING);
+    m_pContext->EnqueueSignal(m_pFence, pSlot->FenceValue);
+    ++m_CapturedFrames;
+}
+
+void Tutorial14_FrameCapture::ProcessSlots(Stream& CaptureStream)
+{
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+
+    // Las copias terminadas se entregan en orden para que el vdeo conserve el orden de los frames
+    for (;;)
+    {
+        Slot* pOldest = nullptr;
+        for (auto& pSlot : CaptureStream.Slots)
+        {
+            if (pSlot->State.load() == SLOT_STATE_COPYING && pSlot->FenceValue <= CompletedValue)
+            {
+                if (pOldest == nullptr || pSlot->FenceValue < pOldest->FenceValue)
+                    pOldest = pSlot.get();
+            }
+        }
+        if (pOldest == nullptr)
+            break;
+        SubmitEncodeJob(CaptureStream, *pOldest);
+    }
+
+    for (auto& pSlot : CaptureStream.Slots)
+    {
+        if (pSlot->State.load() == SLOT_STATE_ENCODED)
+        {
+            m_pContext->UnmapTextureSubresource(pSlot->pStagingTexture, 0, 0);
+            pSlot->State.store(SLOT_STATE_FREE);
+        }
+    }
+}
+
+void Tutorial14_FrameCapture::SubmitEncodeJob(Stream& CaptureStream, Slot& CaptureSlot)
+{
+    // La fence garantiza que la copia ha terminado, as que el mapeo no espera.
+    // La textura sigue mapeada mientras la usa el codificador.
+    MappedTextureSubresource MappedData;
+    m_pContext->MapTextureSubresource(CaptureSlot.pStagingTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+    if (MappedData.pData == nullptr)
+    {
+        ++m_DroppedFrames;
+        CaptureSlot.State.store(SLOT_STATE_FREE);
+        return;
+    }
+
+    CaptureSlot.State.store(SLOT_STATE_ENCODING);
+
+    Stream*      pStream  = &CaptureStream;
+    Slot*        pSlot    = &CaptureSlot;
+    const Uint64 Sequence = CaptureStream.SubmitSequence++;
+    m_pEncoders->Enqueue([this, pStream, pSlot, MappedData, Sequence]() {
+        if (m_Settings.Format == FORMAT::PNG)
+            EncodePNG(*pStream, *pSlot, MappedData.pData, MappedData.Stride);
+        else
+            EncodeY4M(*pStream, *pSlot, MappedData.pData, MappedData.Stride, Sequence);
+
+        ++m_EncodedFrames;
+        pSlot->State.store(SLOT_STATE_ENCODED);
+    });
+}
+
+void Tutorial14_FrameCapture::EncodePNG(const Stream& CaptureStream, const Slot& CaptureSlot, const void* pData, Uint64 Stride) const
+{
+    T14_TRACE_SCOPE("Encode PNG");
+
+    const auto& Desc = CaptureSlot.pStagingTexture->GetDesc();
+
+    // Image::Encode espera RGBA
+    std::vector<Uint8> Swizzled;
+    if (IsBGRA(Desc.Format))
+    {
+        Swizzled.resize(size_t{Desc.Width} * Desc.Height * 4);
+        for (Uint32 y = 0; y < Desc.Height; ++y)
+        {
+            const Uint8* pSrc = static_cast<const Uint8*>(pData) + Stride * y;
+            Uint8*       pDst = Swizzled.data() + size_t{Desc.Width} * 4 * y;
+            for (Uint32 x = 0; x < Desc.Width; ++x)
+            {
+                pDst[x * 4 + 0] = pSrc[x * 4 + 2];
+                pDst[x * 4 + 1] = pSrc[x * 4 + 1];
+                pDst[x * 4 + 2] = pSrc[x * 4 + 0];
+                pDst[x * 4 + 3] = pSrc[x * 4 + 3];
+            }
+        }
+        pData  = Swizzled.data();
+        Stride = Uint64{Desc.Width} * 4;
+    }
+
+    Image::EncodeInfo Info;
+    Info.Width      = Desc.Width;
+    Info.Height     = Desc.Height;
+    Info.TexFormat  = TEX_FORMAT_RGBA8_UNORM;
+    Info.KeepAlpha  = false;
+    Info.pData      = pData;
+    Info.Stride     = static_cast<Uint32>(Stride);
+    Info.FileFormat = IMAGE_FILE_FORMAT_PNG;
+
+    RefCntAutoPtr<IDataBlob> pEncoded;
+    Image::Encode(Info, &pEncoded);
+    if (!pEncoded)
+    {
+        LOG_ERROR_MESSAGE("Failed to encode captured frame ", CaptureSlot.FrameId);
+        return;
+    }
+
+    char FileName[32];
+    snprintf(FileName, sizeof(FileName), "_%s_%06llu.png", GetSourceName(CaptureStream.Source), static_cast<unsigned long long>(CaptureSlot.FrameId));
+    const std::string Path = m_Settings.OutputPrefix + FileName;
+
+    std::ofstream File{Path, std::ios::binary | std::ios::trunc};
+    File.write(static_cast<const char*>(pEncoded->GetDataPtr()), static_cast<std::streamsize>(pEncoded->GetSize()));
+    if (!File)
+        LOG_ERROR_MESSAGE("Failed to write ", Path);
+}
+
+void Tutorial14_FrameCapture::EncodeY4M(Stream& CaptureStream, const Slot& CaptureSlot, const void* pData, Uint64 Stride, Uint64 Sequence)
+{
+    const auto&  Desc         = CaptureSlot.pStagingTexture->GetDesc();
+    const Uint32 Width        = Desc.Width;
+    const Uint32 Height       = Desc.Height;
+    const Uint32 ChromaWidth  = (Width + 1) / 2;
+    const Uint32 ChromaHeight = (Height + 1) / 2;
+    const bool   bBGRA        = IsBGRA(Desc.Format);
+
+    // Conversin a YUV 4:2:0 de rango completo (BT.601), en paralelo con otros frames
+    std::vector<Uint8> Planes(size_t{Width} * Height + 2 * size_t{ChromaWidth} * ChromaHeight);
+    {
+        T14_TRACE_SCOPE("Convert frame to YUV");
+
+        Uint8* pY = Planes.data();
+        Uint8* pU = pY + size_t{Width} * Height;
+        Uint8* pV = pU + size_t{ChromaWidth} * ChromaHeight;
+
+        const Uint32 R = bBGRA ? 2 : 0;
+        const Uint32 B = bBGRA ? 0 : 2;
+        for (Uint32 cy = 0; cy < ChromaHeight; ++cy)
+        {
+            for (Uint32 cx = 0; cx < ChromaWidth; ++cx)
+            {
+                float SumR = 0, SumG = 0, SumB = 0;
+                for (Uint32 dy = 0; dy < 2; ++dy)
+                {
+                    for (Uint32 dx = 0; dx < 2; ++dx)
+                    {
+                        // En los bordes impares se repite la ltima fila o columna
+                        const Uint32 x      = std::min(cx * 2 + dx, Width - 1);
+                        const Uint32 y      = std::min(cy * 2 + dy, Height - 1);
+                        const Uint8* pTexel = static_cast<const Uint8*>(pData) + Stride * y + x * 4;
+
+                        const float r = pTexel[R], g = pTexel[1], b = pTexel[B];
+                        pY[size_t{y} * Width + x] = ToByte(0.299f * r + 0.587f * g + 0.114f * b);
+                        SumR += r;
+                        SumG += g;
+                        SumB += b;
+                    }
+                }
+                SumR *= 0.25f;
+                SumG *= 0.25f;
+                SumB *= 0.25f;
+                pU[size_t{cy} * ChromaWidth + cx] = ToByte(128.f - 0.168736f * SumR - 0.331264f * SumG + 0.5f * SumB);
+                pV[size_t{cy} * ChromaWidth + cx] = ToByte(128.f + 0.5f * SumR - 0.418688f * SumG - 0.081312f * SumB);
+            }
+        }
+    }
+
+    // Los frames se escriben en el orden en que se enviaron. Como la cola del grupo de
+    // hilos es FIFO, el frame anterior ya est en ejecucin o terminado.
+    std::unique_lock<std::mutex> Lock{CaptureStream.VideoMtx};
+    CaptureStream.VideoCV.wait(Lock, [&] { return CaptureStream.NextSequence == Sequence; });
+    {
+        T14_TRACE_SCOPE("Write Y4M frame");
+
+        if (CaptureStream.VideoWidth == 0)
+        {
+            CaptureStream.VideoWidth  = Width;
+            CaptureStream.VideoHeight = Height;
+            CaptureStream.VideoFile << "YUV4MPEG2 W" << Width << " H" << Height << " F" << m_Settings.FrameRate
+                                    << ":1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+        }
+
+        // Un vdeo Y4M no puede cambiar de resolucin
+        if (Width == CaptureStream.VideoWidth && Height == CaptureStream.VideoHeight)
+        {
+            CaptureStream.VideoFile << "FRAME\n";
+            CaptureStream.VideoFile.write(reinterpret_cast<const char*>(Planes.data()), static_cast<std::streamsize>(Planes.size()));
+        }
+        else
+        {
+            ++m_DroppedFrames;
+        }
+    }
+    ++CaptureStream.NextSequence;
+    Lock.unlock();
+    CaptureStream.VideoCV.notify_all();
+}
+
+Tutorial14_FrameCapture::Statistics Tutorial14_FrameCapture::GetStatistics() const
+{
+    Statistics Stats;
+    Stats.CapturedFrames = m_CapturedFrames.load();
+    Stats.DroppedFrames  = m_DroppedFrames.load();
+    Stats.EncodedFrames  = m_EncodedFrames.load();
+    return Stats;
+}
+
+} // namespace Diligent
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+#include "Tutorial14_ThreadPool.hpp"
+
+namespace Diligent
+{
+
+// Captura del back buffer y del canvas a secuencias PNG o a vdeo Y4M sin detener
+// el render. Cada fuente tiene un anillo de texturas de lectura (staging): la copia
+// se marca con una fence y, cuando termina, la textura se mapea y un grupo de hilos
+// codifica directamente desde la memoria mapeada. La ranura se libera en el hilo
+// principal cuando el trabajo termina. Si no hay ranuras libres el frame se descarta.
+class Tutorial14_FrameCapture
+{
+public:
+    static constexpr Uint32 NUM_SLOTS_PER_SOURCE = 4;
+
+    enum SOURCE : Uint32
+    {
+        SOURCE_BACK_BUFFER = 0,
+        SOURCE_CANVAS,
+        SOURCE_COUNT
+    };
+
+    enum class FORMAT
+    {
+        PNG, // Un fichero por frame
+        Y4M  // Un nico fichero YUV 4:2:0 por fuente
+    };
+
+    struct Settings
+    {
+        std::string OutputPrefix          = "Tutorial14_Capture";
+        FORMAT      Format                = FORMAT::PNG;
+        bool        Sources[SOURCE_COUNT] = {true, false};
+        Uint32      FrameInterval         = 1;  // Capturar uno de cada N frames
+        Uint32      FrameRate             = 60; // Velocidad que se indica en la cabecera Y4M
+        Uint32      NumThreads            = 0;  // 0: Tutorial14_ThreadPool::GetDefaultNumThreads()
+    };
+
+    struct Statistics
+    {
+        Uint64 CapturedFrames = 0;
+        Uint64 DroppedFrames  = 0;
+        Uint64 EncodedFrames  = 0;
+    };
+
+    Tutorial14_FrameCapture(IRenderDevice* pDevice, IDeviceContext* pContext);
+    ~Tutorial14_FrameCapture();
+
+    bool Start(const Settings& CaptureSettings);
+    // Espera a las copias y a los codificadores y cierra los ficheros
+    void Stop();
+
+    bool IsCapturing() const { return m_bCapturing; }
+
+    // Al principio de cada frame: entrega las copias terminadas a los codificadores
+    // y libera las ranuras ya codificadas
+    void BeginFrame(Uint64 FrameId);
+
+    // Copia la textura si la fuente est activa y toca capturar este frame.
+    // Solo admite formatos RGBA8/BGRA8.
+    void Capture(SOURCE Source, ITexture* pTexture);
+
+    Statistics GetStatistics() const;
+
+    const Settings& GetSettings() const { return m_Settings; }
+
+    static const char* GetSourceName(SOURCE Source);
+
+private:
+    enum SLOT_STATE : Uint32
+    {
+        SLOT_STATE_FREE = 0,
+        SLOT_STATE_COPYING,  // Esperando a la fence
+        SLOT_STATE_ENCODING, // Mapeada; la usa un codificador
+        SLOT_STATE_ENCODED   // El codificador ha terminado; falta desmapear
+    };
+
+    struct Slot
+    {
+        RefCntAutoPtr<ITexture> pStagingTexture;
+        std::atomic<Uint32>     State{SLOT_STATE_FREE};
+        Uint64                  FenceValue = 0;
+        Uint64                  FrameId    = 0;
+    };
+
+    struct Stream
+    {
+        SOURCE                             Source = SOURCE_BACK_BUFFER;
+        std::vector<std::unique_ptr<Slot>> Slots;
+
+        // Vdeo Y4M: los frames se escriben en el orden en que se enviaron
+        std::ofstream           VideoFile;
+        std::mutex              VideoMtx;
+        std::condition_variable VideoCV;
+        Uint64                  NextSequence   = 0; // Siguiente frame que se puede escribir
+        Uint64                  SubmitSequence = 0; // Solo en el hilo principal
+        Uint32                  VideoWidth     = 0;
+        Uint32                  VideoHeight    = 0;
+    };
+
+    void ProcessSlots(Stream& CaptureStream);
+    void SubmitEncodeJob(Stream& CaptureStream, Slot& CaptureSlot);
+    void EncodePNG(const Stream& CaptureStream, const Slot& CaptureSlot, const void* pData, Uint64 Stride) const;
+    void EncodeY4M(Stream& CaptureStream, const Slot& CaptureSlot, const void* pData, Uint64 Stride, Uint64 Sequence);
+
+    IRenderDevice*  m_pDevice  = nullptr;
+    IDeviceContext* m_pContext = nullptr;
+
+    Settings m_Settings;
+    bool     m_bCapturing     = false;
+    bool     m_bCaptureFrame  = false;
+    Uint64   m_FrameId        = 0;
+    Uint64   m_NextFenceValue = 1;
+
+    RefCntAutoPtr<IFence>                  m_pFence;
+    std::array<Stream, SOURCE_COUNT>       m_Streams;
+    std::unique_ptr<Tutorial14_ThreadPool> m_pEncoders;
+
+    std::atomic<Uint64> m_CapturedFrames{0};
+    std::atomic<Uint64> m_DroppedFrames{0};
+    std::atomic<Uint64> m_EncodedFrames{0};
+};
+
+} // namespace Diligent
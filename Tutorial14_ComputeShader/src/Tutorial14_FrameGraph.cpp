@@ -0,0 +1,368 @@
+#include <algorithm>
+#include "Tutorial14_FrameGraph.hpp"
+#include "Tutorial14_GPUProfiler.hpp"
+#include "Tutorial14_CommandRecorder.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+
+namespace Diligent
+{
+
+Tutorial14_FrameGraph::Tutorial14_FrameGraph(IRenderDevice*  pDevice,
+                                             IDeviceContext* pContext) :
+    m_pDevice(pDevice),
+    m_pContext(pContext)
+{
+}
+
+Tutorial14_FrameGraph::~Tutorial14_FrameGraph()
+{
+}
+
+Tutorial14_FrameGraph::ResourceId Tutorial14_FrameGraph::ImportBuffer(IBuffer* pBuffer)
+{
+    if (pBuffer == nullptr)
+        return INVALID_RESOURCE;
+
+    auto It = m_ImportedIds.find(pBuffer);
+    if (It != m_ImportedIds.end())
+        return It->second;
+
+    Resource Res;
+    Res.pObject = pBuffer;
+    Res.pBuffer = pBuffer;
+    m_Resources.push_back(Res);
+
+    const ResourceId Id = static_cast<ResourceId>(m_Resources.size() - 1);
+    m_ImportedIds.emplace(pBuffer, Id);
+    return Id;
+}
+
+Tutorial14_FrameGraph::ResourceId Tutorial14_FrameGraph::ImportTexture(ITexture* pTexture)
+{
+    if (pTexture == nullptr)
+        return INVALID_RESOURCE;
+
+    auto It = m_ImportedIds.find(pTexture);
+    if (It != m_ImportedIds.end())
+        return It->second;
+
+    Resource Res;
+    Res.pObject  = pTexture;
+    Res.pTexture = pTexture;
+    m_Resources.push_back(Res);
+
+    const ResourceId Id = static_cast<ResourceId>(m_Resources.size() - 1);
+    m_ImportedIds.emplace(pTexture, Id);
+    return Id;
+}
+
+Tutorial14_FrameGraph::ResourceId Tutorial14_FrameGraph::CreateTransientTexture(const TextureDesc& Desc)
+{
+    // La textura fsica se elige en Execute(), cuando se conocen todos los pases
+    Resource Res;
+    Res.bTransient = true;
+    Res.Desc       = Desc;
+    m_Resources.push_back(Res);
+    return static_cast<ResourceId>(m_Resources.size() - 1);
+}
+
+ITexture* Tutorial14_FrameGraph::GetTexture(ResourceId Id) const
+{
+    return Id < m_Resources.size() ? m_Resources[Id].pTexture : nullptr;
+}
+
+void Tutorial14_FrameGraph::AddPass(const char* Name, std::initializer_list<Access> Accesses, ExecuteCallback&& Callback)
+{
+    Pass P;
+    P.Name        = Name;
+    P.FirstAccess = static_cast<Uint32>(m_Accesses.size());
+    for (const Access& A : Accesses)
+    {
+        if (A.Id == INVALID_RESOURCE)
+            continue;
+
+        VERIFY_EXPR(A.Id < m_Resources.size());
+        m_Accesses.push_back(A);
+    }
+    P.NumAccesses = static_cast<Uint32>(m_Accesses.size()) - P.FirstAccess;
+    P.Callback    = std::move(Callback);
+    m_Passes.emplace_back(std::move(P));
+}
+
+void Tutorial14_FrameGraph::AddDeferredPass(const char* Name, std::initializer_list<Access> Accesses, ExecuteCallback&& Callback)
+{
+    AddPass(Name, Accesses, std::move(Callback));
+    m_Passes.back().bDeferred = true;
+}
+
+bool Tutorial14_FrameGraph::IsCompatible(const TextureDesc& Desc1, const TextureDesc& Desc2)
+{
+    // clang-format off
+    return Desc1.Type        == Desc2.Type        &&
+           Desc1.Width       == Desc2.Width       &&
+           Desc1.Height      == Desc2.Height      &&
+           Desc1.ArraySize   == Desc2.ArraySize   &&
+           Desc1.Format      == Desc2.Format      &&
+           Desc1.MipLevels   == Desc2.MipLevels   &&
+           Desc1.SampleCount == Desc2.SampleCount &&
+           Desc1.BindFlags   == Desc2.BindFlags   &&
+           Desc1.Usage       == Desc2.Usage;
+    // clang-format on
+}
+
+void Tutorial14_FrameGraph::AllocateTransientTextures()
+{
+    for (PooledTexture& Pooled : m_TexturePool)
+    {
+        Pooled.AvailableFromPass = 0;
+        Pooled.bUsed             = false;
+    }
+
+    // Intervalo de vida de cada textura temporal: de su primer a su ltimo pase
+    for (Uint32 p = 0; p < m_Passes.size(); ++p)
+    {
+        const Pass& P = m_Passes[p];
+        for (Uint32 a = P.FirstAccess; a < P.FirstAccess + P.NumAccesses; ++a)
+        {
+            Resource& Res = m_Resources[m_Accesses[a].Id];
+            if (Res.bTransient)
+            {
+                Res.FirstPass = std::min(Res.FirstPass, p);
+                Res.LastPass  = std::max(Res.LastPass, p);
+            }
+        }
+    }
+
+    std::vector<ResourceId> Transients;
+    for (ResourceId Id = 0; Id < m_Resources.size(); ++Id)
+    {
+        if (m_Resources[Id].bTransient && m_Resources[Id].FirstPass != ~0u)
+            Transients.push_back(Id);
+    }
+    std::sort(Transients.begin(), Transients.end(), [this](ResourceId Id1, ResourceId Id2) {
+        return m_Resources[Id1].FirstPass < m_Resources[Id2].FirstPass;
+    });
+
+    // Por orden de primer uso, cada textura ocupa la primera textura fsica compatible que
+    // ya no use nadie
+    for (ResourceId Id : Transients)
+    {
+        Resource& Res = m_Resources[Id];
+
+        PooledTexture* pSlot = nullptr;
+        for (PooledTexture& Pooled : m_TexturePool)
+        {
+            if (Pooled.AvailableFromPass <= Res.FirstPass && IsCompatible(Pooled.pTexture->GetDesc(), Res.Desc))
+            {
+                pSlot = &Pooled;
+                break;
+            }
+        }
+
+        if (pSlot == nullptr)
+        {
+            RefCntAutoPtr<ITexture> pTexture;
+            m_pDevice->CreateTexture(Res.Desc, nullptr, &pTexture);
+            if (!pTexture)
+            {
+                LOG_ERROR_MESSAGE("Failed to create transient texture '", (Res.Desc.Name != nullptr ? Res.Desc.Name : ""), "'");
+                continue;
+            }
+            m_TexturePool.emplace_back();
+            pSlot           = &m_TexturePool.back();
+            pSlot->pTexture = std::move(pTexture);
+        }
+
+        pSlot->AvailableFromPass = Res.LastPass + 1;
+        pSlot->bUsed             = true;
+
+        Res.pTexture = pSlot->pTexture;
+        Res.pObject  = Res.pTexture;
+        // El contenido del usuario anterior no se conserva
+        Res.bDiscardContent = true;
+    }
+
+    // Las texturas que no ha usado ningn pase en este frame se liberan
+    m_TexturePool.erase(std::remove_if(m_TexturePool.begin(), m_TexturePool.end(),
+                                       [](const PooledTexture& Pooled) { return !Pooled.bUsed; }),
+                        m_TexturePool.end());
+
+    m_Stats.NumTransientTextures = static_cast<Uint32>(Transients.size());
+    m_Stats.NumPhysicalTextures  = static_cast<Uint32>(m_TexturePool.size());
+}
+
+void Tutorial14_FrameGraph::CollectPassBarriers(const Pass& P, bool bDeferred)
+{
+    for (Uint32 a = P.FirstAccess; a < P.FirstAccess + P.NumAccesses; ++a)
+    {
+        const Access& A   = m_Accesses[a];
+        Resource&     Res = m_Resources[A.Id];
+        if (Res.pObject == nullptr)
+            continue;
+
+        // En un tramo diferido, el estado que dejan las barreras ya calculadas del tramo
+        const auto           It        = bDeferred ? m_DeferredStates.find(Res.pObject) : m_DeferredStates.end();
+        const RESOURCE_STATE CurrState = It != m_DeferredStates.end() ? It->second.State :
+                                                                        (Res.pBuffer != nullptr ? Res.pBuffer->GetState() : Res.pTexture->GetState());
+        // El motor no registra el estado de este recurso: se encarga quien lo cre
+        if (CurrState == RESOURCE_STATE_UNKNOWN)
+            continue;
+
+        // Las barreras grabadas en un contexto diferido no pueden actualizar el estado
+        // registrado, que se fija al ejecutar las listas
+        auto           Flags    = bDeferred ? STATE_TRANSITION_FLAG_NONE : STATE_TRANSITION_FLAG_UPDATE_STATE;
+        RESOURCE_STATE NewState = CurrState;
+        const bool     bDiscard = Res.bDiscardContent;
+        if (bDiscard)
+        {
+            Flags               = static_cast<STATE_TRANSITION_FLAGS>(Flags | STATE_TRANSITION_FLAG_DISCARD_CONTENT);
+            Res.bDiscardContent = false;
+        }
+
+        if (A.State == RESOURCE_STATE_UNORDERED_ACCESS)
+        {
+            if (CurrState != RESOURCE_STATE_UNORDERED_ACCESS)
+            {
+                m_Barriers.emplace_back(Res.pObject, CurrState, A.State, Flags);
+                NewState = A.State;
+            }
+            else if (m_UAVWritten.count(Res.pObject) != 0)
+            {
+                // Escritura tras escritura sin cambio de estado: barrera UAV
+                m_Barriers.emplace_back(Res.pObject, CurrState, A.State, Flags);
+                ++m_Stats.NumUAVBarriers;
+            }
+            m_UAVWritten.insert(Res.pObject);
+        }
+        else if ((CurrState & A.State) != A.State || bDiscard)
+        {
+            // La transicin ya ordena las escrituras UAV anteriores. Un alias nuevo de una
+            // textura temporal la emite aunque el estado coincida, para descartar el contenido.
+            m_Barriers.emplace_back(Res.pObject, CurrState, A.State, Flags);
+            m_UAVWritten.erase(Res.pObject);
+            NewState = A.State;
+        }
+
+        if (bDeferred)
+            m_DeferredStates[Res.pObject] = DeferredState{&Res, NewState};
+    }
+}
+
+void Tutorial14_FrameGraph::TransitionPassResources(const Pass& P)
+{
+    m_Barriers.clear();
+    CollectPassBarriers(P, false);
+
+    if (!m_Barriers.empty())
+    {
+        m_pContext->TransitionResourceStates(static_cast<Uint32>(m_Barriers.size()), m_Barriers.data());
+        m_Stats.NumBarriers += static_cast<Uint32>(m_Barriers.size());
+        ++m_Stats.NumBarrierBatches;
+    }
+}
+
+void Tutorial14_FrameGraph::RecordDeferredPasses(Uint32 FirstPass, Uint32 EndPass)
+{
+    T14_TRACE_SCOPE("FrameGraph::RecordDeferredPasses");
+
+    // Las barreras de todo el tramo se calculan en orden antes de grabarlo: cada pase parte
+    // de los estados que dejan las barreras de los anteriores
+    m_Barriers.clear();
+    m_DeferredStates.clear();
+    for (Uint32 p = FirstPass; p < EndPass; ++p)
+    {
+        Pass& P        = m_Passes[p];
+        P.FirstBarrier = static_cast<Uint32>(m_Barriers.size());
+        CollectPassBarriers(P, true);
+        P.NumBarriers = static_cast<Uint32>(m_Barriers.size()) - P.FirstBarrier;
+        if (P.NumBarriers > 0)
+            ++m_Stats.NumBarrierBatches;
+    }
+    m_Stats.NumBarriers += static_cast<Uint32>(m_Barriers.size());
+
+    // Mientras se graba, el estado de estos recursos solo lo conocen las barreras del tramo:
+    // desconocido para el motor, que no intenta verificarlo desde los otros hilos
+    auto SetState = [](const Resource& Res, RESOURCE_STATE State) {
+        if (Res.pBuffer != nullptr)
+            Res.pBuffer->SetState(State);
+        else
+            Res.pTexture->SetState(State);
+    };
+    for (const auto& It : m_DeferredStates)
+        SetState(*It.second.pRes, RESOURCE_STATE_UNKNOWN);
+
+    // Segmentos de pases contiguos; las listas se ejecutan en el orden de los pases. Con la
+    // medida por pase cada segmento tiene un solo pase y lleva su nombre.
+    const Uint32 NumPasses   = EndPass - FirstPass;
+    const bool   bPerPass    = m_bPerPassTiming && m_pProfiler != nullptr;
+    const Uint32 NumSegments = bPerPass ? NumPasses : std::min({NumPasses, m_pRecorder->GetNumWorkers(), MAX_DEFERRED_SEGMENTS});
+    for (Uint32 s = 0; s < NumSegments; ++s)
+    {
+        const Uint32 SegmentFirst = FirstPass + NumPasses * s / NumSegments;
+        const Uint32 SegmentEnd   = FirstPass + NumPasses * (s + 1) / NumSegments;
+        const char*  SegmentName  = bPerPass ? m_Passes[SegmentFirst].Name : "Frame graph segment";
+        m_pRecorder->AddSegment(SegmentName, [this, SegmentFirst, SegmentEnd](IDeviceContext* pContext) {
+            for (Uint32 p = SegmentFirst; p < SegmentEnd; ++p)
+            {
+                const Pass&                P = m_Passes[p];
+                Tutorial14_CPUTrace::Scope Trace{P.Name};
+                if (P.NumBarriers > 0)
+                    pContext->TransitionResourceStates(P.NumBarriers, &m_Barriers[P.FirstBarrier]);
+                P.Callback(pContext);
+            }
+        });
+    }
+    m_pRecorder->Submit(m_pProfiler);
+
+    for (const auto& It : m_DeferredStates)
+        SetState(*It.second.pRes, It.second.State);
+    m_DeferredStates.clear();
+
+    m_Stats.NumDeferredPasses += NumPasses;
+    m_Stats.NumDeferredSegments += NumSegments;
+}
+
+void Tutorial14_FrameGraph::Execute()
+{
+    T14_TRACE_SCOPE("FrameGraph::Execute");
+
+    m_Stats.NumPasses         = static_cast<Uint32>(m_Passes.size());
+    m_Stats.NumBarriers       = 0;
+    m_Stats.NumUAVBarriers    = 0;
+    m_Stats.NumBarrierBatches = 0;
+
+    m_Stats.NumDeferredPasses   = 0;
+    m_Stats.NumDeferredSegments = 0;
+
+    AllocateTransientTextures();
+
+    const bool bParallel = m_pRecorder != nullptr && m_pRecorder->IsParallel();
+    for (Uint32 p = 0; p < m_Passes.size();)
+    {
+        if (bParallel && m_Passes[p].bDeferred)
+        {
+            Uint32 EndPass = p + 1;
+            while (EndPass < m_Passes.size() && m_Passes[EndPass].bDeferred)
+                ++EndPass;
+            RecordDeferredPasses(p, EndPass);
+            p = EndPass;
+            continue;
+        }
+
+        const Pass&                        P = m_Passes[p++];
+        Tutorial14_CPUTrace::Scope         Trace{P.Name};
+        Tutorial14_GPUProfiler::ScopedPass GPUPass{m_pProfiler, P.Name};
+
+        TransitionPassResources(P);
+        P.Callback(m_pContext);
+    }
+
+    // Los vectores conservan su capacidad para el siguiente frame
+    m_Resources.clear();
+    m_ImportedIds.clear();
+    m_Accesses.clear();
+    m_Passes.clear();
+    m_UAVWritten.clear();
+}
+
+} // namespace Diligent
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+class Tutorial14_GPUProfiler;
+class Tutorial14_CommandRecorder;
+
+// Grafo de pases de un frame. Cada pase declara los recursos que usa y en qu estado, y
+// el grafo emite antes de ejecutarlo las transiciones necesarias en una sola llamada a
+// TransitionResourceStates(); los pases confirman sus recursos con PASS_TRANSITION_MODE
+// en lugar de TRANSITION.
+//
+// Las transiciones se calculan con el estado que el motor registra para cada objeto en
+// el momento de ejecutar el pase, as que siguen siendo correctas si un mdulo hace
+// transiciones por su cuenta dentro del pase. Si un recurso se usa como UAV en dos pases
+// seguidos se emite una barrera UAV entre ellos.
+//
+// Las texturas temporales viven solo entre su primer y su ltimo pase; las que no se
+// solapan en el tiempo y tienen la misma descripcin comparten textura fsica, y la
+// reserva se conserva entre frames.
+//
+// Con un grabador de comandos en paralelo, cada tramo de pases diferidos seguidos
+// (AddDeferredPass()) se reparte en segmentos del grabador. Las barreras del tramo se
+// calculan antes de grabarlo con los estados que van dejando sus pases, se graban en
+// los segmentos como barreras explcitas y los estados registrados se actualizan al
+// ejecutar las listas, igual que en el lote de escenas.
+class Tutorial14_FrameGraph
+{
+public:
+    using ResourceId = Uint32;
+
+    // Segmentos como mucho por tramo de pases diferidos: cada pase suele ser un solo
+    // dispatch o draw, y ms listas de comandos no compensan su coste
+    static constexpr Uint32 MAX_DEFERRED_SEGMENTS = 4;
+
+    // Los accesos con este identificador se ignoran (recursos opcionales)
+    static constexpr ResourceId INVALID_RESOURCE = ~0u;
+
+#ifdef DILIGENT_DEBUG
+    // En depuracin el motor comprueba que el grafo ha dejado cada recurso en su estado
+    static constexpr RESOURCE_STATE_TRANSITION_MODE PASS_TRANSITION_MODE = RESOURCE_STATE_TRANSITION_MODE_VERIFY;
+#else
+    static constexpr RESOURCE_STATE_TRANSITION_MODE PASS_TRANSITION_MODE = RESOURCE_STATE_TRANSITION_MODE_NONE;
+#endif
+
+    struct Access
+    {
+        ResourceId     Id;
+        RESOURCE_STATE State;
+    };
+
+    using ExecuteCallback = std::function<void(IDeviceContext* pContext)>;
+
+    Tutorial14_FrameGraph(IRenderDevice*  pDevice,
+                          IDeviceContext* pContext);
+    ~Tutorial14_FrameGraph();
+
+    // clang-format off
+    Tutorial14_FrameGraph(const Tutorial14_FrameGraph&)            = delete;
+    Tutorial14_FrameGraph& operator=(const Tutorial14_FrameGraph&) = delete;
+    // clang-format on
+
+    // Perfilador opcional: cada pase se mide con su nombre, y cada segmento de pases
+    // diferidos como "Frame graph segment"
+    void SetProfiler(Tutorial14_GPUProfiler* pProfiler) { m_pProfiler = pProfiler; }
+
+    // Con la medida por pase, cada pase diferido se graba en su propio segmento, que se mide
+    // con el nombre del pase. Son ms listas de comandos, as que solo conviene activarla
+    // mientras alguien lee los tiempos (el panel del perfilador o el benchmark).
+    void SetPerPassTiming(bool bPerPassTiming) { m_bPerPassTiming = bPerPassTiming; }
+
+    // Grabador opcional para los pases diferidos; sin l, o si no tiene contextos diferidos,
+    // todos los pases se graban en el contexto inmediato. Las constantes que usan esos pases
+    // deben estar en bferes que no sean dinmicos, porque los datos de un bfer dinmico
+    // son propios de cada contexto.
+    void SetCommandRecorder(Tutorial14_CommandRecorder* pRecorder) { m_pRecorder = pRecorder; }
+
+    // Recursos persistentes. Importar dos veces el mismo objeto devuelve el mismo
+    // identificador; nullptr devuelve INVALID_RESOURCE.
+    ResourceId ImportBuffer(IBuffer* pBuffer);
+    ResourceId ImportTexture(ITexture* pTexture);
+
+    // Textura temporal del frame. Solo se puede obtener con GetTexture() durante la
+    // ejecucin de los pases que la declaran.
+    ResourceId CreateTransientTexture(const TextureDesc& Desc);
+    ITexture*  GetTexture(ResourceId Id) const;
+
+    // Name debe seguir siendo vlido hasta Execute() (normalmente, un literal)
+    void AddPass(const char* Name, std::initializer_list<Access> Accesses, ExecuteCallback&& Callback);
+
+    // Pase que se puede grabar en un contexto diferido en otro hilo. El callback solo debe
+    // grabar en el contexto que recibe, sin transiciones implcitas (fija sus render targets
+    // y viewports), y no puede modificar estado que lean otros pases del frame.
+    void AddDeferredPass(const char* Name, std::initializer_list<Access> Accesses, ExecuteCallback&& Callback);
+
+    // Ejecuta los pases en el orden en que se aadieron y vaca el grafo para el siguiente frame
+    void Execute();
+
+    struct Statistics
+    {
+        Uint32 NumPasses            = 0; // Del ltimo frame
+        Uint32 NumBarriers          = 0; // Del ltimo frame, incluidas las barreras UAV
+        Uint32 NumUAVBarriers       = 0;
+        Uint32 NumBarrierBatches    = 0;
+        Uint32 NumTransientTextures = 0;
+        Uint32 NumPhysicalTextures  = 0; // Texturas de la reserva tras el ltimo frame
+        Uint32 NumDeferredPasses    = 0; // Del ltimo frame, grabados en contextos diferidos
+        Uint32 NumDeferredSegments  = 0;
+    };
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+private:
+    struct Resource
+    {
+        IDeviceObject* pObject  = nullptr;
+        IBuffer*       pBuffer  = nullptr;
+        ITexture*      pTexture = nullptr;
+
+        // Solo texturas temporales
+        bool        bTransient = false;
+        TextureDesc Desc;
+        Uint32      FirstPass = ~0u;
+        Uint32      LastPass  = 0;
+        // El primer acceso descarta el contenido del usuario anterior de la textura fsica.
+        // Va por recurso lgico: varios recursos pueden compartir la misma textura.
+        bool bDiscardContent = false;
+    };
+
+    struct Pass
+    {
+        const char*     Name        = nullptr;
+        Uint32          FirstAccess = 0;
+        Uint32          NumAccesses = 0;
+        bool            bDeferred   = false;
+        ExecuteCallback Callback;
+
+        // Barreras del pase en m_Barriers, solo en los tramos diferidos
+        Uint32 FirstBarrier = 0;
+        Uint32 NumBarriers  = 0;
+    };
+
+    struct PooledTexture
+    {
+        RefCntAutoPtr<ITexture> pTexture;
+        Uint32                  AvailableFromPass = 0;
+        bool                    bUsed             = false;
+    };
+
+    void AllocateTransientTextures();
+    // Aade a m_Barriers las barreras del pase. Las de un pase diferido no actualizan los
+    // estados registrados: se acumulan en m_DeferredStates.
+    void CollectPassBarriers(const Pass& P, bool bDeferred);
+    void TransitionPassResources(const Pass& P);
+    // Graba los pases [FirstPass, EndPass), todos diferidos, en segmentos del grabador
+    void RecordDeferredPasses(Uint32 FirstPass, Uint32 EndPass);
+
+    static bool IsCompatible(const TextureDesc& Desc1, const TextureDesc& Desc2);
+
+    IRenderDevice*              m_pDevice   = nullptr;
+    IDeviceContext*             m_pContext  = nullptr;
+    Tutorial14_GPUProfiler*     m_pProfiler = nullptr;
+    Tutorial14_CommandRecorder* m_pRecorder = nullptr;
+
+    bool m_bPerPassTiming = false;
+
+    std::vector<Resource>                          m_Resources;
+    std::unordered_map<IDeviceObject*, ResourceId> m_ImportedIds;
+    std::vector<Access>                            m_Accesses;
+    std::vector<Pass>                              m_Passes;
+    std::vector<PooledTexture>                     m_TexturePool;
+
+    // Objetos escritos como UAV por un pase anterior del frame
+    std::unordered_set<IDeviceObject*> m_UAVWritten;
+
+    std::vector<StateTransitionDesc> m_Barriers;
+
+    // Estado de cada objeto tras las barreras ya calculadas del tramo diferido en curso. Va
+    // por objeto, no por recurso: varias texturas temporales comparten textura fsica.
+    struct DeferredState
+    {
+        const Resource* pRes  = nullptr;
+        RESOURCE_STATE  State = RESOURCE_STATE_UNKNOWN;
+    };
+    std::unordered_map<IDeviceObject*, DeferredState> m_DeferredStates;
+
+    Statistics m_Stats;
+};
+
+} // namespace Diligent
@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cstring>
+#include "Tutorial14_GPUProfiler.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Mximo de frames resueltos que se guardan si nadie los consume
+constexpr size_t MAX_RESOLVED_FRAMES = 16;
+
+} // namespace
+
+Tutorial14_GPUProfiler::Tutorial14_GPUProfiler(IRenderDevice* pDevice, IDeviceContext* pContext) :
+    m_pDevice(pDevice),
+    m_pContext(pContext)
+{
+    m_bSupported = m_pDevice->GetDeviceInfo().Features.TimestampQueries == DEVICE_FEATURE_STATE_ENABLED;
+    if (!m_bSupported)
+    {
+        LOG_WARNING_MESSAGE("Timestamp queries are not supported by this device: GPU pass timings are disabled");
+    }
+}
+
+RefCntAutoPtr<IQuery> Tutorial14_GPUProfiler::CreateTimestampQuery()
+{
+    QueryDesc QDesc;
+    QDesc.Name = "GPU profiler timestamp";
+    QDesc.Type = QUERY_TYPE_TIMESTAMP;
+
+    RefCntAutoPtr<IQuery> pQuery;
+    m_pDevice->CreateQuery(QDesc, &pQuery);
+    return pQuery;
+}
+
+void Tutorial14_GPUProfiler::BeginFrame(Uint64 FrameId)
+{
+    if (!m_bSupported)
+        return;
+
+    // Intentar resolver todos los frames pendientes, del ms antiguo al ms reciente
+    for (Uint32 i = 1; i <= NUM_FRAMES_IN_FLIGHT; ++i)
+        TryResolve((m_CurrentSlot + i) % NUM_FRAMES_IN_FLIGHT);
+
+    m_CurrentSlot = static_cast<Uint32>(FrameId % NUM_FRAMES_IN_FLIGHT);
+
+    auto& Slot = m_Frames[m_CurrentSlot];
+    // Si la ranura sigue pendiente la GPU va ms de NUM_FRAMES_IN_FLIGHT frames por detrs:
+    // se descarta el frame antiguo en lugar de esperar.
+    Slot.Pending   = false;
+    Slot.FrameId   = FrameId;
+    Slot.NumPasses = 0;
+
+    m_OpenPasses.clear();
+    m_bInsideFrame = true;
+}
+
+void Tutorial14_GPUProfiler::EndFrame()
+{
+    if (!m_bSupported || !m_bInsideFrame)
+        return;
+
+    // Cerrar los pases que hayan quedado abiertos
+    while (!m_OpenPasses.empty())
+        EndPass();
+
+    auto& Slot     = m_Frames[m_CurrentSlot];
+    Slot.Pending   = Slot.NumPasses > 0;
+    m_bInsideFrame = false;
+}
+
+void Tutorial14_GPUProfiler::BeginPass(const char* Name)
+{
+    if (!m_bSupported || !m_bInsideFrame)
+        return;
+
+    auto& Slot = m_Frames[m_CurrentSlot];
+    if (Slot.NumPasses == Slot.Passes.size())
+    {
+        PassQueries NewPass;
+        NewPass.pBegin = CreateTimestampQuery();
+        NewPass.pEnd   = CreateTimestampQuery();
+        if (!NewPass.pBegin || !NewPass.pEnd)
+            return;
+        Slot.Passes.emplace_back(std::move(NewPass));
+    }
+
+    auto& Pass = Slot.Passes[Slot.NumPasses];
+    Pass.Name  = Name;
+    m_pContext->EndQuery(Pass.pBegin);
+    m_OpenPasses.push_back(Slot.NumPasses);
+    ++Slot.NumPasses;
+}
+
+void Tutorial14_GPUProfiler::EndPass()
+{
+    if (!m_bSupported || !m_bInsideFrame || m_OpenPasses.empty())
+        return;
+
+    auto& Slot = m_Frames[m_CurrentSlot];
+    m_pContext->EndQuery(Slot.Passes[m_OpenPasses.back()].pEnd);
+    m_OpenPasses.pop_back();
+}
+
+void Tutorial14_GPUProfiler::TryResolve(Uint32 SlotIdx)
+{
+    auto& Slot = m_Frames[SlotIdx];
+    if (!Slot.Pending)
+        return;
+
+    // Comprobar primero que todas las consultas estn listas sin invalidarlas
+    FrameTimings Timings;
+    Timings.FrameId = Slot.FrameId;
+    Timings.Passes.reserve(Slot.NumPasses);
+    for (Uint32 i = 0; i < Slot.NumPasses; ++i)
+    {
+        const auto& Pass = Slot.Passes[i];
+
+        QueryDataTimestamp BeginData, EndData;
+        if (!Pass.pBegin->GetData(&BeginData, sizeof(BeginData), false) ||
+            !Pass.pEnd->GetData(&EndData, sizeof(EndData), false))
+            return;
+
+        double Milliseconds = 0;
+        if (EndData.Counter > BeginData.Counter && EndData.Frequency > 0)
+            Milliseconds = static_cast<double>(EndData.Counter - BeginData.Counter) * 1000.0 / static_cast<double>(EndData.Frequency);
+
+        // Los pases repetidos en un mismo frame (p. ej. subpasos de la simulacin) se suman
+        auto It = std::find_if(Timings.Passes.begin(), Timings.Passes.end(),
+                               [&](const PassTiming& Timing) { return std::strcmp(Timing.Name, Pass.Name) == 0; });
+        if (It != Timings.Passes.end())
+        {
+            It->Milliseconds += Milliseconds;
+            continue;
+        }
+
+        PassTiming Timing;
+        Timing.Name         = Pass.Name;
+        Timing.Milliseconds = Milliseconds;
+        Timings.Passes.push_back(Timing);
+    }
+
+    for (Uint32 i = 0; i < Slot.NumPasses; ++i)
+    {
+        Slot.Passes[i].pBegin->Invalidate();
+        Slot.Passes[i].pEnd->Invalidate();
+    }
+    Slot.Pending = false;
+
+    UpdateStatistics(Timings);
+
+    if (m_Resolved.size() >= MAX_RESOLVED_FRAMES)
+        m_Resolved.pop_front();
+    m_Resolved.emplace_back(std::move(Timings));
+}
+
+void Tutorial14_GPUProfiler::PassHistory::AddSample(double Milliseconds)
+{
+    if (Samples.size() < STATS_WINDOW)
+    {
+        Samples.push_back(static_cast<float>(Milliseconds));
+    }
+    else
+    {
+        Samples[NextSample] = static_cast<float>(Milliseconds);
+        NextSample          = (NextSample + 1) % STATS_WINDOW;
+    }
+}
+
+void Tutorial14_GPUProfiler::PassHistory::ComputeStatistics(PassStatistics& Stats) const
+{
+    Stats.Name       = Name;
+    Stats.NumSamples = static_cast<Uint32>(Samples.size());
+    if (Samples.empty())
+        return;
+
+    const size_t LastIdx = Samples.size() < STATS_WINDOW ? Samples.size() - 1 : (NextSample + STATS_WINDOW - 1) % STATS_WINDOW;
+    Stats.LastMs         = Samples[LastIdx];
+
+    double Sum = 0;
+    for (float Sample : Samples)
+        Sum += Sample;
+    Stats.AverageMs = Sum / static_cast<double>(Samples.size());
+
+    // Percentil 99 sobre una copia ordenada parcialmente
+    std::vector<float> Sorted{Samples};
+    const size_t       P99Idx = (Sorted.size() * 99) / 100;
+    std::nth_element(Sorted.begin(), Sorted.begin() + P99Idx, Sorted.end());
+    Stats.P99Ms = Sorted[P99Idx];
+    Stats.MaxMs = *std::max_element(Sorted.begin() + P99Idx, Sorted.end());
+}
+
+void Tutorial14_GPUProfiler::UpdateStatistics(const FrameTimings& Timings)
+{
+    m_Statistics.clear();
+
+    double FrameMs = 0;
+    for (const auto& Pass : Timings.Passes)
+    {
+        // Los nombres son cadenas estticas, pero se comparan por contenido por si
+        // el compilador no fusiona literales idnticos entre unidades de traduccin
+        auto it = std::find_if(m_History.begin(), m_History.end(),
+                               [&](const PassHistory& History) { return strcmp(History.Name, Pass.Name) == 0; });
+        if (it == m_History.end())
+        {
+            m_History.emplace_back();
+            it       = m_History.end() - 1;
+            it->Name = Pass.Name;
+        }
+        it->AddSample(Pass.Milliseconds);
+        FrameMs += Pass.Milliseconds;
+
+        // Solo se muestran los pases que se ejecutan en el modo actual
+        m_Statistics.emplace_back();
+        it->ComputeStatistics(m_Statistics.back());
+    }
+
+    m_FrameHistory.Name = "Total";
+    m_FrameHistory.AddSample(FrameMs);
+    m_FrameHistory.ComputeStatistics(m_FrameStatistics);
+}
+
+void Tutorial14_GPUProfiler::ResetStatistics()
+{
+    m_History.clear();
+    m_FrameHistory = {};
+    m_Statistics.clear();
+    m_FrameStatistics = {};
+}
+
+bool Tutorial14_GPUProfiler::PopResolvedFrame(FrameTimings& Timings)
+{
+    if (m_Resolved.empty())
+        return false;
+
+    Timings = std::move(m_Resolved.front());
+    m_Resolved.pop_front();
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <vector>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Query.h"
+
+namespace Diligent
+{
+
+// Perfilador de GPU basado en consultas de marca de tiempo (timestamp queries).
+// Cada pase se delimita con BeginPass()/EndPass(); los resultados se leen varios
+// frames despus sin bloquear la CPU. Si los datos de un frame no estn listos
+// cuando su ranura se reutiliza, el frame simplemente se descarta.
+class Tutorial14_GPUProfiler
+{
+public:
+    // Nmero de frames que pueden estar en vuelo antes de reutilizar las consultas
+    static constexpr Uint32 NUM_FRAMES_IN_FLIGHT = 4;
+
+    // Nmero de frames resueltos sobre los que se calculan las estadsticas
+    static constexpr Uint32 STATS_WINDOW = 240;
+
+    struct PassTiming
+    {
+        const char* Name         = nullptr; // Debe apuntar a una cadena esttica
+        double      Milliseconds = 0;
+    };
+
+    struct FrameTimings
+    {
+        Uint64                  FrameId = 0;
+        std::vector<PassTiming> Passes;
+    };
+
+    // Estadsticas de un pase sobre la ventana de los ltimos STATS_WINDOW frames
+    struct PassStatistics
+    {
+        const char* Name       = nullptr;
+        double      LastMs     = 0;
+        double      AverageMs  = 0;
+        double      P99Ms      = 0;
+        double      MaxMs      = 0;
+        Uint32      NumSamples = 0;
+    };
+
+    Tutorial14_GPUProfiler(IRenderDevice* pDevice, IDeviceContext* pContext);
+
+    bool IsSupported() const { return m_bSupported; }
+
+    void BeginFrame(Uint64 FrameId);
+    void EndFrame();
+
+    void BeginPass(const char* Name);
+    void EndPass();
+
+    // Extrae el frame resuelto ms antiguo. Devuelve false si no hay ninguno.
+    bool PopResolvedFrame(FrameTimings& Timings);
+
+    // Estadsticas de los pases presentes en el ltimo frame resuelto, en orden de ejecucin
+    const std::vector<PassStatistics>& GetStatistics() const { return m_Statistics; }
+
+    // Estadsticas de la suma de todos los pases del frame
+    const PassStatistics& GetFrameStatistics() const { return m_FrameStatistics; }
+
+    void ResetStatistics();
+
+    // Delimita un pase en el mbito actual
+    class ScopedPass
+    {
+    public:
+        ScopedPass(Tutorial14_GPUProfiler* pProfiler, const char* Name) :
+            m_pProfiler(pProfiler)
+        {
+            if (m_pProfiler != nullptr)
+                m_pProfiler->BeginPass(Name);
+        }
+        ~ScopedPass()
+        {
+            if (m_pProfiler != nullptr)
+                m_pProfiler->EndPass();
+        }
+
+        ScopedPass(const ScopedPass&) = delete;
+        ScopedPass& operator=(const ScopedPass&) = delete;
+
+    private:
+        Tutorial14_GPUProfiler* const m_pProfiler;
+    };
+
+private:
+    RefCntAutoPtr<IQuery> CreateTimestampQuery();
+    void                  TryResolve(Uint32 SlotIdx);
+    void                  UpdateStatistics(const FrameTimings& Timings);
+
+    // Historial circular de tiempos de un pase
+    struct PassHistory
+    {
+        const char*        Name = nullptr;
+        std::vector<float> Samples;
+        Uint32             NextSample = 0;
+
+        void AddSample(double Milliseconds);
+        void ComputeStatistics(PassStatistics& Stats) const;
+    };
+
+    struct PassQueries
+    {
+        const char*           Name = nullptr;
+        RefCntAutoPtr<IQuery> pBegin;
+        RefCntAutoPtr<IQuery> pEnd;
+    };
+
+    struct FrameSlot
+    {
+        Uint64                   FrameId   = 0;
+        Uint32                   NumPasses = 0;
+        bool                     Pending   = false;
+        std::vector<PassQueries> Passes; // Las consultas se reutilizan entre frames
+    };
+
+    IRenderDevice*  m_pDevice  = nullptr;
+    IDeviceContext* m_pContext = nullptr;
+
+    bool m_bSupported   = false;
+    bool m_bInsideFrame = false;
+
+    std::array<FrameSlot, NUM_FRAMES_IN_FLIGHT> m_Frames;
+
+    Uint32              m_CurrentSlot = 0;
+    std::vector<Uint32> m_OpenPasses;
+
+    std::deque<FrameTimings> m_Resolved;
+
+    std::vector<PassHistory>    m_History;
+    PassHistory                 m_FrameHistory;
+    std::vector<PassStatistics> m_Statistics;
+    PassStatistics              m_FrameStatistics;
+};
+
+} // namespace Diligent
@@ -0,0 +1,281 @@
+#include <cmath>
+#include "Tutorial14_NeighborList.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de NeighborConstants en neighbor_list.fxh
+struct NeighborConstants
+{
+    Uint32 uiNumParticles = 0;
+    Uint32 uiNumGroups    = 0;
+    float  fSkin          = 0;
+    float  fPadding0      = 0;
+
+    float2 f2Scale;
+    int2   i2ParticleGridSize;
+};
+
+// Grupos, 1, 1 del pase de reconstruccin
+constexpr Uint32 NUM_INDIRECT_ARGS = 3;
+
+} // namespace
+
+Tutorial14_NeighborList::Tutorial14_NeighborList(IRenderDevice*             pDevice,
+                                                 IDeviceContext*            pContext,
+                                                 IEngineFactory*            pEngineFactory,
+                                                 Tutorial14_FrameAllocator* pFrameAllocator,
+                                                 Uint32                     ThreadGroupSize) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pEngineFactory(pEngineFactory),
+    m_pFrameAllocator(pFrameAllocator),
+    m_ThreadGroupSize(ThreadGroupSize)
+{
+    // Bfer con formato: en D3D11 los argumentos indirectos no pueden estar en un bfer estructurado
+    const Uint32 InitialArgs[NUM_INDIRECT_ARGS] = {0, 1, 1};
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Neighbor lists indirect args";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_INDIRECT_DRAW_ARGS | BIND_UNORDERED_ACCESS;
+    BuffDesc.Mode              = BUFFER_MODE_FORMATTED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = sizeof(InitialArgs);
+    BufferData ArgsData{InitialArgs, sizeof(InitialArgs)};
+    m_pDevice->CreateBuffer(BuffDesc, &ArgsData, &m_pIndirectArgsBuffer);
+    if (!m_pIndirectArgsBuffer)
+    {
+        LOG_ERROR_MESSAGE("Failed to create the neighbor lists indirect args buffer");
+        return;
+    }
+
+    BufferViewDesc ViewDesc;
+    ViewDesc.Format.ValueType     = VT_UINT32;
+    ViewDesc.Format.NumComponents = 1;
+    ViewDesc.ViewType             = BUFFER_VIEW_UNORDERED_ACCESS;
+    m_pIndirectArgsBuffer->CreateView(ViewDesc, &m_pIndirectArgsUAV);
+
+    m_pReadback = std::make_unique<Tutorial14_AsyncReadback>(m_pDevice, m_pContext, sizeof(Statistics), 4, "Neighbor lists readback");
+
+    CreatePipelines();
+}
+
+void Tutorial14_NeighborList::SetThreadGroupSize(Uint32 ThreadGroupSize)
+{
+    if (ThreadGroupSize == m_ThreadGroupSize)
+        return;
+
+    m_ThreadGroupSize = ThreadGroupSize;
+    CreatePipelines();
+}
+
+void Tutorial14_NeighborList::CreatePipelines()
+{
+    m_pCheckSRB.Release();
+    m_pCheckPSO.Release();
+    m_pBuildSRB.Release();
+    m_pBuildPSO.Release();
+
+    if (!m_pIndirectArgsUAV)
+        return;
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.EntryPoint                      = "main";
+    ShaderCI.FilePath                        = "neighbor_list.csh";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+    // Las constantes son una ventana del asignador de frame
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    auto CreatePSO = [&](const char* ShaderName, const char* PSOName, bool bCheckDisplacement, RefCntAutoPtr<IPipelineState>& pPSO) {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("THREAD_GROUP_SIZE", m_ThreadGroupSize);
+        Macros.AddShaderMacro("CHECK_DISPLACEMENT", bCheckDisplacement ? 1 : 0);
+        ShaderCI.Macros    = Macros;
+        ShaderCI.Desc.Name = ShaderName;
+
+        RefCntAutoPtr<IShader> pCS;
+        m_pDevice->CreateShader(ShaderCI, &pCS);
+        if (!pCS)
+        {
+            LOG_ERROR_MESSAGE("Failed to create shader ", ShaderName);
+            return;
+        }
+
+        PSODesc.Name      = PSOName;
+        PSOCreateInfo.pCS = pCS;
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+        if (!pPSO)
+            LOG_ERROR_MESSAGE("Failed to create PSO ", PSOName);
+    };
+    CreatePSO("Check neighbor lists CS", "Check neighbor lists PSO", true, m_pCheckPSO);
+    CreatePSO("Build neighbor lists CS", "Build neighbor lists PSO", false, m_pBuildPSO);
+
+    if (IsValid() && m_pMovedParticleAttribs)
+    {
+        SetParticleBuffers(m_pMovedParticleAttribs, m_pParticleListHeads, m_pParticleLists, m_NumParticles);
+    }
+}
+
+void Tutorial14_NeighborList::SetParticleBuffers(IBuffer* pMovedParticleAttribs,
+                                                 IBuffer* pParticleListHeads,
+                                                 IBuffer* pParticleLists,
+                                                 Uint32   NumParticles)
+{
+    m_pMovedParticleAttribs = pMovedParticleAttribs;
+    m_pParticleListHeads    = pParticleListHeads;
+    m_pParticleLists        = pParticleLists;
+    m_bForceRebuild         = true;
+
+    if (!m_pNeighborCountsBuffer || NumParticles != m_NumParticles)
+    {
+        m_pNeighborListsBuffer.Release();
+        m_pNeighborCountsBuffer.Release();
+        m_pRefPositionsBuffer.Release();
+        m_pStatsBuffer.Release();
+
+        // Las listas no se leen hasta la primera reconstruccin, que se fuerza aqu
+        BufferDesc BuffDesc;
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(Int32);
+
+        BuffDesc.Name = "Neighbor lists buffer";
+        BuffDesc.Size = Uint64{NumParticles} * MaxNeighbors * sizeof(Int32);
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pNeighborListsBuffer);
+
+        BuffDesc.Name = "Neighbor counts buffer";
+        BuffDesc.Size = Uint64{NumParticles} * sizeof(Uint32);
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pNeighborCountsBuffer);
+
+        BuffDesc.Name              = "Neighbor lists reference positions";
+        BuffDesc.ElementByteStride = sizeof(float2);
+        BuffDesc.Size              = Uint64{NumParticles} * sizeof(float2);
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pRefPositionsBuffer);
+
+        m_NumParticles = NumParticles;
+    }
+
+    // Los contadores empiezan de cero con cada conjunto de partculas
+    {
+        const Statistics ZeroStats;
+
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "Neighbor lists statistics";
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(Uint32);
+        BuffDesc.Size              = sizeof(ZeroStats);
+        BufferData StatsData{&ZeroStats, sizeof(ZeroStats)};
+        m_pStatsBuffer.Release();
+        m_pDevice->CreateBuffer(BuffDesc, &StatsData, &m_pStatsBuffer);
+        m_Stats = {};
+    }
+
+    m_pCheckSRB.Release();
+    m_pBuildSRB.Release();
+    if (!IsValid() || !m_pNeighborListsBuffer || !m_pNeighborCountsBuffer || !m_pRefPositionsBuffer || !m_pStatsBuffer)
+        return;
+
+    m_pCheckPSO->CreateShaderResourceBinding(&m_pCheckSRB, true);
+    m_pCheckSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pMovedParticleAttribs->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pCheckSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_RefPositions")->Set(m_pRefPositionsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pCheckSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NeighborArgs")->Set(m_pIndirectArgsUAV);
+    m_pCheckSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NeighborStats")->Set(m_pStatsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pFrameAllocator->BindConstants(m_pCheckSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "NeighborConstantsBuffer"), sizeof(NeighborConstants));
+
+    // El pase de reconstruccin se lanza con los argumentos indirectos, as que no los enlaza
+    m_pBuildPSO->CreateShaderResourceBinding(&m_pBuildSRB, true);
+    m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pMovedParticleAttribs->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeads->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pParticleLists->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_RefPositions")->Set(m_pRefPositionsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NeighborLists")->Set(m_pNeighborListsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NeighborCounts")->Set(m_pNeighborCountsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NeighborStats")->Set(m_pStatsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pFrameAllocator->BindConstants(m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "NeighborConstantsBuffer"), sizeof(NeighborConstants));
+}
+
+void Tutorial14_NeighborList::BindNeighborLists(IShaderResourceBinding* pSRB) const
+{
+    if (!m_pNeighborListsBuffer || !m_pNeighborCountsBuffer)
+        return;
+
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NeighborLists")->Set(m_pNeighborListsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NeighborCounts")->Set(m_pNeighborCountsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+}
+
+void Tutorial14_NeighborList::Update(Uint32 NumParticles, const float2& f2Scale, const int2& i2ParticleGridSize)
+{
+    if (!m_pCheckSRB || !m_pBuildSRB)
+        return;
+
+    const Uint32 NumGroups = (NumParticles + m_ThreadGroupSize - 1) / m_ThreadGroupSize;
+
+    // Las distancias se miden dividiendo por la escala: si cambia la relacin de aspecto
+    // las listas dejan de ser vlidas
+    if (f2Scale != m_f2LastScale)
+    {
+        m_f2LastScale   = f2Scale;
+        m_bForceRebuild = true;
+    }
+
+    NeighborConstants Constants;
+    Constants.uiNumParticles     = NumParticles;
+    Constants.uiNumGroups        = NumGroups;
+    Constants.fSkin              = m_Settings.Skin / std::sqrt(static_cast<float>(NumParticles));
+    Constants.f2Scale            = f2Scale;
+    Constants.i2ParticleGridSize = i2ParticleGridSize;
+    const Uint32 Offset          = m_pFrameAllocator->Allocate(Constants);
+    m_pCheckSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "NeighborConstantsBuffer")->SetBufferOffset(Offset);
+    m_pBuildSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "NeighborConstantsBuffer")->SetBufferOffset(Offset);
+
+    // Sin reconstruccin forzada el pase de reconstruccin queda vaco salvo que la
+    // comprobacin escriba el nmero de grupos
+    const Uint32 InitialArgs[NUM_INDIRECT_ARGS] = {m_bForceRebuild ? NumGroups : 0, 1, 1};
+    m_pContext->UpdateBuffer(m_pIndirectArgsBuffer, 0, sizeof(InitialArgs), InitialArgs, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_bForceRebuild = false;
+
+    m_pContext->SetPipelineState(m_pCheckPSO);
+    m_pContext->CommitShaderResources(m_pCheckSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{NumGroups});
+
+    // Las posiciones de referencia pasan de SRV a UAV y los argumentos de UAV a argumentos
+    // indirectos: las transiciones separan la comprobacin de la reconstruccin
+    m_pContext->SetPipelineState(m_pBuildPSO);
+    m_pContext->CommitShaderResources(m_pBuildSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchComputeIndirect(DispatchComputeIndirectAttribs{m_pIndirectArgsBuffer, RESOURCE_STATE_TRANSITION_MODE_TRANSITION});
+}
+
+void Tutorial14_NeighborList::EnqueueReadback()
+{
+    if (m_pStatsBuffer)
+        m_pReadback->Enqueue(m_pStatsBuffer);
+}
+
+const Tutorial14_NeighborList::Statistics& Tutorial14_NeighborList::GetStatistics()
+{
+    if (m_pReadback)
+        m_pReadback->Poll(m_Stats);
+    return m_Stats;
+}
+
+} // namespace Diligent
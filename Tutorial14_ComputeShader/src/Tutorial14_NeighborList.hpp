@@ -0,0 +1,118 @@
+#pragma once
+
+#include <memory>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Tutorial14_AsyncReadback.hpp"
+
+namespace Diligent
+{
+
+class Tutorial14_FrameAllocator;
+
+// Listas de vecinas de Verlet para el pase de colisiones. Cada partcula guarda hasta
+// MaxNeighbors vecinas a menos de la suma de radios ms un margen (skin). Tras el pase de
+// movimiento neighbor_list.csh comprueba si alguna partcula se ha desplazado ms de medio
+// margen desde la ltima reconstruccin; solo entonces escribe los argumentos indirectos
+// del pase que rehace las listas recorriendo la rejilla. Entre reconstrucciones
+// collide_particles.csh compilado con NEIGHBOR_LIST recorre la lista contigua en lugar de
+// las 3x3 celdas de la rejilla.
+//
+// La decisin se toma en la GPU: no hay que esperar a ninguna lectura.
+class Tutorial14_NeighborList
+{
+public:
+    // Debe coincidir con MAX_NEIGHBORS en neighbor_list.fxh
+    static constexpr Uint32 MaxNeighbors = 16;
+
+    struct Settings
+    {
+        // Margen en unidades de 1/sqrt(NumParticles). Las celdas de la rejilla miden 2 y el
+        // radio de colisin llega a 1.4, as que por encima de 0.6 se perderan vecinas.
+        float Skin = 0.3f;
+    };
+
+    struct Statistics
+    {
+        Uint32 NumChecks         = 0; // Subpasos desde que se crearon los bferes
+        Uint32 NumRebuilds       = 0;
+        Uint32 MaxNeighborsFound = 0; // Ms que MaxNeighbors: alguna lista se ha truncado
+    };
+
+    Tutorial14_NeighborList(IRenderDevice*             pDevice,
+                            IDeviceContext*            pContext,
+                            IEngineFactory*            pEngineFactory,
+                            Tutorial14_FrameAllocator* pFrameAllocator,
+                            Uint32                     ThreadGroupSize);
+
+    bool IsValid() const { return m_pCheckPSO != nullptr && m_pBuildPSO != nullptr; }
+
+    void SetThreadGroupSize(Uint32 ThreadGroupSize);
+
+    // Debe llamarse cada vez que se recrean los bferes de partculas; fuerza una reconstruccin
+    void SetParticleBuffers(IBuffer* pMovedParticleAttribs,
+                            IBuffer* pParticleListHeads,
+                            IBuffer* pParticleLists,
+                            Uint32   NumParticles);
+
+    // La siguiente actualizacin rehace las listas aunque nadie se haya movido (por ejemplo,
+    // al activar el modo con listas antiguas)
+    void Invalidate() { m_bForceRebuild = true; }
+
+    // Enlaza g_NeighborLists y g_NeighborCounts en un SRB de colisiones
+    void BindNeighborLists(IShaderResourceBinding* pSRB) const;
+
+    // Graba la comprobacin y la reconstruccin indirecta de un subpaso, despus del pase
+    // de movimiento
+    void Update(Uint32 NumParticles, const float2& f2Scale, const int2& i2ParticleGridSize);
+
+    // Bferes que leen los pases de colisiones
+    IBuffer* GetNeighborListsBuffer() const { return m_pNeighborListsBuffer; }
+    IBuffer* GetNeighborCountsBuffer() const { return m_pNeighborCountsBuffer; }
+
+    // Copia asncrona de los contadores; una vez por frame tras los subpasos
+    void EnqueueReadback();
+
+    const Statistics& GetStatistics();
+
+    Settings& GetSettings() { return m_Settings; }
+
+private:
+    void CreatePipelines();
+
+    IRenderDevice*             m_pDevice         = nullptr;
+    IDeviceContext*            m_pContext        = nullptr;
+    IEngineFactory*            m_pEngineFactory  = nullptr;
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
+
+    Uint32 m_ThreadGroupSize = 64;
+    Uint32 m_NumParticles    = 0;
+
+    RefCntAutoPtr<IBuffer>     m_pNeighborListsBuffer;
+    RefCntAutoPtr<IBuffer>     m_pNeighborCountsBuffer;
+    RefCntAutoPtr<IBuffer>     m_pRefPositionsBuffer;
+    RefCntAutoPtr<IBuffer>     m_pStatsBuffer;
+    RefCntAutoPtr<IBuffer>     m_pIndirectArgsBuffer;
+    RefCntAutoPtr<IBufferView> m_pIndirectArgsUAV;
+
+    // Bferes de la simulacin, para volver a crear los SRB con los pipelines
+    RefCntAutoPtr<IBuffer> m_pMovedParticleAttribs;
+    RefCntAutoPtr<IBuffer> m_pParticleListHeads;
+    RefCntAutoPtr<IBuffer> m_pParticleLists;
+
+    RefCntAutoPtr<IPipelineState>         m_pCheckPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pCheckSRB;
+    RefCntAutoPtr<IPipelineState>         m_pBuildPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pBuildSRB;
+
+    std::unique_ptr<Tutorial14_AsyncReadback> m_pReadback;
+
+    Settings   m_Settings;
+    Statistics m_Stats;
+    bool       m_bForceRebuild = true;
+    float2     m_f2LastScale;
+};
+
+} // namespace Diligent
@@ -0,0 +1,327 @@
+#include "Tutorial14_ParticlePipeline.hpp"
+#include "Tutorial14_AdaptiveTimeStep.hpp"
+#include "Tutorial14_ParticleStructures.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "MapHelper.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+Tutorial14_ParticlePipeline::Tutorial14_ParticlePipeline(IRenderDevice*  pDevice,
+                                                         IDeviceContext* pContext,
+                                                         IDeviceContext* pComputeContext,
+                                                         IEngineFactory* pEngineFactory,
+                                                         Uint32          ThreadGroupSize) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pComputeContext(pComputeContext),
+    m_pEngineFactory(pEngineFactory),
+    m_ThreadGroupSize(ThreadGroupSize)
+{
+    // Los bferes dinmicos solo pueden mapearse en el contexto que los usa
+    BufferDesc BuffDesc;
+    BuffDesc.Name                 = "Pipelined particle constants buffer";
+    BuffDesc.Usage                = USAGE_DYNAMIC;
+    BuffDesc.BindFlags            = BIND_UNIFORM_BUFFER;
+    BuffDesc.CPUAccessFlags       = CPU_ACCESS_WRITE;
+    BuffDesc.Size                 = sizeof(GlobalConstants);
+    BuffDesc.ImmediateContextMask = Uint64{1} << m_pComputeContext->GetDesc().ContextId;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pConstantsBuffer);
+
+    const Tutorial14_AdaptiveTimeStep::TimeStepData TimeStep;
+
+    BuffDesc                      = BufferDesc{};
+    BuffDesc.Name                 = "Pipelined particle time step buffer";
+    BuffDesc.Usage                = USAGE_DEFAULT;
+    BuffDesc.BindFlags            = BIND_SHADER_RESOURCE;
+    BuffDesc.Mode                 = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride    = sizeof(TimeStep);
+    BuffDesc.Size                 = sizeof(TimeStep);
+    BuffDesc.ImmediateContextMask = Uint64{1} << m_pComputeContext->GetDesc().ContextId;
+    BufferData TimeStepData{&TimeStep, sizeof(TimeStep)};
+    m_pDevice->CreateBuffer(BuffDesc, &TimeStepData, &m_pTimeStepBuffer);
+
+    if (!m_pConstantsBuffer || !m_pTimeStepBuffer)
+    {
+        LOG_ERROR_MESSAGE("Failed to create the pipelined particle constants");
+        return;
+    }
+
+    CreatePipelines();
+}
+
+void Tutorial14_ParticlePipeline::SetThreadGroupSize(Uint32 ThreadGroupSize)
+{
+    if (ThreadGroupSize == m_ThreadGroupSize)
+        return;
+
+    m_ThreadGroupSize = ThreadGroupSize;
+    CreatePipelines();
+}
+
+void Tutorial14_ParticlePipeline::CreatePipelines()
+{
+    m_pResetListsPSO.Release();
+    m_pMovePSO.Release();
+    m_pCollidePSO.Release();
+    m_pUpdateSpeedPSO.Release();
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.EntryPoint                      = "main";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    // Los pases de la simulacin principal sin partculas dormidas ni listas de vecinas
+    auto CreateShader = [&](const char* Name, const char* FilePath, bool UpdateSpeed) {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("THREAD_GROUP_SIZE", static_cast<int>(m_ThreadGroupSize));
+        Macros.AddShaderMacro("WORLD_GRID", 0);
+        Macros.AddShaderMacro("PARTICLE_SLEEP", 0);
+        Macros.AddShaderMacro("NEIGHBOR_LIST", 0);
+        if (UpdateSpeed)
+            Macros.AddShaderMacro("UPDATE_SPEED", 1);
+        ShaderCI.Macros    = Macros;
+        ShaderCI.Desc.Name = Name;
+        ShaderCI.FilePath  = FilePath;
+
+        RefCntAutoPtr<IShader> pShader;
+        m_pDevice->CreateShader(ShaderCI, &pShader);
+        if (!pShader)
+            LOG_ERROR_MESSAGE("Failed to create shader ", Name);
+        return pShader;
+    };
+
+    RefCntAutoPtr<IShader> pResetListsCS  = CreateShader("Pipelined reset particle lists CS", "reset_particle_lists.csh", false);
+    RefCntAutoPtr<IShader> pMoveCS        = CreateShader("Pipelined move particles CS", "move_particles.csh", false);
+    RefCntAutoPtr<IShader> pCollideCS     = CreateShader("Pipelined collide particles CS", "collide_particles.csh", false);
+    RefCntAutoPtr<IShader> pUpdateSpeedCS = CreateShader("Pipelined update particle speed CS", "collide_particles.csh", true);
+    if (!pResetListsCS || !pMoveCS || !pCollideCS || !pUpdateSpeedCS)
+        return;
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.PipelineType         = PIPELINE_TYPE_COMPUTE;
+    PSODesc.ImmediateContextMask = Uint64{1} << m_pComputeContext->GetDesc().ContextId;
+
+    // El campo de velocidad es cada paso una textura publicada distinta
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_COMPUTE, "Constants",              SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_COMPUTE, "g_TimeStep",             SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        {SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    SamplerDesc LinearClampSampler;
+    LinearClampSampler.MinFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.MagFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.MipFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.AddressU  = TEXTURE_ADDRESS_CLAMP;
+    LinearClampSampler.AddressV  = TEXTURE_ADDRESS_CLAMP;
+    LinearClampSampler.AddressW  = TEXTURE_ADDRESS_CLAMP;
+
+    ImmutableSamplerDesc ImtblSamplers[] = {{SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture", LinearClampSampler}};
+    PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+    PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+
+    auto CreatePSO = [&](const char* Name, IShader* pCS, RefCntAutoPtr<IPipelineState>& pPSO) {
+        PSODesc.Name      = Name;
+        PSOCreateInfo.pCS = pCS;
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+        if (!pPSO)
+        {
+            LOG_ERROR_MESSAGE("Failed to create PSO ", Name);
+            return;
+        }
+        pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "Constants")->Set(m_pConstantsBuffer);
+        if (auto* pTimeStepVar = pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "g_TimeStep"))
+            pTimeStepVar->Set(m_pTimeStepBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    };
+    CreatePSO("Pipelined reset particle lists PSO", pResetListsCS, m_pResetListsPSO);
+    CreatePSO("Pipelined move particles PSO", pMoveCS, m_pMovePSO);
+    CreatePSO("Pipelined collide particles PSO", pCollideCS, m_pCollidePSO);
+    CreatePSO("Pipelined update particle speed PSO", pUpdateSpeedCS, m_pUpdateSpeedPSO);
+
+    CreateShaderResourceBindings();
+}
+
+void Tutorial14_ParticlePipeline::SetNumParticles(Uint32 NumParticles)
+{
+    T14_TRACE_SCOPE("ParticlePipeline::SetNumParticles");
+
+    m_NumParticles = NumParticles;
+
+    m_pParticleAttribsBuffer.Release();
+    m_pMovedParticleAttribsBuffer.Release();
+    m_pParticleListHeadsBuffer.Release();
+    m_pParticleListsBuffer.Release();
+    for (auto& pBuffer : m_pPublishedBuffers)
+        pBuffer.Release();
+
+    const Uint64 ComputeMask = Uint64{1} << m_pComputeContext->GetDesc().ContextId;
+    const Uint64 BothQueues  = ComputeMask | (Uint64{1} << m_pContext->GetDesc().ContextId);
+    const Uint64 AttribsSize = Uint64{sizeof(ParticleAttribs)} * NumParticles;
+    const Uint64 ListsSize   = Uint64{sizeof(int)} * NumParticles;
+
+    BufferDesc BuffDesc;
+    BuffDesc.Usage                = USAGE_DEFAULT;
+    BuffDesc.BindFlags            = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    BuffDesc.Mode                 = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride    = sizeof(ParticleAttribs);
+    BuffDesc.Size                 = AttribsSize;
+    BuffDesc.Name                 = "Pipelined particle attribs buffer";
+    BuffDesc.ImmediateContextMask = BothQueues; // Begin() y End() lo copian en la cola grfica
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pParticleAttribsBuffer);
+
+    BuffDesc.Name                 = "Pipelined moved particle attribs buffer";
+    BuffDesc.ImmediateContextMask = ComputeMask;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pMovedParticleAttribsBuffer);
+
+    // La cola grfica solo los dibuja
+    static constexpr const char* PublishedNames[NUM_PUBLISHED_BUFFERS] = {"Published particle attribs buffer 0", "Published particle attribs buffer 1", "Published particle attribs buffer 2"};
+    BuffDesc.BindFlags            = BIND_SHADER_RESOURCE;
+    BuffDesc.ImmediateContextMask = BothQueues;
+    for (Uint32 i = 0; i < NUM_PUBLISHED_BUFFERS; ++i)
+    {
+        BuffDesc.Name = PublishedNames[i];
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pPublishedBuffers[i]);
+    }
+
+    BuffDesc.BindFlags            = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    BuffDesc.ElementByteStride    = sizeof(int);
+    BuffDesc.Size                 = ListsSize;
+    BuffDesc.ImmediateContextMask = ComputeMask;
+    BuffDesc.Name                 = "Pipelined particle list heads buffer";
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pParticleListHeadsBuffer);
+    BuffDesc.Name = "Pipelined particle lists buffer";
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pParticleListsBuffer);
+
+    CreateShaderResourceBindings();
+}
+
+void Tutorial14_ParticlePipeline::CreateShaderResourceBindings()
+{
+    m_pResetListsSRB.Release();
+    m_pMoveSRB.Release();
+    m_pCollideSRB.Release();
+
+    if (!IsValid() || !m_pParticleAttribsBuffer || !m_pMovedParticleAttribsBuffer || !m_pParticleListHeadsBuffer || !m_pParticleListsBuffer)
+        return;
+
+    IBufferView* pParticleAttribsSRV = m_pParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pParticleAttribsUAV = m_pParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pMovedParticlesSRV  = m_pMovedParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pMovedParticlesUAV  = m_pMovedParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pListHeadsSRV       = m_pParticleListHeadsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pListHeadsUAV       = m_pParticleListHeadsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pListsSRV           = m_pParticleListsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pListsUAV           = m_pParticleListsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+
+    m_pResetListsPSO->CreateShaderResourceBinding(&m_pResetListsSRB, true);
+    m_pResetListsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pListHeadsUAV);
+
+    m_pMovePSO->CreateShaderResourceBinding(&m_pMoveSRB, true);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pParticleAttribsSRV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutParticles")->Set(pMovedParticlesUAV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pListHeadsUAV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pListsUAV);
+
+    // El pase de velocidad usa la misma SRB que el de colisiones
+    m_pCollidePSO->CreateShaderResourceBinding(&m_pCollideSRB, true);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pMovedParticlesSRV);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutParticles")->Set(pParticleAttribsUAV);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pListHeadsSRV);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pListsSRV);
+}
+
+void Tutorial14_ParticlePipeline::Begin(IBuffer* pParticleAttribs)
+{
+    T14_TRACE_SCOPE("ParticlePipeline::Begin");
+
+    if (!m_pParticleAttribsBuffer)
+        return;
+
+    // El primer frame dibuja el estado de partida desde cualquiera de los bferes publicados
+    const Uint64 Size = m_pParticleAttribsBuffer->GetDesc().Size;
+    m_pContext->CopyBuffer(pParticleAttribs, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, m_pParticleAttribsBuffer, 0, Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    for (auto& pBuffer : m_pPublishedBuffers)
+        m_pContext->CopyBuffer(pParticleAttribs, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pBuffer, 0, Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+}
+
+void Tutorial14_ParticlePipeline::End(IBuffer* pParticleAttribs)
+{
+    T14_TRACE_SCOPE("ParticlePipeline::End");
+
+    if (!m_pParticleAttribsBuffer)
+        return;
+
+    m_pContext->CopyBuffer(m_pParticleAttribsBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pParticleAttribs, 0, m_pParticleAttribsBuffer->GetDesc().Size,
+                           RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+}
+
+void Tutorial14_ParticlePipeline::Dispatch(IDeviceContext* pContext, IPipelineState* pPSO, IShaderResourceBinding* pSRB)
+{
+    pContext->SetPipelineState(pPSO);
+    pContext->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    DispatchComputeAttribs DispatAttribs;
+    DispatAttribs.ThreadGroupCountX = (m_NumParticles + m_ThreadGroupSize - 1) / m_ThreadGroupSize;
+    pContext->DispatchCompute(DispatAttribs);
+}
+
+void Tutorial14_ParticlePipeline::RecordStep(IDeviceContext* pComputeContext,
+                                             Uint32          NumSubsteps,
+                                             float           DeltaTime,
+                                             const float2&   f2Scale,
+                                             const int2&     i2ParticleGridSize,
+                                             ITextureView*   pFluidVelocitySRV,
+                                             Uint32          PublishIndex)
+{
+    T14_TRACE_SCOPE("ParticlePipeline::RecordStep");
+
+    if (!m_pResetListsSRB || !m_pMoveSRB || !m_pCollideSRB)
+        return;
+
+    {
+        // Las constantes son las mismas en todos los subpasos
+        MapHelper<GlobalConstants> Constants(pComputeContext, m_pConstantsBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+        *Constants                    = GlobalConstants{};
+        Constants->uiNumParticles     = m_NumParticles;
+        Constants->fDeltaTime         = DeltaTime;
+        Constants->f2Scale            = f2Scale;
+        Constants->i2ParticleGridSize = i2ParticleGridSize;
+    }
+
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture")->Set(pFluidVelocitySRV);
+
+    // Solo este hilo usa los recursos de trabajo mientras graba, as que basta con las
+    // transiciones de Diligent, como en los pasos del fluido
+    for (Uint32 Substep = 0; Substep < NumSubsteps; ++Substep)
+    {
+        Dispatch(pComputeContext, m_pResetListsPSO, m_pResetListsSRB);
+        Dispatch(pComputeContext, m_pMovePSO, m_pMoveSRB);
+        Dispatch(pComputeContext, m_pCollidePSO, m_pCollideSRB);
+        Dispatch(pComputeContext, m_pUpdateSpeedPSO, m_pCollideSRB);
+    }
+
+    IBuffer* pPublished = m_pPublishedBuffers[PublishIndex];
+    pComputeContext->CopyBuffer(m_pParticleAttribsBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION, pPublished, 0, pPublished->GetDesc().Size,
+                                RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    StateTransitionDesc Barrier{pPublished, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE};
+    pComputeContext->TransitionResourceStates(1, &Barrier);
+}
+
+} // namespace Diligent
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Tutorial14_FluidSimulation.hpp"
+
+namespace Diligent
+{
+
+// Simulacin de partculas canalizada con el fluido asncrono. El hilo de simulacin del
+// fluido graba, tras los pasos del fluido del frame N+1 (AsyncStepCallback), los subpasos de
+// partculas del mismo frame en la cola de cmputo sobre bferes de trabajo propios, y copia
+// el resultado a uno de los tres bferes publicados. El hilo principal dibuja el frame N
+// desde el bfer publicado por el paso anterior. Los bferes publicados usan el ndice del
+// anillo de campos de velocidad, as que las vallas del fluido tambin los protegen.
+//
+// Solo incluye los pases bsicos (listas, movimiento, colisiones y velocidad) con la
+// rejilla densa. Las partculas dormidas, las listas de vecinas, SPH, el intervalo
+// adaptativo, el modo mundo y los mdulos que leen el bfer de partculas en la cola
+// grfica siguen usando los bferes de la simulacin principal.
+class Tutorial14_ParticlePipeline
+{
+public:
+    static constexpr Uint32 NUM_PUBLISHED_BUFFERS = Tutorial14_FluidSimulation::NUM_PUBLISHED_FIELDS;
+
+    Tutorial14_ParticlePipeline(IRenderDevice*  pDevice,
+                                IDeviceContext* pContext,
+                                IDeviceContext* pComputeContext,
+                                IEngineFactory* pEngineFactory,
+                                Uint32          ThreadGroupSize);
+
+    bool IsValid() const { return m_pResetListsPSO && m_pMovePSO && m_pCollidePSO && m_pUpdateSpeedPSO; }
+
+    // Las funciones siguientes, salvo RecordStep(), no deben llamarse mientras el hilo de
+    // simulacin graba un paso de partculas
+
+    void SetThreadGroupSize(Uint32 ThreadGroupSize);
+
+    // Recrea los bferes de trabajo y publicados; cada vez que cambia el nmero de partculas
+    void SetNumParticles(Uint32 NumParticles);
+
+    // Contexto inmediato, antes del primer paso: copia pParticleAttribs a los bferes de
+    // trabajo y a todos los publicados. El paso debe esperar a la copia
+    // (Tutorial14_FluidSimulation::ReleaseToComputeQueue()).
+    void Begin(IBuffer* pParticleAttribs);
+
+    // Contexto inmediato, cuando la cola grfica ya espera al ltimo paso: copia a
+    // pParticleAttribs el estado de ese paso
+    void End(IBuffer* pParticleAttribs);
+
+    // Hilo de simulacin: graba NumSubsteps subpasos en pComputeContext con el campo
+    // pFluidVelocitySRV y copia el resultado al bfer publicado PublishIndex
+    void RecordStep(IDeviceContext* pComputeContext,
+                    Uint32          NumSubsteps,
+                    float           DeltaTime,
+                    const float2&   f2Scale,
+                    const int2&     i2ParticleGridSize,
+                    ITextureView*   pFluidVelocitySRV,
+                    Uint32          PublishIndex);
+
+    IBuffer* GetPublishedBuffer(Uint32 Index) const { return m_pPublishedBuffers[Index]; }
+
+private:
+    void CreatePipelines();
+    void CreateShaderResourceBindings();
+    void Dispatch(IDeviceContext* pContext, IPipelineState* pPSO, IShaderResourceBinding* pSRB);
+
+    IRenderDevice*  m_pDevice         = nullptr;
+    IDeviceContext* m_pContext        = nullptr;
+    IDeviceContext* m_pComputeContext = nullptr;
+    IEngineFactory* m_pEngineFactory  = nullptr;
+
+    Uint32 m_ThreadGroupSize = 64;
+    Uint32 m_NumParticles    = 0;
+
+    // Constantes de los pases, escritas en el contexto de cmputo
+    RefCntAutoPtr<IBuffer> m_pConstantsBuffer;
+    // Los shaders declaran g_TimeStep aunque sin intervalo adaptativo no lo leen
+    RefCntAutoPtr<IBuffer> m_pTimeStepBuffer;
+
+    // Estado de trabajo. Solo lo toca la cola de cmputo, salvo en Begin() y End().
+    RefCntAutoPtr<IBuffer> m_pParticleAttribsBuffer;
+    RefCntAutoPtr<IBuffer> m_pMovedParticleAttribsBuffer;
+    RefCntAutoPtr<IBuffer> m_pParticleListHeadsBuffer;
+    RefCntAutoPtr<IBuffer> m_pParticleListsBuffer;
+
+    RefCntAutoPtr<IBuffer> m_pPublishedBuffers[NUM_PUBLISHED_BUFFERS];
+
+    RefCntAutoPtr<IPipelineState>         m_pResetListsPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pResetListsSRB;
+    RefCntAutoPtr<IPipelineState>         m_pMovePSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pMoveSRB;
+    RefCntAutoPtr<IPipelineState>         m_pCollidePSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pCollideSRB;
+    RefCntAutoPtr<IPipelineState>         m_pUpdateSpeedPSO;
+};
+
+} // namespace Diligent
@@ -0,0 +1,260 @@
+#include <vector>
+#include "Tutorial14_ParticleSleep.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de SleepConstants en particle_sleep.fxh
+struct SleepConstants
+{
+    Uint32 uiNumParticles    = 0;
+    float  fDeltaTime        = 0;
+    float  fAdaptiveTimeStep = 0;
+    float  fSleepDelay       = 0;
+
+    float2 f2Scale;
+    int2   i2ParticleGridSize;
+
+    float  fSleepSpeed     = 0;
+    float  fWakeFluidSpeed = 0;
+    float2 f2Padding0;
+};
+
+// Grupos, 1, 1 y nmero de partculas activas (ACTIVE_ARGS_NUM_PARTICLES)
+constexpr Uint32 NUM_INDIRECT_ARGS = 4;
+
+} // namespace
+
+Tutorial14_ParticleSleep::Tutorial14_ParticleSleep(IRenderDevice*             pDevice,
+                                                   IDeviceContext*            pContext,
+                                                   IEngineFactory*            pEngineFactory,
+                                                   Tutorial14_FrameAllocator* pFrameAllocator,
+                                                   Uint32                     ThreadGroupSize) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pEngineFactory(pEngineFactory),
+    m_pFrameAllocator(pFrameAllocator),
+    m_ThreadGroupSize(ThreadGroupSize)
+{
+    // Bfer con formato: en D3D11 los argumentos indirectos no pueden estar en un bfer estructurado
+    const Uint32 InitialArgs[NUM_INDIRECT_ARGS] = {0, 1, 1, 0};
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Active particles indirect args";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_INDIRECT_DRAW_ARGS | BIND_UNORDERED_ACCESS | BIND_SHADER_RESOURCE;
+    BuffDesc.Mode              = BUFFER_MODE_FORMATTED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = sizeof(InitialArgs);
+    BufferData ArgsData{InitialArgs, sizeof(InitialArgs)};
+    m_pDevice->CreateBuffer(BuffDesc, &ArgsData, &m_pIndirectArgsBuffer);
+    if (!m_pIndirectArgsBuffer)
+    {
+        LOG_ERROR_MESSAGE("Failed to create the active particles indirect args buffer");
+        return;
+    }
+
+    BufferViewDesc ViewDesc;
+    ViewDesc.Format.ValueType     = VT_UINT32;
+    ViewDesc.Format.NumComponents = 1;
+    ViewDesc.ViewType             = BUFFER_VIEW_SHADER_RESOURCE;
+    m_pIndirectArgsBuffer->CreateView(ViewDesc, &m_pIndirectArgsSRV);
+    ViewDesc.ViewType = BUFFER_VIEW_UNORDERED_ACCESS;
+    m_pIndirectArgsBuffer->CreateView(ViewDesc, &m_pIndirectArgsUAV);
+
+    m_pReadback = std::make_unique<Tutorial14_AsyncReadback>(m_pDevice, m_pContext, sizeof(InitialArgs), 4, "Active particles readback");
+
+    CreatePipeline();
+}
+
+void Tutorial14_ParticleSleep::SetThreadGroupSize(Uint32 ThreadGroupSize)
+{
+    if (ThreadGroupSize == m_ThreadGroupSize)
+        return;
+
+    m_ThreadGroupSize = ThreadGroupSize;
+    CreatePipeline();
+}
+
+void Tutorial14_ParticleSleep::CreatePipeline()
+{
+    m_pClassifySRB.Release();
+    m_pClassifyPSO.Release();
+
+    if (!m_pIndirectArgsUAV)
+        return;
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.Desc.Name                       = "Classify sleeping particles CS";
+    ShaderCI.EntryPoint                      = "main";
+    ShaderCI.FilePath                        = "particle_sleep.csh";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("THREAD_GROUP_SIZE", m_ThreadGroupSize);
+    ShaderCI.Macros = Macros;
+
+    RefCntAutoPtr<IShader> pCS;
+    m_pDevice->CreateShader(ShaderCI, &pCS);
+    if (!pCS)
+    {
+        LOG_ERROR_MESSAGE("Failed to create shader ", ShaderCI.Desc.Name);
+        return;
+    }
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name         = "Classify sleeping particles PSO";
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+    // Las constantes son una ventana del asignador de frame
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    PSOCreateInfo.pCS = pCS;
+    m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pClassifyPSO);
+    if (!m_pClassifyPSO)
+    {
+        LOG_ERROR_MESSAGE("Failed to create PSO ", PSODesc.Name);
+        return;
+    }
+
+    if (m_pParticleAttribs)
+    {
+        SetParticleBuffers(m_pParticleAttribs, m_pMovedParticleAttribs, m_pParticleListHeads, m_pParticleLists, m_pTimeStep,
+                           static_cast<Uint32>(m_pRestTimeBuffer->GetDesc().Size / sizeof(Uint32)));
+    }
+}
+
+void Tutorial14_ParticleSleep::SetParticleBuffers(IBuffer* pParticleAttribs,
+                                                  IBuffer* pMovedParticleAttribs,
+                                                  IBuffer* pParticleListHeads,
+                                                  IBuffer* pParticleLists,
+                                                  IBuffer* pTimeStep,
+                                                  Uint32   NumParticles)
+{
+    m_pParticleAttribs      = pParticleAttribs;
+    m_pMovedParticleAttribs = pMovedParticleAttribs;
+    m_pParticleListHeads    = pParticleListHeads;
+    m_pParticleLists        = pParticleLists;
+    m_pTimeStep             = pTimeStep;
+
+    if (!m_pRestTimeBuffer || m_pRestTimeBuffer->GetDesc().Size != Uint64{NumParticles} * sizeof(Uint32))
+    {
+        m_pRestTimeBuffer.Release();
+        m_pWakeFlagsBuffer.Release();
+        m_pActiveListBuffer.Release();
+
+        // Tiempo en reposo 0: todas despiertas
+        const std::vector<Uint32> Zeros(NumParticles);
+
+        BufferDesc BuffDesc;
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(Uint32);
+        BuffDesc.Size              = Uint64{NumParticles} * sizeof(Uint32);
+        BufferData ZerosData{Zeros.data(), BuffDesc.Size};
+
+        BuffDesc.Name = "Particle rest time buffer";
+        m_pDevice->CreateBuffer(BuffDesc, &ZerosData, &m_pRestTimeBuffer);
+        BuffDesc.Name = "Particle wake flags buffer";
+        m_pDevice->CreateBuffer(BuffDesc, &ZerosData, &m_pWakeFlagsBuffer);
+        BuffDesc.Name = "Active particles buffer";
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pActiveListBuffer);
+    }
+
+    m_pClassifySRB.Release();
+    if (!m_pClassifyPSO || !m_pRestTimeBuffer || !m_pWakeFlagsBuffer || !m_pActiveListBuffer)
+        return;
+
+    m_pClassifyPSO->CreateShaderResourceBinding(&m_pClassifySRB, true);
+
+    auto SetUAV = [this](const char* Name, IBuffer* pBuffer) {
+        m_pClassifySRB->GetVariableByName(SHADER_TYPE_COMPUTE, Name)->Set(pBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    };
+    SetUAV("g_Particles", pParticleAttribs);
+    SetUAV("g_OutParticles", pMovedParticleAttribs);
+    SetUAV("g_ParticleListHead", pParticleListHeads);
+    SetUAV("g_ParticleLists", pParticleLists);
+    SetUAV("g_RestTime", m_pRestTimeBuffer);
+    SetUAV("g_WakeFlags", m_pWakeFlagsBuffer);
+    SetUAV("g_ActiveParticles", m_pActiveListBuffer);
+    m_pClassifySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ActiveArgs")->Set(m_pIndirectArgsUAV);
+    m_pClassifySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TimeStep")->Set(pTimeStep->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pFrameAllocator->BindConstants(m_pClassifySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "SleepConstantsBuffer"), sizeof(SleepConstants));
+}
+
+void Tutorial14_ParticleSleep::BindActiveList(IShaderResourceBinding* pSRB) const
+{
+    if (!m_pActiveListBuffer)
+        return;
+
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ActiveParticles")->Set(m_pActiveListBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ActiveArgs")->Set(m_pIndirectArgsSRV);
+}
+
+void Tutorial14_ParticleSleep::BindWakeFlags(IShaderResourceBinding* pSRB) const
+{
+    if (!m_pWakeFlagsBuffer)
+        return;
+
+    pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_WakeFlags")->Set(m_pWakeFlagsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+}
+
+void Tutorial14_ParticleSleep::Classify(Uint32        NumParticles,
+                                        float         DeltaTime,
+                                        bool          bAdaptiveTimeStep,
+                                        const float2& f2Scale,
+                                        const int2&   i2ParticleGridSize,
+                                        ITextureView* pFluidVelocitySRV)
+{
+    if (!m_pClassifySRB || pFluidVelocitySRV == nullptr)
+        return;
+
+    SleepConstants Constants;
+    Constants.uiNumParticles     = NumParticles;
+    Constants.fDeltaTime         = DeltaTime;
+    Constants.fAdaptiveTimeStep  = bAdaptiveTimeStep ? 1.f : 0.f;
+    Constants.fSleepDelay        = m_Settings.SleepDelay;
+    Constants.f2Scale            = f2Scale;
+    Constants.i2ParticleGridSize = i2ParticleGridSize;
+    Constants.fSleepSpeed        = m_Settings.SleepSpeed;
+    Constants.fWakeFluidSpeed    = m_Settings.WakeFluidSpeed;
+    m_pClassifySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "SleepConstantsBuffer")->SetBufferOffset(m_pFrameAllocator->Allocate(Constants));
+    m_pClassifySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture")->Set(pFluidVelocitySRV);
+
+    // La lista se vuelve a llenar en cada subpaso
+    const Uint32 InitialArgs[NUM_INDIRECT_ARGS] = {0, 1, 1, 0};
+    m_pContext->UpdateBuffer(m_pIndirectArgsBuffer, 0, sizeof(InitialArgs), InitialArgs, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    m_pContext->SetPipelineState(m_pClassifyPSO);
+    m_pContext->CommitShaderResources(m_pClassifySRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{(NumParticles + m_ThreadGroupSize - 1) / m_ThreadGroupSize});
+}
+
+void Tutorial14_ParticleSleep::EnqueueReadback()
+{
+    m_pReadback->Enqueue(m_pIndirectArgsBuffer);
+}
+
+Uint32 Tutorial14_ParticleSleep::GetNumActiveParticles()
+{
+    Uint32 Args[NUM_INDIRECT_ARGS] = {};
+    if (m_pReadback && m_pReadback->Poll(Args))
+        m_NumActiveParticles = Args[NUM_INDIRECT_ARGS - 1];
+    return m_NumActiveParticles;
+}
+
+} // namespace Diligent
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <memory>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Tutorial14_AsyncReadback.hpp"
+
+namespace Diligent
+{
+
+class Tutorial14_FrameAllocator;
+
+// Partculas dormidas. Antes de cada subpaso particle_sleep.csh recorre todas las
+// partculas: las que llevan SleepDelay segundos casi quietas, sin colisiones y con el
+// fluido en calma bajo ellas se duermen, y el resto se compacta en una lista de
+// partculas activas. Los pases de movimiento y colisin compilados con PARTICLE_SLEEP
+// se lanzan con DispatchComputeIndirect sobre esa lista.
+//
+// Las dormidas no se mueven, pero la clasificacin las copia al bfer de partculas
+// movidas y las inserta en la rejilla, de modo que las activas chocan con ellas. Una
+// activa que toca a una dormida la despierta en el siguiente subpaso, igual que un
+// fluido ms rpido que WakeFluidSpeed.
+class Tutorial14_ParticleSleep
+{
+public:
+    struct Settings
+    {
+        float SleepSpeed     = 0.01f; // Unidades NDC por segundo
+        float WakeFluidSpeed = 0.05f; // Valor del campo de velocidad del fluido
+        float SleepDelay     = 0.5f;  // Segundos en reposo antes de dormirse
+    };
+
+    Tutorial14_ParticleSleep(IRenderDevice*             pDevice,
+                             IDeviceContext*            pContext,
+                             IEngineFactory*            pEngineFactory,
+                             Tutorial14_FrameAllocator* pFrameAllocator,
+                             Uint32                     ThreadGroupSize);
+
+    bool IsValid() const { return m_pClassifyPSO != nullptr; }
+
+    // Los argumentos indirectos cuentan grupos de ThreadGroupSize hilos, el tamao de grupo
+    // de los pases de partculas
+    void SetThreadGroupSize(Uint32 ThreadGroupSize);
+
+    // Debe llamarse cada vez que se recrean los bferes de partculas; todas empiezan despiertas
+    void SetParticleBuffers(IBuffer* pParticleAttribs,
+                            IBuffer* pMovedParticleAttribs,
+                            IBuffer* pParticleListHeads,
+                            IBuffer* pParticleLists,
+                            IBuffer* pTimeStep,
+                            Uint32   NumParticles);
+
+    // Enlaza g_ActiveParticles y g_ActiveArgs en un SRB de movimiento o colisin
+    void BindActiveList(IShaderResourceBinding* pSRB) const;
+    // Enlaza g_WakeFlags en el SRB del pase de colisiones
+    void BindWakeFlags(IShaderResourceBinding* pSRB) const;
+
+    // Graba la clasificacin de un subpaso, despus de vaciar las listas de la rejilla
+    void Classify(Uint32        NumParticles,
+                  float         DeltaTime,
+                  bool          bAdaptiveTimeStep,
+                  const float2& f2Scale,
+                  const int2&   i2ParticleGridSize,
+                  ITextureView* pFluidVelocitySRV);
+
+    // Bferes que leen los pases de partculas activas
+    IBuffer* GetIndirectArgsBuffer() const { return m_pIndirectArgsBuffer; }
+    IBuffer* GetActiveListBuffer() const { return m_pActiveListBuffer; }
+    IBuffer* GetWakeFlagsBuffer() const { return m_pWakeFlagsBuffer; }
+
+    // Copia asncrona del nmero de partculas activas; una vez por frame tras los subpasos
+    void EnqueueReadback();
+
+    // Partculas activas en el ltimo subpaso ledo de la GPU
+    Uint32 GetNumActiveParticles();
+
+    Settings& GetSettings() { return m_Settings; }
+
+private:
+    void CreatePipeline();
+
+    IRenderDevice*             m_pDevice         = nullptr;
+    IDeviceContext*            m_pContext        = nullptr;
+    IEngineFactory*            m_pEngineFactory  = nullptr;
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
+
+    Uint32 m_ThreadGroupSize = 64;
+
+    RefCntAutoPtr<IBuffer>     m_pRestTimeBuffer;
+    RefCntAutoPtr<IBuffer>     m_pWakeFlagsBuffer;
+    RefCntAutoPtr<IBuffer>     m_pActiveListBuffer;
+    RefCntAutoPtr<IBuffer>     m_pIndirectArgsBuffer;
+    RefCntAutoPtr<IBufferView> m_pIndirectArgsSRV;
+    RefCntAutoPtr<IBufferView> m_pIndirectArgsUAV;
+
+    // Bferes de la simulacin, para volver a crear el SRB con el pipeline
+    RefCntAutoPtr<IBuffer> m_pParticleAttribs;
+    RefCntAutoPtr<IBuffer> m_pMovedParticleAttribs;
+    RefCntAutoPtr<IBuffer> m_pParticleListHeads;
+    RefCntAutoPtr<IBuffer> m_pParticleLists;
+    RefCntAutoPtr<IBuffer> m_pTimeStep;
+
+    RefCntAutoPtr<IPipelineState>         m_pClassifyPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pClassifySRB;
+
+    std::unique_ptr<Tutorial14_AsyncReadback> m_pReadback;
+
+    Settings m_Settings;
+    Uint32   m_NumActiveParticles = 0;
+};
+
+} // namespace Diligent
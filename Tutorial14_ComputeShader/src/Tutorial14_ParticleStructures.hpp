@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// Espejos en la CPU de las estructuras de structures.fxh que comparten los shaders
+// de simulacin y de render. Cualquier cambio en el .fxh debe repetirse aqu.
+
+// Espejo de ParticleAttribs en structures.fxh
+struct ParticleAttribs
+{
+    float2 f2Pos;
+    float2 f2Speed;
+
+    float fSize          = 0;
+    float fTemperature   = 0;
+    int   iNumCollisions = 0;
+    float fPadding0      = 0;
+};
+static_assert(sizeof(ParticleAttribs) == 32, "ParticleAttribs must match structures.fxh");
+
+// Espejo de GlobalConstants en structures.fxh (cbuffer Constants de los shaders de
+// simulacin y render)
+struct GlobalConstants
+{
+    Uint32 uiNumParticles    = 0;
+    float  fDeltaTime        = 0;
+    float  fAdaptiveTimeStep = 0;
+    float  fViewZoom         = 1;
+
+    float2 f2Scale;
+    int2   i2ParticleGridSize;
+
+    float2 f2ViewCenter;
+    float2 f2FluidWindowCenter;
+};
+static_assert(sizeof(GlobalConstants) == 48, "GlobalConstants must match structures.fxh");
+
+} // namespace Diligent
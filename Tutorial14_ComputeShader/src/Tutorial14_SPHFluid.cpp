@@ -0,0 +1,239 @@
+#include <algorithm>
+#include "Tutorial14_SPHFluid.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_FrameGraph.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de SPHConstants en sph.fxh
+struct SPHConstants
+{
+    Uint32 uiNumParticles    = 0;
+    float  fDeltaTime        = 0;
+    float  fAdaptiveTimeStep = 0;
+    float  fSmoothingRadius  = 0;
+
+    float2 f2Scale;
+    int2   i2ParticleGridSize;
+
+    float fRestDensity = 0;
+    float fStiffness   = 0;
+    float fViscosity   = 0;
+    float fGravity     = 0;
+};
+
+// Valores de SPH_PASS en sph.fxh
+constexpr int SPH_PASS_DENSITY = 0;
+constexpr int SPH_PASS_FORCES  = 1;
+
+} // namespace
+
+Tutorial14_SPHFluid::Tutorial14_SPHFluid(IRenderDevice*             pDevice,
+                                         IDeviceContext*            pContext,
+                                         IEngineFactory*            pEngineFactory,
+                                         Tutorial14_FrameAllocator* pFrameAllocator,
+                                         Uint32                     ThreadGroupSize) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pEngineFactory(pEngineFactory),
+    m_pFrameAllocator(pFrameAllocator),
+    m_ThreadGroupSize(ThreadGroupSize)
+{
+    CreatePipelines();
+}
+
+void Tutorial14_SPHFluid::SetThreadGroupSize(Uint32 ThreadGroupSize)
+{
+    if (ThreadGroupSize == m_ThreadGroupSize)
+        return;
+
+    m_ThreadGroupSize = ThreadGroupSize;
+    CreatePipelines();
+}
+
+void Tutorial14_SPHFluid::CreatePipelines()
+{
+    m_pDensitySRB.Release();
+    m_pDensityPSO.Release();
+    m_pForcesSRB.Release();
+    m_pForcesPSO.Release();
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.EntryPoint                      = "main";
+    ShaderCI.FilePath                        = "sph.csh";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+    // Las constantes son una ventana del asignador de frame
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    auto CreatePSO = [&](const char* ShaderName, const char* PSOName, int Pass, RefCntAutoPtr<IPipelineState>& pPSO) {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("THREAD_GROUP_SIZE", m_ThreadGroupSize);
+        Macros.AddShaderMacro("SPH_PASS", Pass);
+        ShaderCI.Macros    = Macros;
+        ShaderCI.Desc.Name = ShaderName;
+
+        RefCntAutoPtr<IShader> pCS;
+        m_pDevice->CreateShader(ShaderCI, &pCS);
+        if (!pCS)
+        {
+            LOG_ERROR_MESSAGE("Failed to create shader ", ShaderName);
+            return;
+        }
+
+        PSODesc.Name      = PSOName;
+        PSOCreateInfo.pCS = pCS;
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+        if (!pPSO)
+            LOG_ERROR_MESSAGE("Failed to create PSO ", PSOName);
+    };
+    CreatePSO("SPH density CS", "SPH density PSO", SPH_PASS_DENSITY, m_pDensityPSO);
+    CreatePSO("SPH forces CS", "SPH forces PSO", SPH_PASS_FORCES, m_pForcesPSO);
+
+    if (IsValid() && m_pParticleAttribs)
+    {
+        SetParticleBuffers(m_pParticleAttribs, m_pMovedParticleAttribs, m_pParticleListHeads, m_pParticleLists, m_pTimeStep, m_NumParticles);
+    }
+}
+
+void Tutorial14_SPHFluid::SetParticleBuffers(IBuffer* pParticleAttribs,
+                                             IBuffer* pMovedParticleAttribs,
+                                             IBuffer* pParticleListHeads,
+                                             IBuffer* pParticleLists,
+                                             IBuffer* pTimeStep,
+                                             Uint32   NumParticles)
+{
+    m_pParticleAttribs      = pParticleAttribs;
+    m_pMovedParticleAttribs = pMovedParticleAttribs;
+    m_pParticleListHeads    = pParticleListHeads;
+    m_pParticleLists        = pParticleLists;
+    m_pTimeStep             = pTimeStep;
+
+    if (!m_pDensityBuffer || NumParticles != m_NumParticles)
+    {
+        m_pDensityBuffer.Release();
+
+        // El pase de densidad lo escribe entero antes de que se lea
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "SPH density buffer";
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(float);
+        BuffDesc.Size              = Uint64{NumParticles} * sizeof(float);
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pDensityBuffer);
+
+        m_NumParticles = NumParticles;
+    }
+
+    m_pDensitySRB.Release();
+    m_pForcesSRB.Release();
+    if (!IsValid() || !m_pDensityBuffer)
+        return;
+
+    IBufferView* pMovedParticleAttribsSRV = pMovedParticleAttribs->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pParticleListHeadsSRV    = pParticleListHeads->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pParticleListsSRV        = pParticleLists->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+
+    m_pDensityPSO->CreateShaderResourceBinding(&m_pDensitySRB, true);
+    m_pDensitySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pMovedParticleAttribsSRV);
+    m_pDensitySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeadsSRV);
+    m_pDensitySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pParticleListsSRV);
+    m_pDensitySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Density")->Set(m_pDensityBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pFrameAllocator->BindConstants(m_pDensitySRB->GetVariableByName(SHADER_TYPE_COMPUTE, "SPHConstantsBuffer"), sizeof(SPHConstants));
+
+    m_pForcesPSO->CreateShaderResourceBinding(&m_pForcesSRB, true);
+    m_pForcesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pMovedParticleAttribsSRV);
+    m_pForcesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeadsSRV);
+    m_pForcesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pParticleListsSRV);
+    m_pForcesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Density")->Set(m_pDensityBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pForcesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TimeStep")->Set(pTimeStep->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pForcesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutParticles")->Set(pParticleAttribs->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    m_pFrameAllocator->BindConstants(m_pForcesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "SPHConstantsBuffer"), sizeof(SPHConstants));
+}
+
+void Tutorial14_SPHFluid::AddPasses(Tutorial14_FrameGraph& Graph,
+                                    Uint32                 NumParticles,
+                                    float                  DeltaTime,
+                                    bool                   bAdaptiveTimeStep,
+                                    const float2&          f2Scale,
+                                    const int2&            i2ParticleGridSize)
+{
+    T14_TRACE_SCOPE("SPHFluid::AddPasses");
+
+    if (!m_pDensitySRB || !m_pForcesSRB)
+        return;
+
+    SPHConstants Constants;
+    Constants.uiNumParticles     = NumParticles;
+    Constants.fDeltaTime         = DeltaTime;
+    Constants.fAdaptiveTimeStep  = bAdaptiveTimeStep ? 1.f : 0.f;
+    Constants.f2Scale            = f2Scale;
+    Constants.i2ParticleGridSize = i2ParticleGridSize;
+    Constants.fRestDensity       = m_Settings.RestDensity;
+    Constants.fStiffness         = m_Settings.Stiffness;
+    Constants.fViscosity         = m_Settings.Viscosity;
+    Constants.fGravity           = m_Settings.Gravity;
+    // Las celdas miden 2 / i2ParticleGridSize en NDC; el ncleo trabaja en unidades de
+    // f2Scale, como las colisiones
+    Constants.fSmoothingRadius = std::min(2.f / (static_cast<float>(i2ParticleGridSize.x) * f2Scale.x),
+                                          2.f / (static_cast<float>(i2ParticleGridSize.y) * f2Scale.y));
+    const Uint32 Offset = m_pFrameAllocator->Allocate(Constants);
+
+    const auto ParticlesId      = Graph.ImportBuffer(m_pParticleAttribs);
+    const auto MovedParticlesId = Graph.ImportBuffer(m_pMovedParticleAttribs);
+    const auto ListHeadsId      = Graph.ImportBuffer(m_pParticleListHeads);
+    const auto ListsId          = Graph.ImportBuffer(m_pParticleLists);
+    const auto TimeStepId       = Graph.ImportBuffer(m_pTimeStep);
+    const auto DensityId        = Graph.ImportBuffer(m_pDensityBuffer);
+
+    const Uint32 NumGroups = (NumParticles + m_ThreadGroupSize - 1) / m_ThreadGroupSize;
+    auto         Dispatch  = [NumGroups, Offset](IDeviceContext* pCtx, IPipelineState* pPSO, IShaderResourceBinding* pSRB) {
+        pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "SPHConstantsBuffer")->SetBufferOffset(Offset);
+        pCtx->SetPipelineState(pPSO);
+        pCtx->CommitShaderResources(pSRB, Tutorial14_FrameGraph::PASS_TRANSITION_MODE);
+        pCtx->DispatchCompute(DispatchComputeAttribs{NumGroups});
+    };
+
+    Graph.AddPass("SPH density",
+                  {
+                      {MovedParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {ListHeadsId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {ListsId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {DensityId, RESOURCE_STATE_UNORDERED_ACCESS},
+                  },
+                  [this, Dispatch](IDeviceContext* pCtx) {
+                      Dispatch(pCtx, m_pDensityPSO, m_pDensitySRB);
+                  });
+
+    Graph.AddPass("SPH forces",
+                  {
+                      {MovedParticlesId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {ListHeadsId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {ListsId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {DensityId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {TimeStepId, RESOURCE_STATE_SHADER_RESOURCE},
+                      {ParticlesId, RESOURCE_STATE_UNORDERED_ACCESS},
+                  },
+                  [this, Dispatch](IDeviceContext* pCtx) {
+                      Dispatch(pCtx, m_pForcesPSO, m_pForcesSRB);
+                  });
+}
+
+} // namespace Diligent
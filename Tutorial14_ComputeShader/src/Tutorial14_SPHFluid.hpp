@@ -0,0 +1,87 @@
+#pragma once
+
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+
+namespace Diligent
+{
+
+class Tutorial14_FrameAllocator;
+class Tutorial14_FrameGraph;
+
+// Modo de fluido SPH (smoothed particle hydrodynamics) sobre la rejilla de partculas.
+// Sustituye a los pases de colisin: tras el pase de movimiento, que ya inserta las
+// partculas en la rejilla, sph.csh calcula la densidad de cada partcula y despus las
+// fuerzas de presin, viscosidad y gravedad, e integra la velocidad. El radio del ncleo
+// es el tamao de celda, de modo que basta con recorrer las 3x3 celdas vecinas y no hace
+// falta otra estructura espacial.
+class Tutorial14_SPHFluid
+{
+public:
+    struct Settings
+    {
+        float RestDensity = 3.f;  // Relativa a las partculas repartidas por toda la pantalla
+        float Stiffness   = 40.f; // Valores altos necesitan subpasos (Adaptive Time Step)
+        float Viscosity   = 1.f;
+        float Gravity     = 0.2f;
+    };
+
+    Tutorial14_SPHFluid(IRenderDevice*             pDevice,
+                        IDeviceContext*            pContext,
+                        IEngineFactory*            pEngineFactory,
+                        Tutorial14_FrameAllocator* pFrameAllocator,
+                        Uint32                     ThreadGroupSize);
+
+    bool IsValid() const { return m_pDensityPSO != nullptr && m_pForcesPSO != nullptr; }
+
+    void SetThreadGroupSize(Uint32 ThreadGroupSize);
+
+    // Debe llamarse cada vez que se recrean los bferes de partculas
+    void SetParticleBuffers(IBuffer* pParticleAttribs,
+                            IBuffer* pMovedParticleAttribs,
+                            IBuffer* pParticleListHeads,
+                            IBuffer* pParticleLists,
+                            IBuffer* pTimeStep,
+                            Uint32   NumParticles);
+
+    // Aade los pases de densidad y de fuerzas de un subpaso, en lugar de los de colisin
+    void AddPasses(Tutorial14_FrameGraph& Graph,
+                   Uint32                 NumParticles,
+                   float                  DeltaTime,
+                   bool                   bAdaptiveTimeStep,
+                   const float2&          f2Scale,
+                   const int2&            i2ParticleGridSize);
+
+    Settings& GetSettings() { return m_Settings; }
+
+private:
+    void CreatePipelines();
+
+    IRenderDevice*             m_pDevice         = nullptr;
+    IDeviceContext*            m_pContext        = nullptr;
+    IEngineFactory*            m_pEngineFactory  = nullptr;
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
+
+    Uint32 m_ThreadGroupSize = 64;
+    Uint32 m_NumParticles    = 0;
+
+    RefCntAutoPtr<IBuffer> m_pDensityBuffer;
+
+    // Bferes de la simulacin, para volver a crear los SRB con los pipelines
+    RefCntAutoPtr<IBuffer> m_pParticleAttribs;
+    RefCntAutoPtr<IBuffer> m_pMovedParticleAttribs;
+    RefCntAutoPtr<IBuffer> m_pParticleListHeads;
+    RefCntAutoPtr<IBuffer> m_pParticleLists;
+    RefCntAutoPtr<IBuffer> m_pTimeStep;
+
+    RefCntAutoPtr<IPipelineState>         m_pDensityPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pDensitySRB;
+    RefCntAutoPtr<IPipelineState>         m_pForcesPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pForcesSRB;
+
+    Settings m_Settings;
+};
+
+} // namespace Diligent
@@ -0,0 +1,567 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "Tutorial14_SceneBatch.hpp"
+#include "Tutorial14_ParticleStructures.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "MapHelper.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de SceneBatchConstants en structures.fxh
+struct SceneBatchConstants
+{
+    Uint32 uiFirstParticle;
+    Uint32 uiNumParticles;
+    Uint32 uiFirstCell;
+    Uint32 uiNumCells;
+};
+
+// Torbellinos con los que se siembra el campo de velocidad de cada escena
+constexpr Uint32 NUM_VORTICES_PER_SCENE = 3;
+
+} // namespace
+
+Tutorial14_SceneBatch::Tutorial14_SceneBatch(IRenderDevice*  pDevice,
+                                             IDeviceContext* pContext,
+                                             IEngineFactory* pEngineFactory,
+                                             Uint32          ThreadGroupSize,
+                                             TEXTURE_FORMAT  RTVFormat,
+                                             TEXTURE_FORMAT  DSVFormat,
+                                             bool            ConvertPSOutputToGamma) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pEngineFactory(pEngineFactory),
+    m_ThreadGroupSize(ThreadGroupSize)
+{
+    static_assert(sizeof(SceneConstants) == 64, "SceneConstants must match structures.fxh");
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name           = "Scene batch constants buffer";
+    BuffDesc.Usage          = USAGE_DYNAMIC;
+    BuffDesc.BindFlags      = BIND_UNIFORM_BUFFER;
+    BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    BuffDesc.Size           = sizeof(SceneBatchConstants);
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pBatchConstants);
+
+    CreatePipelines(ThreadGroupSize, RTVFormat, DSVFormat, ConvertPSOutputToGamma);
+}
+
+void Tutorial14_SceneBatch::CreatePipelines(Uint32 ThreadGroupSize, TEXTURE_FORMAT RTVFormat, TEXTURE_FORMAT DSVFormat, bool ConvertPSOutputToGamma)
+{
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.EntryPoint                      = "main";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    auto CreateShader = [&](SHADER_TYPE Type, const char* Name, const char* FilePath, bool UpdateSpeed) {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("MULTI_SCENE", 1);
+        Macros.AddShaderMacro("THREAD_GROUP_SIZE", static_cast<int>(ThreadGroupSize));
+        Macros.AddShaderMacro("CONVERT_PS_OUTPUT_TO_GAMMA", ConvertPSOutputToGamma ? 1 : 0);
+        if (UpdateSpeed)
+            Macros.AddShaderMacro("UPDATE_SPEED", 1);
+        ShaderCI.Macros          = Macros;
+        ShaderCI.Desc.ShaderType = Type;
+        ShaderCI.Desc.Name       = Name;
+        ShaderCI.FilePath        = FilePath;
+
+        RefCntAutoPtr<IShader> pShader;
+        m_pDevice->CreateShader(ShaderCI, &pShader);
+        if (!pShader)
+            LOG_ERROR_MESSAGE("Failed to create shader ", Name);
+        return pShader;
+    };
+
+    RefCntAutoPtr<IShader> pResetListsCS  = CreateShader(SHADER_TYPE_COMPUTE, "Scene batch reset lists CS", "reset_particle_lists.csh", false);
+    RefCntAutoPtr<IShader> pMoveCS        = CreateShader(SHADER_TYPE_COMPUTE, "Scene batch move particles CS", "move_particles.csh", false);
+    RefCntAutoPtr<IShader> pCollideCS     = CreateShader(SHADER_TYPE_COMPUTE, "Scene batch collide particles CS", "collide_particles.csh", false);
+    RefCntAutoPtr<IShader> pUpdateSpeedCS = CreateShader(SHADER_TYPE_COMPUTE, "Scene batch update speed CS", "collide_particles.csh", true);
+    RefCntAutoPtr<IShader> pRenderVS      = CreateShader(SHADER_TYPE_VERTEX, "Scene batch particle VS", "particle.vsh", false);
+    RefCntAutoPtr<IShader> pRenderPS      = CreateShader(SHADER_TYPE_PIXEL, "Scene batch particle PS", "particle.psh", false);
+
+    {
+        ComputePipelineStateCreateInfo PSOCreateInfo;
+        PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+        PSODesc.PipelineType                       = PIPELINE_TYPE_COMPUTE;
+        PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+        // clang-format off
+        ShaderResourceVariableDesc Vars[] = 
+        {
+            {SHADER_TYPE_COMPUTE, "BatchConstants", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+        };
+        // clang-format on
+        PSODesc.ResourceLayout.Variables    = Vars;
+        PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+        SamplerDesc LinearClampSampler;
+        LinearClampSampler.MinFilter = FILTER_TYPE_LINEAR;
+        LinearClampSampler.MagFilter = FILTER_TYPE_LINEAR;
+        LinearClampSampler.MipFilter = FILTER_TYPE_LINEAR;
+        LinearClampSampler.AddressU  = TEXTURE_ADDRESS_CLAMP;
+        LinearClampSampler.AddressV  = TEXTURE_ADDRESS_CLAMP;
+        LinearClampSampler.AddressW  = TEXTURE_ADDRESS_CLAMP;
+
+        ImmutableSamplerDesc ImtblSamplers[] = {{SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture", LinearClampSampler}};
+        PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+        PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+
+        auto CreatePSO = [&](const char* Name, IShader* pCS, RefCntAutoPtr<IPipelineState>& pPSO) {
+            PSODesc.Name      = Name;
+            PSOCreateInfo.pCS = pCS;
+            m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+            if (!pPSO)
+            {
+                LOG_ERROR_MESSAGE("Failed to create PSO ", Name);
+                return;
+            }
+            pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "BatchConstants")->Set(m_pBatchConstants);
+        };
+        CreatePSO("Scene batch reset lists PSO", pResetListsCS, m_pResetListsPSO);
+        CreatePSO("Scene batch move particles PSO", pMoveCS, m_pMovePSO);
+        CreatePSO("Scene batch collide particles PSO", pCollideCS, m_pCollidePSO);
+        CreatePSO("Scene batch update speed PSO", pUpdateSpeedCS, m_pUpdateSpeedPSO);
+    }
+
+    // Mismo estado que la PSO de partculas de la simulacin principal
+    GraphicsPipelineStateCreateInfo PSOCreateInfo;
+    PSOCreateInfo.PSODesc.Name         = "Scene batch render particles PSO";
+    PSOCreateInfo.PSODesc.PipelineType = PIPELINE_TYPE_GRAPHICS;
+
+    // clang-format off
+    PSOCreateInfo.GraphicsPipeline.NumRenderTargets             = 1;
+    PSOCreateInfo.GraphicsPipeline.RTVFormats[0]                = RTVFormat;
+    PSOCreateInfo.GraphicsPipeline.DSVFormat                    = DSVFormat;
+    PSOCreateInfo.GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_NONE;
+    PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = False;
+    // clang-format on
+
+    auto& BlendDesc = PSOCreateInfo.GraphicsPipeline.BlendDesc;
+
+    BlendDesc.RenderTargets[0].BlendEnable    = True;
+    BlendDesc.RenderTargets[0].SrcBlend       = BLEND_FACTOR_SRC_ALPHA;
+    BlendDesc.RenderTargets[0].DestBlend      = BLEND_FACTOR_INV_SRC_ALPHA;
+    BlendDesc.RenderTargets[0].BlendOp        = BLEND_OPERATION_ADD;
+    BlendDesc.RenderTargets[0].SrcBlendAlpha  = BLEND_FACTOR_ONE;
+    BlendDesc.RenderTargets[0].DestBlendAlpha = BLEND_FACTOR_INV_SRC_ALPHA;
+    BlendDesc.RenderTargets[0].BlendOpAlpha   = BLEND_OPERATION_ADD;
+
+    PSOCreateInfo.pVS = pRenderVS;
+    PSOCreateInfo.pPS = pRenderPS;
+
+    PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pRenderPSO);
+    if (!m_pRenderPSO)
+        LOG_ERROR_MESSAGE("Failed to create PSO Scene batch render particles PSO");
+}
+
+void Tutorial14_SceneBatch::SetSettings(const Settings& NewSettings, float AspectRatio)
+{
+    T14_TRACE_SCOPE("SceneBatch::SetSettings");
+
+    m_Settings                   = NewSettings;
+    m_Settings.NumScenes         = std::max(m_Settings.NumScenes, 1u);
+    m_Settings.ParticlesPerScene = std::max(m_Settings.ParticlesPerScene, 2u);
+    m_Settings.FluidGridSize     = std::max(m_Settings.FluidGridSize, 4u);
+
+    CreateScenes(AspectRatio);
+    CreateFluidFields();
+    CreateShaderResourceBindings();
+}
+
+void Tutorial14_SceneBatch::CreateScenes(float AspectRatio)
+{
+    const Uint32 NumScenes = m_Settings.NumScenes;
+
+    // Cuadrcula de escenas con celdas lo ms cuadradas posible
+    const Uint32 NumCols = std::max(1u, std::min(NumScenes, static_cast<Uint32>(std::round(std::sqrt(static_cast<float>(NumScenes) * AspectRatio)))));
+    const Uint32 NumRows = (NumScenes + NumCols - 1) / NumCols;
+
+    const float2 TileSize{2.f / static_cast<float>(NumCols), 2.f / static_cast<float>(NumRows)};
+    const float  TileAspect = AspectRatio * static_cast<float>(NumRows) / static_cast<float>(NumCols);
+    const float2 f2Scale{std::sqrt(1.f / TileAspect), std::sqrt(TileAspect)};
+
+    // Semilla fija para que cada recreacin produzca las mismas escenas
+    std::mt19937 gen;
+
+    std::uniform_int_distribution<Uint32> count_distr(m_Settings.ParticlesPerScene / 2, m_Settings.ParticlesPerScene);
+    std::uniform_real_distribution<float> pos_distr(-1.f, +1.f);
+    std::uniform_real_distribution<float> size_distr(0.5f, 1.f);
+    std::uniform_real_distribution<float> speed_distr(0.5f, 1.5f);
+
+    m_Scenes.resize(NumScenes);
+    m_SceneSpeed.resize(NumScenes);
+    m_NumParticles = 0;
+    m_NumCells     = 0;
+
+    std::vector<ParticleAttribs> ParticleData;
+    std::vector<Uint32>          ParticleScene;
+    for (Uint32 s = 0; s < NumScenes; ++s)
+    {
+        const Uint32 NumSceneParticles = count_distr(gen);
+
+        int iGridWidth  = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(NumSceneParticles)) / f2Scale.x));
+        int iGridHeight = std::max(1, static_cast<int>(NumSceneParticles) / iGridWidth);
+
+        SceneConstants& Scene    = m_Scenes[s];
+        Scene.uiFirstParticle    = m_NumParticles;
+        Scene.uiNumParticles     = NumSceneParticles;
+        Scene.uiFirstCell        = m_NumCells;
+        Scene.uiFluidSlice       = s;
+        Scene.f2Scale            = f2Scale;
+        Scene.i2ParticleGridSize = int2{iGridWidth, iGridHeight};
+        Scene.fDeltaTime         = 0;
+        Scene.fFluidInfluence    = m_Settings.FluidInfluence;
+        Scene.f2Padding0         = float2{0, 0};
+
+        const Uint32 Col = s % NumCols;
+        const Uint32 Row = s / NumCols;
+        // Un pequeo margen separa las escenas en pantalla
+        Scene.f4Viewport = float4{-1.f + TileSize.x * (static_cast<float>(Col) + 0.5f),
+                                  +1.f - TileSize.y * (static_cast<float>(Row) + 0.5f),
+                                  TileSize.x * 0.5f * 0.96f,
+                                  TileSize.y * 0.5f * 0.96f};
+
+        m_SceneSpeed[s] = speed_distr(gen);
+
+        constexpr float fMaxParticleSize = 0.05f;
+        const float     fSize            = std::min(fMaxParticleSize, 0.7f / std::sqrt(static_cast<float>(NumSceneParticles)));
+        for (Uint32 p = 0; p < NumSceneParticles; ++p)
+        {
+            ParticleAttribs Particle;
+            Particle.f2Pos.x   = pos_distr(gen);
+            Particle.f2Pos.y   = pos_distr(gen);
+            Particle.f2Speed.x = pos_distr(gen) * fSize * 5.f;
+            Particle.f2Speed.y = pos_distr(gen) * fSize * 5.f;
+            Particle.fSize     = fSize * size_distr(gen);
+            ParticleData.push_back(Particle);
+            ParticleScene.push_back(s);
+        }
+
+        m_NumParticles += NumSceneParticles;
+        m_NumCells += static_cast<Uint32>(iGridWidth * iGridHeight);
+    }
+
+    m_pScenesBuffer.Release();
+    m_pParticleSceneBuffer.Release();
+    m_pParticleAttribsBuffer.Release();
+    m_pMovedParticleAttribsBuffer.Release();
+    m_pParticleListHeadsBuffer.Release();
+    m_pParticleListsBuffer.Release();
+
+    // El intervalo de cada escena se sube en el primer Simulate()
+    m_LastDeltaTime = -1;
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Scene batch scenes buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(SceneConstants);
+    BuffDesc.Size              = sizeof(SceneConstants) * NumScenes;
+    BufferData ScenesData{m_Scenes.data(), BuffDesc.Size};
+    m_pDevice->CreateBuffer(BuffDesc, &ScenesData, &m_pScenesBuffer);
+
+    BuffDesc.Name              = "Scene batch particle scene buffer";
+    BuffDesc.Usage             = USAGE_IMMUTABLE;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = sizeof(Uint32) * m_NumParticles;
+    BufferData ParticleSceneData{ParticleScene.data(), BuffDesc.Size};
+    m_pDevice->CreateBuffer(BuffDesc, &ParticleSceneData, &m_pParticleSceneBuffer);
+
+    BuffDesc.Name              = "Scene batch particle attribs buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    BuffDesc.ElementByteStride = sizeof(ParticleAttribs);
+    BuffDesc.Size              = sizeof(ParticleAttribs) * m_NumParticles;
+    BufferData ParticleAttribsData{ParticleData.data(), BuffDesc.Size};
+    m_pDevice->CreateBuffer(BuffDesc, &ParticleAttribsData, &m_pParticleAttribsBuffer);
+
+    BuffDesc.Name = "Scene batch moved particle attribs buffer";
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pMovedParticleAttribsBuffer);
+
+    BuffDesc.Name              = "Scene batch particle list heads buffer";
+    BuffDesc.ElementByteStride = sizeof(int);
+    BuffDesc.Size              = sizeof(int) * m_NumCells;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pParticleListHeadsBuffer);
+
+    BuffDesc.Name = "Scene batch particle lists buffer";
+    BuffDesc.Size = sizeof(int) * m_NumParticles;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pParticleListsBuffer);
+}
+
+void Tutorial14_SceneBatch::CreateFluidFields()
+{
+    const Uint32 GridSize  = m_Settings.FluidGridSize;
+    const Uint32 NumScenes = m_Settings.NumScenes;
+
+    // Campo esttico por escena: suma de torbellinos gaussianos con centro, radio
+    // y sentido aleatorios
+    std::mt19937                          gen{NumScenes};
+    std::uniform_real_distribution<float> center_distr(0.15f, 0.85f);
+    std::uniform_real_distribution<float> radius_distr(0.15f, 0.35f);
+    std::uniform_real_distribution<float> strength_distr(0.5f, 1.5f);
+
+    std::vector<float2> Velocity(size_t{GridSize} * GridSize * NumScenes);
+    for (Uint32 s = 0; s < NumScenes; ++s)
+    {
+        float2 Centers[NUM_VORTICES_PER_SCENE];
+        float  Radii[NUM_VORTICES_PER_SCENE];
+        float  Strengths[NUM_VORTICES_PER_SCENE];
+        for (Uint32 v = 0; v < NUM_VORTICES_PER_SCENE; ++v)
+        {
+            Centers[v]   = float2{center_distr(gen), center_distr(gen)};
+            Radii[v]     = radius_distr(gen);
+            Strengths[v] = strength_distr(gen) * ((v & 1) ? -1.f : 1.f);
+        }
+
+        float2* pSlice = &Velocity[size_t{GridSize} * GridSize * s];
+        for (Uint32 y = 0; y < GridSize; ++y)
+        {
+            for (Uint32 x = 0; x < GridSize; ++x)
+            {
+                const float2 Pos{(static_cast<float>(x) + 0.5f) / static_cast<float>(GridSize),
+                                 (static_cast<float>(y) + 0.5f) / static_cast<float>(GridSize)};
+
+                float2 Vel{0, 0};
+                for (Uint32 v = 0; v < NUM_VORTICES_PER_SCENE; ++v)
+                {
+                    const float2 d       = Pos - Centers[v];
+                    const float  Falloff = std::exp(-(d.x * d.x + d.y * d.y) / (Radii[v] * Radii[v]));
+                    Vel += float2{-d.y, d.x} * (Strengths[v] * Falloff / Radii[v]);
+                }
+                pSlice[x + y * GridSize] = Vel;
+            }
+        }
+    }
+
+    std::vector<TextureSubResData> SubResData(NumScenes);
+    for (Uint32 s = 0; s < NumScenes; ++s)
+    {
+        SubResData[s].pData  = &Velocity[size_t{GridSize} * GridSize * s];
+        SubResData[s].Stride = sizeof(float2) * GridSize;
+    }
+
+    TextureDesc TexDesc;
+    TexDesc.Name      = "Scene batch fluid velocity";
+    TexDesc.Type      = RESOURCE_DIM_TEX_2D_ARRAY;
+    TexDesc.Width     = GridSize;
+    TexDesc.Height    = GridSize;
+    TexDesc.ArraySize = NumScenes;
+    TexDesc.Format    = TEX_FORMAT_RG32_FLOAT;
+    TexDesc.Usage     = USAGE_IMMUTABLE;
+    TexDesc.BindFlags = BIND_SHADER_RESOURCE;
+
+    TextureData InitData{SubResData.data(), NumScenes};
+    m_pFluidVelocity.Release();
+    m_pDevice->CreateTexture(TexDesc, &InitData, &m_pFluidVelocity);
+}
+
+void Tutorial14_SceneBatch::CreateShaderResourceBindings()
+{
+    m_pResetListsSRB.Release();
+    m_pMoveSRB.Release();
+    m_pCollideSRB.Release();
+    m_pRenderSRB.Release();
+
+    if (!m_pResetListsPSO || !m_pMovePSO || !m_pCollidePSO || !m_pUpdateSpeedPSO || !m_pRenderPSO || !m_pFluidVelocity)
+        return;
+
+    IBufferView* pScenesSRV          = m_pScenesBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pParticleSceneSRV   = m_pParticleSceneBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pParticleAttribsSRV = m_pParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pParticleAttribsUAV = m_pParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pMovedParticlesSRV  = m_pMovedParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pMovedParticlesUAV  = m_pMovedParticleAttribsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pListHeadsSRV       = m_pParticleListHeadsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pListHeadsUAV       = m_pParticleListHeadsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pListsSRV           = m_pParticleListsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pListsUAV           = m_pParticleListsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+
+    m_pResetListsPSO->CreateShaderResourceBinding(&m_pResetListsSRB, true);
+    m_pResetListsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pListHeadsUAV);
+
+    m_pMovePSO->CreateShaderResourceBinding(&m_pMoveSRB, true);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pParticleAttribsSRV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutParticles")->Set(pMovedParticlesUAV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pListHeadsUAV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pListsUAV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleScene")->Set(pParticleSceneSRV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Scenes")->Set(pScenesSRV);
+    m_pMoveSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture")->Set(m_pFluidVelocity->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+
+    // El pase de velocidad usa la misma SRB que el de colisiones
+    m_pCollidePSO->CreateShaderResourceBinding(&m_pCollideSRB, true);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pMovedParticlesSRV);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_OutParticles")->Set(pParticleAttribsUAV);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pListHeadsSRV);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pListsSRV);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleScene")->Set(pParticleSceneSRV);
+    m_pCollideSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Scenes")->Set(pScenesSRV);
+
+    m_pRenderPSO->CreateShaderResourceBinding(&m_pRenderSRB, true);
+    m_pRenderSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_Particles")->Set(pParticleAttribsSRV);
+    m_pRenderSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_ParticleScene")->Set(pParticleSceneSRV);
+    m_pRenderSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_Scenes")->Set(pScenesSRV);
+}
+
+void Tutorial14_SceneBatch::Dispatch(IDeviceContext* pContext, IPipelineState* pPSO, IShaderResourceBinding* pSRB, Uint32 NumThreads)
+{
+    pContext->SetPipelineState(pPSO);
+    // Las transiciones son explcitas para que la grabacin funcione en contextos diferidos
+    pContext->CommitShaderResources(pSRB, RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+    DispatchComputeAttribs DispatAttribs;
+    DispatAttribs.ThreadGroupCountX = (NumThreads + m_ThreadGroupSize - 1) / m_ThreadGroupSize;
+    pContext->DispatchCompute(DispatAttribs);
+    m_NumDispatches.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Tutorial14_SceneBatch::BeginFrame(float DeltaTime)
+{
+    T14_TRACE_SCOPE("SceneBatch::BeginFrame");
+
+    m_NumDispatches.store(0);
+
+    // Las constantes de las escenas solo cambian con el intervalo de tiempo
+    if (DeltaTime != m_LastDeltaTime)
+    {
+        for (size_t s = 0; s < m_Scenes.size(); ++s)
+            m_Scenes[s].fDeltaTime = DeltaTime * m_SceneSpeed[s];
+        m_pContext->UpdateBuffer(m_pScenesBuffer, 0, sizeof(SceneConstants) * m_Scenes.size(), m_Scenes.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_LastDeltaTime = DeltaTime;
+    }
+
+    // clang-format off
+    StateTransitionDesc Barriers[] =
+    {
+        {m_pScenesBuffer,            RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,  STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_pParticleSceneBuffer,     RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,  STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_pFluidVelocity,           RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,  STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_pParticleAttribsBuffer,      RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE,  STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_pMovedParticleAttribsBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_pParticleListHeadsBuffer,    RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_pParticleListsBuffer,        RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, STATE_TRANSITION_FLAG_UPDATE_STATE}
+    };
+    // clang-format on
+    m_pContext->TransitionResourceStates(_countof(Barriers), Barriers);
+}
+
+void Tutorial14_SceneBatch::RecordSimulation(IDeviceContext* pContext, Uint32 FirstScene, Uint32 NumScenes)
+{
+    T14_TRACE_SCOPE("SceneBatch::RecordSimulation");
+
+    // Cada rango empieza y termina con el estado de las partculas como SRV y las partculas
+    // movidas, las cabezas y las listas como UAV
+    auto SimulateRange = [&](Uint32 FirstParticle, Uint32 NumParticles, Uint32 FirstCell, Uint32 NumCells) {
+        {
+            MapHelper<SceneBatchConstants> Batch(pContext, m_pBatchConstants, MAP_WRITE, MAP_FLAG_DISCARD);
+            Batch->uiFirstParticle = FirstParticle;
+            Batch->uiNumParticles  = NumParticles;
+            Batch->uiFirstCell     = FirstCell;
+            Batch->uiNumCells      = NumCells;
+        }
+
+        Dispatch(pContext, m_pResetListsPSO, m_pResetListsSRB, NumCells);
+        {
+            StateTransitionDesc Barrier{m_pParticleListHeadsBuffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS};
+            pContext->TransitionResourceStates(1, &Barrier);
+        }
+
+        Dispatch(pContext, m_pMovePSO, m_pMoveSRB, NumParticles);
+        {
+            // clang-format off
+            StateTransitionDesc Barriers[] =
+            {
+                {m_pParticleAttribsBuffer,      RESOURCE_STATE_SHADER_RESOURCE,  RESOURCE_STATE_UNORDERED_ACCESS},
+                {m_pMovedParticleAttribsBuffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE},
+                {m_pParticleListHeadsBuffer,    RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE},
+                {m_pParticleListsBuffer,        RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE}
+            };
+            // clang-format on
+            pContext->TransitionResourceStates(_countof(Barriers), Barriers);
+        }
+
+        Dispatch(pContext, m_pCollidePSO, m_pCollideSRB, NumParticles);
+        {
+            StateTransitionDesc Barrier{m_pParticleAttribsBuffer, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_UNORDERED_ACCESS};
+            pContext->TransitionResourceStates(1, &Barrier);
+        }
+
+        Dispatch(pContext, m_pUpdateSpeedPSO, m_pCollideSRB, NumParticles);
+        {
+            // clang-format off
+            StateTransitionDesc Barriers[] =
+            {
+                {m_pParticleAttribsBuffer,      RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE},
+                {m_pMovedParticleAttribsBuffer, RESOURCE_STATE_SHADER_RESOURCE,  RESOURCE_STATE_UNORDERED_ACCESS},
+                {m_pParticleListHeadsBuffer,    RESOURCE_STATE_SHADER_RESOURCE,  RESOURCE_STATE_UNORDERED_ACCESS},
+                {m_pParticleListsBuffer,        RESOURCE_STATE_SHADER_RESOURCE,  RESOURCE_STATE_UNORDERED_ACCESS}
+            };
+            // clang-format on
+            pContext->TransitionResourceStates(_countof(Barriers), Barriers);
+        }
+    };
+
+    const Uint32 EndScene = std::min(FirstScene + NumScenes, static_cast<Uint32>(m_Scenes.size()));
+    if (FirstScene >= EndScene)
+        return;
+
+    if (m_Settings.DispatchPerScene)
+    {
+        for (Uint32 s = FirstScene; s < EndScene; ++s)
+        {
+            const SceneConstants& Scene         = m_Scenes[s];
+            const Uint32          NumSceneCells = static_cast<Uint32>(Scene.i2ParticleGridSize.x * Scene.i2ParticleGridSize.y);
+            SimulateRange(Scene.uiFirstParticle, Scene.uiNumParticles, Scene.uiFirstCell, NumSceneCells);
+        }
+    }
+    else
+    {
+        // Las escenas consecutivas ocupan rangos contiguos de partculas y de celdas
+        const SceneConstants& First = m_Scenes[FirstScene];
+        const SceneConstants& Last  = m_Scenes[EndScene - 1];
+
+        const Uint32 EndParticle = Last.uiFirstParticle + Last.uiNumParticles;
+        const Uint32 EndCell     = Last.uiFirstCell + static_cast<Uint32>(Last.i2ParticleGridSize.x * Last.i2ParticleGridSize.y);
+        SimulateRange(First.uiFirstParticle, EndParticle - First.uiFirstParticle, First.uiFirstCell, EndCell - First.uiFirstCell);
+    }
+}
+
+void Tutorial14_SceneBatch::RecordRender(IDeviceContext* pContext)
+{
+    // Los rangos de simulacin ya dejan el estado de las partculas como SRV
+    pContext->SetPipelineState(m_pRenderPSO);
+    pContext->CommitShaderResources(m_pRenderSRB, RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+    DrawAttribs drawAttrs;
+    drawAttrs.NumVertices  = 4;
+    drawAttrs.NumInstances = m_NumParticles;
+    pContext->Draw(drawAttrs);
+}
+
+void Tutorial14_SceneBatch::EndFrame()
+{
+    // Las barreras de los segmentos no actualizan los estados registrados
+    m_pParticleAttribsBuffer->SetState(RESOURCE_STATE_SHADER_RESOURCE);
+    m_pMovedParticleAttribsBuffer->SetState(RESOURCE_STATE_UNORDERED_ACCESS);
+    m_pParticleListHeadsBuffer->SetState(RESOURCE_STATE_UNORDERED_ACCESS);
+    m_pParticleListsBuffer->SetState(RESOURCE_STATE_UNORDERED_ACCESS);
+
+    m_LastNumDispatches = m_NumDispatches.load();
+}
+
+} // namespace Diligent
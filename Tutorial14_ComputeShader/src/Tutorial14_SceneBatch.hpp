@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+
+namespace Diligent
+{
+
+// Lote de sistemas de partculas independientes simulados con un dispatch por pase.
+// Cada escena tiene su rango de partculas, su rejilla, sus constantes y su campo de
+// velocidad, pero todas comparten los mismos bferes de partculas y de listas, un
+// bfer estructurado con las constantes de cada escena (g_Scenes) y un Texture2DArray
+// con una capa de velocidad por escena. Los shaders son los de la simulacin
+// principal compilados con MULTI_SCENE=1: cada hilo busca la escena de su partcula
+// en g_ParticleScene, as que el coste de CPU no crece con el nmero de escenas.
+//
+// La grabacin se divide en BeginFrame() en el contexto inmediato, que deja los
+// bferes en los estados de entrada, y rangos de escenas que pueden grabarse en
+// paralelo en contextos diferidos (Tutorial14_CommandRecorder) con barreras
+// explcitas, seguidos de EndFrame() tras ejecutar las listas.
+class Tutorial14_SceneBatch
+{
+public:
+    struct Settings
+    {
+        Uint32 NumScenes         = 64;
+        Uint32 ParticlesPerScene = 512; // Cada escena recibe entre la mitad y este nmero
+        Uint32 FluidGridSize     = 32;
+        float  FluidInfluence    = 0.2f;
+
+        // Un dispatch por escena y pase, como con un sistema por escena (para comparar)
+        bool DispatchPerScene = false;
+    };
+
+    Tutorial14_SceneBatch(IRenderDevice*  pDevice,
+                          IDeviceContext* pContext,
+                          IEngineFactory* pEngineFactory,
+                          Uint32          ThreadGroupSize,
+                          TEXTURE_FORMAT  RTVFormat,
+                          TEXTURE_FORMAT  DSVFormat,
+                          bool            ConvertPSOutputToGamma);
+
+    // Recrea todas las escenas. AspectRatio es el de la pantalla completa: cada
+    // escena ocupa una celda de una cuadrcula de NumScenes celdas.
+    void SetSettings(const Settings& NewSettings, float AspectRatio);
+
+    const Settings& GetSettings() const { return m_Settings; }
+
+    bool IsReady() const { return m_pResetListsSRB && m_pMoveSRB && m_pCollideSRB && m_pRenderSRB; }
+
+    // Contexto inmediato: sube las constantes de las escenas y hace las transiciones
+    // a los estados de entrada de RecordSimulation()
+    void BeginFrame(float DeltaTime);
+
+    // Graba los pases de la simulacin de un rango de escenas. Puede llamarse a la vez
+    // desde varios hilos con contextos distintos; los rangos deben ejecutarse en la
+    // GPU antes que RecordRender().
+    void RecordSimulation(IDeviceContext* pContext, Uint32 FirstScene, Uint32 NumScenes);
+
+    // Dibuja todas las escenas con una sola llamada instanciada en el render target
+    // que el llamador haya fijado en pContext
+    void RecordRender(IDeviceContext* pContext);
+
+    // Contexto inmediato, despus de ejecutar lo grabado: registra los estados finales
+    void EndFrame();
+
+    Uint32 GetNumParticles() const { return m_NumParticles; }
+    Uint32 GetNumCells() const { return m_NumCells; }
+    // Dispatches grabados por el ltimo Simulate()
+    Uint32 GetNumDispatches() const { return m_LastNumDispatches; }
+
+private:
+    void CreatePipelines(Uint32 ThreadGroupSize, TEXTURE_FORMAT RTVFormat, TEXTURE_FORMAT DSVFormat, bool ConvertPSOutputToGamma);
+    void CreateScenes(float AspectRatio);
+    void CreateFluidFields();
+    void CreateShaderResourceBindings();
+    void Dispatch(IDeviceContext* pContext, IPipelineState* pPSO, IShaderResourceBinding* pSRB, Uint32 NumThreads);
+
+    IRenderDevice*  m_pDevice        = nullptr;
+    IDeviceContext* m_pContext       = nullptr;
+    IEngineFactory* m_pEngineFactory = nullptr;
+
+    Settings m_Settings;
+    Uint32   m_ThreadGroupSize = 64;
+
+    // Copia en CPU de las constantes de cada escena (espejo de SceneConstants)
+    struct SceneConstants
+    {
+        Uint32 uiFirstParticle;
+        Uint32 uiNumParticles;
+        Uint32 uiFirstCell;
+        Uint32 uiFluidSlice;
+
+        float2 f2Scale;
+        int2   i2ParticleGridSize;
+
+        float  fDeltaTime;
+        float  fFluidInfluence;
+        float2 f2Padding0;
+
+        float4 f4Viewport;
+    };
+    std::vector<SceneConstants> m_Scenes;
+    // Velocidad de simulacin relativa de cada escena
+    std::vector<float> m_SceneSpeed;
+
+    Uint32 m_NumParticles      = 0;
+    Uint32 m_NumCells          = 0;
+    Uint32 m_LastNumDispatches = 0;
+    float  m_LastDeltaTime     = -1;
+
+    // Se incrementa desde los hilos que graban la simulacin
+    std::atomic<Uint32> m_NumDispatches{0};
+
+    RefCntAutoPtr<IBuffer>  m_pBatchConstants;
+    RefCntAutoPtr<IBuffer>  m_pScenesBuffer;
+    RefCntAutoPtr<IBuffer>  m_pParticleSceneBuffer;
+    RefCntAutoPtr<IBuffer>  m_pParticleAttribsBuffer;
+    RefCntAutoPtr<IBuffer>  m_pMovedParticleAttribsBuffer;
+    RefCntAutoPtr<IBuffer>  m_pParticleListHeadsBuffer;
+    RefCntAutoPtr<IBuffer>  m_pParticleListsBuffer;
+    RefCntAutoPtr<ITexture> m_pFluidVelocity;
+
+    RefCntAutoPtr<IPipelineState>         m_pResetListsPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pResetListsSRB;
+    RefCntAutoPtr<IPipelineState>         m_pMovePSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pMoveSRB;
+    RefCntAutoPtr<IPipelineState>         m_pCollidePSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pCollideSRB;
+    RefCntAutoPtr<IPipelineState>         m_pUpdateSpeedPSO;
+    RefCntAutoPtr<IPipelineState>         m_pRenderPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pRenderSRB;
+};
+
+} // namespace Diligent
@@ -0,0 +1,266 @@
+#include <algorithm>
+#include "Tutorial14_SimulationStats.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de StatsConstants en simulation_stats.fxh
+struct StatsConstants
+{
+    Uint32 uiNumParticles   = 0;
+    Uint32 uiNumPartialSums = 0;
+    Uint32 uiNumCells       = 0;
+    Uint32 uiPadding0       = 0;
+
+    uint2 u2FluidGridSize;
+    uint2 u2Padding1;
+};
+
+// Espejo del bfer de estadsticas (ndices STATS_* en simulation_stats.fxh)
+struct GPUStats
+{
+    float  KineticEnergy;
+    float  MeanTemperature;
+    float  MaxParticleSpeed;
+    float  MaxFluidSpeed;
+    Uint32 MaxCellOccupancy;
+    Uint32 NumOccupiedCells;
+    Uint32 NumParticles;
+    Uint32 Padding0;
+    Uint32 CollisionHistogram[Tutorial14_SimulationStats::COLLISION_HISTOGRAM_BINS];
+};
+static_assert(sizeof(GPUStats) == sizeof(Uint32) * (8 + Tutorial14_SimulationStats::COLLISION_HISTOGRAM_BINS),
+              "GPUStats must match the layout in simulation_stats.fxh");
+
+// Pases definidos en simulation_stats.fxh
+enum STATS_PASS : int
+{
+    STATS_PASS_PARTICLES = 0,
+    STATS_PASS_CELLS     = 1,
+    STATS_PASS_FLUID     = 2,
+    STATS_PASS_FINALIZE  = 3
+};
+
+} // namespace
+
+Tutorial14_SimulationStats::Tutorial14_SimulationStats(IRenderDevice*             pDevice,
+                                                       IDeviceContext*            pContext,
+                                                       IEngineFactory*            pEngineFactory,
+                                                       Tutorial14_FrameAllocator* pFrameAllocator) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pEngineFactory(pEngineFactory),
+    m_pFrameAllocator(pFrameAllocator)
+{
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Simulation stats buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS | BIND_SHADER_RESOURCE;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = sizeof(GPUStats);
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pStatsBuffer);
+
+    m_pReadback = std::make_unique<Tutorial14_AsyncReadback>(m_pDevice, m_pContext, sizeof(GPUStats), NUM_READBACK_SLOTS, "Simulation stats readback");
+
+    CreatePipelines();
+}
+
+void Tutorial14_SimulationStats::CreatePipelines()
+{
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.EntryPoint                      = "main";
+    ShaderCI.FilePath                        = "simulation_stats.csh";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+    // Las constantes son una ventana del asignador de frame
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_COMPUTE, "g_Stats",                SHADER_RESOURCE_VARIABLE_TYPE_STATIC},
+        // La textura de velocidad alterna entre dos texturas cada frame
+        {SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    auto CreatePSO = [&](STATS_PASS Pass, const char* Name, RefCntAutoPtr<IPipelineState>& pPSO) {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("STATS_GROUP_SIZE", static_cast<int>(STATS_GROUP_SIZE));
+        Macros.AddShaderMacro("STATS_PASS", static_cast<int>(Pass));
+        ShaderCI.Macros    = Macros;
+        ShaderCI.Desc.Name = Name;
+
+        RefCntAutoPtr<IShader> pCS;
+        m_pDevice->CreateShader(ShaderCI, &pCS);
+        if (!pCS)
+        {
+            LOG_ERROR_MESSAGE("Failed to create shader ", Name);
+            return;
+        }
+
+        PSODesc.Name      = Name;
+        PSOCreateInfo.pCS = pCS;
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+        if (!pPSO)
+        {
+            LOG_ERROR_MESSAGE("Failed to create PSO ", Name);
+            return;
+        }
+
+        pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "g_Stats")->Set(m_pStatsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+    };
+
+    CreatePSO(STATS_PASS_PARTICLES, "Reduce particle stats CS", m_pReduceParticlesPSO);
+    CreatePSO(STATS_PASS_CELLS, "Reduce cell stats CS", m_pReduceCellsPSO);
+    CreatePSO(STATS_PASS_FLUID, "Reduce fluid stats CS", m_pReduceFluidPSO);
+    CreatePSO(STATS_PASS_FINALIZE, "Finalize stats CS", m_pFinalizePSO);
+
+    if (m_pReduceFluidPSO)
+    {
+        m_pReduceFluidPSO->CreateShaderResourceBinding(&m_pReduceFluidSRB, true);
+        m_pFrameAllocator->BindConstants(m_pReduceFluidSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "StatsConstantsBuffer"), sizeof(StatsConstants));
+    }
+}
+
+void Tutorial14_SimulationStats::SetParticleBuffers(IBuffer* pParticleAttribs,
+                                                    IBuffer* pParticleListHeads,
+                                                    IBuffer* pParticleLists,
+                                                    Uint32   NumParticles)
+{
+    T14_TRACE_SCOPE("SimulationStats::SetParticleBuffers");
+
+    if (!m_pReduceParticlesPSO || !m_pReduceCellsPSO || !m_pFinalizePSO)
+        return;
+
+    // Una suma parcial por grupo del pase de partculas
+    const Uint32 NumPartialSums = std::max((NumParticles + STATS_GROUP_SIZE - 1) / STATS_GROUP_SIZE, 1u);
+
+    m_pPartialSumsBuffer.Release();
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Stats partial sums buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_UNORDERED_ACCESS | BIND_SHADER_RESOURCE;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(float2);
+    BuffDesc.Size              = sizeof(float2) * NumPartialSums;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pPartialSumsBuffer);
+    IBufferView* pPartialSumsUAV = m_pPartialSumsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+
+    m_pReduceParticlesSRB.Release();
+    m_pReduceParticlesPSO->CreateShaderResourceBinding(&m_pReduceParticlesSRB, true);
+    m_pReduceParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(pParticleAttribs->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pReduceParticlesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_PartialSums")->Set(pPartialSumsUAV);
+
+    m_pReduceCellsSRB.Release();
+    m_pReduceCellsPSO->CreateShaderResourceBinding(&m_pReduceCellsSRB, true);
+    m_pReduceCellsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleListHead")->Set(pParticleListHeads->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pReduceCellsSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_ParticleLists")->Set(pParticleLists->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+
+    m_pFinalizeSRB.Release();
+    m_pFinalizePSO->CreateShaderResourceBinding(&m_pFinalizeSRB, true);
+    m_pFinalizeSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_PartialSums")->Set(pPartialSumsUAV);
+
+    for (IShaderResourceBinding* pSRB : {m_pReduceParticlesSRB.RawPtr(), m_pReduceCellsSRB.RawPtr(), m_pFinalizeSRB.RawPtr()})
+        m_pFrameAllocator->BindConstants(pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "StatsConstantsBuffer"), sizeof(StatsConstants));
+}
+
+void Tutorial14_SimulationStats::Compute(Uint32        NumParticles,
+                                         Uint32        NumCells,
+                                         ITextureView* pFluidVelocitySRV,
+                                         Uint32        FluidGridSize,
+                                         Uint64        FrameId)
+{
+    if (!m_pReduceParticlesSRB || !m_pReduceCellsSRB || !m_pFinalizeSRB)
+        return;
+
+    const Uint32 NumPartialSums = (NumParticles + STATS_GROUP_SIZE - 1) / STATS_GROUP_SIZE;
+    {
+        StatsConstants Constants;
+        Constants.uiNumParticles   = NumParticles;
+        Constants.uiNumPartialSums = NumPartialSums;
+        Constants.uiNumCells       = NumCells;
+        Constants.u2FluidGridSize  = uint2{FluidGridSize, FluidGridSize};
+        Constants.u2Padding1       = uint2{0, 0};
+
+        const Uint32 Offset = m_pFrameAllocator->Allocate(Constants);
+        for (IShaderResourceBinding* pSRB : {m_pReduceParticlesSRB.RawPtr(), m_pReduceCellsSRB.RawPtr(), m_pReduceFluidSRB.RawPtr(), m_pFinalizeSRB.RawPtr()})
+        {
+            auto* pVar = pSRB != nullptr ? pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "StatsConstantsBuffer") : nullptr;
+            if (pVar != nullptr)
+                pVar->SetBufferOffset(Offset);
+        }
+    }
+
+    // Los mximos y contadores se acumulan con operaciones atmicas
+    static const GPUStats ZeroStats = {};
+    m_pContext->UpdateBuffer(m_pStatsBuffer, 0, sizeof(ZeroStats), &ZeroStats, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    m_pContext->SetPipelineState(m_pReduceParticlesPSO);
+    m_pContext->CommitShaderResources(m_pReduceParticlesSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{NumPartialSums});
+
+    m_pContext->SetPipelineState(m_pReduceCellsPSO);
+    m_pContext->CommitShaderResources(m_pReduceCellsSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{(NumCells + STATS_GROUP_SIZE - 1) / STATS_GROUP_SIZE});
+
+    if (pFluidVelocitySRV != nullptr && m_pReduceFluidSRB)
+    {
+        m_pReduceFluidSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_FluidVelocityTexture")->Set(pFluidVelocitySRV);
+        m_pContext->SetPipelineState(m_pReduceFluidPSO);
+        m_pContext->CommitShaderResources(m_pReduceFluidSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pContext->DispatchCompute(DispatchComputeAttribs{(FluidGridSize + 15) / 16, (FluidGridSize + 15) / 16});
+    }
+
+    m_pContext->SetPipelineState(m_pFinalizePSO);
+    m_pContext->CommitShaderResources(m_pFinalizeSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{1});
+
+    m_pReadback->SetFrameId(FrameId);
+    m_pReadback->Enqueue(m_pStatsBuffer);
+}
+
+bool Tutorial14_SimulationStats::PollResults()
+{
+    GPUStats Stats;
+    Uint64   FrameId = 0;
+    if (!m_pReadback->Poll(Stats, &FrameId))
+        return false;
+
+    m_Results.FrameId           = FrameId;
+    m_Results.NumParticles      = Stats.NumParticles;
+    m_Results.KineticEnergy     = Stats.KineticEnergy;
+    m_Results.MaxParticleSpeed  = Stats.MaxParticleSpeed;
+    m_Results.MeanTemperature   = Stats.MeanTemperature;
+    m_Results.MaxFluidSpeed     = Stats.MaxFluidSpeed;
+    m_Results.MaxCellOccupancy  = Stats.MaxCellOccupancy;
+    m_Results.NumOccupiedCells  = Stats.NumOccupiedCells;
+    m_Results.MeanCellOccupancy = Stats.NumOccupiedCells > 0 ?
+        static_cast<float>(Stats.NumParticles) / static_cast<float>(Stats.NumOccupiedCells) :
+        0.f;
+    std::copy(std::begin(Stats.CollisionHistogram), std::end(Stats.CollisionHistogram), m_Results.CollisionHistogram.begin());
+
+    m_bHasResults = true;
+    return true;
+}
+
+} // namespace Diligent
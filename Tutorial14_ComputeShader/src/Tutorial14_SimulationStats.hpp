@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Tutorial14_AsyncReadback.hpp"
+
+namespace Diligent
+{
+
+class Tutorial14_FrameAllocator;
+
+// Estadsticas de la simulacin calculadas en la GPU con reducciones paralelas
+// sobre el bfer de partculas, las listas de la rejilla y la textura de velocidad
+// del fluido. Solo se copian a la CPU unos pocos bytes, varios frames ms tarde.
+class Tutorial14_SimulationStats
+{
+public:
+    // Debe coincidir con COLLISION_HISTOGRAM_BINS en simulation_stats.fxh
+    static constexpr Uint32 COLLISION_HISTOGRAM_BINS = 8;
+
+    // Tamao de grupo de los pases de reduccin
+    static constexpr Uint32 STATS_GROUP_SIZE = 256;
+
+    // Copias en vuelo antes de que se empiecen a omitir lecturas
+    static constexpr Uint32 NUM_READBACK_SLOTS = 4;
+
+    struct Results
+    {
+        Uint64 FrameId      = 0;
+        Uint32 NumParticles = 0;
+
+        float KineticEnergy    = 0;
+        float MaxParticleSpeed = 0;
+        float MeanTemperature  = 0;
+        float MaxFluidSpeed    = 0;
+
+        Uint32 MaxCellOccupancy  = 0;
+        Uint32 NumOccupiedCells  = 0;
+        float  MeanCellOccupancy = 0; // Media sobre las celdas ocupadas
+
+        // CollisionHistogram[i]: partculas con i colisiones; la ltima entrada
+        // acumula las de COLLISION_HISTOGRAM_BINS - 1 colisiones o ms
+        std::array<Uint32, COLLISION_HISTOGRAM_BINS> CollisionHistogram = {};
+    };
+
+    Tutorial14_SimulationStats(IRenderDevice*             pDevice,
+                               IDeviceContext*            pContext,
+                               IEngineFactory*            pEngineFactory,
+                               Tutorial14_FrameAllocator* pFrameAllocator);
+
+    // Debe llamarse cada vez que se recrean los bfers de partculas
+    void SetParticleBuffers(IBuffer* pParticleAttribs,
+                            IBuffer* pParticleListHeads,
+                            IBuffer* pParticleLists,
+                            Uint32   NumParticles);
+
+    // Graba los pases de reduccin y la copia asncrona de los resultados.
+    // pFluidVelocitySRV puede ser nulo si no hay simulacin de fluidos.
+    void Compute(Uint32        NumParticles,
+                 Uint32        NumCells,
+                 ITextureView* pFluidVelocitySRV,
+                 Uint32        FluidGridSize,
+                 Uint64        FrameId);
+
+    // Recoge la lectura completada ms reciente. Devuelve true si hay resultados nuevos.
+    bool PollResults();
+
+    bool           HasResults() const { return m_bHasResults; }
+    const Results& GetResults() const { return m_Results; }
+
+    // Bfer con las estadsticas del ltimo Compute() en la GPU
+    IBuffer* GetStatsBuffer() const { return m_pStatsBuffer; }
+
+private:
+    void CreatePipelines();
+
+    IRenderDevice*             m_pDevice         = nullptr;
+    IDeviceContext*            m_pContext        = nullptr;
+    IEngineFactory*            m_pEngineFactory  = nullptr;
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
+
+    RefCntAutoPtr<IBuffer> m_pStatsBuffer;
+    RefCntAutoPtr<IBuffer> m_pPartialSumsBuffer;
+
+    RefCntAutoPtr<IPipelineState>         m_pReduceParticlesPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pReduceParticlesSRB;
+    RefCntAutoPtr<IPipelineState>         m_pReduceCellsPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pReduceCellsSRB;
+    RefCntAutoPtr<IPipelineState>         m_pReduceFluidPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pReduceFluidSRB;
+    RefCntAutoPtr<IPipelineState>         m_pFinalizePSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pFinalizeSRB;
+
+    std::unique_ptr<Tutorial14_AsyncReadback> m_pReadback;
+
+    Results m_Results;
+    bool    m_bHasResults = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <cstring>
+#include "Tutorial14_Snapshot.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "GraphicsAccessories.hpp"
+#include "RefCntAutoPtr.hpp"
+
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <Windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace Diligent
+{
+
+namespace
+{
+
+Uint64 AlignChunkSize(Uint64 Size)
+{
+    return (Size + Tutorial14_Snapshot::CHUNK_ALIGNMENT - 1) & ~Uint64{Tutorial14_Snapshot::CHUNK_ALIGNMENT - 1};
+}
+
+} // namespace
+
+Tutorial14_Snapshot::Writer::Writer(IRenderDevice* pDevice, IDeviceContext* pContext) :
+    m_pDevice(pDevice),
+    m_pContext(pContext)
+{
+}
+
+Tutorial14_Snapshot::Writer::~Writer()
+{
+    if (m_File.is_open())
+        Close();
+}
+
+bool Tutorial14_Snapshot::Writer::Open(const std::string& Path)
+{
+    m_File.open(Path, std::ios::binary | std::ios::trunc);
+    if (!m_File)
+    {
+        LOG_ERROR_MESSAGE("Failed to open snapshot file ", Path, " for writing");
+        return false;
+    }
+
+    // La cabecera se reescribe en Close() con el nmero de bloques
+    m_Header = Header{};
+    m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+    return true;
+}
+
+void Tutorial14_Snapshot::Writer::BeginChunk(Uint32 Id, Uint64 Size)
+{
+    ChunkHeader Chunk;
+    Chunk.Id   = Id;
+    Chunk.Size = Size;
+    m_File.write(reinterpret_cast<const char*>(&Chunk), sizeof(Chunk));
+    ++m_Header.NumChunks;
+}
+
+void Tutorial14_Snapshot::Writer::EndChunk(Uint64 Size)
+{
+    static constexpr char Padding[CHUNK_ALIGNMENT] = {};
+    m_File.write(Padding, static_cast<std::streamsize>(AlignChunkSize(Size) - Size));
+}
+
+void Tutorial14_Snapshot::Writer::AddChunk(Uint32 Id, const void* pData, Uint64 Size)
+{
+    BeginChunk(Id, Size);
+    m_File.write(static_cast<const char*>(pData), static_cast<std::streamsize>(Size));
+    EndChunk(Size);
+}
+
+bool Tutorial14_Snapshot::Writer::AddBufferChunk(Uint32 Id, IBuffer* pBuffer)
+{
+    T14_TRACE_SCOPE("Snapshot::AddBufferChunk");
+
+    const Uint64 Size = pBuffer->GetDesc().Size;
+
+    BufferDesc StagingDesc;
+    StagingDesc.Name           = "Snapshot staging buffer";
+    StagingDesc.Usage          = USAGE_STAGING;
+    StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+    StagingDesc.Size           = Size;
+
+    RefCntAutoPtr<IBuffer> pStaging;
+    m_pDevice->CreateBuffer(StagingDesc, nullptr, &pStaging);
+    if (!pStaging)
+    {
+        LOG_ERROR_MESSAGE("Failed to create snapshot staging buffer");
+        return false;
+    }
+
+    m_pContext->CopyBuffer(pBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                           pStaging, 0, Size, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->WaitForIdle();
+
+    void* pData = nullptr;
+    m_pContext->MapBuffer(pStaging, MAP_READ, MAP_FLAG_DO_NOT_WAIT, pData);
+    if (pData == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Failed to map snapshot staging buffer");
+        return false;
+    }
+    // Se escribe directamente desde la memoria del bfer de lectura
+    AddChunk(Id, pData, Size);
+    m_pContext->UnmapBuffer(pStaging, MAP_READ);
+    return true;
+}
+
+bool Tutorial14_Snapshot::Writer::AddTextureChunk(Uint32 Id, ITexture* pTexture)
+{
+    T14_TRACE_SCOPE("Snapshot::AddTextureChunk");
+
+    const auto& SrcDesc = pTexture->GetDesc();
+
+    TextureDesc StagingDesc;
+    StagingDesc.Name           = "Snapshot staging texture";
+    StagingDesc.Type           = RESOURCE_DIM_TEX_2D;
+    StagingDesc.Width          = SrcDesc.Width;
+    StagingDesc.Height         = SrcDesc.Height;
+    StagingDesc.Format         = SrcDesc.Format;
+    StagingDesc.Usage          = USAGE_STAGING;
+    StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+
+    RefCntAutoPtr<ITexture> pStaging;
+    m_pDevice->CreateTexture(StagingDesc, nullptr, &pStaging);
+    if (!pStaging)
+    {
+        LOG_ERROR_MESSAGE("Failed to create snapshot staging texture");
+        return false;
+    }
+
+    m_pContext->CopyTexture(CopyTextureAttribs{pTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                               pStaging, RESOURCE_STATE_TRANSITION_MODE_TRANSITION});
+    m_pContext->WaitForIdle();
+
+    MappedTextureSubresource MappedData;
+    m_pContext->MapTextureSubresource(pStaging, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+    if (MappedData.pData == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Failed to map snapshot staging texture");
+        return false;
+    }
+
+    // Las filas del bfer de lectura pueden llevar relleno; en el fichero van seguidas
+    const Uint64 RowSize = Uint64{GetTextureFormatAttribs(SrcDesc.Format).GetElementSize()} * SrcDesc.Width;
+    const Uint64 Size    = RowSize * SrcDesc.Height;
+    BeginChunk(Id, Size);
+    for (Uint32 Row = 0; Row < SrcDesc.Height; ++Row)
+    {
+        const char* pRow = static_cast<const char*>(MappedData.pData) + MappedData.Stride * Row;
+        m_File.write(pRow, static_cast<std::streamsize>(RowSize));
+    }
+    EndChunk(Size);
+
+    m_pContext->UnmapTextureSubresource(pStaging, 0, 0);
+    return true;
+}
+
+bool Tutorial14_Snapshot::Writer::Close()
+{
+    m_File.seekp(0);
+    m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+    const bool bSucceeded = m_File.good();
+    m_File.close();
+    return bSucceeded;
+}
+
+Tutorial14_Snapshot::Reader::~Reader()
+{
+    Close();
+}
+
+bool Tutorial14_Snapshot::Reader::Open(const std::string& Path)
+{
+    T14_TRACE_SCOPE("Snapshot::Open");
+
+    Close();
+
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+    HANDLE hFile = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        LOG_ERROR_MESSAGE("Failed to open snapshot file ", Path);
+        return false;
+    }
+
+    LARGE_INTEGER FileSize = {};
+    GetFileSizeEx(hFile, &FileSize);
+    m_FileSize = static_cast<Uint64>(FileSize.QuadPart);
+
+    // La vista mantiene la proyeccin abierta, as que los handles se pueden cerrar ya
+    HANDLE hMapping = m_FileSize > 0 ? CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    if (hMapping != nullptr)
+    {
+        m_pMapping = static_cast<const Uint8*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(hMapping);
+    }
+    CloseHandle(hFile);
+#else
+    int File = open(Path.c_str(), O_RDONLY);
+    if (File < 0)
+    {
+        LOG_ERROR_MESSAGE("Failed to open snapshot file ", Path);
+        return false;
+    }
+
+    struct stat FileStat = {};
+    fstat(File, &FileStat);
+    m_FileSize = static_cast<Uint64>(FileStat.st_size);
+
+    // La proyeccin sigue siendo vlida despus de cerrar el descriptor
+    if (m_FileSize > 0)
+    {
+        void* pMapping = mmap(nullptr, static_cast<size_t>(m_FileSize), PROT_READ, MAP_PRIVATE, File, 0);
+        if (pMapping != MAP_FAILED)
+            m_pMapping = static_cast<const Uint8*>(pMapping);
+    }
+    close(File);
+#endif
+
+    if (m_pMapping == nullptr)
+    {
+        LOG_ERROR_MESSAGE("Failed to map snapshot file ", Path);
+        Close();
+        return false;
+    }
+
+    Header FileHeader;
+    if (m_FileSize < sizeof(FileHeader))
+    {
+        LOG_ERROR_MESSAGE("Snapshot file ", Path, " is truncated");
+        Close();
+        return false;
+    }
+    memcpy(&FileHeader, m_pMapping, sizeof(FileHeader));
+    if (FileHeader.Magic != MAGIC)
+    {
+        LOG_ERROR_MESSAGE(Path, " is not a snapshot file");
+        Close();
+        return false;
+    }
+    if (FileHeader.Version == 0 || FileHeader.Version > VERSION)
+    {
+        LOG_ERROR_MESSAGE("Snapshot file ", Path, " has unsupported version ", FileHeader.Version);
+        Close();
+        return false;
+    }
+    m_Version = FileHeader.Version;
+
+    Uint64 Offset = sizeof(FileHeader);
+    for (Uint32 i = 0; i < FileHeader.NumChunks; ++i)
+    {
+        ChunkHeader Chunk;
+        if (m_FileSize - Offset < sizeof(Chunk))
+        {
+            LOG_ERROR_MESSAGE("Snapshot file ", Path, " is truncated");
+            Close();
+            return false;
+        }
+        memcpy(&Chunk, m_pMapping + Offset, sizeof(Chunk));
+        Offset += sizeof(Chunk);
+
+        if (m_FileSize - Offset < Chunk.Size)
+        {
+            LOG_ERROR_MESSAGE("Snapshot file ", Path, " is truncated");
+            Close();
+            return false;
+        }
+
+        ChunkEntry Entry;
+        Entry.Id     = Chunk.Id;
+        Entry.Offset = Offset;
+        Entry.Size   = Chunk.Size;
+        m_Chunks.push_back(Entry);
+
+        // El ltimo bloque puede no llevar el relleno completo
+        Offset = std::min(Offset + AlignChunkSize(Chunk.Size), m_FileSize);
+    }
+
+    return true;
+}
+
+void Tutorial14_Snapshot::Reader::Close()
+{
+    if (m_pMapping != nullptr)
+    {
+#if PLATFORM_WIN32 || PLATFORM_UNIVERSAL_WINDOWS
+        UnmapViewOfFile(m_pMapping);
+#else
+        munmap(const_cast<Uint8*>(m_pMapping), static_cast<size_t>(m_FileSize));
+#endif
+    }
+    m_pMapping = nullptr;
+    m_FileSize = 0;
+    m_Version  = 0;
+    m_Chunks.clear();
+}
+
+const void* Tutorial14_Snapshot::Reader::FindChunk(Uint32 Id, Uint64& Size) const
+{
+    for (const auto& Chunk : m_Chunks)
+    {
+        if (Chunk.Id == Id)
+        {
+            Size = Chunk.Size;
+            return m_pMapping + Chunk.Offset;
+        }
+    }
+    Size = 0;
+    return nullptr;
+}
+
+} // namespace Diligent
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+
+namespace Diligent
+{
+
+// Instantneas del estado completo de la simulacin en un formato binario por bloques.
+//
+//   Header
+//   ChunkHeader + datos     (NumChunks veces)
+//
+// Los datos de cada bloque empiezan alineados a CHUNK_ALIGNMENT bytes. Al cargar, el
+// fichero se proyecta en memoria y los punteros a los bloques se pasan directamente a
+// CreateBuffer/UpdateTexture, sin copias intermedias. Los lectores ignoran los bloques
+// que no conocen, as que aadir un bloque no requiere cambiar de versin.
+constexpr Uint32 MakeSnapshotChunkId(char a, char b, char c, char d)
+{
+    return static_cast<Uint32>(static_cast<Uint8>(a)) |
+        (static_cast<Uint32>(static_cast<Uint8>(b)) << 8u) |
+        (static_cast<Uint32>(static_cast<Uint8>(c)) << 16u) |
+        (static_cast<Uint32>(static_cast<Uint8>(d)) << 24u);
+}
+
+class Tutorial14_Snapshot
+{
+public:
+    static constexpr Uint32 MAGIC           = MakeSnapshotChunkId('T', '1', '4', 'S');
+    static constexpr Uint32 VERSION         = 1;
+    static constexpr Uint32 CHUNK_ALIGNMENT = 16;
+
+    // Bloques de la versin 1
+    static constexpr Uint32 CHUNK_SIMULATION_STATE = MakeSnapshotChunkId('S', 'T', 'A', 'T'); // SimulationState
+    static constexpr Uint32 CHUNK_PARTICLES        = MakeSnapshotChunkId('P', 'A', 'R', 'T'); // ParticleAttribs[NumParticles]
+    static constexpr Uint32 CHUNK_PARTICLE_HEADS   = MakeSnapshotChunkId('H', 'E', 'A', 'D'); // int[NumParticles]
+    static constexpr Uint32 CHUNK_PARTICLE_LISTS   = MakeSnapshotChunkId('L', 'I', 'S', 'T'); // int[NumParticles]
+    static constexpr Uint32 CHUNK_FLUID_VELOCITY1  = MakeSnapshotChunkId('V', 'E', 'L', '1'); // float2[FluidGridSize^2], por filas
+    static constexpr Uint32 CHUNK_FLUID_VELOCITY2  = MakeSnapshotChunkId('V', 'E', 'L', '2'); // float2[FluidGridSize^2], por filas
+
+    struct Header
+    {
+        Uint32 Magic     = MAGIC;
+        Uint32 Version   = VERSION;
+        Uint32 NumChunks = 0;
+        Uint32 Reserved  = 0;
+    };
+    static_assert(sizeof(Header) % CHUNK_ALIGNMENT == 0, "Chunk data must stay aligned");
+
+    struct ChunkHeader
+    {
+        Uint32 Id       = 0;
+        Uint32 Reserved = 0;
+        Uint64 Size     = 0; // Tamao de los datos sin el relleno de alineacin
+    };
+    static_assert(sizeof(ChunkHeader) % CHUNK_ALIGNMENT == 0, "Chunk data must stay aligned");
+
+    // Contenido de CHUNK_SIMULATION_STATE
+    struct SimulationState
+    {
+        Uint32 NumParticles      = 0;
+        Uint32 ParticleStride    = 0; // sizeof(ParticleAttribs) al guardar
+        Uint32 FluidGridSize     = 0; // 0 si no haba simulacin de fluidos
+        Int32  FluidTextureIndex = 0;
+
+        float  FluidTimer      = 0;
+        float  AccumulatedTime = 0;
+        float2 FluidLastForcePos;
+    };
+    static_assert(sizeof(SimulationState) == 32, "SimulationState is part of the file format");
+
+    // Escribe una instantnea. Los recursos de la GPU se copian a bferes de lectura y
+    // se espera a la GPU, as que solo debe usarse fuera del bucle de medicin.
+    class Writer
+    {
+    public:
+        Writer(IRenderDevice* pDevice, IDeviceContext* pContext);
+        ~Writer();
+
+        bool Open(const std::string& Path);
+
+        void AddChunk(Uint32 Id, const void* pData, Uint64 Size);
+        bool AddBufferChunk(Uint32 Id, IBuffer* pBuffer);
+        // Solo el nivel 0 de una textura 2D; las filas se guardan sin relleno
+        bool AddTextureChunk(Uint32 Id, ITexture* pTexture);
+
+        // Completa la cabecera y cierra el fichero. Devuelve false si hubo algn error de escritura.
+        bool Close();
+
+    private:
+        void BeginChunk(Uint32 Id, Uint64 Size);
+        void EndChunk(Uint64 Size);
+
+        IRenderDevice*  m_pDevice  = nullptr;
+        IDeviceContext* m_pContext = nullptr;
+
+        std::ofstream m_File;
+        Header        m_Header;
+    };
+
+    // Lee una instantnea proyectando el fichero en memoria. Los punteros que devuelve
+    // FindChunk() son vlidos mientras el lector exista.
+    class Reader
+    {
+    public:
+        Reader() = default;
+        ~Reader();
+
+        // clang-format off
+        Reader(const Reader&)            = delete;
+        Reader& operator=(const Reader&) = delete;
+        // clang-format on
+
+        bool Open(const std::string& Path);
+        void Close();
+
+        const void* FindChunk(Uint32 Id, Uint64& Size) const;
+
+        template <typename DataType>
+        const DataType* FindChunk(Uint32 Id) const
+        {
+            Uint64      Size  = 0;
+            const void* pData = FindChunk(Id, Size);
+            return Size >= sizeof(DataType) ? static_cast<const DataType*>(pData) : nullptr;
+        }
+
+        Uint32 GetVersion() const { return m_Version; }
+
+    private:
+        struct ChunkEntry
+        {
+            Uint32 Id     = 0;
+            Uint64 Offset = 0;
+            Uint64 Size   = 0;
+        };
+
+        const Uint8*            m_pMapping = nullptr;
+        Uint64                  m_FileSize = 0;
+        Uint32                  m_Version  = 0;
+        std::vector<ChunkEntry> m_Chunks;
+    };
+};
+
+} // namespace Diligent
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include "Tutorial14_ThreadPool.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+
+namespace Diligent
+{
+
+Tutorial14_ThreadPool::Tutorial14_ThreadPool(Uint32 NumThreads, const char* Name) :
+    m_Name(Name)
+{
+    m_Threads.reserve(NumThreads);
+    for (Uint32 i = 0; i < std::max(NumThreads, 1u); ++i)
+        m_Threads.emplace_back(&Tutorial14_ThreadPool::WorkerThread, this);
+}
+
+Tutorial14_ThreadPool::~Tutorial14_ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_bStop = true;
+    }
+    m_JobCV.notify_all();
+    for (auto& Thread : m_Threads)
+        Thread.join();
+}
+
+Uint32 Tutorial14_ThreadPool::GetDefaultNumThreads()
+{
+    const Uint32 NumCores = std::thread::hardware_concurrency();
+    return NumCores > 1 ? NumCores - 1 : 1;
+}
+
+void Tutorial14_ThreadPool::Enqueue(std::function<void()> Job)
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Jobs.emplace_back(std::move(Job));
+    }
+    m_JobCV.notify_one();
+}
+
+void Tutorial14_ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    m_IdleCV.wait(Lock, [this] { return m_Jobs.empty() && m_NumRunningJobs == 0; });
+}
+
+size_t Tutorial14_ThreadPool::GetNumPendingJobs() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_Jobs.size() + m_NumRunningJobs;
+}
+
+void Tutorial14_ThreadPool::WorkerThread()
+{
+    Tutorial14_CPUTrace::SetThreadName(m_Name.c_str());
+
+    for (;;)
+    {
+        std::function<void()> Job;
+        {
+            std::unique_lock<std::mutex> Lock{m_Mtx};
+            m_JobCV.wait(Lock, [this] { return m_bStop || !m_Jobs.empty(); });
+            // Al destruir el grupo se terminan antes los trabajos pendientes
+            if (m_Jobs.empty())
+                break;
+            Job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+            ++m_NumRunningJobs;
+        }
+
+        Job();
+
+        {
+            std::lock_guard<std::mutex> Lock{m_Mtx};
+            --m_NumRunningJobs;
+        }
+        m_IdleCV.notify_all();
+    }
+}
+
+} // namespace Diligent
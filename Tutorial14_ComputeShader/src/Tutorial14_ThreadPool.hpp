@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// Grupo de hilos con una nica cola FIFO. Los trabajos empiezan en el mismo orden
+// en que se encolan, aunque pueden terminar en cualquier orden.
+class Tutorial14_ThreadPool
+{
+public:
+    // Name es el nombre de los hilos en la traza de CPU
+    Tutorial14_ThreadPool(Uint32 NumThreads, const char* Name);
+    ~Tutorial14_ThreadPool();
+
+    // clang-format off
+    Tutorial14_ThreadPool(const Tutorial14_ThreadPool&)            = delete;
+    Tutorial14_ThreadPool& operator=(const Tutorial14_ThreadPool&) = delete;
+    // clang-format on
+
+    void Enqueue(std::function<void()> Job);
+
+    // Espera a que la cola se vace y terminen todos los trabajos en curso
+    void WaitIdle();
+
+    // Trabajos encolados o en ejecucin
+    size_t GetNumPendingJobs() const;
+
+    Uint32 GetNumThreads() const { return static_cast<Uint32>(m_Threads.size()); }
+
+    // Nmero de hilos por defecto: todos los ncleos menos el del hilo principal
+    static Uint32 GetDefaultNumThreads();
+
+private:
+    void WorkerThread();
+
+    std::string              m_Name;
+    std::vector<std::thread> m_Threads;
+
+    mutable std::mutex                m_Mtx;
+    std::condition_variable           m_JobCV;
+    std::condition_variable           m_IdleCV;
+    std::deque<std::function<void()>> m_Jobs;
+    size_t                            m_NumRunningJobs = 0;
+    bool                              m_bStop          = false;
+};
+
+} // namespace Diligent
@@ -0,0 +1,326 @@
+#include <algorithm>
+#include <vector>
+#include "Tutorial14_TiledPaint.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de PaintTileConstants en paint.fxh
+struct PaintTileConstants
+{
+    Uint32 uiNumParticles = 0;
+    Uint32 uiMaxEntries   = 0;
+    uint2  u2NumTiles     = uint2{0, 0};
+
+    float2 f2CanvasSize = float2{0, 0};
+    float2 f2Padding0   = float2{0, 0};
+};
+
+// Pases definidos en paint.fxh
+enum PAINT_PASS : int
+{
+    PAINT_PASS_BIN     = 0,
+    PAINT_PASS_SCAN    = 1,
+    PAINT_PASS_SCATTER = 2,
+    PAINT_PASS_TILES   = 3
+};
+
+// Capacidad inicial de las listas de los tiles; se ampla segn la lectura del total
+constexpr Uint32 INITIAL_MAX_ENTRIES = 1u << 18;
+
+} // namespace
+
+static_assert(sizeof(Tutorial14_TiledPaint::PaintSplat) == 48, "PaintSplat must match paint.fxh");
+
+Tutorial14_TiledPaint::Tutorial14_TiledPaint(IRenderDevice*             pDevice,
+                                             IDeviceContext*            pContext,
+                                             IEngineFactory*            pEngineFactory,
+                                             Tutorial14_FrameAllocator* pFrameAllocator,
+                                             ITextureView*              pColorPaletteSRV) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pEngineFactory(pEngineFactory),
+    m_pFrameAllocator(pFrameAllocator)
+{
+    m_pEntriesReadback = std::make_unique<Tutorial14_AsyncReadback>(m_pDevice, m_pContext, sizeof(Uint32), 4, "Paint entries readback");
+
+    CreateEntriesBuffer(INITIAL_MAX_ENTRIES);
+    CreatePipelines(pColorPaletteSRV);
+}
+
+bool Tutorial14_TiledPaint::IsSupported(IRenderDevice* pDevice)
+{
+    const auto& Features = pDevice->GetDeviceInfo().Features;
+    if (!Features.ComputeShaders || !Features.TextureUAVExtendedFormats)
+        return false;
+
+    return (pDevice->GetTextureFormatInfoExt(TEX_FORMAT_RGBA8_UNORM).BindFlags & BIND_UNORDERED_ACCESS) != 0;
+}
+
+void Tutorial14_TiledPaint::CreatePipelines(ITextureView* pColorPaletteSRV)
+{
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.EntryPoint                      = "main";
+    ShaderCI.FilePath                        = "paint_tiles.csh";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+    // Las constantes son una ventana del asignador de frame
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_COMPUTE, "g_ColorPalette", SHADER_RESOURCE_VARIABLE_TYPE_STATIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    // La misma paleta y el mismo filtrado que el camino rasterizado
+    SamplerDesc PaletteSampler;
+    PaletteSampler.MinFilter = FILTER_TYPE_LINEAR;
+    PaletteSampler.MagFilter = FILTER_TYPE_LINEAR;
+    PaletteSampler.MipFilter = FILTER_TYPE_LINEAR;
+    PaletteSampler.AddressU  = TEXTURE_ADDRESS_WRAP;
+    PaletteSampler.AddressV  = TEXTURE_ADDRESS_WRAP;
+
+    ImmutableSamplerDesc ImtblSamplers[] = {{SHADER_TYPE_COMPUTE, "g_ColorPalette", PaletteSampler}};
+    PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+    PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+
+    auto CreatePSO = [&](PAINT_PASS Pass, const char* Name, RefCntAutoPtr<IPipelineState>& pPSO) {
+        ShaderMacroHelper Macros;
+        Macros.AddShaderMacro("PAINT_GROUP_SIZE", static_cast<int>(PAINT_GROUP_SIZE));
+        Macros.AddShaderMacro("PAINT_PASS", static_cast<int>(Pass));
+        ShaderCI.Macros    = Macros;
+        ShaderCI.Desc.Name = Name;
+
+        RefCntAutoPtr<IShader> pCS;
+        m_pDevice->CreateShader(ShaderCI, &pCS);
+        if (!pCS)
+        {
+            LOG_ERROR_MESSAGE("Failed to create shader ", Name);
+            return;
+        }
+
+        PSODesc.Name      = Name;
+        PSOCreateInfo.pCS = pCS;
+        m_pDevice->CreateComputePipelineState(PSOCreateInfo, &pPSO);
+        if (!pPSO)
+        {
+            LOG_ERROR_MESSAGE("Failed to create PSO ", Name);
+            return;
+        }
+
+        if (auto* pPaletteVar = pPSO->GetStaticVariableByName(SHADER_TYPE_COMPUTE, "g_ColorPalette"))
+            pPaletteVar->Set(pColorPaletteSRV);
+    };
+
+    CreatePSO(PAINT_PASS_BIN, "Paint bin CS", m_pBinPSO);
+    CreatePSO(PAINT_PASS_SCAN, "Paint tile scan CS", m_pScanPSO);
+    CreatePSO(PAINT_PASS_SCATTER, "Paint scatter CS", m_pScatterPSO);
+    CreatePSO(PAINT_PASS_TILES, "Paint tiles CS", m_pTilesPSO);
+}
+
+void Tutorial14_TiledPaint::SetParticleBuffer(IBuffer* pParticleAttribs, Uint32 NumParticles)
+{
+    m_pParticleAttribs = pParticleAttribs;
+
+    if (NumParticles != m_NumSplats || !m_pSplatsBuffer)
+    {
+        m_NumSplats = std::max(NumParticles, 1u);
+
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "Paint splats buffer";
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(PaintSplat);
+        BuffDesc.Size              = Uint64{sizeof(PaintSplat)} * m_NumSplats;
+        m_pSplatsBuffer.Release();
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pSplatsBuffer);
+    }
+
+    CreateShaderResourceBindings();
+}
+
+void Tutorial14_TiledPaint::SetCanvas(ITexture* pCanvas)
+{
+    m_pCanvas = pCanvas;
+    CreateTileBuffers();
+    CreateShaderResourceBindings();
+}
+
+void Tutorial14_TiledPaint::CreateTileBuffers()
+{
+    m_pTileCountsBuffer.Release();
+    m_pTileOffsetsBuffer.Release();
+    m_NumTiles = uint2{0, 0};
+    if (!m_pCanvas)
+        return;
+
+    const auto& CanvasDesc = m_pCanvas->GetDesc();
+    m_NumTiles             = uint2{(CanvasDesc.Width + TILE_SIZE - 1) / TILE_SIZE, (CanvasDesc.Height + TILE_SIZE - 1) / TILE_SIZE};
+    const Uint32 NumTiles  = m_NumTiles.x * m_NumTiles.y;
+
+    // Los contadores deben empezar a cero; el pase de scatter los deja a cero al terminar
+    const std::vector<Uint32> Zeros(NumTiles + 1, 0u);
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Paint tile counts buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = Uint64{sizeof(Uint32)} * NumTiles;
+    BufferData CountsData{Zeros.data(), BuffDesc.Size};
+    m_pDevice->CreateBuffer(BuffDesc, &CountsData, &m_pTileCountsBuffer);
+
+    BuffDesc.Name = "Paint tile offsets buffer";
+    BuffDesc.Size = Uint64{sizeof(Uint32)} * (NumTiles + 1);
+    BufferData OffsetsData{Zeros.data(), BuffDesc.Size};
+    m_pDevice->CreateBuffer(BuffDesc, &OffsetsData, &m_pTileOffsetsBuffer);
+}
+
+void Tutorial14_TiledPaint::CreateEntriesBuffer(Uint32 MaxEntries)
+{
+    BufferDesc BuffDesc;
+    BuffDesc.Name              = "Paint tile entries buffer";
+    BuffDesc.Usage             = USAGE_DEFAULT;
+    BuffDesc.BindFlags         = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+    BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+    BuffDesc.ElementByteStride = sizeof(Uint32);
+    BuffDesc.Size              = Uint64{sizeof(Uint32)} * MaxEntries;
+    m_pTileEntriesBuffer.Release();
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &m_pTileEntriesBuffer);
+    m_MaxEntries = m_pTileEntriesBuffer ? MaxEntries : 0;
+}
+
+void Tutorial14_TiledPaint::CreateShaderResourceBindings()
+{
+    m_pBinSRB.Release();
+    m_pScanSRB.Release();
+    m_pScatterSRB.Release();
+    m_pTilesSRB.Release();
+
+    if (!m_pBinPSO || !m_pScanPSO || !m_pScatterPSO || !m_pTilesPSO ||
+        !m_pParticleAttribs || !m_pSplatsBuffer || !m_pTileCountsBuffer || !m_pTileEntriesBuffer || !m_pCanvas)
+        return;
+
+    IBufferView* pSplatsSRV      = m_pSplatsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pSplatsUAV      = m_pSplatsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pTileCountsSRV  = m_pTileCountsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pTileCountsUAV  = m_pTileCountsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pTileOffsetsSRV = m_pTileOffsetsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE);
+    IBufferView* pTileOffsetsUAV = m_pTileOffsetsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+    IBufferView* pTileEntriesUAV = m_pTileEntriesBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS);
+
+    m_pBinPSO->CreateShaderResourceBinding(&m_pBinSRB, true);
+    m_pBinSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Particles")->Set(m_pParticleAttribs->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pBinSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Splats")->Set(pSplatsUAV);
+    m_pBinSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TileCounts")->Set(pTileCountsUAV);
+
+    m_pScanPSO->CreateShaderResourceBinding(&m_pScanSRB, true);
+    m_pScanSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TileCounts")->Set(pTileCountsSRV);
+    m_pScanSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TileOffsets")->Set(pTileOffsetsUAV);
+
+    m_pScatterPSO->CreateShaderResourceBinding(&m_pScatterSRB, true);
+    m_pScatterSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Splats")->Set(pSplatsSRV);
+    m_pScatterSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TileOffsets")->Set(pTileOffsetsSRV);
+    m_pScatterSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TileCounts")->Set(pTileCountsUAV);
+    m_pScatterSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TileEntries")->Set(pTileEntriesUAV);
+
+    m_pTilesPSO->CreateShaderResourceBinding(&m_pTilesSRB, true);
+    m_pTilesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Splats")->Set(pSplatsSRV);
+    m_pTilesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TileOffsets")->Set(pTileOffsetsSRV);
+    m_pTilesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_TileEntries")->Set(pTileEntriesUAV);
+    m_pTilesSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Canvas")->Set(m_pCanvas->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS));
+
+    for (IShaderResourceBinding* pSRB : {m_pBinSRB.RawPtr(), m_pScanSRB.RawPtr(), m_pScatterSRB.RawPtr(), m_pTilesSRB.RawPtr()})
+        m_pFrameAllocator->BindConstants(pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "PaintTileConstantsBuffer"), sizeof(PaintTileConstants));
+}
+
+void Tutorial14_TiledPaint::Paint(Uint32 NumParticles)
+{
+    if (!IsReady())
+        return;
+
+    T14_TRACE_SCOPE("TiledPaint::Paint");
+
+    // El total de entradas se conoce unos frames tarde. Si las listas se desbordaron,
+    // los trazos que no cupieron no se pintaron en esos frames y se ampla el bfer.
+    Uint32 NumEntries = 0;
+    if (m_pEntriesReadback->Poll(NumEntries))
+    {
+        m_LastNumEntries = NumEntries;
+        if (NumEntries > m_MaxEntries)
+        {
+            CreateEntriesBuffer(NumEntries + NumEntries / 2);
+            CreateShaderResourceBindings();
+            if (!IsReady())
+                return;
+        }
+    }
+
+    NumParticles = std::min(NumParticles, m_NumSplats);
+
+    const auto& CanvasDesc = m_pCanvas->GetDesc();
+    {
+        T14_TRACE_SCOPE("Allocate paint tile constants");
+        PaintTileConstants Constants;
+        Constants.uiNumParticles = NumParticles;
+        Constants.uiMaxEntries   = m_MaxEntries;
+        Constants.u2NumTiles     = m_NumTiles;
+        Constants.f2CanvasSize   = float2{static_cast<float>(CanvasDesc.Width), static_cast<float>(CanvasDesc.Height)};
+
+        const Uint32 Offset = m_pFrameAllocator->Allocate(Constants);
+        for (IShaderResourceBinding* pSRB : {m_pBinSRB.RawPtr(), m_pScanSRB.RawPtr(), m_pScatterSRB.RawPtr(), m_pTilesSRB.RawPtr()})
+        {
+            if (auto* pVar = pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "PaintTileConstantsBuffer"))
+                pVar->SetBufferOffset(Offset);
+        }
+    }
+
+    const Uint32 NumParticleGroups = (NumParticles + PAINT_GROUP_SIZE - 1) / PAINT_GROUP_SIZE;
+    if (NumParticleGroups > 0)
+    {
+        m_pContext->SetPipelineState(m_pBinPSO);
+        m_pContext->CommitShaderResources(m_pBinSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pContext->DispatchCompute(DispatchComputeAttribs{NumParticleGroups});
+    }
+
+    m_pContext->SetPipelineState(m_pScanPSO);
+    m_pContext->CommitShaderResources(m_pScanSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{1});
+
+    if (NumParticleGroups > 0)
+    {
+        m_pContext->SetPipelineState(m_pScatterPSO);
+        m_pContext->CommitShaderResources(m_pScatterSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        m_pContext->DispatchCompute(DispatchComputeAttribs{NumParticleGroups});
+    }
+
+    m_pContext->SetPipelineState(m_pTilesPSO);
+    m_pContext->CommitShaderResources(m_pTilesSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pContext->DispatchCompute(DispatchComputeAttribs{m_NumTiles.x, m_NumTiles.y});
+
+    m_pEntriesReadback->Enqueue(m_pTileOffsetsBuffer, Uint64{sizeof(Uint32)} * m_NumTiles.x * m_NumTiles.y);
+}
+
+} // namespace Diligent
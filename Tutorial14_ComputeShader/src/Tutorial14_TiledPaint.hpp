@@ -0,0 +1,101 @@
+#pragma once
+
+#include <memory>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Tutorial14_AsyncReadback.hpp"
+
+namespace Diligent
+{
+
+class Tutorial14_FrameAllocator;
+
+// Pintura del canvas con compute shaders (paint_tiles.csh). En lugar de mezclar un
+// quad por partcula en el ROP, los trazos se reparten en tiles de 16x16 pxeles:
+// se cuentan los trazos de cada tile, un scan calcula los desplazamientos y cada
+// ndice de partcula se escribe en la lista de su tile. Despus, un grupo por
+// tile ordena su lista por ndice de partcula y mezcla los trazos en ese orden
+// con el mismo modelo de pincel que PaintParticle.psh (paint.fxh), escribiendo
+// cada pxel del canvas una sola vez.
+class Tutorial14_TiledPaint
+{
+public:
+    static constexpr Uint32 PAINT_GROUP_SIZE = 256;
+    static constexpr Uint32 TILE_SIZE        = 16; // PAINT_TILE_SIZE en paint.fxh
+
+    // Espejo de PaintSplat en paint.fxh
+    struct PaintSplat
+    {
+        float2 f2Center;
+        float2 f2Radius;
+        float3 f3BaseColor;
+        float  fSpeed;
+        float  fTemperature;
+        float3 f3Padding0;
+    };
+
+    Tutorial14_TiledPaint(IRenderDevice*             pDevice,
+                          IDeviceContext*            pContext,
+                          IEngineFactory*            pEngineFactory,
+                          Tutorial14_FrameAllocator* pFrameAllocator,
+                          ITextureView*              pColorPaletteSRV);
+
+    // El canvas RGBA8 se lee y escribe como UAV tipado, lo que requiere la
+    // caracterstica TextureUAVExtendedFormats
+    static bool IsSupported(IRenderDevice* pDevice);
+
+    bool IsReady() const { return m_pBinSRB && m_pScanSRB && m_pScatterSRB && m_pTilesSRB; }
+
+    // Debe llamarse cada vez que se recrea el bfer de partculas
+    void SetParticleBuffer(IBuffer* pParticleAttribs, Uint32 NumParticles);
+
+    // Debe llamarse cada vez que se recrea el canvas (necesita BIND_UNORDERED_ACCESS)
+    void SetCanvas(ITexture* pCanvas);
+
+    // Graba los cuatro pases; el canvas queda en estado UAV
+    void Paint(Uint32 NumParticles);
+
+    // Entradas (trazo, tile) del ltimo frame ledo y capacidad actual de las listas
+    Uint32 GetLastNumEntries() const { return m_LastNumEntries; }
+    Uint32 GetMaxEntries() const { return m_MaxEntries; }
+
+private:
+    void CreatePipelines(ITextureView* pColorPaletteSRV);
+    void CreateTileBuffers();
+    void CreateEntriesBuffer(Uint32 MaxEntries);
+    void CreateShaderResourceBindings();
+
+    IRenderDevice*             m_pDevice         = nullptr;
+    IDeviceContext*            m_pContext        = nullptr;
+    IEngineFactory*            m_pEngineFactory  = nullptr;
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
+
+    RefCntAutoPtr<IBuffer> m_pParticleAttribs;
+    RefCntAutoPtr<IBuffer> m_pSplatsBuffer;
+    RefCntAutoPtr<IBuffer> m_pTileCountsBuffer;
+    RefCntAutoPtr<IBuffer> m_pTileOffsetsBuffer;
+    RefCntAutoPtr<IBuffer> m_pTileEntriesBuffer;
+
+    RefCntAutoPtr<ITexture> m_pCanvas;
+
+    RefCntAutoPtr<IPipelineState>         m_pBinPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pBinSRB;
+    RefCntAutoPtr<IPipelineState>         m_pScanPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pScanSRB;
+    RefCntAutoPtr<IPipelineState>         m_pScatterPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pScatterSRB;
+    RefCntAutoPtr<IPipelineState>         m_pTilesPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pTilesSRB;
+
+    // Total de entradas (ltimo elemento de g_TileOffsets), para ampliar las listas
+    std::unique_ptr<Tutorial14_AsyncReadback> m_pEntriesReadback;
+
+    Uint32 m_NumSplats      = 0;
+    uint2  m_NumTiles       = uint2{0, 0};
+    Uint32 m_MaxEntries     = 0;
+    Uint32 m_LastNumEntries = 0;
+};
+
+} // namespace Diligent
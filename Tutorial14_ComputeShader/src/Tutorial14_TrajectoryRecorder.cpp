@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Tutorial14_TrajectoryRecorder.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr Uint32 NUM_READBACK_SLOTS = 4;
+
+void WriteVarUint(std::vector<Uint8>& Out, Uint32 Value)
+{
+    while (Value >= 0x80u)
+    {
+        Out.push_back(static_cast<Uint8>(Value | 0x80u));
+        Value >>= 7u;
+    }
+    Out.push_back(static_cast<Uint8>(Value));
+}
+
+Uint32 ZigZag(Int32 Value)
+{
+    return (static_cast<Uint32>(Value) << 1u) ^ static_cast<Uint32>(Value >> 31);
+}
+
+Int32 Quantize(float Value, float InvStep)
+{
+    // Se satura a +-2^29 para que la diferencia entre dos frames quepa en 32 bits
+    constexpr float MaxQuantized = static_cast<float>(1 << 29);
+
+    const float Scaled = Value * InvStep;
+    if (!(Scaled > -MaxQuantized)) // Tambin descarta NaN
+        return -(1 << 29);
+    if (Scaled > MaxQuantized)
+        return 1 << 29;
+    return static_cast<Int32>(std::lround(Scaled));
+}
+
+} // namespace
+
+Tutorial14_TrajectoryRecorder::Tutorial14_TrajectoryRecorder(IRenderDevice*        pDevice,
+                                                             IDeviceContext*       pContext,
+                                                             const ParticleLayout& Layout) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_Layout(Layout)
+{
+}
+
+Tutorial14_TrajectoryRecorder::~Tutorial14_TrajectoryRecorder()
+{
+    Stop();
+}
+
+bool Tutorial14_TrajectoryRecorder::Start(const Settings& RecorderSettings, Uint32 NumParticles)
+{
+    Stop();
+
+    if (NumParticles == 0 || RecorderSettings.PositionStep <= 0 || RecorderSettings.SpeedStep <= 0 || RecorderSettings.TemperatureStep <= 0)
+    {
+        LOG_ERROR_MESSAGE("Invalid trajectory recorder settings");
+        return false;
+    }
+
+    m_Settings                  = RecorderSettings;
+    m_Settings.FrameInterval    = std::max(m_Settings.FrameInterval, 1u);
+    m_Settings.KeyFrameInterval = std::max(m_Settings.KeyFrameInterval, 1u);
+    m_NumParticles              = NumParticles;
+
+    m_pReadback = std::make_unique<Tutorial14_AsyncReadback>(m_pDevice, m_pContext, Uint64{m_Layout.Stride} * NumParticles,
+                                                             NUM_READBACK_SLOTS, "Trajectory readback");
+    if (!m_pReadback->IsValid())
+    {
+        m_pReadback.reset();
+        return false;
+    }
+
+    m_File.open(m_Settings.OutputPath, std::ios::binary | std::ios::trunc);
+    if (!m_File)
+    {
+        LOG_ERROR_MESSAGE("Failed to open trajectory file ", m_Settings.OutputPath);
+        m_pReadback.reset();
+        return false;
+    }
+
+    FileHeader Header;
+    Header.NumParticles     = NumParticles;
+    Header.FrameInterval    = m_Settings.FrameInterval;
+    Header.KeyFrameInterval = m_Settings.KeyFrameInterval;
+    Header.PositionStep     = m_Settings.PositionStep;
+    Header.SpeedStep        = m_Settings.SpeedStep;
+    Header.TemperatureStep  = m_Settings.TemperatureStep;
+    m_File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+
+    m_PrevQuantized.assign(size_t{NUM_CHANNELS} * NumParticles, 0);
+    m_Payload.clear();
+    m_Payload.reserve(size_t{NUM_CHANNELS} * NumParticles * 2);
+    m_NumEncodedFrames = 0;
+
+    m_RecordedFrames = 0;
+    m_DroppedFrames  = 0;
+    m_WrittenBytes   = sizeof(Header);
+
+    m_QueuedFrames.clear();
+    m_FreeFrames.clear();
+    m_bStopWorker = false;
+    m_Worker      = std::thread{&Tutorial14_TrajectoryRecorder::WorkerThread, this};
+    m_bRecording  = true;
+
+    LOG_INFO_MESSAGE("Recording ", NumParticles, " particle trajectories to ", m_Settings.OutputPath);
+    return true;
+}
+
+void Tutorial14_TrajectoryRecorder::Stop()
+{
+    if (!m_bRecording)
+        return;
+
+    T14_TRACE_SCOPE("TrajectoryRecorder::Stop");
+
+    // Recoger las copias que siguen en vuelo
+    if (m_pReadback->HasPendingCopies())
+    {
+        m_pContext->WaitForIdle();
+        ProcessCompletedReadbacks();
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        m_bStopWorker = true;
+    }
+    m_QueueCV.notify_one();
+    m_Worker.join();
+
+    m_File.close();
+    m_pReadback.reset();
+    m_bRecording = false;
+
+    const auto Stats = GetStatistics();
+    LOG_INFO_MESSAGE("Trajectory recording finished: ", Stats.RecordedFrames, " frames, ", Stats.DroppedFrames, " dropped, ",
+                     Stats.WrittenBytes, " bytes written");
+}
+
+void Tutorial14_TrajectoryRecorder::Capture(IBuffer* pParticleAttribs, Uint64 FrameId)
+{
+    if (!m_bRecording)
+        return;
+
+    T14_TRACE_SCOPE("TrajectoryRecorder::Capture");
+
+    ProcessCompletedReadbacks();
+
+    if (FrameId % m_Settings.FrameInterval != 0)
+        return;
+
+    if (pParticleAttribs->GetDesc().Size != m_pReadback->GetSize())
+    {
+        LOG_ERROR_MESSAGE("Particle buffer size changed while recording trajectories");
+        Stop();
+        return;
+    }
+
+    m_pReadback->SetFrameId(FrameId);
+    if (!m_pReadback->Enqueue(pParticleAttribs))
+    {
+        // La GPU va demasiado por detrs
+        ++m_DroppedFrames;
+    }
+}
+
+void Tutorial14_TrajectoryRecorder::ProcessCompletedReadbacks()
+{
+    for (;;)
+    {
+        std::unique_ptr<QueuedFrame> pFrame;
+        {
+            std::lock_guard<std::mutex> Lock{m_QueueMtx};
+            if (!m_FreeFrames.empty())
+            {
+                pFrame = std::move(m_FreeFrames.back());
+                m_FreeFrames.pop_back();
+            }
+        }
+        if (!pFrame)
+            pFrame = std::make_unique<QueuedFrame>();
+        pFrame->Data.resize(static_cast<size_t>(m_pReadback->GetSize()));
+
+        const bool bHasFrame = m_pReadback->PollOldest(pFrame->Data.data(), &pFrame->FrameId);
+
+        {
+            std::lock_guard<std::mutex> Lock{m_QueueMtx};
+            if (!bHasFrame)
+            {
+                m_FreeFrames.push_back(std::move(pFrame));
+                break;
+            }
+            if (m_QueuedFrames.size() >= m_Settings.MaxQueuedFrames)
+            {
+                // El hilo de compresin no da abasto: se descarta el frame en lugar de esperar
+                ++m_DroppedFrames;
+                m_FreeFrames.push_back(std::move(pFrame));
+                continue;
+            }
+            m_QueuedFrames.push_back(std::move(pFrame));
+        }
+        m_QueueCV.notify_one();
+    }
+}
+
+void Tutorial14_TrajectoryRecorder::WorkerThread()
+{
+    Tutorial14_CPUTrace::SetThreadName("Trajectory encoder");
+
+    for (;;)
+    {
+        std::unique_ptr<QueuedFrame> pFrame;
+        {
+            std::unique_lock<std::mutex> Lock{m_QueueMtx};
+            m_QueueCV.wait(Lock, [this] { return m_bStopWorker || !m_QueuedFrames.empty(); });
+            // Al parar se comprimen primero los frames que queden en la cola
+            if (m_QueuedFrames.empty())
+                break;
+            pFrame = std::move(m_QueuedFrames.front());
+            m_QueuedFrames.pop_front();
+        }
+
+        EncodeFrame(*pFrame);
+
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        m_FreeFrames.push_back(std::move(pFrame));
+    }
+}
+
+void Tutorial14_TrajectoryRecorder::EncodeFrame(const QueuedFrame& Frame)
+{
+    T14_TRACE_SCOPE("Encode trajectory frame");
+
+    const bool bKeyFrame = m_NumEncodedFrames % m_Settings.KeyFrameInterval == 0;
+
+    // clang-format off
+    const Uint32 ChannelOffsets[NUM_CHANNELS] =
+    {
+        m_Layout.PositionOffset,
+        m_Layout.PositionOffset + Uint32{sizeof(float)},
+        m_Layout.SpeedOffset,
+        m_Layout.SpeedOffset + Uint32{sizeof(float)},
+        m_Layout.TemperatureOffset
+    };
+    const float InvSteps[NUM_CHANNELS] =
+    {
+        1.f / m_Settings.PositionStep,
+        1.f / m_Settings.PositionStep,
+        1.f / m_Settings.SpeedStep,
+        1.f / m_Settings.SpeedStep,
+        1.f / m_Settings.TemperatureStep
+    };
+    // clang-format on
+
+    m_Payload.clear();
+    for (Uint32 Channel = 0; Channel < NUM_CHANNELS; ++Channel)
+    {
+        const Uint8* pSrc  = Frame.Data.data() + ChannelOffsets[Channel];
+        Int32*       pPrev = m_PrevQuantized.data() + size_t{Channel} * m_NumParticles;
+        for (Uint32 i = 0; i < m_NumParticles; ++i)
+        {
+            float Value;
+            memcpy(&Value, pSrc + size_t{i} * m_Layout.Stride, sizeof(Value));
+
+            // La diferencia se calcula entre valores cuantizados, as que el error no se acumula
+            const Int32 Quantized = Quantize(Value, InvSteps[Channel]);
+            WriteVarUint(m_Payload, ZigZag(bKeyFrame ? Quantized : Quantized - pPrev[i]));
+            pPrev[i] = Quantized;
+        }
+    }
+
+    FrameHeader Header;
+    Header.FrameId     = Frame.FrameId;
+    Header.Flags       = bKeyFrame ? FRAME_FLAG_KEY_FRAME : 0u;
+    Header.PayloadSize = static_cast<Uint32>(m_Payload.size());
+    m_File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+    m_File.write(reinterpret_cast<const char*>(m_Payload.data()), static_cast<std::streamsize>(m_Payload.size()));
+
+    ++m_NumEncodedFrames;
+    ++m_RecordedFrames;
+    m_WrittenBytes += sizeof(Header) + m_Payload.size();
+}
+
+Tutorial14_TrajectoryRecorder::Statistics Tutorial14_TrajectoryRecorder::GetStatistics() const
+{
+    Statistics Stats;
+    Stats.RecordedFrames = m_RecordedFrames.load();
+    Stats.DroppedFrames  = m_DroppedFrames.load();
+    Stats.RawBytes       = Stats.RecordedFrames * m_Layout.Stride * m_NumParticles;
+    Stats.WrittenBytes   = m_WrittenBytes.load();
+    return Stats;
+}
+
+} // namespace Diligent
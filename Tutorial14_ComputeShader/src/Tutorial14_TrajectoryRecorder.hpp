@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Tutorial14_AsyncReadback.hpp"
+
+namespace Diligent
+{
+
+// Grabacin continua de las trayectorias de las partculas (posicin, velocidad y
+// temperatura). Cada N frames se copia el bfer de partculas a un anillo de lectura
+// asncrona; las copias terminadas pasan a un hilo que las cuantiza, calcula la
+// diferencia con el frame anterior y escribe el resultado como varints en zigzag.
+// Si el hilo no da abasto los frames se descartan en lugar de bloquear el render.
+//
+// Formato del fichero (little-endian):
+//   FileHeader
+//   FrameHeader + carga, por cada frame grabado
+// La carga guarda los canales uno tras otro (x, y, vx, vy, temperatura) y, dentro de
+// cada canal, un varint por partcula. En los fotogramas clave el valor es el propio
+// entero cuantizado; en el resto es la diferencia con el ltimo frame escrito.
+class Tutorial14_TrajectoryRecorder
+{
+public:
+    static constexpr Uint32 FILE_MAGIC   = 0x52343154; // "T14R"
+    static constexpr Uint32 FILE_VERSION = 1;
+    static constexpr Uint32 NUM_CHANNELS = 5;
+
+    static constexpr Uint32 FRAME_FLAG_KEY_FRAME = 1u << 0u;
+
+    struct FileHeader
+    {
+        Uint32 Magic            = FILE_MAGIC;
+        Uint32 Version          = FILE_VERSION;
+        Uint32 NumParticles     = 0;
+        Uint32 FrameInterval    = 0;
+        Uint32 KeyFrameInterval = 0;
+        float  PositionStep     = 0;
+        float  SpeedStep        = 0;
+        float  TemperatureStep  = 0;
+    };
+
+    struct FrameHeader
+    {
+        Uint64 FrameId     = 0;
+        Uint32 Flags       = 0;
+        Uint32 PayloadSize = 0;
+    };
+
+    // Desplazamientos dentro de ParticleAttribs (structures.fxh)
+    struct ParticleLayout
+    {
+        Uint32 Stride            = 0;
+        Uint32 PositionOffset    = 0;
+        Uint32 SpeedOffset       = 0;
+        Uint32 TemperatureOffset = 0;
+    };
+
+    struct Settings
+    {
+        std::string OutputPath       = "Tutorial14_Trajectory.t14r";
+        Uint32      FrameInterval    = 1;  // Grabar uno de cada N frames
+        Uint32      KeyFrameInterval = 60; // Fotograma clave cada N frames grabados
+        float       PositionStep     = 1.f / 8192.f;
+        float       SpeedStep        = 1.f / 8192.f;
+        float       TemperatureStep  = 1.f / 1024.f;
+        Uint32      MaxQueuedFrames  = 8; // Frames pendientes de comprimir antes de descartar
+    };
+
+    struct Statistics
+    {
+        Uint64 RecordedFrames = 0;
+        Uint64 DroppedFrames  = 0;
+        Uint64 RawBytes       = 0; // Lo que ocuparan los ParticleAttribs sin comprimir
+        Uint64 WrittenBytes   = 0;
+    };
+
+    Tutorial14_TrajectoryRecorder(IRenderDevice*        pDevice,
+                                  IDeviceContext*       pContext,
+                                  const ParticleLayout& Layout);
+    ~Tutorial14_TrajectoryRecorder();
+
+    // clang-format off
+    Tutorial14_TrajectoryRecorder(const Tutorial14_TrajectoryRecorder&)            = delete;
+    Tutorial14_TrajectoryRecorder& operator=(const Tutorial14_TrajectoryRecorder&) = delete;
+    // clang-format on
+
+    bool Start(const Settings& RecorderSettings, Uint32 NumParticles);
+    // Espera a las copias pendientes, termina de comprimir y cierra el fichero
+    void Stop();
+
+    bool IsRecording() const { return m_bRecording; }
+
+    // Llamar una vez por frame despus de la simulacin
+    void Capture(IBuffer* pParticleAttribs, Uint64 FrameId);
+
+    Statistics GetStatistics() const;
+
+    const Settings& GetSettings() const { return m_Settings; }
+
+private:
+    struct QueuedFrame
+    {
+        Uint64             FrameId = 0;
+        std::vector<Uint8> Data;
+    };
+
+    void ProcessCompletedReadbacks();
+    void WorkerThread();
+    void EncodeFrame(const QueuedFrame& Frame);
+
+    IRenderDevice*  m_pDevice  = nullptr;
+    IDeviceContext* m_pContext = nullptr;
+    ParticleLayout  m_Layout;
+    Settings        m_Settings;
+    Uint32          m_NumParticles = 0;
+    bool            m_bRecording   = false;
+
+    std::unique_ptr<Tutorial14_AsyncReadback> m_pReadback;
+
+    // Cola hacia el hilo de compresin; los bferes se reciclan a travs de m_FreeFrames
+    std::thread                               m_Worker;
+    mutable std::mutex                        m_QueueMtx;
+    std::condition_variable                   m_QueueCV;
+    std::deque<std::unique_ptr<QueuedFrame>>  m_QueuedFrames;
+    std::vector<std::unique_ptr<QueuedFrame>> m_FreeFrames;
+    bool                                      m_bStopWorker = false;
+
+    // Estado del hilo de compresin
+    std::ofstream      m_File;
+    std::vector<Int32> m_PrevQuantized; // NUM_CHANNELS * m_NumParticles, por canales
+    std::vector<Uint8> m_Payload;
+    Uint64             m_NumEncodedFrames = 0;
+
+    std::atomic<Uint64> m_RecordedFrames{0};
+    std::atomic<Uint64> m_DroppedFrames{0};
+    std::atomic<Uint64> m_WrittenBytes{0};
+};
+
+} // namespace Diligent
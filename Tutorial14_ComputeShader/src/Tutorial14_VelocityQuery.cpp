@@ -0,0 +1,317 @@
+#include <stdexcept>
+#include "Tutorial14_VelocityQuery.hpp"
+#include "Tutorial14_FrameAllocator.hpp"
+#include "Tutorial14_CPUTrace.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Espejo de VelocityQueryConstants en velocity_query.csh
+struct VelocityQueryConstants
+{
+    Uint32 uiNumPositions = 0;
+    Uint32 uiPadding0     = 0;
+    float2 f2FluidWindowCenter = float2{0, 0};
+};
+
+} // namespace
+
+Tutorial14_VelocityQuery::Tutorial14_VelocityQuery(IRenderDevice*             pDevice,
+                                                   IDeviceContext*            pContext,
+                                                   IEngineFactory*            pEngineFactory,
+                                                   Tutorial14_FrameAllocator* pFrameAllocator,
+                                                   Uint32                     MaxPositionsPerFrame) :
+    m_pDevice(pDevice),
+    m_pContext(pContext),
+    m_pEngineFactory(pEngineFactory),
+    m_pFrameAllocator(pFrameAllocator),
+    m_MaxPositionsPerFrame(MaxPositionsPerFrame)
+{
+    FenceDesc FDesc;
+    FDesc.Name = "Velocity query fence";
+    m_pDevice->CreateFence(FDesc, &m_pFence);
+    if (!m_pFence)
+    {
+        LOG_ERROR_MESSAGE("Failed to create velocity query fence");
+        return;
+    }
+
+    CreatePipeline();
+    if (!m_pQueryPSO)
+        return;
+
+    // Cada lote en vuelo tiene sus propios bferes, as que el siguiente dispatch no
+    // espera a que la CPU lea el anterior
+    m_Slots.resize(NUM_READBACK_SLOTS);
+    for (auto& BatchSlot : m_Slots)
+    {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = "Velocity query positions buffer";
+        BuffDesc.Usage             = USAGE_DEFAULT;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = sizeof(float2);
+        BuffDesc.Size              = Uint64{sizeof(float2)} * m_MaxPositionsPerFrame;
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &BatchSlot.pPositionsBuffer);
+
+        BuffDesc.Name      = "Velocity query results buffer";
+        BuffDesc.BindFlags = BIND_UNORDERED_ACCESS;
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &BatchSlot.pVelocitiesBuffer);
+
+        BuffDesc                = {};
+        BuffDesc.Name           = "Velocity query readback buffer";
+        BuffDesc.Usage          = USAGE_STAGING;
+        BuffDesc.CPUAccessFlags = CPU_ACCESS_READ;
+        BuffDesc.Size           = Uint64{sizeof(float2)} * m_MaxPositionsPerFrame;
+        m_pDevice->CreateBuffer(BuffDesc, nullptr, &BatchSlot.pStagingBuffer);
+
+        if (!BatchSlot.pPositionsBuffer || !BatchSlot.pVelocitiesBuffer || !BatchSlot.pStagingBuffer)
+        {
+            LOG_ERROR_MESSAGE("Failed to create velocity query buffers");
+            m_Slots.clear();
+            return;
+        }
+
+        m_pQueryPSO->CreateShaderResourceBinding(&BatchSlot.pSRB, true);
+        BatchSlot.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Positions")->Set(BatchSlot.pPositionsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+        BatchSlot.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_Velocities")->Set(BatchSlot.pVelocitiesBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
+        m_pFrameAllocator->BindConstants(BatchSlot.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "VelocityQueryConstants"), sizeof(VelocityQueryConstants));
+    }
+}
+
+void Tutorial14_VelocityQuery::CreatePipeline()
+{
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage                  = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+    ShaderCI.Desc.ShaderType                 = SHADER_TYPE_COMPUTE;
+    ShaderCI.Desc.Name                       = "Velocity query CS";
+    ShaderCI.EntryPoint                      = "main";
+    ShaderCI.FilePath                        = "velocity_query.csh";
+
+    RefCntAutoPtr<IShaderSourceInputStreamFactory> pShaderSourceFactory;
+    m_pEngineFactory->CreateDefaultShaderSourceStreamFactory(nullptr, &pShaderSourceFactory);
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("QUERY_GROUP_SIZE", static_cast<int>(QUERY_GROUP_SIZE));
+    ShaderCI.Macros = Macros;
+
+    RefCntAutoPtr<IShader> pCS;
+    m_pDevice->CreateShader(ShaderCI, &pCS);
+    if (!pCS)
+    {
+        LOG_ERROR_MESSAGE("Failed to create velocity query shader");
+        return;
+    }
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&             PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name         = "Velocity query PSO";
+    PSODesc.PipelineType = PIPELINE_TYPE_COMPUTE;
+    // Las constantes son una ventana del asignador de frame
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        // El campo del fluido alterna entre dos texturas
+        {SHADER_TYPE_COMPUTE, "g_VelocityTexture", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    SamplerDesc LinearClampSampler;
+    LinearClampSampler.MinFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.MagFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.MipFilter = FILTER_TYPE_LINEAR;
+    LinearClampSampler.AddressU  = TEXTURE_ADDRESS_CLAMP;
+    LinearClampSampler.AddressV  = TEXTURE_ADDRESS_CLAMP;
+    LinearClampSampler.AddressW  = TEXTURE_ADDRESS_CLAMP;
+
+    ImmutableSamplerDesc ImtblSamplers[] = {{SHADER_TYPE_COMPUTE, "g_VelocityTexture", LinearClampSampler}};
+    PSODesc.ResourceLayout.ImmutableSamplers    = ImtblSamplers;
+    PSODesc.ResourceLayout.NumImmutableSamplers = _countof(ImtblSamplers);
+
+    PSOCreateInfo.pCS = pCS;
+    m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pQueryPSO);
+    if (!m_pQueryPSO)
+    {
+        LOG_ERROR_MESSAGE("Failed to create velocity query PSO");
+        return;
+    }
+}
+
+bool Tutorial14_VelocityQuery::Submit(const float2* pPositions, Uint32 NumPositions, Callback OnComplete)
+{
+    if (pPositions == nullptr || NumPositions == 0 || NumPositions > m_MaxPositionsPerFrame)
+        return false;
+
+    Query NewQuery;
+    NewQuery.Positions.assign(pPositions, pPositions + NumPositions);
+    NewQuery.OnComplete = std::move(OnComplete);
+
+    std::lock_guard<std::mutex> Lock{m_QueueMtx};
+    m_Queue.push_back(std::move(NewQuery));
+    return true;
+}
+
+std::future<std::vector<float2>> Tutorial14_VelocityQuery::Submit(std::vector<float2> Positions)
+{
+    auto pPromise = std::make_shared<std::promise<std::vector<float2>>>();
+    auto Result   = pPromise->get_future();
+
+    if (Positions.empty())
+    {
+        pPromise->set_value({});
+        return Result;
+    }
+    if (Positions.size() > m_MaxPositionsPerFrame)
+    {
+        pPromise->set_exception(std::make_exception_ptr(std::length_error("Too many positions in a velocity query")));
+        return Result;
+    }
+
+    Query NewQuery;
+    NewQuery.Positions  = std::move(Positions);
+    NewQuery.OnComplete = [pPromise](const float2* pVelocities, Uint32 NumPositions) {
+        pPromise->set_value(std::vector<float2>(pVelocities, pVelocities + NumPositions));
+    };
+
+    std::lock_guard<std::mutex> Lock{m_QueueMtx};
+    m_Queue.push_back(std::move(NewQuery));
+    return Result;
+}
+
+void Tutorial14_VelocityQuery::Dispatch(ITextureView* pVelocitySRV, const float2& f2FluidWindowCenter)
+{
+    T14_TRACE_SCOPE("VelocityQuery::Dispatch");
+
+    if (!IsValid() || pVelocitySRV == nullptr)
+        return;
+
+    // Si todos los lotes estn en vuelo las consultas esperan al siguiente frame
+    Slot& BatchSlot = m_Slots[m_NextSlot];
+    if (BatchSlot.Pending)
+        return;
+
+    // Se toman consultas completas en orden de llegada mientras quepan en el lote
+    Uint32 NumPositions = 0;
+    {
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        while (!m_Queue.empty() && NumPositions + m_Queue.front().Positions.size() <= m_MaxPositionsPerFrame)
+        {
+            NumPositions += static_cast<Uint32>(m_Queue.front().Positions.size());
+            BatchSlot.Queries.push_back(std::move(m_Queue.front()));
+            m_Queue.pop_front();
+        }
+    }
+    if (NumPositions == 0)
+        return;
+
+    Uint32 Offset = 0;
+    for (const auto& BatchQuery : BatchSlot.Queries)
+    {
+        const Uint32 Size = static_cast<Uint32>(BatchQuery.Positions.size() * sizeof(float2));
+        m_pContext->UpdateBuffer(BatchSlot.pPositionsBuffer, Offset, Size, BatchQuery.Positions.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        Offset += Size;
+    }
+
+    {
+        VelocityQueryConstants Constants;
+        Constants.uiNumPositions      = NumPositions;
+        Constants.f2FluidWindowCenter = f2FluidWindowCenter;
+        if (auto* pVar = BatchSlot.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "VelocityQueryConstants"))
+            pVar->SetBufferOffset(m_pFrameAllocator->Allocate(Constants));
+    }
+
+    BatchSlot.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_VelocityTexture")->Set(pVelocitySRV);
+    m_pContext->SetPipelineState(m_pQueryPSO);
+    m_pContext->CommitShaderResources(BatchSlot.pSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    DispatchComputeAttribs DispatAttribs;
+    DispatAttribs.ThreadGroupCountX = (NumPositions + QUERY_GROUP_SIZE - 1) / QUERY_GROUP_SIZE;
+    m_pContext->DispatchCompute(DispatAttribs);
+
+    // Solo se copian las velocidades del lote, no la capacidad completa
+    m_pContext->CopyBuffer(BatchSlot.pVelocitiesBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                           BatchSlot.pStagingBuffer, 0, Uint64{sizeof(float2)} * NumPositions, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    BatchSlot.FenceValue = m_NextFenceValue++;
+    BatchSlot.Pending    = true;
+    m_pContext->EnqueueSignal(m_pFence, BatchSlot.FenceValue);
+
+    m_NextSlot           = (m_NextSlot + 1) % static_cast<Uint32>(m_Slots.size());
+    m_LastBatchPositions = NumPositions;
+}
+
+void Tutorial14_VelocityQuery::Poll()
+{
+    T14_TRACE_SCOPE("VelocityQuery::Poll");
+
+    if (!IsValid())
+        return;
+
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+
+    // Los lotes se entregan en el orden en que se enviaron
+    while (true)
+    {
+        Slot* pOldest = nullptr;
+        for (auto& BatchSlot : m_Slots)
+        {
+            if (BatchSlot.Pending && BatchSlot.FenceValue <= CompletedValue)
+            {
+                if (pOldest == nullptr || BatchSlot.FenceValue < pOldest->FenceValue)
+                    pOldest = &BatchSlot;
+            }
+        }
+        if (pOldest == nullptr)
+            break;
+
+        // La fence garantiza que la copia ha terminado, as que el mapeo no espera
+        void* pMappedData = nullptr;
+        m_pContext->MapBuffer(pOldest->pStagingBuffer, MAP_READ, MAP_FLAG_DO_NOT_WAIT, pMappedData);
+        if (pMappedData == nullptr)
+            break;
+
+        const float2* pVelocities = static_cast<const float2*>(pMappedData);
+        for (auto& BatchQuery : pOldest->Queries)
+        {
+            const Uint32 NumPositions = static_cast<Uint32>(BatchQuery.Positions.size());
+            if (BatchQuery.OnComplete)
+                BatchQuery.OnComplete(pVelocities, NumPositions);
+            pVelocities += NumPositions;
+        }
+        m_pContext->UnmapBuffer(pOldest->pStagingBuffer, MAP_READ);
+
+        m_TotalResolvedQueries += pOldest->Queries.size();
+        pOldest->Queries.clear();
+        pOldest->Pending = false;
+    }
+}
+
+Tutorial14_VelocityQuery::Statistics Tutorial14_VelocityQuery::GetStatistics() const
+{
+    Statistics Stats;
+    {
+        std::lock_guard<std::mutex> Lock{m_QueueMtx};
+        Stats.NumPendingQueries = static_cast<Uint32>(m_Queue.size());
+    }
+    for (const auto& BatchSlot : m_Slots)
+    {
+        if (BatchSlot.Pending)
+            ++Stats.NumInFlightBatches;
+    }
+    Stats.LastBatchPositions   = m_LastBatchPositions;
+    Stats.TotalResolvedQueries = m_TotalResolvedQueries;
+    return Stats;
+}
+
+} // namespace Diligent
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+#include "BasicMath.hpp"
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "EngineFactory.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+class Tutorial14_FrameAllocator;
+
+// Consultas por lotes del campo de velocidad del fluido. Los sistemas que sondean el
+// flujo en muchos puntos encolan posiciones desde cualquier hilo; una vez por frame
+// todas las consultas encoladas se resuelven con un solo dispatch que muestrea la
+// textura de velocidad real, y los resultados se copian a la CPU de forma asncrona.
+// Cuando la copia termina se entregan con el callback o el future de cada consulta.
+class Tutorial14_VelocityQuery
+{
+public:
+    static constexpr Uint32 QUERY_GROUP_SIZE = 256;
+
+    // Posiciones que se resuelven como mximo en un frame; las que no caben esperan al siguiente
+    static constexpr Uint32 DEFAULT_MAX_POSITIONS_PER_FRAME = 16384;
+
+    // Lotes en vuelo antes de que las consultas esperen a que termine una copia
+    static constexpr Uint32 NUM_READBACK_SLOTS = 3;
+
+    // pVelocities tiene NumPositions velocidades en el mismo orden que las posiciones, en
+    // texels por segundo como el campo del fluido. Solo es vlido durante la llamada.
+    using Callback = std::function<void(const float2* pVelocities, Uint32 NumPositions)>;
+
+    Tutorial14_VelocityQuery(IRenderDevice*             pDevice,
+                             IDeviceContext*            pContext,
+                             IEngineFactory*            pEngineFactory,
+                             Tutorial14_FrameAllocator* pFrameAllocator,
+                             Uint32                     MaxPositionsPerFrame = DEFAULT_MAX_POSITIONS_PER_FRAME);
+
+    bool IsValid() const { return m_pQueryPSO != nullptr && m_pFence != nullptr && !m_Slots.empty(); }
+
+    // Encola una consulta con posiciones en el espacio de las partculas ([-1, 1] alrededor
+    // del centro de la ventana del campo en el modo mundo); fuera de ese rango la velocidad
+    // es cero. Puede llamarse desde cualquier hilo. Devuelve false si la consulta no cabe
+    // en un frame.
+    bool Submit(const float2* pPositions, Uint32 NumPositions, Callback OnComplete);
+    // Igual que Submit(), pero el resultado se entrega en un future. Si el objeto se destruye
+    // antes de resolver la consulta, el future lanza std::future_error (broken_promise).
+    std::future<std::vector<float2>> Submit(std::vector<float2> Positions);
+
+    // Hilo de render, una vez por frame: graba el dispatch de las consultas encoladas sobre
+    // el campo indicado, con su ventana centrada en f2FluidWindowCenter, y la copia de los
+    // resultados
+    void Dispatch(ITextureView* pVelocitySRV, const float2& f2FluidWindowCenter);
+    // Hilo de render: entrega los resultados de las copias completadas. Los callbacks se
+    // ejecutan dentro de esta llamada.
+    void Poll();
+
+    struct Statistics
+    {
+        Uint32 NumPendingQueries    = 0; // Encoladas y todava sin dispatch
+        Uint32 NumInFlightBatches   = 0;
+        Uint32 LastBatchPositions   = 0;
+        Uint64 TotalResolvedQueries = 0;
+    };
+    Statistics GetStatistics() const;
+
+private:
+    struct Query
+    {
+        std::vector<float2> Positions;
+        Callback            OnComplete;
+    };
+
+    struct Slot
+    {
+        RefCntAutoPtr<IBuffer>                pPositionsBuffer;
+        RefCntAutoPtr<IBuffer>                pVelocitiesBuffer;
+        RefCntAutoPtr<IBuffer>                pStagingBuffer;
+        RefCntAutoPtr<IShaderResourceBinding> pSRB;
+
+        std::vector<Query> Queries; // Consultas del lote, en el orden de sus posiciones
+        Uint64             FenceValue = 0;
+        bool               Pending    = false;
+    };
+
+    void CreatePipeline();
+
+    IRenderDevice*             m_pDevice         = nullptr;
+    IDeviceContext*            m_pContext        = nullptr;
+    IEngineFactory*            m_pEngineFactory  = nullptr;
+    Tutorial14_FrameAllocator* m_pFrameAllocator = nullptr;
+
+    Uint32 m_MaxPositionsPerFrame = 0;
+
+    RefCntAutoPtr<IPipelineState> m_pQueryPSO;
+    RefCntAutoPtr<IFence>         m_pFence;
+    std::vector<Slot>             m_Slots;
+    Uint32                        m_NextSlot       = 0;
+    Uint64                        m_NextFenceValue = 1;
+
+    // Consultas encoladas por Submit() desde cualquier hilo
+    mutable std::mutex m_QueueMtx;
+    std::deque<Query>  m_Queue;
+
+    Uint32 m_LastBatchPositions   = 0;
+    Uint64 m_TotalResolvedQueries = 0;
+};
+
+} // namespace Diligent